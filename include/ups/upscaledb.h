@@ -57,6 +57,8 @@
  * <table>
  * <tr><td>@ref ups_db_insert</td><td>Inserts a key/value pair into a
   Database</td></tr>
+ * <tr><td>@ref ups_db_bulk_insert</td><td>Inserts a batch of sorted
+  key/value pairs into a Database</td></tr>
  * <tr><td>@ref ups_db_find</td><td>Lookup of a key/value pair in a
   Database</td></tr>
  * <tr><td>@ref ups_db_erase</td><td>Erases a key/value pair from a
@@ -570,6 +572,20 @@ ups_get_version(uint32_t *major, uint32_t *minor,
  *      By default, upscaledb checks if it can use mmap,
  *      since mmap is faster than read/write. For performance
  *      reasons, this flag should not be used.
+ *     <li>@ref UPS_ENABLE_IO_URING</li> Uses Linux io_uring for pages
+ *      which are read or written with read/write instead of mmap: page
+ *      writes are submitted in batches, and cursor scans read the next
+ *      leaf pages ahead. Falls back to regular read/write if io_uring is
+ *      not available.
+ *     <li>@ref UPS_ENABLE_DIRECT_IO</li> Bypasses the page cache of the
+ *      operating system (O_DIRECT on Linux) and disables mmap; upscaledb's
+ *      own cache is then the only cache. Page buffers are aligned and
+ *      recycled. Best with page sizes that are a multiple of 4 kb. Ignored
+ *      if not supported by the platform.
+ *     <li>@ref UPS_ENABLE_HUGE_PAGES</li> Page buffers are allocated from
+ *      2 mb slabs which are backed by huge pages (MAP_HUGETLB on Linux,
+ *      requires reserved huge pages); otherwise transparent huge pages
+ *      are requested. The slabs are limited by the cache size.
  *     <li>@ref UPS_CACHE_UNLIMITED</li> Do not limit the cache. Nearly as
  *      fast as an In-Memory Database. Not allowed in combination
  *      with a limited cache size.
@@ -590,6 +606,22 @@ ups_get_version(uint32_t *major, uint32_t *minor,
  *    <li>@ref UPS_PARAM_CACHE_SIZE</li> The size of the Database cache,
  *      in bytes. The default size is defined in src/config.h
  *      as @a UPS_DEFAULT_CACHE_SIZE - usually 2MB
+ *    <li>@ref UPS_PARAM_CACHE_POLICY</li> The page replacement policy of
+ *      the cache. Allowed values are @ref UPS_CACHE_POLICY_LRU (which is
+ *      the default) or @ref UPS_CACHE_POLICY_2Q.
+ *    <li>@ref UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC</li> If @ref
+ *      UPS_ENABLE_FSYNC is set then concurrent calls to @ref ups_txn_commit
+ *      share a single fsync; a commit waits up to this many microseconds
+ *      for other commits to join. Default is 0 (every commit is synced
+ *      on its own).
+ *    <li>@ref UPS_PARAM_FLUSH_THREADS</li> The number of background
+ *      threads which write modified pages to disk. Default is 1.
+ *    <li>@ref UPS_PARAM_QUERY_THREADS</li> The number of threads which
+ *      scan the Btree leafs of a UQI query (@ref uqi_select) in parallel.
+ *      Default is 1 (queries are not parallelized).
+ *    <li>@ref UPS_PARAM_SCAN_READAHEAD</li> The number of Btree leafs
+ *      which are read ahead when a Cursor or a UQI query scans the
+ *      Database sequentially. Default is 8; 0 disables the read-ahead.
  *    <li>@ref UPS_PARAM_POSIX_FADVISE</li> Sets the "advice" for
  *      posix_fadvise(). Only on supported platforms. Allowed values are
  *      @ref UPS_POSIX_FADVICE_NORMAL (which is the default) or
@@ -687,6 +719,20 @@ ups_env_create(ups_env_t **env, const char *filename,
  *      By default, upscaledb checks if it can use mmap,
  *      since mmap is faster than read/write. For performance
  *      reasons, this flag should not be used.
+ *     <li>@ref UPS_ENABLE_IO_URING </li> Uses Linux io_uring for pages
+ *      which are read or written with read/write instead of mmap: page
+ *      writes are submitted in batches, and cursor scans read the next
+ *      leaf pages ahead. Falls back to regular read/write if io_uring is
+ *      not available.
+ *     <li>@ref UPS_ENABLE_DIRECT_IO </li> Bypasses the page cache of the
+ *      operating system (O_DIRECT on Linux) and disables mmap; upscaledb's
+ *      own cache is then the only cache. Page buffers are aligned and
+ *      recycled. Best with page sizes that are a multiple of 4 kb. Ignored
+ *      if not supported by the platform.
+ *     <li>@ref UPS_ENABLE_HUGE_PAGES </li> Page buffers are allocated from
+ *      2 mb slabs which are backed by huge pages (MAP_HUGETLB on Linux,
+ *      requires reserved huge pages); otherwise transparent huge pages
+ *      are requested. The slabs are limited by the cache size.
  *     <li>@ref UPS_CACHE_UNLIMITED </li> Do not limit the cache. Nearly as
  *      fast as an In-Memory Database. Not allowed in combination
  *      with a limited cache size.
@@ -705,6 +751,22 @@ ups_env_create(ups_env_t **env, const char *filename,
  *    <li>@ref UPS_PARAM_CACHE_SIZE </li> The size of the Database cache,
  *      in bytes. The default size is defined in src/config.h
  *      as @a UPS_DEFAULT_CACHE_SIZE - usually 2MB
+ *    <li>@ref UPS_PARAM_CACHE_POLICY</li> The page replacement policy of
+ *      the cache. Allowed values are @ref UPS_CACHE_POLICY_LRU (which is
+ *      the default) or @ref UPS_CACHE_POLICY_2Q.
+ *    <li>@ref UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC</li> If @ref
+ *      UPS_ENABLE_FSYNC is set then concurrent calls to @ref ups_txn_commit
+ *      share a single fsync; a commit waits up to this many microseconds
+ *      for other commits to join. Default is 0 (every commit is synced
+ *      on its own).
+ *    <li>@ref UPS_PARAM_FLUSH_THREADS</li> The number of background
+ *      threads which write modified pages to disk. Default is 1.
+ *    <li>@ref UPS_PARAM_QUERY_THREADS</li> The number of threads which
+ *      scan the Btree leafs of a UQI query (@ref uqi_select) in parallel.
+ *      Default is 1 (queries are not parallelized).
+ *    <li>@ref UPS_PARAM_SCAN_READAHEAD</li> The number of Btree leafs
+ *      which are read ahead when a Cursor or a UQI query scans the
+ *      Database sequentially. Default is 8; 0 disables the read-ahead.
  *    <li>@ref UPS_PARAM_POSIX_FADVISE</li> Sets the "advice" for
  *      posix_fadvise(). Only on supported platforms. Allowed values are
  *      @ref UPS_POSIX_FADVICE_NORMAL (which is the default) or
@@ -750,6 +812,12 @@ ups_env_open(ups_env_t **env, const char *filename,
  * The following parameters are supported:
  *    <ul>
  *    <li>UPS_PARAM_CACHE_SIZE</li> returns the cache size
+ *    <li>@ref UPS_PARAM_CACHE_POLICY</li> returns the page replacement
+ *        policy of the cache
+ *    <li>@ref UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC</li> returns the
+ *        time window for group commits, in microseconds
+ *    <li>@ref UPS_PARAM_FLUSH_THREADS</li> returns the number of
+ *        background threads which flush modified pages
  *    <li>UPS_PARAM_PAGE_SIZE</li> returns the page size
  *    <li>UPS_PARAM_MAX_DATABASES</li> returns the max. number of
  *        Databases of this Database's Environment
@@ -880,6 +948,24 @@ ups_env_get_parameters(ups_env_t *env, ups_parameter_t *param);
  * change and might be removed in following versions. They only work with the
  * default page size of 16kb.
  *
+ * Databases created with the type @ref UPS_TYPE_UINT64 can use the
+ * *experimental* algorithms @ref UPS_COMPRESSOR_UINT64_FOR and
+ * @ref UPS_COMPRESSOR_UINT64_STREAMVBYTE, which work well for ascending
+ * 64bit timestamps or IDs. They also require the default page size of 16kb.
+ *
+ * Records of a numeric type (@ref UPS_TYPE_UINT8 to @ref UPS_TYPE_REAL64)
+ * can be compressed with @ref UPS_COMPRESSOR_NUMERIC. Integer records are
+ * stored as bit-packed differences to the smallest record of a block,
+ * floating point records as the XOR with the first record of a block.
+ * This works best for counters or measurements which change slowly from
+ * key to key. Duplicate keys are not supported.
+ *
+ * Variable length binary keys (i.e. URLs or file paths) which share long
+ * prefixes can be compressed with @ref UPS_COMPRESSOR_PREFIX. Each node
+ * then stores the common prefix of its keys only once, and the separator
+ * keys in the internal nodes are truncated to the shortest length that
+ * still separates the leaves.
+ *
  * @param env A valid Environment handle.
  * @param db A valid Database handle, which will point to the created
  *      Database. To close the handle, use @ref ups_db_close.
@@ -1177,9 +1263,18 @@ typedef struct ups_txn_t ups_txn_t;
  *    <ul>
  *     <li>@ref UPS_TXN_READ_ONLY </li> This Transaction is read-only and
  *      will not modify the Database.
+ *     <li>@ref UPS_TXN_SNAPSHOT </li> Reads from a consistent snapshot
+ *      of the Environment, taken when the Transaction begins. Changes of
+ *      Transactions which are still active or which commit later are
+ *      invisible, and reads never fail with @ref UPS_TXN_CONFLICT.
+ *      Requires @ref UPS_TXN_READ_ONLY; all modifications fail with
+ *      @ref UPS_WRITE_PROTECTED. Committed Transactions are not flushed
+ *      to the Btree while an older snapshot is still active.
  *    </ul>
  *
  * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @ref UPS_TXN_SNAPSHOT is specified
+ *      without @ref UPS_TXN_READ_ONLY
  * @return @ref UPS_OUT_OF_MEMORY if memory allocation failed
  */
 UPS_EXPORT ups_status_t
@@ -1192,6 +1287,9 @@ ups_txn_begin(ups_txn_t **txn, ups_env_t *env, const char *name,
 /* Internal flag for @ref ups_txn_begin */
 #define UPS_TXN_TEMPORARY                     2
 
+/** Flag for @ref ups_txn_begin */
+#define UPS_TXN_SNAPSHOT                     16
+
 /**
  * Retrieves the Transaction name
  *
@@ -1263,13 +1361,19 @@ ups_txn_abort(ups_txn_t *txn, uint32_t flags);
  * This flag is non persistent. */
 #define UPS_READ_ONLY                               0x00000004
 
-/* unused                                           0x00000008 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_IO_URING                         0x00000008
 
-/* unused                                           0x00000010 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_DIRECT_IO                        0x00000010
 
 /* reserved                                         0x00000020 */
 
-/* unused                                           0x00000040 */
+/** Flag for @ref ups_env_open, @ref ups_env_create.
+ * This flag is non persistent. */
+#define UPS_ENABLE_HUGE_PAGES                       0x00000040
 
 /** Flag for @ref ups_env_create.
  * This flag is non persistent. */
@@ -1536,6 +1640,54 @@ UPS_EXPORT ups_status_t UPS_CALLCONV
 ups_db_insert(ups_db_t *db, ups_txn_t *txn, ups_key_t *key,
             ups_record_t *record, uint32_t flags);
 
+/**
+ * Inserts a batch of sorted key/record pairs (bulk load)
+ *
+ * The keys are appended to the Database without traversing the Btree;
+ * new Btree nodes are filled up to @a fill_factor percent and are never
+ * split. This is much faster than inserting the keys with
+ * @ref ups_db_insert or @ref ups_cursor_insert and @ref UPS_HINT_APPEND.
+ *
+ * The keys in @a keys must be sorted in ascending order (according to
+ * the compare function of the Database), must not contain duplicates
+ * and must be greater than all keys which are already stored in the
+ * Database. Otherwise @ref UPS_INV_PARAMETER is returned and the Database
+ * is not modified.
+ *
+ * The keys are written directly to the Btree, bypassing the Transactions
+ * and the logical journal. If Transactions are enabled then all committed
+ * Transactions are flushed first; the function fails if a Transaction is
+ * still active. If recovery is enabled then each batch is logged as a
+ * single atomic change. Large batches therefore require more memory.
+ *
+ * This function is not supported for Record Number Databases and for
+ * remote Databases.
+ *
+ * @param db A valid Database handle
+ * @param keys An array of @a count sorted keys
+ * @param records An array of @a count records
+ * @param count The number of keys and records
+ * @param fill_factor The percentage of each new Btree node which is
+ *        filled (1 - 100); 0 is the same as 100 (fully packed nodes).
+ *        A lower fill factor leaves room for subsequent inserts.
+ * @param flags Optional flags; unused, set to 0
+ *
+ * @return @ref UPS_SUCCESS upon success
+ * @return @ref UPS_INV_PARAMETER if @a db, @a keys or @a records is NULL
+ * @return @ref UPS_INV_PARAMETER if the keys are not sorted, or are not
+ *        greater than the existing keys, or if the Database is a Record
+ *        Number Database
+ * @return @ref UPS_INV_PARAMETER if @a fill_factor is greater than 100
+ * @return @ref UPS_WRITE_PROTECTED if the Database is read-only
+ * @return @ref UPS_TXN_STILL_OPEN if a Transaction is active
+ * @return @ref UPS_INV_KEY_SIZE or @ref UPS_INV_RECORD_SIZE if the size
+ *        of a key or record does not match the Database configuration
+ * @return @ref UPS_NOT_IMPLEMENTED if the Database is a remote Database
+ */
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_insert(ups_db_t *db, ups_key_t *keys, ups_record_t *records,
+            uint32_t count, uint32_t fill_factor, uint32_t flags);
+
 /**
  * Flag for @ref ups_db_insert and @ref ups_cursor_insert
  *
@@ -1761,6 +1913,37 @@ ups_db_get_parameters(ups_db_t *db, ups_parameter_t *param);
 /** Value for @ref UPS_PARAM_POSIX_FADVISE */
 #define UPS_POSIX_FADVICE_RANDOM                 1
 
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * page replacement policy of the cache */
+#define UPS_PARAM_CACHE_POLICY          0x00000113
+
+/** Value for @ref UPS_PARAM_CACHE_POLICY: evicts the least recently used
+ * pages (this is the default) */
+#define UPS_CACHE_POLICY_LRU                     0
+
+/** Value for @ref UPS_PARAM_CACHE_POLICY: a scan-resistant "2Q" policy.
+ * Pages which are accessed only once (i.e. during a full table scan) are
+ * evicted before pages which are accessed frequently */
+#define UPS_CACHE_POLICY_2Q                      1
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; enables
+ * group commit for @ref UPS_ENABLE_FSYNC. A committing Transaction waits
+ * up to this many microseconds for other Transactions to commit, then
+ * all of them are synced with a single fsync */
+#define UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC 0x00000114
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of background threads which write modified pages to disk */
+#define UPS_PARAM_FLUSH_THREADS         0x00000115
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of threads which execute a UQI query in parallel */
+#define UPS_PARAM_QUERY_THREADS         0x00000116
+
+/** Parameter name for @ref ups_env_create, @ref ups_env_open; sets the
+ * number of Btree leafs which are read ahead during sequential scans */
+#define UPS_PARAM_SCAN_READAHEAD        0x00000117
+
 /** Value for unlimited record sizes */
 #define UPS_RECORD_SIZE_UNLIMITED       ((uint32_t)-1)
 
@@ -1874,6 +2057,31 @@ ups_db_get_parameters(ups_db_t *db, ups_parameter_t *param);
  */
 #define UPS_COMPRESSOR_UINT32_SIMDFOR      11
 
+/**
+ * prefix compression for variable length binary keys; each Btree node
+ * stores the common prefix of its keys only once. Only allowed for
+ * keys of type UPS_TYPE_BINARY with UPS_KEY_SIZE_UNLIMITED.
+ */
+#define UPS_COMPRESSOR_PREFIX              12
+
+/**
+ * uint64 key compression (FOR - Frame Of Reference)
+ */
+#define UPS_COMPRESSOR_UINT64_FOR          13
+
+/**
+ * uint64 key compression (Stream Vbyte compression)
+ */
+#define UPS_COMPRESSOR_UINT64_STREAMVBYTE  14
+
+/**
+ * compression for numeric records (@ref UPS_TYPE_UINT8 to
+ * @ref UPS_TYPE_REAL64); the records are bit-packed in the Btree leaf.
+ * Only allowed for @ref UPS_PARAM_RECORD_COMPRESSION, and not in
+ * combination with duplicate keys.
+ */
+#define UPS_COMPRESSOR_NUMERIC             15
+
 /**
  * Retrieves the Environment handle of a Database
  *
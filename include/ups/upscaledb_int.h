@@ -207,7 +207,7 @@ typedef struct btree_metrics_t {
  * Metrics marked "global" are stored globally and shared between multiple
  * Environments.
  */
-#define UPS_METRICS_VERSION         9
+#define UPS_METRICS_VERSION         10
 
 typedef struct ups_env_metrics_t {
   /* the version indicator - must be UPS_METRICS_VERSION */
@@ -257,6 +257,18 @@ typedef struct ups_env_metrics_t {
   /* number of cache misses */
   uint64_t cache_misses;
 
+  /* the page replacement policy of the cache (UPS_CACHE_POLICY_*) */
+  int cache_policy;
+
+  /* the number of (independently locked) shards of the cache */
+  uint32_t cache_shards;
+
+  /* 2Q: number of cache misses of recently evicted pages ("ghost hits") */
+  uint64_t cache_ghost_hits;
+
+  /* 2Q: number of pages in the probation queue */
+  uint64_t cache_probation_pages;
+
   /* number of blobs allocated */
   uint64_t blob_total_allocated;
 
@@ -284,6 +296,54 @@ typedef struct ups_env_metrics_t {
   /* PRO: log/journal bytes after compression */
   uint64_t journal_bytes_after_compression;
 
+  /* number of commits which were synced by a group commit */
+  uint64_t journal_group_commits;
+
+  /* number of fsyncs issued by group commits; commits per fsync is
+   * journal_group_commits / journal_group_fsyncs */
+  uint64_t journal_group_fsyncs;
+
+  /* io_uring: number of read and write requests submitted to the ring */
+  uint64_t io_uring_submissions;
+
+  /* io_uring: the max. number of requests which were in flight at the
+   * same time */
+  uint64_t io_uring_max_queue_depth;
+
+  /* io_uring: accumulated completion latency of all requests, in
+   * microseconds; the average is io_uring_latency_usec / io_uring_submissions */
+  uint64_t io_uring_latency_usec;
+
+  /* number of pages which were read ahead during cursor scans and UQI
+   * queries */
+  uint64_t page_count_prefetched;
+
+  /* number of read-ahead pages which were actually used */
+  uint64_t page_count_prefetch_hits;
+
+  /* number of read-ahead pages which were discarded (i.e. because they
+   * were overwritten) before they were used */
+  uint64_t page_count_prefetch_wasted;
+
+  /* bytes of page buffers allocated by the device (in use and pooled) */
+  uint64_t page_buffer_bytes;
+
+  /* number of unused page buffers which are pooled for reuse */
+  uint64_t page_buffers_pooled;
+
+  /* number of page buffers which are currently in use */
+  uint64_t page_buffers_in_use;
+
+  /* max. number of bytes reserved for pooled page buffers (0: unlimited) */
+  uint64_t page_buffer_capacity;
+
+  /* bytes of pooled page buffers which are backed by huge pages */
+  uint64_t page_buffer_huge_page_bytes;
+
+  /* number of page buffers which did not fit into the pool and were
+   * allocated from the heap */
+  uint64_t page_buffer_overflows;
+
   /* PRO: record bytes before compression */
   uint64_t record_bytes_before_compression;
 
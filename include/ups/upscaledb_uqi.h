@@ -177,6 +177,15 @@ typedef int (*uqi_plugin_predicate_function)(void *state,
 /** Assigns the results to an @a uqi_result_t structure */
 typedef void (*uqi_plugin_result_function)(void *state, uqi_result_t *result);
 
+/**
+ * Merges the state of another instance of an aggregation plugin into
+ * |state|. Used if a query is executed by several threads in parallel
+ * (see @ref UPS_PARAM_QUERY_THREADS); each thread aggregates a range of
+ * keys with its own state. |other_state| always aggregated the keys which
+ * follow the keys aggregated in |state|, and is released after this call.
+ */
+typedef void (*uqi_plugin_merge_function)(void *state, void *other_state);
+
 /** Describes a plugin for predicates */
 #define UQI_PLUGIN_PREDICATE                    1
 
@@ -233,7 +242,10 @@ typedef struct {
    */
   uint32_t flags;
 
-  /** The version of the plugin's interface; always set to 0 */
+  /**
+   * The version of the plugin's interface; set to 0, or to 1 if the
+   * plugin implements @a merge
+   */
   uint32_t plugin_version;
 
   /** The initialization function; can be null */
@@ -263,6 +275,13 @@ typedef struct {
   /** Assigns the result to a @a uqi_result_t structure; must not be null */
   uqi_plugin_result_function results;
 
+  /**
+   * Merges the states of two instances of an aggregation plugin; can be
+   * null. Only evaluated if @a plugin_version is 1 or higher. If
+   * implemented then queries with this plugin can be executed in parallel.
+   */
+  uqi_plugin_merge_function merge;
+
 } uqi_plugin_t;
 
 
@@ -319,8 +338,12 @@ uqi_select(ups_env_t *env, const char *query, uqi_result_t **result);
  *
  * The supplied @ref query string has a syntax similar to SQL:
  *
- *   [DISTINCT] <FUNCTION>(<STREAM>) FROM DATABASE <DB>
- *          [WHERE <PREDICATE>(<STREAM>)]
+ *   [DISTINCT] <FUNCTION>(<STREAM>)[, <FUNCTION>(<STREAM>)...]
+ *          FROM DATABASE <DB>
+ *          [WHERE <PREDICATE>(<STREAM>[, <ARGUMENT>...])
+ *            | WHERE <STREAM> <OPERATOR> <ARGUMENT>
+ *            | WHERE <STREAM> BETWEEN <ARGUMENT> AND <ARGUMENT>]
+ *          [GROUP BY <GROUP>]
  *          [LIMIT <LIMIT>]
  *
  *   DISTINCT: an optional key word which strips the query input from all
@@ -334,15 +357,62 @@ uqi_select(ups_env_t *env, const char *query, uqi_result_t **result);
  *
  *   DB: the numerical id of the database
  *
- *   PREDICATE: an identifier for a predicate function.
+ *   PREDICATE: an identifier for a predicate function. Built-in predicates
+ *          are the numeric comparisons "eq", "lt", "le", "gt", "ge" (with one
+ *          argument) and "between" (with two arguments, both inclusive),
+ *          i.e. "WHERE between($key, 100, 200)". They are not available for
+ *          binary keys or records. "starts_with" (with one argument) is
+ *          only available for binary keys and records and compares the
+ *          prefix of the stream, i.e. "WHERE starts_with($key, \"abc\")".
+ *          Built-in comparisons of the key skip all leafs and compressed
+ *          blocks which are out of range, unless @a begin is specified.
+ *          Other built-in comparisons are evaluated on whole arrays of
+ *          keys or records, which are filtered with SIMD instructions.
+ *          Other identifiers are names of registered plugins, which do not
+ *          accept arguments.
+ *
+ *   OPERATOR: the infix form of a numeric comparison; one of "=", "==",
+ *          "<", "<=", ">", ">=", i.e. "WHERE $record >= 10" is identical
+ *          to "WHERE ge($record, 10)"
+ *
+ *   ARGUMENT: a number or a string; strings can be quoted with '"'
  *
  *   STREAM: a literal "$key" or "$record"; decides whether keys or
  *          records are aggregated
  *
+ *   GROUP: a literal "$key" or "$record", or "prefix(<STREAM>, <SIZE>)"
+ *          (the first SIZE bytes of the stream), or
+ *          "field(<STREAM>, <OFFSET>, <SIZE>)" (SIZE bytes starting at
+ *          OFFSET). The functions are calculated separately for each
+ *          distinct value of the group.
+ *
  *   LIMIT: a limit for the result. Currently ONLY allowed for the built-in
  *          functions "TOP" and "BOTTOM"! When used with other functions then
  *          an error is returned.
  *
+ * All functions of a query are calculated in a single scan. If several
+ * functions are specified, or if GROUP BY is used, then TOP, BOTTOM and
+ * VALUE are not allowed, and the result has one row per group and
+ * function; the rows are sorted by group, then by the order of the
+ * functions in the query. The key of each row is the value of the group
+ * (or the upper-case function name, i.e. "SUM", if GROUP BY is not used),
+ * the record is the aggregated value. The key type is the type of the
+ * grouped stream if the whole stream is grouped, otherwise
+ * @ref UPS_TYPE_BINARY. The record type is @ref UPS_TYPE_BINARY unless all
+ * values have the same type.
+ *
+ * If the Environment was created with @ref UPS_PARAM_QUERY_THREADS then
+ * the leafs of the database are split into ranges which are scanned by
+ * several threads in parallel. This requires a database without
+ * duplicate keys, without pending Transactions, with fixed-length keys,
+ * with inline records (or records which are not required by the query)
+ * and neither @a begin nor @a end. COUNT, MIN, MAX, and SUM of integers
+ * are parallelized, as well as TOP and BOTTOM of keys and plugins which
+ * implement @a uqi_plugin_t::merge; queries with several functions or
+ * with GROUP BY are parallelized if all of their functions are. All other
+ * queries are executed by
+ * the calling thread.
+ *
  * The @a result object is allocated automatically and has to be released
  * with @a uqi_result_close by the caller.
  *
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+#ifndef WIN32
+#  include <sys/mman.h>
+#endif
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1mem/buffer_pool.h"
+#include "1mem/mem.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+// Allocates a slab; tries to use huge pages if |use_huge_pages| is true.
+// MAP_HUGETLB requires reserved huge pages (/proc/sys/vm/nr_hugepages);
+// otherwise the kernel is advised to use transparent huge pages.
+static uint8_t *
+allocate_slab(size_t size, bool use_huge_pages, bool *is_huge)
+{
+  *is_huge = false;
+
+#ifdef MAP_HUGETLB
+  if (use_huge_pages && size % BufferPool::kSlabSize == 0) {
+    void *p = ::mmap(0, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+      *is_huge = true;
+      return (uint8_t *)p;
+    }
+  }
+#endif
+
+  uint8_t *p = Memory::allocate_aligned<uint8_t>(size, BufferPool::kSlabSize);
+#ifdef MADV_HUGEPAGE
+  if (use_huge_pages)
+    (void)::madvise(p, size, MADV_HUGEPAGE);
+#endif
+  return p;
+}
+
+// Releases a slab which was allocated with allocate_slab()
+static void
+release_slab(uint8_t *p, const BufferPool::Slab &slab)
+{
+#ifdef MAP_HUGETLB
+  if (slab.is_huge) {
+    ::munmap(p, slab.size);
+    return;
+  }
+#endif
+  Memory::release_aligned(p);
+}
+
+BufferPool::BufferPool(size_t alignment, uint64_t capacity,
+                bool use_huge_pages)
+  : alignment(alignment), capacity(capacity), use_huge_pages(use_huge_pages),
+    buffer_size(0), slab_bytes(0), huge_page_bytes(0), in_use(0),
+    heap_buffers(0), overflows(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+  ScopedSpinlock lock(mutex);
+  free_list.clear();
+  for (SlabMap::iterator it = slabs.begin(); it != slabs.end(); it++)
+    release_slab(it->first, it->second);
+  slabs.clear();
+}
+
+uint8_t *
+BufferPool::alloc(size_t size)
+{
+  {
+    ScopedSpinlock lock(mutex);
+    if (size != buffer_size)
+      reset_nolock(size);
+
+    if (free_list.empty())
+      grow_nolock();
+
+    in_use++;
+    if (!free_list.empty()) {
+      uint8_t *p = free_list.back();
+      free_list.pop_back();
+      return p;
+    }
+
+    // the pool is exhausted; fall back to the heap
+    heap_buffers++;
+    overflows++;
+  }
+
+  try {
+    return Memory::allocate_aligned<uint8_t>(size, alignment);
+  }
+  catch (Exception &) {
+    ScopedSpinlock lock(mutex);
+    in_use--;
+    heap_buffers--;
+    throw;
+  }
+}
+
+void
+BufferPool::release(void *p)
+{
+  if (!p)
+    return;
+
+  {
+    ScopedSpinlock lock(mutex);
+    assert(in_use > 0);
+    in_use--;
+
+    Slab *slab = find_slab_nolock((uint8_t *)p);
+    if (slab) {
+      // buffers with an outdated size are not recycled
+      if (slab->buffer_size == buffer_size)
+        free_list.push_back((uint8_t *)p);
+      return;
+    }
+    heap_buffers--;
+  }
+
+  Memory::release_aligned(p);
+}
+
+void
+BufferPool::fill_metrics(ups_env_metrics_t *metrics)
+{
+  ScopedSpinlock lock(mutex);
+  metrics->page_buffer_bytes = slab_bytes + heap_buffers * buffer_size;
+  metrics->page_buffers_pooled = free_list.size();
+  metrics->page_buffers_in_use = in_use;
+  metrics->page_buffer_capacity = capacity;
+  metrics->page_buffer_huge_page_bytes = huge_page_bytes;
+  metrics->page_buffer_overflows = overflows;
+}
+
+void
+BufferPool::reset_nolock(size_t size)
+{
+  free_list.clear();
+  buffer_size = size;
+
+  if (in_use > 0)
+    return;
+
+  for (SlabMap::iterator it = slabs.begin(); it != slabs.end(); it++)
+    release_slab(it->first, it->second);
+  slabs.clear();
+  slab_bytes = 0;
+  huge_page_bytes = 0;
+}
+
+bool
+BufferPool::grow_nolock()
+{
+  size_t count = kSlabSize / buffer_size;
+  if (count == 0)
+    count = 1;
+
+  // stay within the capacity
+  if (capacity != 0) {
+    if (slab_bytes >= capacity)
+      return false;
+    uint64_t remaining = (capacity - slab_bytes) / buffer_size;
+    if (remaining == 0)
+      return false;
+    if (remaining < count)
+      count = (size_t)remaining;
+  }
+
+  size_t size = count * buffer_size;
+  Slab slab;
+  slab.size = size;
+  slab.buffer_size = buffer_size;
+  uint8_t *p = allocate_slab(size, use_huge_pages, &slab.is_huge);
+  slabs[p] = slab;
+
+  slab_bytes += size;
+  if (slab.is_huge)
+    huge_page_bytes += size;
+
+  // hand out the buffers in ascending order
+  free_list.reserve(free_list.size() + count);
+  for (size_t i = count; i > 0; i--)
+    free_list.push_back(p + (i - 1) * buffer_size);
+  return true;
+}
+
+BufferPool::Slab *
+BufferPool::find_slab_nolock(uint8_t *p)
+{
+  SlabMap::iterator it = slabs.upper_bound(p);
+  if (it == slabs.begin())
+    return 0;
+  --it;
+  if (p < it->first + it->second.size)
+    return &it->second;
+  return 0;
+}
+
+} // namespace upscaledb
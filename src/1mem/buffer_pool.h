@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * A pool of fixed-size buffers (i.e. for pages).
+ *
+ * The buffers are carved from large slabs, which are allocated on demand
+ * till |capacity| bytes are reached (usually the cache size). Released
+ * buffers are kept in a free list and are handed out again; the slabs are
+ * only returned to the operating system when the pool is destroyed.
+ * If the pool is exhausted then buffers are allocated from the heap, and
+ * released immediately when they are no longer used.
+ *
+ * Slabs can be backed by huge pages. If huge pages are not available then
+ * the slabs are aligned to the huge page size and the kernel is advised
+ * to use transparent huge pages.
+ *
+ * Buffers are aligned to |alignment| bytes if their size is a multiple of
+ * |alignment|.
+ *
+ * If the buffer size changes (i.e. because the page size of a file was
+ * read from its header) then the unused buffers are discarded.
+ *
+ * @exception_safe: strong
+ * @thread_safe: yes
+ */
+
+#ifndef UPS_BUFFER_POOL_H
+#define UPS_BUFFER_POOL_H
+
+#include "0root/root.h"
+
+#include <map>
+#include <vector>
+
+#include "ups/upscaledb_int.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/spinlock.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct BufferPool
+{
+  enum {
+    // The size of a slab; this is the huge page size on x86-64
+    kSlabSize = 2 * 1024 * 1024
+  };
+
+  // A contiguous chunk of memory which is split into buffers
+  struct Slab {
+    // the size of this slab
+    size_t size;
+
+    // the size of the buffers in this slab
+    size_t buffer_size;
+
+    // true if this slab was allocated with MAP_HUGETLB
+    bool is_huge;
+  };
+
+  typedef std::map<uint8_t *, Slab> SlabMap;
+
+  // Constructor; |capacity| is the max. number of bytes allocated for
+  // slabs (0: unlimited)
+  BufferPool(size_t alignment, uint64_t capacity, bool use_huge_pages);
+
+  // Destructor; releases the slabs. Buffers which are still in use
+  // are invalidated!
+  ~BufferPool();
+
+  // Returns a buffer with |size| bytes
+  uint8_t *alloc(size_t size);
+
+  // Returns a buffer to the pool
+  void release(void *p);
+
+  // Fills in the metrics
+  void fill_metrics(ups_env_metrics_t *metrics);
+
+  // Discards the unused buffers and sets a new buffer size; the slabs are
+  // released if no buffer is in use. The caller holds the lock.
+  void reset_nolock(size_t size);
+
+  // Allocates a new slab and adds its buffers to the free list; returns
+  // false if the capacity is exhausted. The caller holds the lock.
+  bool grow_nolock();
+
+  // Returns the slab which contains |p|, or null if |p| was allocated
+  // from the heap. The caller holds the lock.
+  Slab *find_slab_nolock(uint8_t *p);
+
+  // Protects the slabs, the free list and the counters
+  Spinlock mutex;
+
+  // The alignment of the buffers
+  size_t alignment;
+
+  // The max. number of bytes used for slabs
+  uint64_t capacity;
+
+  // True if huge pages should be used
+  bool use_huge_pages;
+
+  // The size of each buffer
+  size_t buffer_size;
+
+  // The slabs, indexed by their start address
+  SlabMap slabs;
+
+  // The unused buffers
+  std::vector<uint8_t *> free_list;
+
+  // The accumulated size of all slabs
+  uint64_t slab_bytes;
+
+  // The accumulated size of all slabs which are backed by huge pages
+  uint64_t huge_page_bytes;
+
+  // The number of buffers which are currently in use
+  uint64_t in_use;
+
+  // The number of buffers which are currently allocated from the heap
+  uint64_t heap_buffers;
+
+  // The number of allocations which did not fit into the slabs
+  uint64_t overflows;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_BUFFER_POOL_H */
@@ -29,6 +29,9 @@
 
 #include <new>
 #include <stdlib.h>
+#ifdef WIN32
+#  include <malloc.h>
+#endif
 #ifdef UPS_USE_TCMALLOC
 #  include <gperftools/tcmalloc.h>
 #endif
@@ -133,6 +136,37 @@ class Memory {
       }
     }
 
+    // allocates |size| bytes, aligned to |alignment| bytes (a power of two);
+    // the memory has to be released with release_aligned()
+    template<typename T>
+    static T *allocate_aligned(size_t size, size_t alignment) {
+      ms_total_allocations++;
+      ms_current_allocations++;
+#ifdef WIN32
+      T *t = (T *)::_aligned_malloc(size, alignment);
+#else
+      T *t = 0;
+      if (::posix_memalign((void **)&t, alignment, size) != 0)
+        t = 0;
+#endif
+      if (!t)
+        throw Exception(UPS_OUT_OF_MEMORY);
+      return t;
+    }
+
+    // releases a memory block which was allocated with allocate_aligned();
+    // can deal with NULL pointers
+    static void release_aligned(void *ptr) {
+      if (ptr) {
+        ms_current_allocations--;
+#ifdef WIN32
+        ::_aligned_free(ptr);
+#else
+        ::free(ptr);
+#endif
+      }
+    }
+
     // updates and returns the collected metrics
     static void get_global_metrics(ups_env_metrics_t *metrics);
 
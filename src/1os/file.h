@@ -60,17 +60,26 @@ class File
 #endif
     };
 
+    enum {
+      // With direct I/O, buffers, file offsets and lengths have to be
+      // aligned to this boundary
+      kDirectIoAlignment = 4096
+    };
+
     // Constructor: creates an empty File handle
     File()
-      : m_fd(UPS_INVALID_FD), m_mmaph(UPS_INVALID_FD), m_posix_advice(0) {
+      : m_fd(UPS_INVALID_FD), m_mmaph(UPS_INVALID_FD), m_posix_advice(0),
+        m_direct_fd(UPS_INVALID_FD), m_direct_io(false) {
     }
 
     // Copy constructor: moves ownership of the file handle
     File(File &other)
       : m_fd(other.m_fd), m_mmaph(other.m_mmaph),
-        m_posix_advice(other.m_posix_advice) {
+        m_posix_advice(other.m_posix_advice),
+        m_direct_fd(other.m_direct_fd), m_direct_io(other.m_direct_io) {
       other.m_fd = UPS_INVALID_FD;
 	  other.m_mmaph = UPS_INVALID_FD;
+      other.m_direct_fd = UPS_INVALID_FD;
     }
 
     // Destructor: closes the file
@@ -81,7 +90,10 @@ class File
     // Assignment operator: moves ownership of the file handle
     File &operator=(File &other) {
       m_fd = other.m_fd;
+      m_direct_fd = other.m_direct_fd;
+      m_direct_io = other.m_direct_io;
       other.m_fd = UPS_INVALID_FD;
+      other.m_direct_fd = UPS_INVALID_FD;
       return *this;
     }
 
@@ -96,12 +108,29 @@ class File
       return m_fd != UPS_INVALID_FD;
     }
 
+    // Returns the file handle
+    ups_fd_t fd() const {
+      return m_fd;
+    }
+
     // Flushes a file
     void flush();
 
     // Sets the parameter for posix_fadvise()
     void set_posix_advice(int parameter);
 
+    // Bypasses the operating system's page cache for reads and writes
+    // which are aligned to |kDirectIoAlignment|. On Linux, |filename| is
+    // opened a second time with O_DIRECT; unaligned requests (i.e. for the
+    // file header) use the regular descriptor. Returns false if this is
+    // not supported.
+    bool set_direct_io(const char *filename);
+
+    // Returns true if direct I/O is enabled
+    bool is_direct_io() const {
+      return m_direct_io;
+    }
+
     // Maps a file in memory
     //
     // mmap is called with MAP_PRIVATE - the allocated buffer
@@ -113,12 +142,30 @@ class File
     // Unmaps a buffer
     void munmap(void *buffer, size_t size);
 
+    // Discards the private copies of mapped pages which were modified;
+    // the next access reads the data from the file again. |buffer| and
+    // |size| must be aligned to the granularity
+    void discard_mapped(void *buffer, size_t size);
+
+    // Asks the operating system to read the range [addr, addr + len[
+    // into its page cache in the background (posix_fadvise(WILLNEED)).
+    // Only a hint; does nothing if direct I/O is enabled
+    void prefetch(uint64_t addr, size_t len);
+
+    // Asks the operating system to read mapped pages in the background
+    // (madvise(WILLNEED)). |buffer| must be aligned to the granularity
+    void prefetch_mapped(void *buffer, size_t size);
+
     // Positional read from a file
     void pread(uint64_t addr, void *buffer, size_t len);
 
     // Positional write to a file
     void pwrite(uint64_t addr, const void *buffer, size_t len);
 
+    // Positional write of multiple buffers to adjacent ranges of a file
+    void pwritev(uint64_t addr, const void **buffers, const size_t *lengths,
+                    size_t count);
+
     // Write data to a file; uses the current file position
     void write(const void *buffer, size_t len);
 
@@ -150,6 +197,12 @@ class File
     // Parameter for posix_fadvise()
     int m_posix_advice;
 
+    // A second file handle opened with O_DIRECT (only for aligned I/O)
+    ups_fd_t m_direct_fd;
+
+    // True if the page cache is bypassed
+    bool m_direct_io;
+
 #ifdef WIN32
 	// A mutex; required for Win32
 	Mutex m_mutex;
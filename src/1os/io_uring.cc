@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1os/io_uring.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+IoUring::IoUring()
+  : m_fd(-1), m_queued(0), m_sq_ptr(0), m_sq_size(0), m_cq_ptr(0),
+    m_cq_size(0), m_sqes(0), m_sqes_size(0), m_sq_head(0), m_sq_tail(0),
+    m_sq_mask(0), m_sq_array(0), m_cq_head(0), m_cq_tail(0), m_cq_mask(0),
+    m_cqes(0)
+{
+}
+
+uint64_t
+IoUring::now_usec()
+{
+  struct timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool
+IoUring::open(uint32_t entries)
+{
+  assert(m_fd == -1);
+
+  struct io_uring_params params;
+  ::memset(&params, 0, sizeof(params));
+
+  int fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    ups_log(("io_uring_setup failed with status %u (%s)", errno,
+                strerror(errno)));
+    return false;
+  }
+
+  m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  m_cq_size = params.cq_off.cqes
+                + params.cq_entries * sizeof(struct io_uring_cqe);
+  m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+  void *sq = ::mmap(0, m_sq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  void *cq = ::mmap(0, m_cq_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  void *sqes = ::mmap(0, m_sqes_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+    ups_log(("mmap of the io_uring failed with status %u (%s)", errno,
+                strerror(errno)));
+    if (sq != MAP_FAILED)
+      ::munmap(sq, m_sq_size);
+    if (cq != MAP_FAILED)
+      ::munmap(cq, m_cq_size);
+    if (sqes != MAP_FAILED)
+      ::munmap(sqes, m_sqes_size);
+    ::close(fd);
+    return false;
+  }
+
+  m_fd = fd;
+  m_sq_ptr = (uint8_t *)sq;
+  m_cq_ptr = (uint8_t *)cq;
+  m_sqes = (uint8_t *)sqes;
+
+  m_sq_head = (unsigned *)(m_sq_ptr + params.sq_off.head);
+  m_sq_tail = (unsigned *)(m_sq_ptr + params.sq_off.tail);
+  m_sq_mask = (unsigned *)(m_sq_ptr + params.sq_off.ring_mask);
+  m_sq_array = (unsigned *)(m_sq_ptr + params.sq_off.array);
+  m_cq_head = (unsigned *)(m_cq_ptr + params.cq_off.head);
+  m_cq_tail = (unsigned *)(m_cq_ptr + params.cq_off.tail);
+  m_cq_mask = (unsigned *)(m_cq_ptr + params.cq_off.ring_mask);
+  m_cqes = m_cq_ptr + params.cq_off.cqes;
+  m_queued = 0;
+  return true;
+}
+
+void
+IoUring::close()
+{
+  if (m_fd == -1)
+    return;
+
+  ::munmap(m_sqes, m_sqes_size);
+  ::munmap(m_cq_ptr, m_cq_size);
+  ::munmap(m_sq_ptr, m_sq_size);
+  ::close(m_fd);
+  m_fd = -1;
+  m_sq_ptr = m_cq_ptr = m_sqes = 0;
+  m_queued = 0;
+}
+
+// Returns the next free submission queue entry, or null if the queue
+// is full
+static inline struct io_uring_sqe *
+next_sqe(uint8_t *sqes, unsigned *sq_head, unsigned *sq_tail,
+                unsigned *sq_mask, unsigned *sq_array)
+{
+  unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+  unsigned tail = *sq_tail;
+  if (tail - head > *sq_mask)
+    return 0;
+
+  unsigned index = tail & *sq_mask;
+  struct io_uring_sqe *sqe = (struct io_uring_sqe *)sqes + index;
+  ::memset(sqe, 0, sizeof(*sqe));
+  sq_array[index] = index;
+  return sqe;
+}
+
+bool
+IoUring::prepare_read(ups_fd_t fd, void *buffer, size_t len,
+                uint64_t offset, void *tag)
+{
+  struct io_uring_sqe *sqe = next_sqe(m_sqes, m_sq_head, m_sq_tail,
+                  m_sq_mask, m_sq_array);
+  if (!sqe)
+    return false;
+
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buffer;
+  sqe->len = (uint32_t)len;
+  sqe->off = offset;
+  sqe->user_data = (uint64_t)(uintptr_t)tag;
+
+  __atomic_store_n(m_sq_tail, *m_sq_tail + 1, __ATOMIC_RELEASE);
+  m_queued++;
+  return true;
+}
+
+bool
+IoUring::prepare_writev(ups_fd_t fd, const struct iovec *iov, int count,
+                uint64_t offset, void *tag)
+{
+  struct io_uring_sqe *sqe = next_sqe(m_sqes, m_sq_head, m_sq_tail,
+                  m_sq_mask, m_sq_array);
+  if (!sqe)
+    return false;
+
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)iov;
+  sqe->len = (uint32_t)count;
+  sqe->off = offset;
+  sqe->user_data = (uint64_t)(uintptr_t)tag;
+
+  __atomic_store_n(m_sq_tail, *m_sq_tail + 1, __ATOMIC_RELEASE);
+  m_queued++;
+  return true;
+}
+
+void
+IoUring::submit(uint32_t min_complete)
+{
+  uint32_t flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+  if (m_queued == 0 && min_complete == 0)
+    return;
+
+  while (true) {
+    int s = (int)::syscall(__NR_io_uring_enter, m_fd, m_queued,
+                    min_complete, flags, 0, 0);
+    if (s >= 0) {
+      // requests which were not consumed are picked up with the next call
+      m_queued -= std::min((uint32_t)s, m_queued);
+      return;
+    }
+    if (errno == EINTR)
+      continue;
+    ups_log(("io_uring_enter failed with status %u (%s)", errno,
+                strerror(errno)));
+    throw Exception(UPS_IO_ERROR);
+  }
+}
+
+bool
+IoUring::pop_completion(void **tag, int32_t *result)
+{
+  unsigned head = *m_cq_head;
+  if (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE))
+    return false;
+
+  struct io_uring_cqe *cqe = (struct io_uring_cqe *)m_cqes
+                                + (head & *m_cq_mask);
+  *tag = (void *)(uintptr_t)cqe->user_data;
+  *result = cqe->res;
+  __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+} // namespace upscaledb
+
+#endif // HAVE_LINUX_IO_URING_H
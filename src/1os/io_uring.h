@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * A minimal wrapper around a Linux io_uring instance (submission and
+ * completion queue). Uses the raw system calls, liburing is not required.
+ * Requests are identified by an opaque |tag| which is returned with
+ * the completion.
+ *
+ * Only available if HAVE_LINUX_IO_URING_H is defined. If the kernel does
+ * not support io_uring then open() returns false.
+ *
+ * @exception_safe: strong
+ * @thread_safe: no
+ */
+
+#ifndef UPS_IO_URING_H
+#define UPS_IO_URING_H
+
+#include "0root/root.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1os/os.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+struct iovec;
+
+namespace upscaledb {
+
+class IoUring
+{
+  public:
+    // Constructor: creates an empty ring
+    IoUring();
+
+    // Destructor: closes the ring
+    ~IoUring() {
+      close();
+    }
+
+    // Creates a ring with |entries| submission slots. Returns false if
+    // io_uring is not supported
+    bool open(uint32_t entries);
+
+    // Returns true if the ring was created
+    bool is_open() const {
+      return m_fd != -1;
+    }
+
+    // Closes the ring. The caller has to make sure that there are no
+    // pending requests.
+    void close();
+
+    // Queues a positional read; returns false if the submission queue
+    // is full
+    bool prepare_read(ups_fd_t fd, void *buffer, size_t len,
+                    uint64_t offset, void *tag);
+
+    // Queues a positional, vectored write; returns false if the
+    // submission queue is full. |iov| must stay valid till the request
+    // is completed.
+    bool prepare_writev(ups_fd_t fd, const struct iovec *iov, int count,
+                    uint64_t offset, void *tag);
+
+    // Submits all queued requests to the kernel, then waits till at
+    // least |min_complete| requests are completed
+    void submit(uint32_t min_complete);
+
+    // Fetches a completed request. Returns false if there is none.
+    // |result| is the number of bytes or a negative errno value.
+    bool pop_completion(void **tag, int32_t *result);
+
+    // Returns a monotonic time stamp in microseconds; used to measure
+    // the completion latency
+    static uint64_t now_usec();
+
+  private:
+    // the file descriptor of the ring
+    int m_fd;
+
+    // the number of queued, not yet submitted requests
+    uint32_t m_queued;
+
+    // the mapped submission queue ring
+    uint8_t *m_sq_ptr;
+    size_t m_sq_size;
+
+    // the mapped completion queue ring
+    uint8_t *m_cq_ptr;
+    size_t m_cq_size;
+
+    // the mapped array of submission queue entries
+    uint8_t *m_sqes;
+    size_t m_sqes_size;
+
+    // pointers into the mapped submission queue ring
+    unsigned *m_sq_head;
+    unsigned *m_sq_tail;
+    unsigned *m_sq_mask;
+    unsigned *m_sq_array;
+
+    // pointers into the mapped completion queue ring
+    unsigned *m_cq_head;
+    unsigned *m_cq_tail;
+    unsigned *m_cq_mask;
+    uint8_t *m_cqes;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_IO_URING_H */
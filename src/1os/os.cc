@@ -30,6 +30,11 @@ namespace upscaledb {
 //  Windows
 #  include <intrin.h>
 #  define cpuid    __cpuid
+#  define cpuid_count __cpuidex
+static uint64_t
+xgetbv() {
+  return _xgetbv(0);
+}
 #else
 #  include <cpuid.h>
 static void
@@ -46,8 +51,42 @@ cpuid(int info[4], int level) {
       "a" (infotype)
   );*/
 }
+
+static void
+cpuid_count(int info[4], int level, int count) {
+  __cpuid_count(level, count, info[0], info[1], info[2], info[3]);
+}
+
+static uint64_t
+xgetbv() {
+  uint32_t eax, edx;
+  __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+  return (((uint64_t)edx) << 32) | eax;
+}
 #endif
 
+// Returns the bits of the extended features (cpuid leaf 7, register EBX)
+// if the operating system saves all registers in |xcr0_mask| on a context
+// switch; otherwise returns 0
+static int
+extended_features(uint64_t xcr0_mask)
+{
+  int info[4];
+  cpuid(info, 0);
+  if (info[0] < 7)
+    return 0;
+
+  // OSXSAVE: the operating system supports xgetbv
+  cpuid(info, 0x00000001);
+  if ((info[2] & ((int)1 << 27)) == 0)
+    return 0;
+  if ((xgetbv() & xcr0_mask) != xcr0_mask)
+    return 0;
+
+  cpuid_count(info, 7, 0);
+  return info[1];
+}
+
 bool
 os_has_avx()
 {
@@ -72,6 +111,24 @@ os_has_avx()
   return available;
 }
 
+bool
+os_has_avx2()
+{
+  // XMM and YMM registers; AVX2 is bit 5
+  static bool available = (extended_features(0x06) & (1 << 5)) != 0;
+  return available;
+}
+
+bool
+os_has_avx512()
+{
+  // XMM, YMM, ZMM and the opmask registers; AVX512F is bit 16, AVX512BW
+  // is bit 30
+  static bool available = (extended_features(0xe6) & (1 << 16 | 1 << 30))
+                                == (1 << 16 | 1 << 30);
+  return available;
+}
+
 int
 os_get_simd_lane_width()
 {
@@ -86,6 +143,18 @@ os_has_avx()
   return false;
 }
 
+bool
+os_has_avx2()
+{
+  return false;
+}
+
+bool
+os_has_avx512()
+{
+  return false;
+}
+
 int
 os_get_simd_lane_width()
 {
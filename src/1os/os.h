@@ -69,6 +69,15 @@ typedef SOCKET             ups_socket_t;
 extern bool
 os_has_avx();
 
+// Returns true if the CPU and the operating system support AVX2
+extern bool
+os_has_avx2();
+
+// Returns true if the CPU and the operating system support AVX-512
+// (AVX512F and AVX512BW)
+extern bool
+os_has_avx512();
+
 // Returns the number of 32bit integers that the CPU can process in
 // parallel (the SIMD lane width) 
 extern int
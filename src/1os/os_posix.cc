@@ -26,9 +26,12 @@
 #if HAVE_MMAP
 #  include <sys/mman.h>
 #endif
-#if HAVE_WRITEV
+#if HAVE_WRITEV || HAVE_PWRITEV
 #  include <sys/uio.h>
 #endif
+#include <limits.h>
+#include <algorithm>
+#include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/file.h>
@@ -144,6 +147,20 @@ os_write(ups_fd_t fd, const void *buffer, size_t len)
   }
 }
 
+// Returns the descriptor for a request: requests which are properly
+// aligned bypass the page cache if |direct_fd| is valid
+static inline ups_fd_t
+select_fd(ups_fd_t fd, ups_fd_t direct_fd, uint64_t addr, const void *buffer,
+                size_t len)
+{
+  if (direct_fd != UPS_INVALID_FD
+      && addr % File::kDirectIoAlignment == 0
+      && len % File::kDirectIoAlignment == 0
+      && (uintptr_t)buffer % File::kDirectIoAlignment == 0)
+    return direct_fd;
+  return fd;
+}
+
 size_t
 File::granularity()
 {
@@ -168,6 +185,36 @@ File::set_posix_advice(int advice)
 #endif
 }
 
+bool
+File::set_direct_io(const char *filename)
+{
+  assert(m_fd != UPS_INVALID_FD);
+
+#if defined(O_DIRECT)
+  // O_DIRECT fails for unaligned requests, therefore the file is opened
+  // a second time (with the same access mode); toggling the flag with
+  // fcntl() would affect concurrent requests on the same descriptor
+  int osflags = (::fcntl(m_fd, F_GETFL, 0) & O_ACCMODE) | O_DIRECT;
+  ups_fd_t fd = ::open(filename, osflags);
+  if (fd < 0) {
+    ups_log(("opening file %s with O_DIRECT failed with status %u (%s)",
+                filename, errno, strerror(errno)));
+    return false;
+  }
+  enable_largefile(fd);
+  m_direct_fd = fd;
+  m_direct_io = true;
+#elif defined(F_NOCACHE)
+  if (::fcntl(m_fd, F_NOCACHE, 1) != 0) {
+    ups_log(("fcntl(F_NOCACHE) failed with status %u (%s)", errno,
+                strerror(errno)));
+    return false;
+  }
+  m_direct_io = true;
+#endif
+  return m_direct_io;
+}
+
 void
 File::mmap(uint64_t position, size_t size, bool readonly, uint8_t **buffer)
 {
@@ -217,17 +264,57 @@ File::munmap(void *buffer, size_t size)
 #endif
 }
 
+void
+File::discard_mapped(void *buffer, size_t size)
+{
+  os_log(("File::discard_mapped: size=%lld", size));
+
+#if HAVE_MADVISE && defined(MADV_DONTNEED)
+  // only a hint; if this fails then the pages stay in memory
+  if (::madvise(buffer, size, MADV_DONTNEED) != 0)
+    ups_log(("madvise failed with status %d (%s)", errno, strerror(errno)));
+#endif
+}
+
+void
+File::prefetch(uint64_t addr, size_t len)
+{
+  os_log(("File::prefetch: fd=%d, address=%lld, size=%lld", m_fd, addr, len));
+
+#if HAVE_POSIX_FADVISE && defined(POSIX_FADV_WILLNEED)
+  // only a hint; the page cache is bypassed with direct I/O
+  if (m_direct_io)
+    return;
+  int r = ::posix_fadvise(m_fd, addr, len, POSIX_FADV_WILLNEED);
+  if (r != 0)
+    ups_log(("posix_fadvise failed with status %d (%s)", r, strerror(r)));
+#endif
+}
+
+void
+File::prefetch_mapped(void *buffer, size_t size)
+{
+  os_log(("File::prefetch_mapped: size=%lld", size));
+
+#if HAVE_MADVISE && defined(MADV_WILLNEED)
+  // only a hint; if this fails then the pages are read on access
+  if (::madvise(buffer, size, MADV_WILLNEED) != 0)
+    ups_log(("madvise failed with status %d (%s)", errno, strerror(errno)));
+#endif
+}
+
 void
 File::pread(uint64_t addr, void *buffer, size_t len)
 {
   os_log(("File::pread: fd=%d, address=%lld, size=%lld", m_fd, addr, len));
 
 #if HAVE_PREAD
+  ups_fd_t fd = select_fd(m_fd, m_direct_fd, addr, buffer, len);
   int r;
   size_t total = 0;
 
   while (total < len) {
-    r = ::pread(m_fd, (uint8_t *)buffer + total, len - total,
+    r = ::pread(fd, (uint8_t *)buffer + total, len - total,
                     addr + total);
     if (r < 0) {
       ups_log(("File::pread failed with status %u (%s)", errno,
@@ -255,11 +342,12 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
   os_log(("File::pwrite: fd=%d, address=%lld, size=%lld", m_fd, addr, len));
 
 #if HAVE_PWRITE
+  ups_fd_t fd = select_fd(m_fd, m_direct_fd, addr, buffer, len);
   ssize_t s;
   size_t total = 0;
 
   while (total < len) {
-    s = ::pwrite(m_fd, buffer, len, addr + total);
+    s = ::pwrite(fd, buffer, len, addr + total);
     if (s < 0) {
       ups_log(("pwrite() failed with status %u (%s)", errno, strerror(errno)));
       throw Exception(UPS_IO_ERROR);
@@ -279,6 +367,65 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
 #endif
 }
 
+void
+File::pwritev(uint64_t addr, const void **buffers, const size_t *lengths,
+                size_t count)
+{
+  os_log(("File::pwritev: fd=%d, address=%lld, count=%lld", m_fd, addr,
+                count));
+
+#if HAVE_PWRITEV
+#  ifdef IOV_MAX
+  const size_t kMaxIovecs = IOV_MAX;
+#  else
+  const size_t kMaxIovecs = 1024;
+#  endif
+
+  // the O_DIRECT handle is only used if all buffers are aligned
+  ups_fd_t fd = select_fd(m_fd, m_direct_fd, addr, 0, 0);
+  for (size_t j = 0; fd != m_fd && j < count; j++)
+    fd = select_fd(m_fd, m_direct_fd, 0, buffers[j], lengths[j]);
+
+  std::vector<struct iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    iov[i].iov_base = (void *)buffers[i];
+    iov[i].iov_len = lengths[i];
+  }
+
+  size_t i = 0;
+  while (i < count) {
+    int n = (int)std::min(count - i, kMaxIovecs);
+    ssize_t s = ::pwritev(fd, &iov[i], n, addr);
+    if (s < 0) {
+      ups_log(("pwritev() failed with status %u (%s)", errno,
+                  strerror(errno)));
+      throw Exception(UPS_IO_ERROR);
+    }
+    if (s == 0) {
+      ups_log(("pwritev() failed with short write (%s)", strerror(errno)));
+      throw Exception(UPS_IO_ERROR);
+    }
+    addr += s;
+
+    // skip the buffers that were fully written, then adjust the partially
+    // written one
+    while (i < count && (size_t)s >= iov[i].iov_len) {
+      s -= iov[i].iov_len;
+      i++;
+    }
+    if (s > 0) {
+      iov[i].iov_base = (uint8_t *)iov[i].iov_base + s;
+      iov[i].iov_len -= s;
+    }
+  }
+#else
+  for (size_t i = 0; i < count; i++) {
+    pwrite(addr, buffers[i], lengths[i]);
+    addr += lengths[i];
+  }
+#endif
+}
+
 void
 File::write(const void *buffer, size_t len)
 {
@@ -407,6 +554,13 @@ File::close()
 
     m_fd = UPS_INVALID_FD;
   }
+
+  if (m_direct_fd != UPS_INVALID_FD) {
+    if (::close(m_direct_fd) == -1)
+      throw Exception(UPS_IO_ERROR);
+    m_direct_fd = UPS_INVALID_FD;
+  }
+  m_direct_io = false;
 }
 
 void
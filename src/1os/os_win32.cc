@@ -104,6 +104,13 @@ File::set_posix_advice(int advice)
   // Only available for posix platforms
 }
 
+bool
+File::set_direct_io(const char *filename)
+{
+  // FILE_FLAG_NO_BUFFERING can only be set when the file is opened
+  return false;
+}
+
 void
 File::mmap(uint64_t position, size_t size, bool readonly, uint8_t **buffer)
 {
@@ -168,6 +175,24 @@ File::munmap(void *buffer, size_t size)
   m_mmaph = UPS_INVALID_FD;
 }
 
+void
+File::discard_mapped(void *buffer, size_t size)
+{
+  // Only a hint; not implemented on Win32
+}
+
+void
+File::prefetch(uint64_t addr, size_t len)
+{
+  // Only a hint; not implemented on Win32
+}
+
+void
+File::prefetch_mapped(void *buffer, size_t size)
+{
+  // Only a hint; not implemented on Win32
+}
+
 void
 File::pread(uint64_t addr, void *buffer, size_t len)
 {
@@ -230,6 +255,16 @@ File::pwrite(uint64_t addr, const void *buffer, size_t len)
     throw Exception(UPS_IO_ERROR);
 }
 
+void
+File::pwritev(uint64_t addr, const void **buffers, const size_t *lengths,
+                size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    pwrite(addr, buffers[i], lengths[i]);
+    addr += lengths[i];
+  }
+}
+
 void
 File::write(const void *buffer, size_t len)
 {
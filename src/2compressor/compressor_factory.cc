@@ -45,6 +45,8 @@ CompressorFactory::is_available(int type)
     case UPS_COMPRESSOR_UINT32_VARBYTE:
     case UPS_COMPRESSOR_UINT32_GROUPVARINT:
     case UPS_COMPRESSOR_UINT32_FOR:
+    case UPS_COMPRESSOR_UINT64_FOR:
+    case UPS_COMPRESSOR_UINT64_STREAMVBYTE:
       return true;
     case UPS_COMPRESSOR_ZLIB:
 #ifdef HAVE_ZLIB_H
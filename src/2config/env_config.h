@@ -52,7 +52,9 @@ struct EnvConfig
       file_size_limit_bytes(std::numeric_limits<size_t>::max()), 
       remote_timeout_sec(0), journal_compressor(0),
       is_encryption_enabled(false), journal_switch_threshold(0),
-      posix_advice(UPS_POSIX_FADVICE_NORMAL) {
+      posix_advice(UPS_POSIX_FADVICE_NORMAL),
+      cache_policy(UPS_CACHE_POLICY_LRU), journal_group_commit_usec(0),
+      flush_threads(1), query_threads(1), scan_readahead(8) {
   }
 
   // the environment's flags
@@ -96,6 +98,21 @@ struct EnvConfig
 
   // parameter for posix_fadvise()
   int posix_advice;
+
+  // the page replacement policy of the cache
+  int cache_policy;
+
+  // the time window for journal group commits (in microseconds)
+  uint32_t journal_group_commit_usec;
+
+  // the number of threads which flush modified pages
+  uint32_t flush_threads;
+
+  // the number of threads which execute UQI queries
+  uint32_t query_threads;
+
+  // the number of leafs which are read ahead during sequential scans
+  uint32_t scan_readahead;
 };
 
 } // namespace upscaledb
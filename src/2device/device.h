@@ -28,9 +28,10 @@
 
 #include "0root/root.h"
 
-#include "ups/upscaledb.h"
+#include "ups/upscaledb_int.h"
 
 // Always verify that a file of level N does not include headers > N!
+#include "1mem/mem.h"
 #include "2config/env_config.h"
 
 #ifndef UPS_ROOT_H
@@ -89,6 +90,11 @@ struct Device {
   // Writes to the device; this function does not use mmap
   virtual void write(uint64_t offset, void *buffer, size_t len) = 0;
 
+  // Writes |count| buffers to adjacent ranges of the device, starting
+  // at |offset|; this function does not use mmap
+  virtual void writev(uint64_t offset, const void **buffers,
+                  const size_t *lengths, size_t count) = 0;
+
   // Allocate storage from this device; this function
   // will *NOT* use mmap. returns the offset of the allocated storage.
   virtual uint64_t alloc(size_t len) = 0;
@@ -96,10 +102,31 @@ struct Device {
   // Reads a page from the device; this function CAN use mmap
   virtual void read_page(Page *page, uint64_t address) = 0;
 
+  // Starts reading a page in the background; a subsequent call to
+  // read_page() for the same |address| picks up the data. A hint only,
+  // the default implementation does nothing
+  virtual void prefetch_page(uint64_t address) {
+  }
+
   // Allocate storage for a page from this device; this function
   // can use mmap if available
   virtual void alloc_page(Page *page) = 0;
 
+  // Allocates a buffer for a page which is not mapped
+  virtual uint8_t *alloc_page_buffer() {
+    return Memory::allocate<uint8_t>(config.page_size_bytes);
+  }
+
+  // Releases a buffer which was allocated with alloc_page_buffer()
+  virtual void release_page_buffer(void *buffer) {
+    Memory::release(buffer);
+  }
+
+  // Called when a page with a mapped (and flushed) buffer is deleted;
+  // the default implementation does nothing
+  virtual void release_mapped_buffer(void *buffer) {
+  }
+
   // Frees a page on the device.
   // The caller is responsible for flushing the page; the @ref free_page
   // function will assert that the page is not dirty.
@@ -111,6 +138,10 @@ struct Device {
   // Removes unused space at the end of the file
   virtual void reclaim_space() = 0;
 
+  // Fills in the current metrics
+  virtual void fill_metrics(ups_env_metrics_t *metrics) const {
+  }
+
   // the Environment configuration settings
   const EnvConfig &config;
 };
@@ -29,10 +29,14 @@
 
 #include "0root/root.h"
 
+#include <algorithm>
+#include <deque>
+
 // Always verify that a file of level N does not include headers > N!
 #include "1base/error.h"
 #include "1base/dynamic_array.h"
 #include "1mem/mem.h"
+#include "1mem/buffer_pool.h"
 #include "1os/file.h"
 #ifdef UPS_ENABLE_ENCRYPTION
 #  include "2aes/aes.h"
@@ -48,18 +52,65 @@ namespace upscaledb {
 
 /*
  * a File-based device
+ *
+ * The file is mapped in segments. When the file grows then a new segment
+ * is mapped behind the existing ones; its size is at least the size of
+ * all previous segments, therefore only few segments are required. The
+ * segments can exceed the end of the file, but only the range up to the
+ * file size is used. Pages in the mapped range always use the mapped
+ * memory, never an allocated buffer.
+ *
+ * The mapping is not extended on Win32, because a mapped file cannot be
+ * resized.
+ *
+ * Pages which are read ahead (prefetch_page()) are loaded into the page
+ * cache of the operating system with posix_fadvise() or madvise(); the
+ * device remembers the most recent ones to count hits and wasted reads.
  */
 class DiskDevice : public Device {
+    enum {
+      // the max. number of mapped segments
+      kMaxSegments = 48,
+
+      // the min. size of a new segment
+      kMinSegmentSize = 1024 * 1024,
+
+      // the max. number of read-ahead pages which are tracked for the
+      // metrics
+      kMaxReadahead = 64
+    };
+
+    // A mapped range of the file
+    struct Segment {
+      // the file offset of the segment
+      uint64_t offset;
+
+      // the size of the segment
+      uint64_t size;
+
+      // pointer to the mapped data
+      uint8_t *ptr;
+    };
+
     struct State {
       // the database file
       File file;
 
-      // pointer to the the mmapped data
-      uint8_t *mmapptr;
+      // the mapped segments, sorted by offset and adjacent to each other
+      Segment segments[kMaxSegments];
+
+      // the number of mapped segments
+      size_t num_segments;
 
-      // the size of mmapptr as used in mmap
+      // the size of the mapped range which is backed by the file
       uint64_t mapped_size;
 
+      // the end of the last segment; can exceed the file size
+      uint64_t reserved_size;
+
+      // true if the mapping is extended when the file grows
+      bool grow_mapping;
+
       // the (cached) size of the file
       uint64_t file_size;
 
@@ -69,10 +120,18 @@ class DiskDevice : public Device {
 
   public:
     DiskDevice(const EnvConfig &config)
-      : Device(config) {
+      : Device(config),
+        m_buffers(File::kDirectIoAlignment,
+                ISSET(config.flags, UPS_CACHE_UNLIMITED)
+                    ? 0
+                    : config.cache_size_bytes,
+                ISSET(config.flags, UPS_ENABLE_HUGE_PAGES)),
+        m_readahead_count(0), m_readahead_hits(0), m_readahead_wasted(0) {
       State state;
-      state.mmapptr = 0;
+      state.num_segments = 0;
       state.mapped_size = 0;
+      state.reserved_size = 0;
+      state.grow_mapping = false;
       state.file_size = 0;
       state.excess_at_end = 0;
       std::swap(m_state, state);
@@ -85,12 +144,20 @@ class DiskDevice : public Device {
       File file;
       file.create(config.filename.c_str(), config.file_mode);
       file.set_posix_advice(config.posix_advice);
+      if (ISSET(config.flags, UPS_ENABLE_DIRECT_IO))
+        file.set_direct_io(config.filename.c_str());
       m_state.file = file;
+#ifndef WIN32
+      // the file is empty; it is mapped as soon as it grows
+      m_state.grow_mapping = NOTSET(config.flags, UPS_DISABLE_MMAP)
+                                && !m_state.file.is_direct_io();
+#endif
     }
 
     // opens an existing device
     //
-    // tries to map the file; if it fails then continue with read/write 
+    // tries to map the file; if it fails then continue with read/write.
+    // Direct I/O bypasses the page cache, and therefore also disables mmap
     virtual void open() {
       bool read_only = (config.flags & UPS_READ_ONLY) != 0;
 
@@ -99,33 +166,32 @@ class DiskDevice : public Device {
       State state = m_state;
       state.file.open(config.filename.c_str(), read_only);
       state.file.set_posix_advice(config.posix_advice);
+      if (ISSET(config.flags, UPS_ENABLE_DIRECT_IO))
+        state.file.set_direct_io(config.filename.c_str());
 
       // the file size which backs the mapped ptr
       state.file_size = state.file.file_size();
 
-      if (config.flags & UPS_DISABLE_MMAP) {
+      if (config.flags & UPS_DISABLE_MMAP || state.file.is_direct_io()) {
         std::swap(m_state, state);
         return;
       }
 
+#ifdef WIN32
       // make sure we do not exceed the "real" size of the file, otherwise
-      // we crash when accessing memory which exceeds the mapping (at least
-      // on Win32)
+      // we crash when accessing memory which exceeds the mapping
       size_t granularity = File::granularity();
       if (state.file_size == 0 || state.file_size % granularity) {
         std::swap(m_state, state);
         return;
       }
+#else
+      state.grow_mapping = !read_only;
+#endif
 
-      state.mapped_size = state.file_size;
-      try {
-        state.file.mmap(0, state.mapped_size, read_only, &state.mmapptr);
-      }
-      catch (Exception &ex) {
-        ups_log(("mmap failed with error %d, falling back to read/write",
-                    ex.code));
-      }
       std::swap(m_state, state);
+      if (m_state.file_size > 0)
+        map_nolock(m_state.file_size, read_only);
     }
 
     // returns true if the device is open
@@ -138,8 +204,13 @@ class DiskDevice : public Device {
     virtual void close() {
       ScopedSpinlock lock(m_mutex);
       State state = m_state;
-      if (state.mmapptr)
-        state.file.munmap(state.mmapptr, state.mapped_size);
+      for (size_t i = 0; i < state.num_segments; i++)
+        state.file.munmap(state.segments[i].ptr,
+                        (size_t)state.segments[i].size);
+      state.num_segments = 0;
+      state.mapped_size = 0;
+      state.reserved_size = 0;
+      state.grow_mapping = false;
       state.file.close();
 
       std::swap(m_state, state);
@@ -193,6 +264,7 @@ class DiskDevice : public Device {
     // filters
     virtual void write(uint64_t offset, void *buffer, size_t len) {
       ScopedSpinlock lock(m_mutex);
+      discard_readahead_nolock(offset, len);
 #ifdef UPS_ENABLE_ENCRYPTION
       if (config.is_encryption_enabled) {
         // encryption disables direct I/O -> only full pages are allowed
@@ -208,6 +280,31 @@ class DiskDevice : public Device {
       m_state.file.pwrite(offset, buffer, len);
     }
 
+    // writes multiple buffers to adjacent ranges of the device; this
+    // function does not use mmap. The spinlock is not held during the
+    // I/O because positional writes do not modify the file pointer,
+    // and multiple flusher threads can write in parallel.
+    virtual void writev(uint64_t offset, const void **buffers,
+                    const size_t *lengths, size_t count) {
+      {
+        ScopedSpinlock lock(m_mutex);
+        size_t len = 0;
+        for (size_t i = 0; i < count; i++)
+          len += lengths[i];
+        discard_readahead_nolock(offset, len);
+      }
+#ifdef UPS_ENABLE_ENCRYPTION
+      if (config.is_encryption_enabled) {
+        for (size_t i = 0; i < count; i++) {
+          write(offset, (void *)buffers[i], lengths[i]);
+          offset += lengths[i];
+        }
+        return;
+      }
+#endif
+      m_state.file.pwritev(offset, buffers, lengths, count);
+    }
+
     // allocate storage from this device; this function
     // will *NOT* return mmapped memory
     virtual uint64_t alloc(size_t requested_length) {
@@ -254,22 +351,36 @@ class DiskDevice : public Device {
 	// pointer to mmapped memory
     virtual void read_page(Page *page, uint64_t address) {
       ScopedSpinlock lock(m_mutex);
+      // was this page read ahead?
+      if (!m_readahead.empty()) {
+        std::deque<uint64_t>::iterator it = std::find(m_readahead.begin(),
+                        m_readahead.end(), address);
+        if (it != m_readahead.end()) {
+          m_readahead.erase(it);
+          m_readahead_hits++;
+        }
+      }
+
       // if this page is in the mapped area: return a pointer into that area.
       // otherwise fall back to read/write.
-      if (address < m_state.mapped_size && m_state.mmapptr != 0) {
+      uint8_t *mapped = mapped_range(address, config.page_size_bytes);
+      if (mapped) {
         // the following line will not throw a C++ exception, but can
         // raise a signal. If that's the case then we don't catch it because
         // something is seriously wrong and proper recovery is not possible.
-        page->assign_mapped_buffer(&m_state.mmapptr[address], address);
+        if (page->is_allocated())
+          release_page_buffer(page->data());
+        page->assign_mapped_buffer(mapped, address);
         return;
       }
 
-      // this page is not in the mapped area; allocate a buffer
-      if (page->data() == 0) {
+      // this page is not in the mapped area; allocate a buffer (unless
+      // the page already has one)
+      if (page->data() == 0 || !page->is_allocated()) {
         // note that |p| will not leak if file.pread() throws; |p| is stored
         // in the |page| object and will be cleaned up by the caller in
         // case of an exception.
-        uint8_t *p = Memory::allocate<uint8_t>(config.page_size_bytes);
+        uint8_t *p = alloc_page_buffer();
         page->assign_allocated_buffer(p, address);
       }
 
@@ -283,17 +394,96 @@ class DiskDevice : public Device {
 #endif
     }
 
-    // Allocates storage for a page from this device; this function
-    // will *NOT* return mmapped memory
+    // Asks the operating system to read a page into its page cache;
+    // mapped pages are advised with madvise(), all others with
+    // posix_fadvise(). Does nothing with direct I/O, because the page
+    // cache is bypassed
+    virtual void prefetch_page(uint64_t address) {
+      uint8_t *mapped;
+      {
+        ScopedSpinlock lock(m_mutex);
+        if (!m_state.file.is_open() || m_state.file.is_direct_io())
+          return;
+        if (address + config.page_size_bytes > m_state.file_size)
+          return;
+        if (std::find(m_readahead.begin(), m_readahead.end(), address)
+              != m_readahead.end())
+          return;
+        if (m_readahead.size() >= kMaxReadahead) {
+          m_readahead.pop_front();
+          m_readahead_wasted++;
+        }
+        m_readahead.push_back(address);
+        m_readahead_count++;
+        mapped = mapped_range(address, config.page_size_bytes);
+      }
+
+      // the system calls are not made while holding the spinlock
+      if (mapped) {
+        size_t granularity = File::granularity();
+        uint8_t *begin = (uint8_t *)((uintptr_t)mapped & ~(granularity - 1));
+        size_t length = mapped + config.page_size_bytes - begin;
+        length = ((length + granularity - 1) / granularity) * granularity;
+        m_state.file.prefetch_mapped(begin, length);
+      }
+      else
+        m_state.file.prefetch(address, config.page_size_bytes);
+    }
+
+    // Allocates storage for a page from this device; returns mmapped
+    // memory if the file was mapped while it grew
     virtual void alloc_page(Page *page) {
       uint64_t address = alloc(config.page_size_bytes);
       page->set_address(address);
 
+      uint8_t *mapped;
+      {
+        ScopedSpinlock lock(m_mutex);
+        mapped = mapped_range(address, config.page_size_bytes);
+      }
+      if (mapped) {
+        page->assign_mapped_buffer(mapped, address);
+        return;
+      }
+
       // allocate a memory buffer
-      uint8_t *p = Memory::allocate<uint8_t>(config.page_size_bytes);
+      uint8_t *p = alloc_page_buffer();
       page->assign_allocated_buffer(p, address);
     }
 
+    // Allocates a page buffer from the pool; the buffers are aligned
+    // for direct I/O, and the pool is sized from the cache size
+    virtual uint8_t *alloc_page_buffer() {
+      return m_buffers.alloc(config.page_size_bytes);
+    }
+
+    // Returns a page buffer to the pool
+    virtual void release_page_buffer(void *buffer) {
+      m_buffers.release(buffer);
+    }
+
+    // Discards the private copy of a mapped page; the next access reads
+    // the (flushed) data from the file. Otherwise the copies of all pages
+    // which were ever modified would stay in memory. The buffer is ignored
+    // if the file was already unmapped.
+    virtual void release_mapped_buffer(void *buffer) {
+      size_t granularity = File::granularity();
+      if ((uintptr_t)buffer % granularity != 0
+            || config.page_size_bytes % granularity != 0)
+        return;
+
+      ScopedSpinlock lock(m_mutex);
+      uint8_t *p = (uint8_t *)buffer;
+      for (size_t i = 0; i < m_state.num_segments; i++) {
+        const Segment &segment = m_state.segments[i];
+        if (p >= segment.ptr
+              && p + config.page_size_bytes <= segment.ptr + segment.size) {
+          m_state.file.discard_mapped(buffer, config.page_size_bytes);
+          return;
+        }
+      }
+    }
+
     // Frees a page on the device; plays counterpoint to |alloc_page|
     virtual void free_page(Page *page) {
       ScopedSpinlock lock(m_mutex);
@@ -303,7 +493,7 @@ class DiskDevice : public Device {
 
     // Returns true if the specified range is in mapped memory
     virtual bool is_mapped(uint64_t file_offset, size_t size) const {
-      return file_offset + size <= m_state.mapped_size;
+      return mapped_range(file_offset, size) != 0;
     }
 
     // Removes unused space at the end of the file
@@ -315,17 +505,129 @@ class DiskDevice : public Device {
       }
     }
 
+    // Fills in the current metrics
+    virtual void fill_metrics(ups_env_metrics_t *metrics) const {
+      m_buffers.fill_metrics(metrics);
+      metrics->page_count_prefetched = m_readahead_count;
+      metrics->page_count_prefetch_hits = m_readahead_hits;
+      metrics->page_count_prefetch_wasted = m_readahead_wasted;
+    }
+
+    // Returns true if the page cache of the operating system is bypassed
+    bool is_direct_io() const {
+      return m_state.file.is_direct_io();
+    }
+
     // Returns a pointer directly into mapped memory
     uint8_t *mapped_pointer(uint64_t address) const {
-      return &m_state.mmapptr[address];
+      return mapped_range(address, 0);
+    }
+
+  protected:
+    // Returns a pointer to the mapped memory of the range
+    // [offset, offset + size[, or null if the range is not mapped or
+    // spans multiple segments
+    uint8_t *mapped_range(uint64_t offset, size_t size) const {
+      if (offset + size > m_state.mapped_size)
+        return 0;
+
+      // binary search for the last segment which starts at or before
+      // |offset|
+      size_t lo = 0, hi = m_state.num_segments;
+      while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (m_state.segments[mid].offset <= offset)
+          lo = mid;
+        else
+          hi = mid;
+      }
+
+      const Segment &segment = m_state.segments[lo];
+      if (m_state.num_segments == 0
+            || offset + size > segment.offset + segment.size)
+        return 0;
+      return segment.ptr + (offset - segment.offset);
+    }
+
+    // Maps the file up to |new_file_size| bytes; creates a new segment if
+    // the existing segments are too small. If mmap fails then the device
+    // continues with read/write for the remaining file.
+    void map_nolock(uint64_t new_file_size, bool read_only) {
+      if (new_file_size > m_state.reserved_size
+            && (m_state.grow_mapping || m_state.num_segments == 0)
+            && m_state.num_segments < kMaxSegments) {
+        uint64_t size = new_file_size - m_state.reserved_size;
+#ifndef WIN32
+        // grow geometrically; the new segment can exceed the end of
+        // the file
+        size = std::max(size, std::max((uint64_t)kMinSegmentSize,
+                                m_state.reserved_size));
+        size_t granularity = File::granularity();
+        size = ((size + granularity - 1) / granularity) * granularity;
+#endif
+
+        Segment &segment = m_state.segments[m_state.num_segments];
+        try {
+          if ((uint64_t)(size_t)size != size)
+            throw Exception(UPS_LIMITS_REACHED);
+          m_state.file.mmap(m_state.reserved_size, (size_t)size, read_only,
+                          &segment.ptr);
+          segment.offset = m_state.reserved_size;
+          segment.size = size;
+          m_state.num_segments++;
+          m_state.reserved_size += size;
+        }
+        catch (Exception &ex) {
+          ups_log(("mmap failed with error %d, falling back to read/write",
+                      ex.code));
+          m_state.grow_mapping = false;
+        }
+      }
+
+      m_state.mapped_size = std::min(new_file_size, m_state.reserved_size);
+    }
+
+    // Shrinks the mapped range after the file was truncated; segments
+    // which are completely beyond the end of the file are unmapped. The
+    // pages in this range were already deleted.
+    void unmap_nolock(uint64_t new_file_size) {
+      while (m_state.num_segments > 0) {
+        Segment &segment = m_state.segments[m_state.num_segments - 1];
+        if (segment.offset < new_file_size)
+          break;
+        m_state.file.munmap(segment.ptr, (size_t)segment.size);
+        m_state.reserved_size = segment.offset;
+        m_state.num_segments--;
+      }
+
+      m_state.mapped_size = std::min(m_state.mapped_size, new_file_size);
+    }
+
+    // Forgets the read-ahead pages which overlap with the range
+    // [offset, offset + len[; they were overwritten before they were read
+    void discard_readahead_nolock(uint64_t offset, uint64_t len) {
+      std::deque<uint64_t>::iterator it = m_readahead.begin();
+      while (it != m_readahead.end()) {
+        if (*it + config.page_size_bytes > offset && *it < offset + len) {
+          it = m_readahead.erase(it);
+          m_readahead_wasted++;
+        }
+        else
+          it++;
+      }
     }
 
-  private:
     // truncate/resize the device, sans locking
     void truncate_nolock(uint64_t new_file_size) {
       if (new_file_size > config.file_size_limit_bytes)
         throw Exception(UPS_LIMITS_REACHED);
       m_state.file.truncate(new_file_size);
+      if (new_file_size > m_state.file_size) {
+        if (m_state.grow_mapping)
+          map_nolock(new_file_size, false);
+      }
+      else
+        unmap_nolock(new_file_size);
       m_state.file_size = new_file_size;
     }
 
@@ -333,6 +635,22 @@ class DiskDevice : public Device {
     Spinlock m_mutex;
 
     State m_state;
+
+    // The aligned page buffers
+    mutable BufferPool m_buffers;
+
+    // The pages which were read ahead, but not yet read; oldest first
+    std::deque<uint64_t> m_readahead;
+
+    // Metrics: the number of pages which were read ahead
+    uint64_t m_readahead_count;
+
+    // Metrics: the number of read-ahead pages which were actually read
+    uint64_t m_readahead_hits;
+
+    // Metrics: the number of read-ahead pages which were overwritten or
+    // dropped before they were read
+    uint64_t m_readahead_wasted;
 };
 
 } // namespace upscaledb
@@ -31,6 +31,9 @@
 #include "2config/env_config.h"
 #include "2device/device_disk.h"
 #include "2device/device_inmem.h"
+#ifdef HAVE_LINUX_IO_URING_H
+#  include "2device/device_uring.h"
+#endif
 
 #ifndef UPS_ROOT_H
 #  error "root.h was not included"
@@ -43,8 +46,13 @@ struct DeviceFactory {
   static Device *create(const EnvConfig &config) {
     if (ISSET(config.flags, UPS_IN_MEMORY))
       return new InMemoryDevice(config);
-    else
-      return new DiskDevice(config);
+#ifdef HAVE_LINUX_IO_URING_H
+    // the io_uring device does not support encryption
+    if (ISSET(config.flags, UPS_ENABLE_IO_URING)
+          && !config.is_encryption_enabled)
+      return new IoUringDevice(config);
+#endif
+    return new DiskDevice(config);
   }
 };
 
@@ -105,6 +105,11 @@ struct InMemoryDevice : public Device {
   virtual void write(uint64_t offset, void *buffer, size_t len) {
   }
 
+  // writes multiple buffers to the device 
+  virtual void writev(uint64_t offset, const void **buffers,
+                  const size_t *lengths, size_t count) {
+  }
+
   // reads a page from the device 
   virtual void read_page(Page *page, uint64_t address) {
     assert(!"operation is not possible for in-memory-databases");
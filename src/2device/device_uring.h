@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * A disk-based device which submits its I/O through a Linux io_uring.
+ *
+ * Vectored page writes are split into chunks and submitted as one batch.
+ * Pages can be prefetched: the read is started in the background, and
+ * read_page() later picks up the buffer. Pages in the mapped area are
+ * read ahead by the DiskDevice (with madvise()).
+ *
+ * If the ring cannot be created (i.e. because the kernel is too old) then
+ * all operations are forwarded to the DiskDevice.
+ *
+ * The ring is shared by all threads and protected by |m_ring_mutex|;
+ * write operations hold this mutex while they are in flight, therefore
+ * a prefetched page is never older than the data on disk.
+ *
+ * @exception_safe: basic/strong
+ * @thread_safe: no
+ */
+
+#ifndef UPS_DEVICE_URING_H
+#define UPS_DEVICE_URING_H
+
+#include "0root/root.h"
+
+#include <algorithm>
+#include <string.h>
+#include <map>
+#include <vector>
+#include <limits>
+#include <limits.h>
+#include <sys/uio.h>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/mutex.h"
+#include "1os/io_uring.h"
+#include "2device/device_disk.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+class IoUringDevice : public DiskDevice {
+    enum {
+      // the number of submission queue entries
+      kQueueDepth = 64,
+
+      // the max. number of prefetched pages which are not yet consumed
+      kMaxPrefetches = 32,
+
+      // the max. number of write requests in a single batch
+      kMaxWriteBatch = kQueueDepth - kMaxPrefetches,
+
+#ifdef IOV_MAX
+      kMaxIovecs = IOV_MAX
+#else
+      kMaxIovecs = 1024
+#endif
+    };
+
+    // A request which was submitted to the ring
+    struct Request {
+      Request()
+        : buffer(0), length(0), submitted_at(0), result(0), done(false) {
+      }
+
+      uint8_t *buffer;
+      size_t length;
+      uint64_t submitted_at;
+      int32_t result;
+      bool done;
+    };
+
+    typedef std::map<uint64_t, Request *> PrefetchMap;
+
+  public:
+    IoUringDevice(const EnvConfig &config)
+      : DiskDevice(config), m_in_flight(0), m_submissions(0),
+        m_max_queue_depth(0), m_latency_usec(0), m_prefetched(0),
+        m_prefetch_hits(0), m_prefetch_wasted(0) {
+    }
+
+    ~IoUringDevice() {
+      close_ring();
+    }
+
+    // Create a new device
+    virtual void create() {
+      DiskDevice::create();
+      open_ring();
+    }
+
+    // opens an existing device
+    virtual void open() {
+      DiskDevice::open();
+      open_ring();
+    }
+
+    // closes the device
+    virtual void close() {
+      close_ring();
+      DiskDevice::close();
+    }
+
+    // writes to the device; discards prefetched pages in this range
+    virtual void write(uint64_t offset, void *buffer, size_t len) {
+      ScopedLock lock(m_ring_mutex);
+      discard_prefetches(offset, len);
+      DiskDevice::write(offset, buffer, len);
+    }
+
+    // writes multiple buffers to adjacent ranges of the device; the buffers
+    // are split into chunks of |kMaxIovecs|, and all chunks are submitted
+    // as a single batch
+    virtual void writev(uint64_t offset, const void **buffers,
+                    const size_t *lengths, size_t count) {
+      if (!m_ring.is_open() || config.is_encryption_enabled) {
+        ScopedLock lock(m_ring_mutex);
+        discard_prefetches(offset, total_length(lengths, count));
+        DiskDevice::writev(offset, buffers, lengths, count);
+        return;
+      }
+
+      std::vector<struct iovec> iov(count);
+      for (size_t i = 0; i < count; i++) {
+        iov[i].iov_base = (void *)buffers[i];
+        iov[i].iov_len = lengths[i];
+      }
+
+      ScopedLock lock(m_ring_mutex);
+      discard_prefetches(offset, total_length(lengths, count));
+
+      size_t i = 0;
+      while (i < count) {
+        Request requests[kMaxWriteBatch];
+        size_t first[kMaxWriteBatch];
+        uint64_t offsets[kMaxWriteBatch];
+        int batch = 0;
+
+        for (; batch < kMaxWriteBatch && i < count; batch++) {
+          size_t n = std::min(count - i, (size_t)kMaxIovecs);
+          requests[batch].length = total_length(&lengths[i], n);
+          first[batch] = i;
+          offsets[batch] = offset;
+          if (!submit_writev(&iov[i], (int)n, offset, &requests[batch])) {
+            requests[batch].result = -1;
+            requests[batch].done = true;
+          }
+          offset += requests[batch].length;
+          i += n;
+        }
+
+        for (int b = 0; b < batch; b++)
+          wait_for(&requests[b]);
+
+        // rewrite chunks which failed or were incomplete with a regular
+        // (blocking) write
+        for (int b = 0; b < batch; b++) {
+          if (requests[b].result == (int32_t)requests[b].length)
+            continue;
+          size_t n = std::min(count - first[b], (size_t)kMaxIovecs);
+          m_state.file.pwritev(offsets[b], &buffers[first[b]],
+                          &lengths[first[b]], n);
+        }
+      }
+    }
+
+    // reads a page from the device; uses the prefetched buffer if
+    // this page was prefetched
+    virtual void read_page(Page *page, uint64_t address) {
+      Request *request = 0;
+      if (m_ring.is_open()) {
+        ScopedLock lock(m_ring_mutex);
+        PrefetchMap::iterator it = m_prefetches.find(address);
+        if (it != m_prefetches.end()) {
+          request = it->second;
+          m_prefetches.erase(it);
+          wait_for(request);
+        }
+      }
+
+      if (request) {
+        if (request->result == (int32_t)config.page_size_bytes) {
+          // the page already has a buffer: copy the data, otherwise the
+          // existing buffer would leak
+          if (page->is_allocated() && page->data()) {
+            ::memcpy(page->data(), request->buffer, config.page_size_bytes);
+            release_page_buffer(request->buffer);
+            page->set_address(address);
+          }
+          else
+            page->assign_allocated_buffer(request->buffer, address);
+          m_prefetch_hits++;
+          delete request;
+          return;
+        }
+        release_page_buffer(request->buffer);
+        delete request;
+      }
+
+      DiskDevice::read_page(page, address);
+    }
+
+    // Starts reading a page in the background; does nothing if the page
+    // is already prefetched or if too many prefetches are pending. Mapped
+    // pages (or all pages, if the ring is not available) are read ahead
+    // by the DiskDevice
+    virtual void prefetch_page(uint64_t address) {
+      if (!m_ring.is_open() || config.is_encryption_enabled
+          || is_mapped(address, config.page_size_bytes)) {
+        DiskDevice::prefetch_page(address);
+        return;
+      }
+
+      ScopedLock lock(m_ring_mutex);
+      if (m_prefetches.size() >= kMaxPrefetches
+          || m_prefetches.find(address) != m_prefetches.end())
+        return;
+      if (address + config.page_size_bytes > m_state.file_size)
+        return;
+
+      Request *request = new Request;
+      request->length = config.page_size_bytes;
+      request->buffer = alloc_page_buffer();
+
+      if (!m_ring.prepare_read(m_state.file.fd(), request->buffer,
+                              request->length, address, request)) {
+        release_page_buffer(request->buffer);
+        delete request;
+        return;
+      }
+
+      submitted(request);
+      m_ring.submit(0);
+      m_prefetches[address] = request;
+      m_prefetched++;
+    }
+
+    // Fills in the current metrics
+    virtual void fill_metrics(ups_env_metrics_t *metrics) const {
+      DiskDevice::fill_metrics(metrics);
+      metrics->io_uring_submissions = m_submissions;
+      metrics->io_uring_max_queue_depth = m_max_queue_depth;
+      metrics->io_uring_latency_usec = m_latency_usec;
+      metrics->page_count_prefetched += m_prefetched;
+      metrics->page_count_prefetch_hits += m_prefetch_hits;
+      metrics->page_count_prefetch_wasted += m_prefetch_wasted;
+    }
+
+    // Returns true if the ring was created; false if the device fell
+    // back to regular read/write
+    bool is_ring_enabled() const {
+      return m_ring.is_open();
+    }
+
+  private:
+    // Creates the ring; if this fails then the device continues with
+    // regular read/write
+    void open_ring() {
+      ScopedLock lock(m_ring_mutex);
+      if (!m_ring.is_open() && !m_ring.open(kQueueDepth))
+        ups_log(("io_uring is not available, falling back to read/write"));
+    }
+
+    // Waits for all pending prefetches, then closes the ring
+    void close_ring() {
+      ScopedLock lock(m_ring_mutex);
+      discard_prefetches(0, std::numeric_limits<uint64_t>::max());
+      m_ring.close();
+    }
+
+    // Discards all prefetched pages which overlap with the range
+    // [offset, offset + len[; waits till their reads are completed
+    void discard_prefetches(uint64_t offset, uint64_t len) {
+      if (m_prefetches.empty())
+        return;
+
+      PrefetchMap::iterator it = m_prefetches.lower_bound(
+                      offset >= config.page_size_bytes
+                          ? offset - config.page_size_bytes + 1
+                          : 0);
+      while (it != m_prefetches.end() && it->first < offset + len) {
+        wait_for(it->second);
+        release_page_buffer(it->second->buffer);
+        delete it->second;
+        m_prefetches.erase(it++);
+        m_prefetch_wasted++;
+      }
+    }
+
+    // Queues a vectored write; submits the queue if it is full
+    bool submit_writev(const struct iovec *iov, int count, uint64_t offset,
+                    Request *request) {
+      if (!m_ring.prepare_writev(m_state.file.fd(), iov, count, offset,
+                              request)) {
+        m_ring.submit(0);
+        if (!m_ring.prepare_writev(m_state.file.fd(), iov, count, offset,
+                                request))
+          return false;
+      }
+      submitted(request);
+      return true;
+    }
+
+    // Updates the metrics after a request was queued
+    void submitted(Request *request) {
+      request->submitted_at = IoUring::now_usec();
+      m_submissions++;
+      m_in_flight++;
+      if (m_in_flight > m_max_queue_depth)
+        m_max_queue_depth = m_in_flight;
+    }
+
+    // Submits all queued requests, then waits till |request| is completed.
+    // Completions of other requests are recorded as well.
+    void wait_for(Request *request) {
+      while (!request->done) {
+        m_ring.submit(1);
+
+        void *tag;
+        int32_t result;
+        while (m_ring.pop_completion(&tag, &result)) {
+          Request *r = (Request *)tag;
+          r->result = result;
+          r->done = true;
+          m_in_flight--;
+          m_latency_usec += IoUring::now_usec() - r->submitted_at;
+        }
+      }
+    }
+
+    // Returns the sum of |count| buffer lengths
+    static uint64_t total_length(const size_t *lengths, size_t count) {
+      uint64_t total = 0;
+      for (size_t i = 0; i < count; i++)
+        total += lengths[i];
+      return total;
+    }
+
+    // Protects the ring and the prefetched pages
+    Mutex m_ring_mutex;
+
+    // The io_uring instance
+    IoUring m_ring;
+
+    // The prefetched pages, indexed by address
+    PrefetchMap m_prefetches;
+
+    // The number of requests which are currently in flight
+    uint64_t m_in_flight;
+
+    // Metrics: the number of submitted requests
+    uint64_t m_submissions;
+
+    // Metrics: the max. number of requests in flight
+    uint64_t m_max_queue_depth;
+
+    // Metrics: the accumulated completion latency
+    uint64_t m_latency_usec;
+
+    // Metrics: the number of prefetched pages
+    uint64_t m_prefetched;
+
+    // Metrics: the number of prefetched pages which were read
+    uint64_t m_prefetch_hits;
+
+    // Metrics: the number of prefetched pages which were discarded before
+    // they were read
+    uint64_t m_prefetch_wasted;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_DEVICE_URING_H */
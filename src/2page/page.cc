@@ -18,6 +18,7 @@
 #include "0root/root.h"
 
 #include <string.h>
+#include <vector>
 #include "3rdparty/murmurhash3/MurmurHash3.h"
 
 #include "1base/error.h"
@@ -28,7 +29,20 @@
 
 namespace upscaledb {
 
-uint64_t Page::ms_page_count_flushed = 0;
+boost::atomic<uint64_t> Page::ms_page_count_flushed(0);
+
+// updates the crc32 of a page before it's written to disk
+static inline void
+update_crc32(Device *device, Page::PersistedData *data)
+{
+  if (ISSET(device->config.flags, UPS_ENABLE_CRC32)
+      && likely(!data->is_without_header)) {
+    MurmurHash3_x86_32(data->raw_data->header.payload,
+                       data->size - (sizeof(PPageHeader) - 1),
+                       (uint32_t)data->address,
+                       &data->raw_data->header.crc32);
+  }
+}
 
 Page::Page(Device *device, LocalDatabase *db)
   : device_(device), db_(db), cursor_list_(0), node_proxy_(0)
@@ -44,6 +58,18 @@ Page::~Page()
 {
   assert(cursor_list_ == 0);
   free_buffer();
+
+  // the buffer was allocated by the device, and is returned to the device
+  if (persisted_data.is_allocated && persisted_data.raw_data) {
+    device_->release_page_buffer(persisted_data.raw_data);
+    persisted_data.raw_data = 0;
+    persisted_data.is_allocated = false;
+  }
+  // a mapped buffer which was flushed; the device can discard its copy
+  else if (persisted_data.raw_data && !persisted_data.is_dirty) {
+    device_->release_mapped_buffer(persisted_data.raw_data);
+    persisted_data.raw_data = 0;
+  }
 }
 
 uint32_t
@@ -78,14 +104,7 @@ void
 Page::flush()
 {
   if (persisted_data.is_dirty) {
-    // update crc32
-    if (ISSET(device_->config.flags, UPS_ENABLE_CRC32)
-        && likely(!persisted_data.is_without_header)) {
-      MurmurHash3_x86_32(persisted_data.raw_data->header.payload,
-                         persisted_data.size - (sizeof(PPageHeader) - 1),
-                         (uint32_t)persisted_data.address,
-                         &persisted_data.raw_data->header.crc32);
-    }
+    update_crc32(device_, &persisted_data);
     device_->write(persisted_data.address, persisted_data.raw_data,
                     persisted_data.size);
     persisted_data.is_dirty = false;
@@ -93,6 +112,37 @@ Page::flush()
   }
 }
 
+void
+Page::flush(Page **pages, size_t count)
+{
+  if (count == 1) {
+    pages[0]->flush();
+    return;
+  }
+
+  Device *device = pages[0]->device_;
+  std::vector<const void *> buffers(count);
+  std::vector<size_t> lengths(count);
+
+  for (size_t i = 0; i < count; i++) {
+    PersistedData *data = &pages[i]->persisted_data;
+    assert(data->is_dirty);
+    assert(pages[i]->device_ == device);
+    assert(i == 0 || pages[i - 1]->persisted_data.address
+                        + pages[i - 1]->persisted_data.size == data->address);
+    update_crc32(device, data);
+    buffers[i] = data->raw_data;
+    lengths[i] = data->size;
+  }
+
+  device->writev(pages[0]->persisted_data.address, &buffers[0],
+                  &lengths[0], count);
+
+  for (size_t i = 0; i < count; i++)
+    pages[i]->persisted_data.is_dirty = false;
+  ms_page_count_flushed += count;
+}
+
 void
 Page::free_buffer()
 {
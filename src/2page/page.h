@@ -148,8 +148,11 @@ class Page {
       // a bucket in the hash table of the cache
       kListBucket             = 2,
 
+      // the probation queue of the cache (only for the 2Q policy)
+      kListCacheProbation     = 3,
+
       // array limit
-      kListMax                = 3
+      kListMax                = 4
     };
 
     // non-persistent page flags
@@ -343,6 +346,11 @@ class Page {
     // Flushes the page to disk, clears the "dirty" flag
     void flush();
 
+    // Flushes a run of dirty pages with adjacent addresses in a single
+    // (vectored) write, clears their "dirty" flag. All pages must be
+    // sorted by address and must belong to the same Device.
+    static void flush(Page **pages, size_t count);
+
     // Returns the cached BtreeNodeProxy
     BtreeNodeProxy *node_proxy() {
       return node_proxy_;
@@ -363,8 +371,8 @@ class Page {
       return list_node.previous[list];
     }
 
-    // tracks number of flushed pages
-    static uint64_t ms_page_count_flushed;
+    // tracks number of flushed pages; updated by the flusher threads
+    static boost::atomic<uint64_t> ms_page_count_flushed;
 
     // the persistent data of this page
     PersistedData persisted_data;
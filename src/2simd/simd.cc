@@ -0,0 +1,683 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * AVX2 and AVX-512 search functions.
+ *
+ * The library is compiled for SSE2 (or SSE4), therefore the AVX functions
+ * are compiled with a "target" attribute and selected at runtime. The
+ * search is split in two parts:
+ *
+ * 1. A branchless binary search narrows the range till it fits into a
+ *    single cache line (64 bytes). It does not branch on the result of the
+ *    comparison, therefore it does not suffer from branch mispredictions.
+ *
+ * 2. The keys in this cache line are compared with the search key. The
+ *    number of keys which are smaller than the search key is the slot
+ *    of the (lower bound) key. *
+ * The selection functions (select_range_*) compare a whole array with a
+ * closed interval and store the positions of the matching values in a
+ * selection vector. The matching lanes of each register are compacted
+ * with a permutation (AVX2) or with a compress instruction (AVX-512).
+ */
+
+#include "0root/root.h"
+
+#ifdef __SSE__
+
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1os/os.h"
+#include "2simd/simd.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+#ifdef _MSC_VER
+#  define UPS_TARGET_AVX2
+#  define UPS_TARGET_AVX512
+#  define popcount(x) ((int)__popcnt64(x))
+#else
+#  define UPS_TARGET_AVX2   __attribute__((target("avx2,popcnt")))
+#  define UPS_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,popcnt")))
+#  define popcount(x) __builtin_popcountll(x)
+#endif
+
+namespace upscaledb {
+
+// Branchless binary search; returns the first key of the block of
+// |block| keys which contains the lower bound of |key|.
+// |node_count| must be >= |block|.
+template<typename T>
+static inline const T *
+narrow(const T *data, size_t node_count, size_t block, T key)
+{
+  const T *base = data;
+  size_t n = node_count;
+  while (n > block) {
+    size_t half = n / 2;
+    base = base[half] < key ? base + half : base;
+    n -= half;
+  }
+  // make sure that the block does not exceed the end of the array
+  return std::min(base, data + node_count - block);
+}
+
+//
+// AVX2: compares 64 bytes (two 256bit registers) with the search key and
+// returns the number of keys which are smaller than the search key.
+// AVX2 only has signed integer comparisons, therefore the sign bit is
+// flipped for unsigned integers.
+//
+template<typename T>
+struct Avx2Kernel;
+
+template<>
+struct Avx2Kernel<uint8_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const uint8_t *p, uint8_t key) {
+    __m256i flip = _mm256_set1_epi8((char)0x80);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi8((char)key), flip);
+    __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p + 1),
+                            flip);
+    uint64_t m0 = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(k, v0));
+    uint64_t m1 = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(k, v1));
+    return popcount(m0 | (m1 << 32));
+  }
+};
+
+template<>
+struct Avx2Kernel<uint16_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const uint16_t *p, uint16_t key) {
+    __m256i flip = _mm256_set1_epi16((short)0x8000);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi16((short)key), flip);
+    __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p + 1),
+                            flip);
+    // pack the 16bit results to 8bit, then count the bytes
+    __m256i lt = _mm256_packs_epi16(_mm256_cmpgt_epi16(k, v0),
+                            _mm256_cmpgt_epi16(k, v1));
+    return popcount((uint32_t)_mm256_movemask_epi8(lt));
+  }
+};
+
+template<>
+struct Avx2Kernel<uint32_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const uint32_t *p, uint32_t key) {
+    __m256i flip = _mm256_set1_epi32((int)0x80000000);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi32((int)key), flip);
+    __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p + 1),
+                            flip);
+    int m0 = _mm256_movemask_ps(_mm256_castsi256_ps(
+                            _mm256_cmpgt_epi32(k, v0)));
+    int m1 = _mm256_movemask_ps(_mm256_castsi256_ps(
+                            _mm256_cmpgt_epi32(k, v1)));
+    return popcount((uint32_t)(m0 | (m1 << 8)));
+  }
+};
+
+template<>
+struct Avx2Kernel<uint64_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const uint64_t *p, uint64_t key) {
+    __m256i flip = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi64x((long long)key), flip);
+    __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p + 1),
+                            flip);
+    int m0 = _mm256_movemask_pd(_mm256_castsi256_pd(
+                            _mm256_cmpgt_epi64(k, v0)));
+    int m1 = _mm256_movemask_pd(_mm256_castsi256_pd(
+                            _mm256_cmpgt_epi64(k, v1)));
+    return popcount((uint32_t)(m0 | (m1 << 4)));
+  }
+};
+
+template<>
+struct Avx2Kernel<float>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const float *p, float key) {
+    __m256 k = _mm256_set1_ps(key);
+    int m0 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + 0), k,
+                            _CMP_LT_OQ));
+    int m1 = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p + 8), k,
+                            _CMP_LT_OQ));
+    return popcount((uint32_t)(m0 | (m1 << 8)));
+  }
+};
+
+template<>
+struct Avx2Kernel<double>
+{
+  UPS_TARGET_AVX2 static inline int
+  count_less(const double *p, double key) {
+    __m256d k = _mm256_set1_pd(key);
+    int m0 = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + 0), k,
+                            _CMP_LT_OQ));
+    int m1 = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + 4), k,
+                            _CMP_LT_OQ));
+    return popcount((uint32_t)(m0 | (m1 << 4)));
+  }
+};
+
+//
+// AVX-512: compares up to 64 bytes (a single 512bit register) with the
+// search key and returns the number of keys which are smaller than the
+// search key. Only the first |count| keys are loaded; smaller nodes
+// therefore do not require a separate code path.
+//
+template<typename T>
+struct Avx512Kernel;
+
+template<>
+struct Avx512Kernel<uint8_t>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const uint8_t *p, size_t count, uint8_t key) {
+    __mmask64 m = count >= 64 ? ~0ull : (1ull << count) - 1;
+    __m512i v = _mm512_maskz_loadu_epi8(m, p);
+    return popcount(_mm512_mask_cmplt_epu8_mask(m, v,
+                            _mm512_set1_epi8((char)key)));
+  }
+};
+
+template<>
+struct Avx512Kernel<uint16_t>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const uint16_t *p, size_t count, uint16_t key) {
+    __mmask32 m = (__mmask32)((1ull << count) - 1);
+    __m512i v = _mm512_maskz_loadu_epi16(m, p);
+    return popcount(_mm512_mask_cmplt_epu16_mask(m, v,
+                            _mm512_set1_epi16((short)key)));
+  }
+};
+
+template<>
+struct Avx512Kernel<uint32_t>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const uint32_t *p, size_t count, uint32_t key) {
+    __mmask16 m = (__mmask16)((1u << count) - 1);
+    __m512i v = _mm512_maskz_loadu_epi32(m, p);
+    return popcount(_mm512_mask_cmplt_epu32_mask(m, v,
+                            _mm512_set1_epi32((int)key)));
+  }
+};
+
+template<>
+struct Avx512Kernel<uint64_t>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const uint64_t *p, size_t count, uint64_t key) {
+    __mmask8 m = (__mmask8)((1u << count) - 1);
+    __m512i v = _mm512_maskz_loadu_epi64(m, p);
+    return popcount(_mm512_mask_cmplt_epu64_mask(m, v,
+                            _mm512_set1_epi64((long long)key)));
+  }
+};
+
+template<>
+struct Avx512Kernel<float>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const float *p, size_t count, float key) {
+    __mmask16 m = (__mmask16)((1u << count) - 1);
+    __m512 v = _mm512_maskz_loadu_ps(m, p);
+    return popcount(_mm512_mask_cmp_ps_mask(m, v, _mm512_set1_ps(key),
+                            _CMP_LT_OQ));
+  }
+};
+
+template<>
+struct Avx512Kernel<double>
+{
+  UPS_TARGET_AVX512 static inline int
+  count_less(const double *p, size_t count, double key) {
+    __mmask8 m = (__mmask8)((1u << count) - 1);
+    __m512d v = _mm512_maskz_loadu_pd(m, p);
+    return popcount(_mm512_mask_cmp_pd_mask(m, v, _mm512_set1_pd(key),
+                            _CMP_LT_OQ));
+  }
+};
+
+template<typename T>
+UPS_TARGET_AVX2 static int
+search_avx2(size_t node_count, const T *data, T key)
+{
+  const size_t kBlock = 64 / sizeof(T);
+
+  // the node is smaller than a cache line
+  if (node_count < kBlock)
+    return linear_search((T *)data, 0, (int)node_count, key);
+
+  const T *p = narrow(data, node_count, kBlock, key);
+  size_t slot = (p - data) + Avx2Kernel<T>::count_less(p, key);
+  if (slot < node_count && data[slot] == key)
+    return (int)slot;
+  return -1;
+}
+
+template<typename T>
+UPS_TARGET_AVX512 static int
+search_avx512(size_t node_count, const T *data, T key)
+{
+  const size_t kBlock = 64 / sizeof(T);
+
+  const T *p = data;
+  size_t count = node_count;
+  if (node_count > kBlock) {
+    p = narrow(data, node_count, kBlock, key);
+    count = kBlock;
+  }
+
+  size_t slot = (p - data) + Avx512Kernel<T>::count_less(p, count, key);
+  if (slot < node_count && data[slot] == key)
+    return (int)slot;
+  return -1;
+}
+
+template<typename T>
+int
+find_simd_avx2(size_t node_count, T *data, const ups_key_t *hkey)
+{
+  assert(hkey->size == sizeof(T));
+  return search_avx2<T>(node_count, data, *(T *)hkey->data);
+}
+
+template<typename T>
+int
+find_simd_avx512(size_t node_count, T *data, const ups_key_t *hkey)
+{
+  assert(hkey->size == sizeof(T));
+  return search_avx512<T>(node_count, data, *(T *)hkey->data);
+}
+
+template<typename T>
+struct SearchDispatcher
+{
+  typedef int (*Function)(size_t node_count, T *data, const ups_key_t *hkey);
+
+  // Returns the fastest search function which is supported by the CPU
+  static Function select() {
+    if (os_has_avx512())
+      return find_simd_avx512<T>;
+    if (os_has_avx2())
+      return find_simd_avx2<T>;
+    return find_simd_sse<T>;
+  }
+};
+
+template<typename T>
+int
+find_simd(size_t node_count, T *data, const ups_key_t *hkey)
+{
+  static typename SearchDispatcher<T>::Function function
+            = SearchDispatcher<T>::select();
+  return function(node_count, data, hkey);
+}
+
+#define INSTANTIATE(T) \
+  template int find_simd_avx2<T>(size_t, T *, const ups_key_t *);         \
+  template int find_simd_avx512<T>(size_t, T *, const ups_key_t *);       \
+  template int find_simd<T>(size_t, T *, const ups_key_t *);
+
+INSTANTIATE(uint8_t)
+INSTANTIATE(uint16_t)
+INSTANTIATE(uint32_t)
+INSTANTIATE(uint64_t)
+INSTANTIATE(float)
+INSTANTIATE(double)
+
+//
+// AVX2: compares eight values with the interval [lo, hi] and returns a
+// bit mask of the matching values
+//
+template<typename T>
+struct Avx2Select;
+
+template<>
+struct Avx2Select<uint8_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const uint8_t *p, uint8_t lo, uint8_t hi) {
+    __m128i flip = _mm_set1_epi8((char)0x80);
+    __m128i l = _mm_xor_si128(_mm_set1_epi8((char)lo), flip);
+    __m128i h = _mm_xor_si128(_mm_set1_epi8((char)hi), flip);
+    __m128i v = _mm_xor_si128(_mm_loadl_epi64((const __m128i *)p), flip);
+    __m128i out = _mm_or_si128(_mm_cmpgt_epi8(l, v), _mm_cmpgt_epi8(v, h));
+    return ~_mm_movemask_epi8(out) & 0xff;
+  }
+};
+
+template<>
+struct Avx2Select<uint16_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const uint16_t *p, uint16_t lo, uint16_t hi) {
+    __m128i flip = _mm_set1_epi16((short)0x8000);
+    __m128i l = _mm_xor_si128(_mm_set1_epi16((short)lo), flip);
+    __m128i h = _mm_xor_si128(_mm_set1_epi16((short)hi), flip);
+    __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)p), flip);
+    __m128i out = _mm_or_si128(_mm_cmpgt_epi16(l, v), _mm_cmpgt_epi16(v, h));
+    // pack the 16bit results to 8bit
+    return ~_mm_movemask_epi8(_mm_packs_epi16(out, _mm_setzero_si128()))
+                & 0xff;
+  }
+};
+
+template<>
+struct Avx2Select<uint32_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const uint32_t *p, uint32_t lo, uint32_t hi) {
+    __m256i flip = _mm256_set1_epi32((int)0x80000000);
+    __m256i l = _mm256_xor_si256(_mm256_set1_epi32((int)lo), flip);
+    __m256i h = _mm256_xor_si256(_mm256_set1_epi32((int)hi), flip);
+    __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(l, v),
+                            _mm256_cmpgt_epi32(v, h));
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff;
+  }
+};
+
+template<>
+struct Avx2Select<uint64_t>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const uint64_t *p, uint64_t lo, uint64_t hi) {
+    __m256i flip = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+    __m256i l = _mm256_xor_si256(_mm256_set1_epi64x((long long)lo), flip);
+    __m256i h = _mm256_xor_si256(_mm256_set1_epi64x((long long)hi), flip);
+    __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p),
+                            flip);
+    __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)p + 1),
+                            flip);
+    __m256i out0 = _mm256_or_si256(_mm256_cmpgt_epi64(l, v0),
+                            _mm256_cmpgt_epi64(v0, h));
+    __m256i out1 = _mm256_or_si256(_mm256_cmpgt_epi64(l, v1),
+                            _mm256_cmpgt_epi64(v1, h));
+    int m0 = _mm256_movemask_pd(_mm256_castsi256_pd(out0));
+    int m1 = _mm256_movemask_pd(_mm256_castsi256_pd(out1));
+    return ~(m0 | (m1 << 4)) & 0xff;
+  }
+};
+
+template<>
+struct Avx2Select<float>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const float *p, float lo, float hi) {
+    __m256 v = _mm256_loadu_ps(p);
+    __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, _mm256_set1_ps(lo), _CMP_GE_OQ),
+                            _mm256_cmp_ps(v, _mm256_set1_ps(hi), _CMP_LE_OQ));
+    return _mm256_movemask_ps(in);
+  }
+};
+
+template<>
+struct Avx2Select<double>
+{
+  UPS_TARGET_AVX2 static inline int
+  mask(const double *p, double lo, double hi) {
+    __m256d l = _mm256_set1_pd(lo);
+    __m256d h = _mm256_set1_pd(hi);
+    __m256d v0 = _mm256_loadu_pd(p + 0);
+    __m256d v1 = _mm256_loadu_pd(p + 4);
+    __m256d in0 = _mm256_and_pd(_mm256_cmp_pd(v0, l, _CMP_GE_OQ),
+                            _mm256_cmp_pd(v0, h, _CMP_LE_OQ));
+    __m256d in1 = _mm256_and_pd(_mm256_cmp_pd(v1, l, _CMP_GE_OQ),
+                            _mm256_cmp_pd(v1, h, _CMP_LE_OQ));
+    return _mm256_movemask_pd(in0) | (_mm256_movemask_pd(in1) << 4);
+  }
+};
+
+// For each 8bit mask: the lanes of the set bits, moved to the front. Used
+// as a permutation to compact eight positions.
+struct CompactTable
+{
+  CompactTable() {
+    for (int mask = 0; mask < 256; mask++) {
+      int n = 0;
+      for (int lane = 0; lane < 8; lane++)
+        if (mask & (1 << lane))
+          lanes[mask][n++] = (uint8_t)lane;
+      for (; n < 8; n++)
+        lanes[mask][n] = 0;
+    }
+  }
+
+  uint8_t lanes[256][8];
+};
+
+static const CompactTable compact_table;
+
+template<typename T>
+UPS_TARGET_AVX2 static size_t
+select_avx2(const T *data, size_t length, T lo, T hi, uint32_t *selection)
+{
+  __m256i positions = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i eight = _mm256_set1_epi32(8);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    int m = Avx2Select<T>::mask(data + i, lo, hi);
+    __m256i perm = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64((const __m128i *)compact_table.lanes[m]));
+    _mm256_storeu_si256((__m256i *)(selection + n),
+                    _mm256_permutevar8x32_epi32(positions, perm));
+    n += popcount((uint32_t)m);
+    positions = _mm256_add_epi32(positions, eight);
+  }
+
+  // the remaining values
+  for (; i < length; i++) {
+    selection[n] = (uint32_t)i;
+    n += (data[i] >= lo) & (data[i] <= hi);
+  }
+  return n;
+}
+
+//
+// AVX-512: compares |kLanes| values with the interval [lo, hi] and returns
+// a bit mask of the matching values
+//
+template<typename T>
+struct Avx512Select;
+
+template<>
+struct Avx512Select<uint8_t>
+{
+  enum { kLanes = 16 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const uint8_t *p, uint8_t lo, uint8_t hi) {
+    __m512i v = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)p));
+    return _mm512_cmpge_epu32_mask(v, _mm512_set1_epi32(lo))
+            & _mm512_cmple_epu32_mask(v, _mm512_set1_epi32(hi));
+  }
+};
+
+template<>
+struct Avx512Select<uint16_t>
+{
+  enum { kLanes = 16 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const uint16_t *p, uint16_t lo, uint16_t hi) {
+    __m512i v = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)p));
+    return _mm512_cmpge_epu32_mask(v, _mm512_set1_epi32(lo))
+            & _mm512_cmple_epu32_mask(v, _mm512_set1_epi32(hi));
+  }
+};
+
+template<>
+struct Avx512Select<uint32_t>
+{
+  enum { kLanes = 16 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const uint32_t *p, uint32_t lo, uint32_t hi) {
+    __m512i v = _mm512_loadu_si512(p);
+    return _mm512_cmpge_epu32_mask(v, _mm512_set1_epi32((int)lo))
+            & _mm512_cmple_epu32_mask(v, _mm512_set1_epi32((int)hi));
+  }
+};
+
+template<>
+struct Avx512Select<uint64_t>
+{
+  enum { kLanes = 8 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const uint64_t *p, uint64_t lo, uint64_t hi) {
+    __m512i v = _mm512_loadu_si512(p);
+    return _mm512_cmpge_epu64_mask(v, _mm512_set1_epi64((long long)lo))
+            & _mm512_cmple_epu64_mask(v, _mm512_set1_epi64((long long)hi));
+  }
+};
+
+template<>
+struct Avx512Select<float>
+{
+  enum { kLanes = 16 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const float *p, float lo, float hi) {
+    __m512 v = _mm512_loadu_ps(p);
+    return _mm512_cmp_ps_mask(v, _mm512_set1_ps(lo), _CMP_GE_OQ)
+            & _mm512_cmp_ps_mask(v, _mm512_set1_ps(hi), _CMP_LE_OQ);
+  }
+};
+
+template<>
+struct Avx512Select<double>
+{
+  enum { kLanes = 8 };
+
+  UPS_TARGET_AVX512 static inline __mmask16
+  mask(const double *p, double lo, double hi) {
+    __m512d v = _mm512_loadu_pd(p);
+    return _mm512_cmp_pd_mask(v, _mm512_set1_pd(lo), _CMP_GE_OQ)
+            & _mm512_cmp_pd_mask(v, _mm512_set1_pd(hi), _CMP_LE_OQ);
+  }
+};
+
+// The matching positions are compacted in a register and then stored;
+// compressing directly to memory is very slow on some CPUs
+template<typename T>
+UPS_TARGET_AVX512 static size_t
+select_avx512(const T *data, size_t length, T lo, T hi, uint32_t *selection)
+{
+  const size_t kLanes = Avx512Select<T>::kLanes;
+  __m512i positions = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                          8, 9, 10, 11, 12, 13, 14, 15);
+  const __m512i step = _mm512_set1_epi32((int)kLanes);
+
+  size_t n = 0;
+  size_t i = 0;
+  for (; i + kLanes <= length; i += kLanes) {
+    __mmask16 m = Avx512Select<T>::mask(data + i, lo, hi);
+    _mm512_storeu_si512(selection + n,
+                    _mm512_maskz_compress_epi32(m, positions));
+    n += popcount((uint32_t)m);
+    positions = _mm512_add_epi32(positions, step);
+  }
+
+  // the remaining values
+  for (; i < length; i++) {
+    selection[n] = (uint32_t)i;
+    n += (data[i] >= lo) & (data[i] <= hi);
+  }
+  return n;
+}
+
+template<typename T>
+size_t
+select_range_avx2(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection)
+{
+  return select_avx2<T>(data, length, lo, hi, selection);
+}
+
+template<typename T>
+size_t
+select_range_avx512(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection)
+{
+  return select_avx512<T>(data, length, lo, hi, selection);
+}
+
+template<typename T>
+struct SelectDispatcher
+{
+  typedef size_t (*Function)(const T *data, size_t length, T lo, T hi,
+                  uint32_t *selection);
+
+  // Returns the fastest selection function which is supported by the CPU
+  static Function select() {
+    if (os_has_avx512())
+      return select_range_avx512<T>;
+    if (os_has_avx2())
+      return select_range_avx2<T>;
+    return select_range_scalar<T>;
+  }
+};
+
+template<typename T>
+size_t
+select_range_simd(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection)
+{
+  static typename SelectDispatcher<T>::Function function
+            = SelectDispatcher<T>::select();
+  return function(data, length, lo, hi, selection);
+}
+
+#define INSTANTIATE_SELECT(T) \
+  template size_t select_range_avx2<T>(const T *, size_t, T, T, uint32_t *); \
+  template size_t select_range_avx512<T>(const T *, size_t, T, T,           \
+                  uint32_t *);                                              \
+  template size_t select_range_simd<T>(const T *, size_t, T, T, uint32_t *);
+
+INSTANTIATE_SELECT(uint8_t)
+INSTANTIATE_SELECT(uint16_t)
+INSTANTIATE_SELECT(uint32_t)
+INSTANTIATE_SELECT(uint64_t)
+INSTANTIATE_SELECT(float)
+INSTANTIATE_SELECT(double)
+
+} // namespace upscaledb
+
+#endif // __SSE__
@@ -19,6 +19,9 @@
 /*
  * SIMD search functions.
  *
+ * The SSE functions are inlined. The AVX2 and AVX-512 functions are
+ * compiled in simd.cc and selected at runtime, depending on the CPU.
+ *
  * @exception_safe: unknown
  * @thread_safe: unknown
  */
@@ -332,6 +335,161 @@ linear_search_sse<uint64_t>(uint64_t *data, int start, int count, uint64_t key)
 }
 #endif
 
+#ifdef __SSE2__
+// Returns the position of the first key in the sorted array |data| which
+// is not less than |key| (like std::lower_bound), or |count| if all keys
+// are smaller. A branchless binary search narrows the range to 16 keys,
+// which are then compared with SSE2 instructions (four keys at a time).
+inline int
+lower_bound_sse(const uint32_t *data, int count, uint32_t key)
+{
+  int base = 0;
+  int n = count;
+  while (n > 16) {
+    int half = n / 2;
+    base = data[base + half] < key ? base + half : base;
+    n -= half;
+  }
+
+  // SSE only compares signed integers; flipping the sign bit maps the
+  // unsigned order to the signed order
+  const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+  __m128i key4 = _mm_xor_si128(_mm_set1_epi32((int)key), bias);
+
+  int i = base;
+  int end = base + n;
+  for (; i + 4 <= end; i += 4) {
+    __m128i v = _mm_xor_si128(
+                    _mm_loadu_si128((const __m128i *)&data[i]), bias);
+
+    // a lane is set if its key is < |key|
+    int res = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(key4, v)));
+    if (res != 0xf)
+      return i + ctz(~res);
+  }
+
+  for (; i < end; i++)
+    if (data[i] >= key)
+      return i;
+  return end;
+}
+#endif // __SSE2__
+
+#ifdef __SSE4_2__
+// Returns the position of the first key in the sorted array |data| which
+// is not less than |key| (like std::lower_bound), or |count| if all keys
+// are smaller. A branchless binary search narrows the range to 16 keys,
+// which are then compared with SSE4.2 instructions (two keys at a time).
+inline int
+lower_bound_sse(const uint64_t *data, int count, uint64_t key)
+{
+  int base = 0;
+  int n = count;
+  while (n > 16) {
+    int half = n / 2;
+    base = data[base + half] < key ? base + half : base;
+    n -= half;
+  }
+
+  // SSE only compares signed integers; flipping the sign bit maps the
+  // unsigned order to the signed order
+  const __m128i bias = _mm_set1_epi64x((long long)0x8000000000000000ull);
+  __m128i key2 = _mm_xor_si128(_mm_set1_epi64x((long long)key), bias);
+
+  int i = base;
+  int end = base + n;
+  for (; i + 4 <= end; i += 4) {
+    __m128i v1 = _mm_xor_si128(
+                    _mm_loadu_si128((const __m128i *)&data[i + 0]), bias);
+    __m128i v2 = _mm_xor_si128(
+                    _mm_loadu_si128((const __m128i *)&data[i + 2]), bias);
+
+    // a lane is set if its key is < |key|
+    int res = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key2, v1)))
+            | (_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(key2, v2)))
+                    << 2);
+    if (res != 0xf)
+      return i + ctz(~res);
+  }
+
+  for (; i < end; i++)
+    if (data[i] >= key)
+      return i;
+  return end;
+}
+#endif // __SSE4_2__
+
+// Searches |data| for the key in |hkey| and returns its slot, or -1 if the
+// key does not exist. A branchless binary search narrows the range till it
+// fits into a single cache line; the keys in this cache line are then
+// compared with AVX2 instructions (two 256bit registers).
+//
+// Only call this if os_has_avx2() returns true!
+template<typename T>
+int
+find_simd_avx2(size_t node_count, T *data, const ups_key_t *hkey);
+
+// Same as find_simd_avx2(), but compares the cache line with a single
+// AVX-512 instruction.
+//
+// Only call this if os_has_avx512() returns true!
+template<typename T>
+int
+find_simd_avx512(size_t node_count, T *data, const ups_key_t *hkey);
+
+// Searches |data| for the key in |hkey|. Picks the widest instruction set
+// which is supported by the CPU (AVX-512, AVX2 or SSE); the check is
+// performed only once.
+//
+// Available for uint8_t, uint16_t, uint32_t, uint64_t, float and double.
+template<typename T>
+int
+find_simd(size_t node_count, T *data, const ups_key_t *hkey);
+
+// Stores the positions of all values of |data| in the closed interval
+// [lo, hi] in the selection vector |selection|, and returns their number.
+// Does not branch on the result of the comparisons.
+template<typename T>
+inline size_t
+select_range_scalar(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < length; i++) {
+    selection[n] = (uint32_t)i;
+    n += (data[i] >= lo) & (data[i] <= hi);
+  }
+  return n;
+}
+
+// Same as select_range_scalar(), but compares eight values at a time with
+// AVX2 instructions. The SIMD functions store whole registers, therefore
+// |selection| must have room for |length| + 16 positions.
+//
+// Only call this if os_has_avx2() returns true!
+template<typename T>
+size_t
+select_range_avx2(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection);
+
+// Same as select_range_avx2(), but compares (up to) 16 values at a time
+// with AVX-512 instructions.
+//
+// Only call this if os_has_avx512() returns true!
+template<typename T>
+size_t
+select_range_avx512(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection);
+
+// Picks the widest instruction set which is supported by the CPU for
+// select_range_*(); the check is performed only once.
+//
+// Available for uint8_t, uint16_t, uint32_t, uint64_t, float and double.
+template<typename T>
+size_t
+select_range_simd(const T *data, size_t length, T lo, T hi,
+                uint32_t *selection);
+
 } // namespace upscaledb
 
 #endif // __SSE__
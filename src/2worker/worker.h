@@ -28,6 +28,7 @@
 #include <boost/thread/thread.hpp>
 
 // Always verify that a file of level N does not include headers > N!
+#include "1base/mutex.h"
 #include "2worker/workitem.h"
 
 #ifndef UPS_ROOT_H
@@ -51,21 +52,76 @@ struct WorkerThread {
  
 // the actual thread pool
 struct WorkerPool {
+  // wraps a work item which was added with enqueue_parallel(); keeps
+  // track of the items which are still in flight
+  template<typename F>
+  struct ParallelWorkItem {
+    ParallelWorkItem(WorkerPool *pool_, F f_)
+      : pool(pool_), f(f_) {
+    }
+
+    void operator()() {
+      try {
+        f();
+      }
+      catch (...) {
+        pool->parallel_item_done();
+        throw;
+      }
+      pool->parallel_item_done();
+    }
+
+    WorkerPool *pool;
+    F f;
+  };
+
   // the constructor just launches some amount of workers
   WorkerPool(size_t num_threads)
-    : working(service), strand(service) {
+    : working(service), strand(service), in_flight(0) {
     for (size_t i = 0; i < num_threads; ++i)
       workers.push_back(new boost::thread(WorkerThread(*this)));
   }
 
-  // Add a new work item to the pool
+  // Add a new work item to the pool; all items which are added with this
+  // method are executed sequentially, in the order they were added
   template<typename F>
   void enqueue(F &f) {
     strand.post(f);
   }
 
+  // Add a new work item to the pool; the item can run in parallel to
+  // all other items
+  template<typename F>
+  void enqueue_parallel(F &f) {
+    {
+      ScopedLock lock(mutex);
+      in_flight++;
+    }
+    service.post(ParallelWorkItem<F>(this, f));
+  }
+
+  // Blocks till all items added with enqueue_parallel() were executed
+  void wait_for_parallel() {
+    ScopedLock lock(mutex);
+    while (in_flight > 0)
+      cond.wait(lock);
+  }
+
+  // Called whenever a parallel work item was executed
+  void parallel_item_done() {
+    ScopedLock lock(mutex);
+    if (--in_flight == 0)
+      cond.notify_all();
+  }
+
+  // Returns the number of threads
+  size_t num_threads() const {
+    return (workers.size());
+  }
+
   // the destructor joins all threads
   ~WorkerPool() {
+    wait_for_parallel();
     service.stop();
 
     for (size_t i = 0; i < workers.size(); ++i) {
@@ -80,7 +136,16 @@ struct WorkerPool {
   // the io_service we are wrapping
   boost::asio::io_service service;
   boost::asio::io_service::work working;
-  boost::asio::strand strand;
+  boost::asio::io_service::strand strand;
+
+  // protects |in_flight|
+  boost::mutex mutex;
+
+  // signalled when |in_flight| drops to zero
+  Condition cond;
+
+  // number of parallel work items which were not yet executed
+  size_t in_flight;
 };
 
 inline void
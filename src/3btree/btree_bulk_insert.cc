@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * btree bulk loading
+ *
+ * The keys are appended to the right-most leaf. When a node is full (or
+ * the fill factor is reached) then a new node is allocated on the right
+ * side and the first key of the new node is appended to the parent. Nodes
+ * are never split, and the tree is never traversed from the root.
+ */
+
+#include "0root/root.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "1base/dynamic_array.h"
+#include "2page/page.h"
+#include "3page_manager/page_manager.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_node_proxy.h"
+#include "3btree/btree_update.h"
+#include "4db/db.h"
+#include "4env/env.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct BtreeBulkInsertAction : public BtreeUpdateAction
+{
+  BtreeBulkInsertAction(BtreeIndex *btree_, Context *context_,
+                  ups_key_t *keys_, ups_record_t *records_, uint32_t count_,
+                  uint32_t fill_factor_)
+    : BtreeUpdateAction(btree_, context_, 0, 0), keys(keys_),
+      records(records_), count(count_),
+      fill_factor(fill_factor_ ? fill_factor_ : 100) {
+  }
+
+  // This is the entry point for the bulk insert operation
+  ups_status_t run() {
+    if (count == 0)
+      return 0;
+
+    // the keys must be sorted and unique
+    for (uint32_t i = 1; i < count; i++) {
+      if (btree->compare_keys(&keys[i - 1], &keys[i]) >= 0) {
+        ups_trace(("keys are not sorted (key #%u)", i));
+        return UPS_INV_PARAMETER;
+      }
+    }
+
+    // fetch the right-most path, from the leaf up to the root
+    LocalEnvironment *env = btree->db()->lenv();
+    Page *page = env->page_manager()->fetch(context, btree->root_address());
+    BtreeNodeProxy *node = btree->get_node_from_page(page);
+    path.push_back(page);
+    while (!node->is_leaf()) {
+      uint64_t child = node->length() > 0
+                          ? node->record_id(context, node->length() - 1)
+                          : node->left_child();
+      page = env->page_manager()->fetch(context, child);
+      node = btree->get_node_from_page(page);
+      path.push_back(page);
+    }
+    std::reverse(path.begin(), path.end());
+
+    // the first key must be greater than all keys in the btree; the
+    // right-most leaf can be empty if keys were erased
+    while (node->length() == 0 && node->left_sibling() != 0) {
+      page = env->page_manager()->fetch(context, node->left_sibling(),
+                      PageManager::kReadOnly);
+      node = btree->get_node_from_page(page);
+    }
+    if (node->length() > 0
+          && node->compare(context, &keys[0], node->length() - 1) <= 0) {
+      ups_trace(("keys must be greater than the existing keys"));
+      return UPS_INV_PARAMETER;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+      append_leaf(&keys[i], &records[i]);
+    return 0;
+  }
+
+  // Returns the max. number of keys which are appended to |node| before a
+  // new node is started
+  size_t node_limit(BtreeNodeProxy *node) const {
+    if (fill_factor >= 100)
+      return (size_t)-1;
+    size_t limit = node->estimate_capacity() * fill_factor / 100;
+    return limit > 2 ? limit : 2;
+  }
+
+  // Allocates a new node right of |path[level]|
+  Page *allocate_sibling(size_t level) {
+    LocalEnvironment *env = btree->db()->lenv();
+    Page *old_page = path[level];
+    BtreeNodeProxy *old_node = btree->get_node_from_page(old_page);
+
+    Page *new_page = env->page_manager()->alloc(context, Page::kTypeBindex);
+    {
+      PBtreeNode *node = PBtreeNode::from_page(new_page);
+      node->set_flags(old_node->is_leaf() ? PBtreeNode::kLeafNode : 0);
+    }
+    BtreeNodeProxy *new_node = btree->get_node_from_page(new_page);
+
+    new_node->set_left_sibling(old_page->address());
+    old_node->set_right_sibling(new_page->address());
+    new_page->set_dirty(true);
+    old_page->set_dirty(true);
+    return new_page;
+  }
+
+  // Appends a key/record pair to the right-most leaf
+  void append_leaf(ups_key_t *key, ups_record_t *record) {
+    BtreeNodeProxy *node = btree->get_node_from_page(path[0]);
+
+    PBtreeNode::InsertResult result(UPS_LIMITS_REACHED, 0);
+    if (node->length() < node_limit(node))
+      result = node->insert(context, key, PBtreeNode::kInsertAppend);
+
+    // the leaf is full: continue with a new leaf
+    if (result.status == UPS_LIMITS_REACHED && node->length() > 0) {
+      Page *new_page = allocate_sibling(0);
+      append_internal(1, key, new_page->address());
+      path[0] = new_page;
+
+      node = btree->get_node_from_page(new_page);
+      result = node->insert(context, key, PBtreeNode::kInsertAppend);
+    }
+    if (result.status)
+      throw Exception(result.status);
+
+    try {
+      uint32_t new_duplicate_id = 0;
+      node->set_record(context, result.slot, record, 0, 0,
+                      &new_duplicate_id);
+    }
+    // undo the insert, i.e. if the BlobManager failed to allocate storage
+    catch (Exception &ex) {
+      node->erase(context, result.slot);
+      throw ex;
+    }
+
+    path[0]->set_dirty(true);
+  }
+
+  // Appends the separator |key| and the |child| page to the internal
+  // node at |path[level]|; allocates a new root if necessary
+  void append_internal(size_t level, ups_key_t *key, uint64_t child) {
+    if (level == path.size())
+      path.push_back(allocate_new_root(path[level - 1]));
+
+    Page *page = path[level];
+    BtreeNodeProxy *node = btree->get_node_from_page(page);
+
+    PBtreeNode::InsertResult result(UPS_LIMITS_REACHED, 0);
+    if (node->length() < node_limit(node))
+      result = node->insert(context, key, PBtreeNode::kInsertAppend);
+
+    // the node is full: the |key| moves up to the parent, and |child|
+    // becomes the left-most child of a new node
+    if (result.status == UPS_LIMITS_REACHED && node->length() > 0) {
+      Page *new_page = allocate_sibling(level);
+      btree->get_node_from_page(new_page)->set_left_child(child);
+      append_internal(level + 1, key, new_page->address());
+      path[level] = new_page;
+      return;
+    }
+    if (result.status)
+      throw Exception(result.status);
+
+    node->set_record_id(context, result.slot, child);
+    page->set_dirty(true);
+  }
+
+  // the sorted keys
+  ups_key_t *keys;
+
+  // the records
+  ups_record_t *records;
+
+  // the number of keys and records
+  uint32_t count;
+
+  // percentage of a node which is filled
+  uint32_t fill_factor;
+
+  // the right-most page of each level; path[0] is the leaf
+  std::vector<Page *> path;
+};
+
+ups_status_t
+BtreeIndex::bulk_insert(Context *context, ups_key_t *keys,
+                ups_record_t *records, uint32_t count, uint32_t fill_factor)
+{
+  context->db = db();
+
+  BtreeBulkInsertAction bbia(this, context, keys, records, count,
+                  fill_factor);
+  return bbia.run();
+}
+
+} // namespace upscaledb
@@ -219,6 +219,7 @@ move_next(BtreeCursor *cursor, Context *context, uint32_t flags)
   if (unlikely(!node->right_sibling()))
     return UPS_KEY_NOT_FOUND;
 
+  uint64_t from = st_.m_coupled_page->address();
   Page *page = env->page_manager()->fetch(context, node->right_sibling(),
                     PageManager::kReadOnly);
   node = st_.m_btree->get_node_from_page(page);
@@ -233,6 +234,9 @@ move_next(BtreeCursor *cursor, Context *context, uint32_t flags)
     node = st_.m_btree->get_node_from_page(page);
   }
 
+  // the scan continues to the right; read the next leafs ahead
+  st_.m_readahead.advance(context, st_.m_btree, from, page, true);
+
   // couple this cursor to the smallest key in this page
   cursor->couple_to_page(page, 0, 0);
 
@@ -272,6 +276,7 @@ move_previous(BtreeCursor *cursor, Context *context, uint32_t flags)
     if (unlikely(!node->left_sibling()))
       return UPS_KEY_NOT_FOUND;
 
+    uint64_t from = st_.m_coupled_page->address();
     Page *page = env->page_manager()->fetch(context, node->left_sibling(),
                     PageManager::kReadOnly);
     node = st_.m_btree->get_node_from_page(page);
@@ -286,6 +291,9 @@ move_previous(BtreeCursor *cursor, Context *context, uint32_t flags)
       node = st_.m_btree->get_node_from_page(page);
     }
 
+    // the scan continues to the left; read the next leafs ahead
+    st_.m_readahead.advance(context, st_.m_btree, from, page, false);
+
     // couple this cursor to the highest key in this page
     cursor->couple_to_page(page, node->length() - 1);
   }
@@ -406,8 +414,29 @@ BtreeCursor::overwrite(Context *context, ups_record_t *record, uint32_t flags)
 
   // copy the key flags, and remove all flags concerning the key size
   BtreeNodeProxy *node = st_.m_btree->get_node_from_page(st_.m_coupled_page);
-  node->set_record(context, st_.m_coupled_index, record, st_.m_duplicate_index,
-                    flags | UPS_OVERWRITE, 0);
+  try {
+    node->set_record(context, st_.m_coupled_index, record,
+                    st_.m_duplicate_index, flags | UPS_OVERWRITE, 0);
+  }
+  // compressed RecordLists can grow if a record is overwritten. If the node
+  // is full then overwrite the record through the Btree, which splits
+  // the node and couples the cursor to the new position of the key
+  catch (Exception &ex) {
+    if (ex.code != UPS_LIMITS_REACHED
+        || ISSET(st_.m_btree->db()->get_flags(), UPS_ENABLE_DUPLICATE_KEYS))
+      throw ex;
+
+    uncouple_from_page(context);
+    ByteArray arena;
+    arena.copy((uint8_t *)st_.m_uncoupled_key.data,
+                    st_.m_uncoupled_key.size);
+    ups_key_t key = ups_make_key(arena.data(), (uint16_t)arena.size());
+    ups_status_t st = st_.m_btree->insert(context, parent(), &key, record,
+                    flags | UPS_OVERWRITE);
+    if (st)
+      throw Exception(st);
+    return;
+  }
 
   st_.m_coupled_page->set_dirty(true);
 }
@@ -513,8 +542,12 @@ BtreeCursor::move_to_next_page(Context *context)
     return UPS_KEY_NOT_FOUND;
   }
 
+  uint64_t from = st_.m_coupled_page->address();
   Page *page = env->page_manager()->fetch(context, node->right_sibling(),
                         PageManager::kReadOnly);
+  // this function is only used by UQI queries, which always scan
+  // sequentially
+  st_.m_readahead.advance(context, st_.m_btree, from, page, true, true);
   couple_to_page(page, 0, 0);
   return 0;
 }
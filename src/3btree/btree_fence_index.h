@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * An in-memory search index for internal Btree nodes with binary keys.
+ *
+ * All keys of a node share a common prefix (the common prefix of the first
+ * and the last key). For each key, the 8 bytes following this prefix are
+ * stored as a big-endian integer (the "fence"); shorter keys are padded
+ * with zeroes. If the keys are compared with memcmp(3) then the fences
+ * are sorted as well, and if the fence of a key is smaller (or greater)
+ * than the fence of the search key then the key itself is smaller (or
+ * greater).
+ *
+ * A lookup therefore runs a binary search on a dense array of integers
+ * instead of the (large and scattered) keys of the page. Only the slots
+ * with the same fence as the search key have to be compared with the
+ * regular comparator - usually a single key, or none at all.
+ *
+ * The index is owned by the BtreeNodeProxy, which is cached in the Page.
+ * It is invalidated whenever the node is modified and rebuilt lazily
+ * when the node is searched again.
+ *
+ * @exception_safe: strong
+ * @thread_safe: no
+ */
+
+#ifndef UPS_BTREE_FENCE_INDEX_H
+#define UPS_BTREE_FENCE_INDEX_H
+
+#include "0root/root.h"
+
+#include <string.h>
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct Context;
+
+struct BtreeFenceIndex
+{
+  enum {
+    // Smaller nodes are searched without an index
+    kMinimumLength = 32
+  };
+
+  // Constructor
+  BtreeFenceIndex()
+    : is_valid(false), length(0) {
+  }
+
+  // Invalidates the index; called whenever the node is modified
+  void invalidate() {
+    is_valid = false;
+  }
+
+  // Returns true if the index is up-to-date for a node with |node_length|
+  // keys
+  bool is_up_to_date(size_t node_length) const {
+    return is_valid && length == node_length;
+  }
+
+  // Rebuilds the index from the keys of |impl|
+  template<typename NodeImpl>
+  void rebuild(Context *context, NodeImpl &impl, size_t node_length) {
+    is_valid = false;
+
+    // the common prefix of the first and the last key is shared by
+    // all keys in the node. The first key is copied because the KeyList
+    // can return a pointer to a temporary buffer (i.e. if the keys
+    // are compressed).
+    ups_key_t first = {0};
+    ups_key_t last = {0};
+    impl.keys.get_key(context, 0, &first_arena, &first, true);
+    impl.keys.get_key(context, (int)node_length - 1, &last_arena, &last,
+                    false);
+    size_t prefix_length = 0;
+    size_t max = std::min(first.size, last.size);
+    while (prefix_length < max
+            && ((uint8_t *)first.data)[prefix_length]
+                    == ((uint8_t *)last.data)[prefix_length])
+      prefix_length++;
+    prefix.copy((uint8_t *)first.data, prefix_length);
+
+    uint64_t *p = fences.resize(node_length);
+    for (size_t i = 0; i < node_length; i++) {
+      ups_key_t key = {0};
+      impl.keys.get_key(context, (int)i, &last_arena, &key, false);
+      p[i] = fence((uint8_t *)key.data, key.size, prefix_length);
+    }
+
+    length = node_length;
+    is_valid = true;
+  }
+
+  // Narrows the search for |key|: all keys left of |*pbegin| are smaller
+  // than |key|, all keys starting at |*pend| are greater than |key|. The
+  // keys in between have to be compared with the actual comparator.
+  void narrow(const ups_key_t *key, int *pbegin, int *pend) const {
+    const uint8_t *data = (const uint8_t *)key->data;
+    size_t prefix_length = prefix.size();
+
+    // compare the key with the common prefix
+    size_t max = std::min((size_t)key->size, prefix_length);
+    int cmp = ::memcmp(data, prefix.data(), max);
+    if (cmp < 0 || (cmp == 0 && key->size < prefix_length)) {
+      *pbegin = *pend = 0;
+      return;
+    }
+    if (cmp > 0) {
+      *pbegin = *pend = (int)length;
+      return;
+    }
+
+    uint64_t f = fence(data, key->size, prefix_length);
+    const uint64_t *begin = fences.data();
+    const uint64_t *lower = std::lower_bound(begin, begin + length, f);
+    const uint64_t *upper = std::upper_bound(lower, begin + length, f);
+    *pbegin = (int)(lower - begin);
+    *pend = (int)(upper - begin);
+  }
+
+  // Returns the 8 bytes following |offset| as a big-endian integer
+  static uint64_t fence(const uint8_t *data, size_t size, size_t offset) {
+    uint64_t f = 0;
+    for (size_t i = offset; i < offset + 8; i++)
+      f = (f << 8) | (i < size ? data[i] : 0);
+    return f;
+  }
+
+  // True if the index is up-to-date
+  bool is_valid;
+
+  // The number of keys in the index
+  size_t length;
+
+  // The common prefix of all keys
+  ByteArray prefix;
+
+  // The fences of all keys
+  DynamicArray<uint64_t> fences;
+
+  // Memory arenas for rebuilding the index
+  ByteArray first_arena;
+  ByteArray last_arena;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_FENCE_INDEX_H */
@@ -42,7 +42,11 @@ struct BtreeKey
     kExtendedKey          = 0x01,
 
     // key is compressed; the original size is stored in the payload
-    kCompressed           = 0x08
+    kCompressed           = 0x08,
+
+    // only the suffix of the key is stored; the prefix is shared by
+    // all keys of the node (see btree_keys_prefix.h)
+    kPrefixCompressed     = 0x10
   };
 
   // flags used with the ups_key_t::_flags (note the underscore - this
@@ -122,11 +122,65 @@ class BaseNodeImpl
       if (!requires_records)
         distinct = true;
 
-      ByteArray *key_arena = &context->db->key_arena(context->txn);
-      ByteArray *rec_arena = &context->db->record_arena(context->txn);
+      ByteArray *key_arena = context->key_arena
+                                ? context->key_arena
+                                : &context->db->key_arena(context->txn);
+      ByteArray *rec_arena = context->record_arena
+                                ? context->record_arena
+                                : &context->db->record_arena(context->txn);
 
       // this branch handles non-duplicate block scans without an iterator
       if (distinct) {
+        // built-in comparison of the keys? then the KeyList skips all keys
+        // (and compressed blocks) which are out of range
+        const ComparisonPredicate &cmp = statement->comparison;
+        if (KeyList::kSupportsRangeScans
+                && cmp.is_active()
+                && cmp.stream == UQI_STREAM_KEY
+                && (!requires_records || RecordList::kSupportsBlockScans)) {
+          uint32_t streams = visitor->prefiltered_streams();
+          uint32_t first;
+          ScanResult srk = keys.scan_range(key_arena, node->length(), start,
+                          cmp, ISSET(streams, UQI_STREAM_KEY), &first);
+          if (srk.second == 0)
+            return;
+          const void *record_array = 0;
+          if (requires_records && ISSET(streams, UQI_STREAM_RECORD))
+            record_array = records.scan(rec_arena, node->length(),
+                            first).first;
+          visitor->prefiltered(srk.first, record_array, srk.second);
+          return;
+        }
+
+        // other built-in comparisons (i.e. of the records) filter the
+        // arrays with a selection vector; only the accepted rows are
+        // passed to the visitor
+        if (cmp.is_active()
+                && (KeyList::kSupportsBlockScans || !requires_keys)
+                && (RecordList::kSupportsBlockScans || !requires_records)) {
+          ScanResult srk(0, 0), srr(0, 0);
+          uint32_t streams = 0;
+          if (requires_keys) {
+            srk = keys.scan(key_arena, node->length(), start);
+            streams |= UQI_STREAM_KEY;
+          }
+          if (requires_records) {
+            srr = records.scan(rec_arena, node->length(), start);
+            streams |= UQI_STREAM_RECORD;
+          }
+          size_t length = requires_keys ? srk.second : srr.second;
+
+          const DbConfig &config = context->db->config();
+          const void *key_array, *record_array;
+          size_t count = visitor->selection.apply(cmp, srk.first,
+                          config.key_size, srr.first, config.record_size,
+                          length, streams & visitor->prefiltered_streams(),
+                          &key_array, &record_array);
+          if (count > 0)
+            visitor->prefiltered(key_array, record_array, count);
+          return;
+        }
+
         // only scan keys?
         if (KeyList::kSupportsBlockScans && !requires_records) {
           ScanResult sr = keys.scan(key_arena, node->length(), start);
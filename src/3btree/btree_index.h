@@ -21,6 +21,7 @@
 #include "0root/root.h"
 
 #include <algorithm>
+#include <vector>
 
 // Always verify that a file of level N does not include headers > N!
 #include "1base/abi.h"
@@ -227,6 +228,14 @@ struct BtreeIndex
   ups_status_t insert(Context *context, LocalCursor *cursor, ups_key_t *key,
                   ups_record_t *record, uint32_t flags);
 
+  // Appends |count| sorted key/record pairs to the index; all keys must
+  // be greater than the existing keys (ups_db_bulk_insert).
+  // |fill_factor| is the percentage of each node which is filled (1..100,
+  // 0 is the same as 100)
+  ups_status_t bulk_insert(Context *context, ups_key_t *keys,
+                  ups_record_t *records, uint32_t count,
+                  uint32_t fill_factor);
+
   // Erases a key/record from the index (ups_db_erase).
   // If |duplicate_index| is 0 then all duplicates are erased, otherwise only
   // the specified duplicate is erased.
@@ -237,6 +246,13 @@ struct BtreeIndex
   void visit_nodes(Context *context, BtreeVisitor &visitor,
                   bool visit_internal_nodes);
 
+  // Splits the leafs into (at most) |count| ranges of consecutive leafs of
+  // similar size and stores the address of the first leaf of each range
+  // in |leafs|, from left to right. The pages remain in the changeset of
+  // |context|.
+  void partition_leafs(Context *context, size_t count,
+                  std::vector<uint64_t> *leafs);
+
   // Checks the integrity of the btree (ups_db_check_integrity)
   void check_integrity(Context *context, uint32_t flags);
 
@@ -27,6 +27,7 @@
 #include "3btree/btree_keys_pod.h"
 #include "3btree/btree_keys_binary.h"
 #include "3btree/btree_keys_varlen.h"
+#include "3btree/btree_keys_prefix.h"
 #include "3btree/btree_zint32_groupvarint.h"
 #include "3btree/btree_zint32_maskedvbyte.h"
 #include "3btree/btree_zint32_simdcomp.h"
@@ -34,11 +35,14 @@
 #include "3btree/btree_zint32_simdfor.h"
 #include "3btree/btree_zint32_streamvbyte.h"
 #include "3btree/btree_zint32_varbyte.h"
+#include "3btree/btree_zint64_for.h"
+#include "3btree/btree_zint64_streamvbyte.h"
 #include "3btree/btree_records_default.h"
 #include "3btree/btree_records_inline.h"
 #include "3btree/btree_records_internal.h"
 #include "3btree/btree_records_duplicate.h"
 #include "3btree/btree_records_pod.h"
+#include "3btree/btree_records_numeric.h"
 #include "3btree/btree_node_proxy.h"
 #include "4db/db_local.h"
 
@@ -90,6 +94,45 @@ struct BtreeIndexTraitsImpl : public BtreeIndexTraits
 #define PAX_INTERNAL_NUMERIC(type) \
           PAX_INTERNAL_NODE(PaxLayout::PodKeyList<type>, NumericCompare<type> )
 
+// compressed numeric records have a variable size and therefore always
+// use the DefaultNodeImpl
+#define NUMERIC_RECORDS_IMPL(KeyList, Compare) \
+        switch (cfg.record_type) {                                          \
+          case UPS_TYPE_UINT8:                                              \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<uint8_t> >,        \
+                      Compare >());                                         \
+          case UPS_TYPE_UINT16:                                             \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<uint16_t> >,       \
+                      Compare >());                                         \
+          case UPS_TYPE_UINT32:                                             \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<uint32_t> >,       \
+                      Compare >());                                         \
+          case UPS_TYPE_UINT64:                                             \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<uint64_t> >,       \
+                      Compare >());                                         \
+          case UPS_TYPE_REAL32:                                             \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<float> >,          \
+                      Compare >());                                         \
+          case UPS_TYPE_REAL64:                                             \
+            return (new BtreeIndexTraitsImpl                                \
+                      <DefaultNodeImpl<KeyList,                             \
+                            DefLayout::NumericRecordList<double> >,         \
+                      Compare >());                                         \
+          default:                                                          \
+            assert(!"shouldn't be here");                                   \
+            return (0);                                                     \
+        }
+
 #define LEAF_NODE_IMPL(Impl, KeyList, Compare) \
         if (use_duplicates) {                                               \
           if (inline_records) {                                             \
@@ -117,6 +160,8 @@ struct BtreeIndexTraitsImpl : public BtreeIndexTraits
                       Compare >());                                         \
         }                                                                   \
         else {                                                              \
+          if (inline_records && numeric_records)                            \
+            NUMERIC_RECORDS_IMPL(KeyList, Compare);                         \
           if (inline_records)                                               \
             switch (cfg.record_type) {                                      \
               case UPS_TYPE_UINT8:                                          \
@@ -176,6 +221,7 @@ struct BtreeIndexFactory
     bool fixed_keys = (cfg.key_size != UPS_KEY_SIZE_UNLIMITED);
     bool use_duplicates = (cfg.flags & UPS_ENABLE_DUPLICATES) != 0;
     int key_compression = cfg.key_compressor;
+    bool numeric_records = cfg.record_compressor == UPS_COMPRESSOR_NUMERIC;
 
     switch (cfg.key_type) {
       // 8bit unsigned integer
@@ -231,7 +277,16 @@ struct BtreeIndexFactory
       case UPS_TYPE_UINT64:
         if (!is_leaf)
           PAX_INTERNAL_NUMERIC(uint64_t);
-        PAX_LEAF_NUMERIC(uint64_t);
+        switch (key_compression) {
+          case UPS_COMPRESSOR_UINT64_FOR:
+            PAX_LEAF_NODE(Zint64::ForKeyList, NumericCompare<uint64_t>);
+          case UPS_COMPRESSOR_UINT64_STREAMVBYTE:
+            PAX_LEAF_NODE(Zint64::StreamVbyteKeyList,
+                            NumericCompare<uint64_t>);
+          default:
+            // no key compression
+            PAX_LEAF_NUMERIC(uint64_t);
+        }
       // 32bit float
       case UPS_TYPE_REAL32:
         if (!is_leaf)
@@ -268,6 +323,14 @@ struct BtreeIndexFactory
                     FixedSizeCompare);
         } // fixed keys
 
+        // variable length keys with prefix compression
+        if (key_compression == UPS_COMPRESSOR_PREFIX) {
+          if (!is_leaf)
+            DEF_INTERNAL_NODE(DefLayout::PrefixKeyList, VariableSizeCompare);
+          LEAF_NODE_IMPL(DefaultNodeImpl, DefLayout::PrefixKeyList,
+                    VariableSizeCompare);
+        }
+
         // variable length keys, with and without duplicates
         if (!is_leaf)
           DEF_INTERNAL_NODE(DefLayout::VariableLengthKeyList,
@@ -49,6 +49,9 @@ struct BaseKeyList
 
     // A flag whether this KeyList supports the scan() call
     kSupportsBlockScans = 0,
+
+    // A flag whether this KeyList supports the scan_range() call
+    kSupportsRangeScans = 0,
   };
 
   BaseKeyList()
@@ -82,6 +85,13 @@ struct BaseKeyList
     throw Exception(UPS_NOT_IMPLEMENTED);
   }
 
+  // Scans the keys which are accepted by a built-in comparison predicate
+  template<typename Predicate>
+  ScanResult scan_range(ByteArray *arena, size_t node_count, uint32_t start,
+                  const Predicate &predicate, bool decode, uint32_t *pfirst) {
+    throw Exception(UPS_NOT_IMPLEMENTED);
+  }
+
   // Fills the btree_metrics structure
   void fill_metrics(btree_metrics_t *metrics, size_t node_count) {
     BtreeStatistics::update_min_max_avg(&metrics->keylist_ranges, m_range_size);
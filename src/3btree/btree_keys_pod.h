@@ -32,6 +32,7 @@
 
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 // Always verify that a file of level N does not include headers > N!
 #include "1globals/globals.h"
@@ -67,6 +68,9 @@ class PodKeyList : public BaseKeyList
       // A flag whether this KeyList supports the scan() call
       kSupportsBlockScans = 1,
 
+      // A flag whether this KeyList supports the scan_range() call
+      kSupportsRangeScans = 1,
+
       // This KeyList has a custom find() implementation
       kCustomFind = 1,
 
@@ -107,12 +111,12 @@ class PodKeyList : public BaseKeyList
     // Searches the node for the key and returns the slot of this key
     // - only for exact matches!
     //
-    // This is the SIMD implementation. If SIMD is disabled then the
-    // BaseKeyList::find method is used.
+    // This is the SIMD implementation; it uses AVX-512 or AVX2 if the
+    // CPU supports it. If SIMD is disabled then std::lower_bound is used.
     template<typename Cmp>
     int find(Context *context, size_t node_count, const ups_key_t *key,
                     Cmp &comparator) {
-      return (find_simd_sse<T>(node_count, &m_data[0], key));
+      return (find_simd<T>(node_count, &m_data[0], key));
     }
 #else
     template<typename Cmp>
@@ -179,6 +183,25 @@ class PodKeyList : public BaseKeyList
       return std::make_pair(&m_data[start], node_count - start);
     }
 
+    // Scans the keys which are accepted by the built-in comparison
+    // |predicate|. The keys are sorted, therefore the matching keys are
+    // consecutive and a binary search finds them. |*pfirst| receives the
+    // slot of the first matching key.
+    template<typename Predicate>
+    ScanResult scan_range(ByteArray *arena, size_t node_count, uint32_t start,
+                    const Predicate &predicate, bool decode,
+                    uint32_t *pfirst) {
+      T lo, hi;
+      *pfirst = start;
+      if (!predicate.bounds(&lo, &hi))
+        return std::make_pair((const void *)0, (size_t)0);
+
+      T *begin = std::lower_bound(&m_data[start], &m_data[node_count], lo);
+      T *end = std::upper_bound(begin, &m_data[node_count], hi);
+      *pfirst = (uint32_t)(begin - &m_data[0]);
+      return std::make_pair(begin, (size_t)(end - begin));
+    }
+
     // Erases a whole slot by shifting all larger keys to the "left"
     void erase(Context *context, size_t node_count, int slot) {
       if (slot < (int)node_count - 1)
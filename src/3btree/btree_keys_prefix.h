@@ -0,0 +1,520 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Prefix compressed KeyList for variable length keys
+ *
+ * The keys of a node are stored like in the VariableLengthKeyList, but the
+ * common prefix of the keys is stored only once, in the first chunk of the
+ * UpfrontIndex. All other chunks are shifted by one slot. Keys which start
+ * with this prefix only store their suffix (and are flagged with
+ * |BtreeKey::kPrefixCompressed|), all other keys (i.e. extended keys) are
+ * stored in full.
+ *
+ * The prefix is recalculated whenever the node is vacuumized or split;
+ * newly inserted keys are compressed if they share the current prefix.
+ *
+ * Since the suffixes are sorted like the keys, lookups only compare the
+ * search key once with the prefix, and then run a binary search on the
+ * suffixes.
+ */
+
+#ifndef UPS_BTREE_KEYS_PREFIX_H
+#define UPS_BTREE_KEYS_PREFIX_H
+
+#include "0root/root.h"
+
+#include <string.h>
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "3btree/btree_keys_varlen.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+namespace DefLayout {
+
+//
+// The format of the first chunk (the prefix) is:
+//   |Reserved|Prefix...|
+// where Reserved is 8 bit. The format of all other chunks is identical to
+// the VariableLengthKeyList.
+//
+class PrefixKeyList : public VariableLengthKeyList
+{
+    typedef VariableLengthKeyList Base;
+
+  public:
+    enum {
+      // This KeyList has a custom find() implementation
+      kCustomFind = 1,
+
+      // This KeyList has a custom find_lower_bound() implementation
+      kCustomFindLowerBound = 1,
+
+      // The maximum size of a key that can be stored in a single chunk
+      kMaxChunkSize = 255
+    };
+
+    // Constructor
+    PrefixKeyList(LocalDatabase *db)
+      : VariableLengthKeyList(db) {
+    }
+
+    // Creates a new KeyList starting at |ptr|, total size is
+    // |range_size| (in bytes)
+    void create(uint8_t *data, size_t range_size) {
+      Base::create(data, range_size);
+      assign_prefix(0, 0);
+    }
+
+    // Opens an existing KeyList
+    void open(uint8_t *data, size_t range_size, size_t node_count) {
+      Base::open(data, range_size, node_count + 1);
+    }
+
+    // Calculates the required size for a range
+    size_t get_required_range_size(size_t node_count) const {
+      return (Base::get_required_range_size(node_count + 1));
+    }
+
+    // Copies a key into |dest|; the prefix and the suffix of compressed
+    // keys are concatenated in |arena| (or in the user's buffer)
+    void get_key(Context *context, int slot, ByteArray *arena, ups_key_t *dest,
+                    bool deep_copy = true) {
+      if (!(get_key_flags(slot + 1) & BtreeKey::kPrefixCompressed)) {
+        Base::get_key(context, slot + 1, arena, dest, deep_copy);
+        return;
+      }
+
+      size_t prefix_size = get_prefix_size();
+      size_t suffix_size = Base::get_key_size(slot + 1);
+      dest->size = (uint16_t)(prefix_size + suffix_size);
+
+      if (deep_copy == false || !(dest->flags & UPS_KEY_USER_ALLOC)) {
+        arena->resize(dest->size);
+        dest->data = arena->data();
+      }
+      ::memcpy(dest->data, get_prefix_data(), prefix_size);
+      ::memcpy((uint8_t *)dest->data + prefix_size,
+                      Base::get_key_data(slot + 1), suffix_size);
+    }
+
+    // Erases a key's payload. Does NOT remove the chunk from the UpfrontIndex
+    // (see |erase()|).
+    void erase_extended_key(Context *context, int slot) {
+      Base::erase_extended_key(context, slot + 1);
+    }
+
+    // Erases a key, including extended blobs
+    void erase(Context *context, size_t node_count, int slot) {
+      Base::erase(context, node_count + 1, slot + 1);
+    }
+
+    // Inserts the |key| at the position identified by |slot|. Only the
+    // suffix is stored if the key starts with the prefix of this node.
+    template<typename Cmp>
+    PBtreeNode::InsertResult insert(Context *context, size_t node_count,
+                                const ups_key_t *key, uint32_t flags,
+                                Cmp &comparator, int slot) {
+      size_t prefix_size = get_prefix_size();
+      if (prefix_size == 0 || !is_compressible(key)) {
+        Base::insert(context, node_count + 1, key, flags, comparator,
+                        slot + 1);
+        return (PBtreeNode::InsertResult(0, slot));
+      }
+
+      m_index.insert(node_count + 1, slot + 1);
+
+      // now there's one additional slot (plus the prefix)
+      node_count += 2;
+
+      size_t suffix_size = key->size - prefix_size;
+      if (m_index.can_allocate_space(node_count, suffix_size + 1)) {
+        uint32_t offset = m_index.allocate_space(node_count, slot + 1,
+                        suffix_size + 1);
+        uint8_t *p = m_index.get_chunk_data_by_offset(offset);
+        *p = BtreeKey::kPrefixCompressed;
+        ::memcpy(p + 1, (uint8_t *)key->data + prefix_size, suffix_size);
+        Globals::ms_bytes_before_compression += key->size;
+        Globals::ms_bytes_after_compression += suffix_size;
+      }
+      else {
+        uint64_t blob_id = add_extended_key(context, key);
+        m_index.allocate_space(node_count, slot + 1, 8 + 1);
+        set_extended_blob_id(slot + 1, blob_id);
+        set_key_flags(slot + 1, BtreeKey::kExtendedKey);
+      }
+
+      return (PBtreeNode::InsertResult(0, slot));
+    }
+
+    // Returns true if the |key| no longer fits into the node and a split
+    // is required.
+    bool requires_split(size_t node_count, const ups_key_t *key) {
+      return (Base::requires_split(node_count + 1, key));
+    }
+
+    // Performs a lower-bound search for a key. The search key is compared
+    // only once with the prefix; afterwards only the suffixes are compared.
+    template<typename Cmp>
+    int find_lower_bound(Context *context, size_t node_count,
+                    const ups_key_t *key, Cmp &comparator, int *pcmp) {
+      // compare the search key with the prefix: if the prefix is not
+      // a prefix of the search key then the key is either smaller or
+      // greater than all compressed keys
+      size_t prefix_size = get_prefix_size();
+      int prefix_cmp = 0;
+      if (prefix_size > 0) {
+        prefix_cmp = ::memcmp(key->data, get_prefix_data(),
+                        std::min((size_t)key->size, prefix_size));
+        if (prefix_cmp == 0 && key->size < prefix_size)
+          prefix_cmp = -1;
+        else if (prefix_cmp != 0)
+          prefix_cmp = prefix_cmp < 0 ? -1 : +1;
+      }
+
+      int right = (int)node_count;
+      int left = 0;
+      int last = right + 1;
+
+      *pcmp = -1;
+
+      while (right - left > 0) {
+        int middle = (left + right) / 2;
+
+        if (middle == last) {
+          *pcmp = 1;
+          return (middle);
+        }
+
+        *pcmp = compare(context, key, prefix_cmp, middle, comparator);
+
+        if (*pcmp == 0)
+          return (middle);
+
+        if (*pcmp < 0) {
+          if (right == 0) {
+            assert(middle == 0);
+            return (-1);
+          }
+          right = middle;
+        }
+        else {
+          last = middle;
+          left = middle;
+        }
+      }
+
+      return (-1);
+    }
+
+    // Searches the node for a key; returns -1 if the key was not found
+    template<typename Cmp>
+    int find(Context *context, size_t node_count, const ups_key_t *key,
+                    Cmp &comparator) {
+      int cmp = 0;
+      int slot = find_lower_bound(context, node_count, key, comparator, &cmp);
+      if (slot == -1 || cmp != 0)
+        return (-1);
+      return (slot);
+    }
+
+    // Copies |count| key from this[sstart] to dest[dstart]. The keys are
+    // re-encoded with the prefix of |dest|. If |dest| is empty (i.e. after
+    // a split) then it gets a new prefix.
+    void copy_to(int sstart, size_t node_count, PrefixKeyList &dest,
+                    size_t other_node_count, int dstart) {
+      size_t to_copy = node_count - sstart;
+      assert(to_copy > 0);
+
+      // make sure that the other node has sufficient capacity in its
+      // UpfrontIndex
+      dest.m_index.change_range_size(other_node_count + 1, 0, 0,
+                      m_index.get_capacity());
+
+      if (other_node_count == 0) {
+        uint8_t first[kMaxChunkSize];
+        uint8_t last[kMaxChunkSize];
+        size_t prefix_size = calculate_prefix(sstart, node_count,
+                        first, last);
+        if (prefix_size > 0
+              && dest.get_usable_size()
+                    < get_encoded_size(sstart, node_count, prefix_size))
+          dest.assign_prefix(get_prefix_data(), get_prefix_size());
+        else
+          dest.assign_prefix(first, prefix_size);
+      }
+
+      uint8_t buffer[kMaxChunkSize];
+      for (size_t i = 0; i < to_copy; i++) {
+        uint8_t flags = get_key_flags(sstart + i + 1);
+        size_t size;
+        const uint8_t *data;
+
+        // extended keys are copied as they are
+        if (flags & BtreeKey::kExtendedKey) {
+          size = Base::get_key_size(sstart + i + 1);
+          data = Base::get_key_data(sstart + i + 1);
+        }
+        else {
+          size = decode_key(sstart + i, buffer);
+          data = buffer;
+          flags = 0;
+          // then compress it again with the new prefix
+          size_t prefix_size = dest.get_prefix_size();
+          if (prefix_size > 0 && size >= prefix_size
+                && !::memcmp(data, dest.get_prefix_data(), prefix_size)) {
+            flags = BtreeKey::kPrefixCompressed;
+            data += prefix_size;
+            size -= prefix_size;
+          }
+        }
+
+        dest.m_index.insert(other_node_count + i + 1, dstart + i + 1);
+        // Add 1 byte for key flags
+        uint32_t offset = dest.m_index.allocate_space(other_node_count + i + 2,
+                        dstart + i + 1, size + 1);
+        uint8_t *p = dest.m_index.get_chunk_data_by_offset(offset);
+        *p = flags; // sets flags
+        ::memcpy(p + 1, data, size); // and data
+      }
+
+      // A lot of keys will be invalidated after copying, therefore make
+      // sure that the next_offset is recalculated when it's required
+      m_index.invalidate_next_offset();
+    }
+
+    // Checks the integrity of this node. Throws an exception if there is a
+    // violation.
+    void check_integrity(Context *context, size_t node_count) const {
+      Base::check_integrity(context, node_count + 1);
+
+      for (size_t i = 0; i < node_count; i++) {
+        uint8_t flags = get_key_flags(i + 1);
+        if ((flags & BtreeKey::kPrefixCompressed)
+              && (flags & (BtreeKey::kExtendedKey | BtreeKey::kCompressed))) {
+          ups_log(("integrity check failed: item %u has invalid flags 0x%x",
+                  (unsigned)i, (unsigned)flags));
+          throw Exception(UPS_INTEGRITY_VIOLATED);
+        }
+      }
+    }
+
+    // Rearranges the list; also recalculates the prefix
+    void vacuumize(size_t node_count, bool force) {
+      Base::vacuumize(node_count + 1, force);
+      update_prefix(node_count);
+    }
+
+    // Change the range size; the capacity will be adjusted, the data is
+    // copied as necessary
+    void change_range_size(size_t node_count, uint8_t *new_data_ptr,
+            size_t new_range_size, size_t capacity_hint) {
+      Base::change_range_size(node_count + 1, new_data_ptr, new_range_size,
+                      capacity_hint ? capacity_hint + 1 : 0);
+    }
+
+    // Fills the btree_metrics structure
+    void fill_metrics(btree_metrics_t *metrics, size_t node_count) {
+      Base::fill_metrics(metrics, node_count + 1);
+    }
+
+    // Prints a slot to |out| (for debugging)
+    void print(Context *context, int slot, std::stringstream &out) {
+      ByteArray arena;
+      ups_key_t tmp = {0};
+      get_key(context, slot, &arena, &tmp, false);
+      out << std::string((const char *)tmp.data, tmp.size);
+    }
+
+    // Returns the size of the prefix
+    size_t get_prefix_size() const {
+      return (m_index.get_chunk_size(0) - 1);
+    }
+
+    // Returns a pointer to the prefix
+    uint8_t *get_prefix_data() const {
+      return (m_index.get_chunk_data_by_offset(m_index.get_chunk_offset(0))
+                      + 1);
+    }
+
+  private:
+    // Compares |key| with the key at |slot|; |prefix_cmp| is the result of
+    // the comparison of |key| and the prefix
+    template<typename Cmp>
+    int compare(Context *context, const ups_key_t *key, int prefix_cmp,
+                    int slot, Cmp &comparator) {
+      if (Cmp::kIsMemcmpOrder
+            && (get_key_flags(slot + 1) & BtreeKey::kPrefixCompressed)) {
+        if (prefix_cmp != 0)
+          return (prefix_cmp);
+        size_t prefix_size = get_prefix_size();
+        return (comparator((uint8_t *)key->data + prefix_size,
+                                key->size - prefix_size,
+                                Base::get_key_data(slot + 1),
+                                Base::get_key_size(slot + 1)));
+      }
+
+      ups_key_t tmp = {0};
+      get_key(context, slot, &m_arena, &tmp, false);
+      return (comparator(key->data, key->size, tmp.data, tmp.size));
+    }
+
+    // Returns true if |key| can be stored with the current prefix
+    bool is_compressible(const ups_key_t *key) const {
+      size_t prefix_size = get_prefix_size();
+      return (key->size >= prefix_size
+                && key->size <= m_extkey_threshold
+                && !::memcmp(key->data, get_prefix_data(), prefix_size));
+    }
+
+    // Copies the (uncompressed) inline key at |slot| to |buffer|; returns
+    // the key size
+    size_t decode_key(int slot, uint8_t *buffer) const {
+      size_t size = Base::get_key_size(slot + 1);
+      size_t prefix_size = 0;
+      if (get_key_flags(slot + 1) & BtreeKey::kPrefixCompressed) {
+        prefix_size = get_prefix_size();
+        ::memcpy(buffer, get_prefix_data(), prefix_size);
+      }
+      assert(prefix_size + size <= kMaxChunkSize);
+      ::memcpy(buffer + prefix_size, Base::get_key_data(slot + 1), size);
+      return (prefix_size + size);
+    }
+
+    // Calculates the common prefix of the inline keys in [start, end); the
+    // prefix is copied to |first|. All inline keys are sorted, therefore
+    // the common prefix of the first and the last one is shared by all
+    // keys in between.
+    size_t calculate_prefix(int start, int end, uint8_t *first,
+                    uint8_t *last) const {
+      while (start < end
+              && (get_key_flags(start + 1) & BtreeKey::kExtendedKey))
+        start++;
+      while (end > start
+              && (get_key_flags(end) & BtreeKey::kExtendedKey))
+        end--;
+      if (end - start < 2)
+        return (0);
+
+      size_t first_size = decode_key(start, first);
+      size_t last_size = decode_key(end - 1, last);
+      size_t max = std::min(first_size, last_size);
+      size_t prefix_size = 0;
+      while (prefix_size < max && first[prefix_size] == last[prefix_size])
+        prefix_size++;
+      return (prefix_size);
+    }
+
+    // Returns the number of bytes required for storing the keys in
+    // [start, end) with a prefix of |prefix_size| bytes (which is shared
+    // by all inline keys)
+    size_t get_encoded_size(int start, int end, size_t prefix_size) const {
+      size_t required = prefix_size + 1;
+      for (int i = start; i < end; i++) {
+        size_t size = Base::get_key_size(i + 1);
+        uint8_t flags = get_key_flags(i + 1);
+        if (!(flags & BtreeKey::kExtendedKey)) {
+          if (flags & BtreeKey::kPrefixCompressed)
+            size += get_prefix_size();
+          size -= prefix_size;
+        }
+        required += size + 1;
+      }
+      return (required);
+    }
+
+    // Returns the number of bytes that can be used for the chunks
+    size_t get_usable_size() const {
+      return (m_range_size - UpfrontIndex::kPayloadOffset
+                      - m_index.get_capacity() * m_index.get_full_index_size());
+    }
+
+    // Resets the (empty) UpfrontIndex and stores a new prefix in the
+    // first chunk
+    void assign_prefix(const uint8_t *prefix, size_t prefix_size) {
+      assert(prefix_size + 1 <= kMaxChunkSize);
+      m_index.create(m_data, m_range_size, m_index.get_capacity());
+      m_index.insert(0, 0);
+      uint32_t offset = m_index.allocate_space(1, 0, prefix_size + 1);
+      uint8_t *p = m_index.get_chunk_data_by_offset(offset);
+      *p = 0;
+      if (prefix_size)
+        ::memcpy(p + 1, prefix, prefix_size);
+    }
+
+    // Recalculates the prefix and re-encodes all keys if the prefix
+    // changed. Does nothing if the re-encoded keys would not fit.
+    void update_prefix(size_t node_count) {
+      uint8_t first[kMaxChunkSize];
+      uint8_t last[kMaxChunkSize];
+      size_t prefix_size = calculate_prefix(0, (int)node_count, first, last);
+      if (prefix_size == get_prefix_size()
+            && !::memcmp(first, get_prefix_data(), prefix_size))
+        return;
+
+      size_t required = get_encoded_size(0, (int)node_count, prefix_size);
+      if (required > get_usable_size())
+        return;
+
+      // encode all keys in a temporary buffer
+      m_arena.resize(required);
+      uint8_t *p = m_arena.data();
+      uint8_t *chunk_sizes = (uint8_t *)::alloca(node_count + 1);
+      uint8_t buffer[kMaxChunkSize];
+      for (size_t i = 0; i < node_count; i++) {
+        uint8_t flags = get_key_flags(i + 1);
+        if (flags & BtreeKey::kExtendedKey) {
+          size_t size = Base::get_key_size(i + 1);
+          *p = flags;
+          ::memcpy(p + 1, Base::get_key_data(i + 1), size);
+          chunk_sizes[i] = (uint8_t)(size + 1);
+        }
+        else {
+          size_t size = decode_key(i, buffer) - prefix_size;
+          *p = prefix_size > 0 ? BtreeKey::kPrefixCompressed : 0;
+          ::memcpy(p + 1, buffer + prefix_size, size);
+          chunk_sizes[i] = (uint8_t)(size + 1);
+        }
+        p += chunk_sizes[i];
+      }
+
+      // then rewrite the whole index
+      assign_prefix(first, prefix_size);
+      p = m_arena.data();
+      for (size_t i = 0; i < node_count; i++) {
+        m_index.insert(i + 1, i + 1);
+        uint32_t offset = m_index.allocate_space(i + 2, i + 1, chunk_sizes[i]);
+        ::memcpy(m_index.get_chunk_data_by_offset(offset), p, chunk_sizes[i]);
+        p += chunk_sizes[i];
+      }
+    }
+
+    // A memory arena for comparisons and for re-encoding the keys
+    ByteArray m_arena;
+};
+
+} // namespace DefLayout
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_KEYS_PREFIX_H */
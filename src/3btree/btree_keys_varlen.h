@@ -102,7 +102,8 @@ class VariableLengthKeyList : public BaseKeyList
       : m_db(db), m_index(db), m_data(0) {
       size_t page_size = db->lenv()->config().page_size_bytes;
       int algo = m_db->config().key_compressor;
-      if (algo)
+      // prefix compression is implemented by the PrefixKeyList
+      if (algo && algo != UPS_COMPRESSOR_PREFIX)
         m_compressor.reset(CompressorFactory::create(algo));
       if (Globals::ms_extended_threshold)
         m_extkey_threshold = Globals::ms_extended_threshold;
@@ -421,7 +422,7 @@ class VariableLengthKeyList : public BaseKeyList
       return (m_index.get_chunk_size(slot) - 1);
     }
 
-  private:
+  protected:
     // Returns the flags of a key. Flags are defined in btree_flags.h
     uint8_t get_key_flags(int slot) const {
       uint32_t offset = m_index.get_chunk_offset(slot);
@@ -32,6 +32,7 @@
 #include "1base/error.h"
 #include "2page/page.h"
 #include "3btree/btree_node.h"
+#include "3btree/btree_fence_index.h"
 #include "3blob_manager/blob_manager.h"
 #include "4env/env_local.h"
 #include "4db/db_local.h"
@@ -251,6 +252,9 @@ struct BtreeNodeProxy
 //
 struct CallbackCompare
 {
+  // The keys are not sorted like memcmp(3)
+  enum { kIsMemcmpOrder = 0 };
+
   CallbackCompare(LocalDatabase *db_)
     : db(db_) {
   }
@@ -272,6 +276,9 @@ struct CallbackCompare
 template<typename T>
 struct NumericCompare
 {
+  // The keys are not sorted like memcmp(3)
+  enum { kIsMemcmpOrder = 0 };
+
   NumericCompare(LocalDatabase *) {
   }
 
@@ -291,6 +298,9 @@ struct NumericCompare
 //
 struct FixedSizeCompare
 {
+  // The keys are sorted like memcmp(3); see btree_fence_index.h
+  enum { kIsMemcmpOrder = 1 };
+
   FixedSizeCompare(LocalDatabase *) {
   }
 
@@ -308,6 +318,9 @@ struct FixedSizeCompare
 //
 struct VariableSizeCompare
 {
+  // The keys are sorted like memcmp(3); see btree_fence_index.h
+  enum { kIsMemcmpOrder = 1 };
+
   VariableSizeCompare(LocalDatabase *) {
   }
 
@@ -388,6 +401,9 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
       return -1;
     }
     Comparator cmp(page->db());
+    if (use_fence_index())
+      return find_lower_bound_fenced(context, key, cmp, precord_id,
+                            pcmp ? pcmp : &dummy);
     return impl.find_lower_bound(context, key, cmp, precord_id ? precord_id : 0,
                             pcmp ? pcmp : &dummy);
   }
@@ -456,6 +472,7 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
   // and |erase_record| on each record that is associated with the key.
   virtual void erase(Context *context, int slot) {
     assert(slot < (int)length());
+    fence_index.invalidate();
     impl.erase(context, slot);
     set_length(length() - 1);
   }
@@ -498,6 +515,8 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
       return result;
     }
 
+    fence_index.invalidate();
+
     Comparator cmp(page->db());
     try {
       result = impl.insert(context, key, flags, cmp);
@@ -538,6 +557,8 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
     ClassType *other = dynamic_cast<ClassType *>(other_node);
     assert(other != 0);
 
+    fence_index.invalidate();
+    other->fence_index.invalidate();
     impl.split(context, &other->impl, pivot);
 
     uint32_t old_length = length();
@@ -554,6 +575,8 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
     ClassType *other = dynamic_cast<ClassType *>(other_node);
     assert(other != 0);
 
+    fence_index.invalidate();
+    other->fence_index.invalidate();
     impl.merge_from(context, &other->impl);
 
     set_length(length() + other->length());
@@ -584,7 +607,61 @@ struct BtreeNodeProxyImpl : public BtreeNodeProxy
     return get_classname(*this);
   }
 
+  // Returns true if lookups in this node use the BtreeFenceIndex: only
+  // for internal nodes with binary keys which are large enough
+  bool use_fence_index() const {
+    return Comparator::kIsMemcmpOrder
+            && !is_leaf()
+            && length() >= BtreeFenceIndex::kMinimumLength;
+  }
+
+  // Implementation of find_lower_bound() with the BtreeFenceIndex; the
+  // index is rebuilt if the node was modified. Returns the same results
+  // as BaseNodeImpl::find_lower_bound().
+  int find_lower_bound_fenced(Context *context, ups_key_t *key,
+                  Comparator &cmp, uint64_t *precord_id, int *pcmp) {
+    uint32_t node_length = length();
+    if (!fence_index.is_up_to_date(node_length))
+      fence_index.rebuild(context, impl, node_length);
+
+    // only the keys in [left, right[ can be equal to |key|
+    int left, right;
+    fence_index.narrow(key, &left, &right);
+
+    // the lower bound is the last key which is <= |key|
+    int slot = -1;
+    *pcmp = -1;
+    while (left < right) {
+      int middle = (left + right) / 2;
+      int c = impl.compare(context, key, middle, cmp);
+      if (c == 0) {
+        slot = middle;
+        *pcmp = 0;
+        break;
+      }
+      if (c < 0)
+        right = middle;
+      else
+        left = middle + 1;
+    }
+    if (*pcmp != 0 && left > 0) {
+      slot = left - 1;
+      *pcmp = 1;
+    }
+
+    if (precord_id) {
+      if (slot == -1)
+        *precord_id = left_child();
+      else
+        *precord_id = impl.record_id(context, slot);
+    }
+    return slot;
+  }
+
   NodeImpl impl;
+
+  // Accelerates lookups in internal nodes
+  BtreeFenceIndex fence_index;
 };
 
 } // namespace upscaledb
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include "0root/root.h"
+
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "3page_manager/page_manager.h"
+#include "3btree/btree_index.h"
+#include "3btree/btree_node_proxy.h"
+#include "3btree/btree_readahead.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+void
+BtreeReadahead::advance(Context *context, BtreeIndex *btree, uint64_t from,
+                Page *page, bool forward_, bool sequential)
+{
+  LocalEnvironment *env = btree->db()->lenv();
+  const EnvConfig &config = env->config();
+  if (config.scan_readahead == 0 || ISSET(config.flags, UPS_IN_MEMORY))
+    return;
+
+  uint64_t address = page->address();
+  if (from != 0 && from == last_leaf && forward_ == forward)
+    run++;
+  else {
+    run = 1;
+    failed = false;
+    window.clear();
+    position = issued = 0;
+  }
+  last_leaf = address;
+  forward = forward_;
+
+  PageManager *page_manager = env->page_manager();
+  BtreeNodeProxy *node = btree->get_node_from_page(page);
+
+  // not (yet) sequential? then only read the adjacent leaf ahead
+  if (failed || (!sequential && run < kSequentialThreshold)) {
+    uint64_t sibling = forward ? node->right_sibling() : node->left_sibling();
+    if (sibling)
+      page_manager->prefetch(sibling);
+    return;
+  }
+
+  // find the current leaf in the window; leafs which were skipped by the
+  // scan (i.e. because they are empty) are removed
+  std::vector<uint64_t>::iterator it = std::find(window.begin() + position,
+                  window.end(), address);
+  if (it != window.end())
+    position = (it - window.begin()) + 1;
+  else if (!fill_window(context, btree, page)) {
+    failed = true;
+    uint64_t sibling = forward ? node->right_sibling() : node->left_sibling();
+    if (sibling)
+      page_manager->prefetch(sibling);
+    return;
+  }
+
+  if (window.size() - position < config.scan_readahead)
+    extend_window(context, btree);
+
+  issued = std::max(issued, position);
+  while (issued < window.size()
+          && issued < position + config.scan_readahead)
+    page_manager->prefetch(window[issued++]);
+}
+
+bool
+BtreeReadahead::fill_window(Context *context, BtreeIndex *btree, Page *page)
+{
+  window.clear();
+  position = issued = 0;
+  next_parent = 0;
+
+  BtreeNodeProxy *node = btree->get_node_from_page(page);
+  if (node->length() == 0)
+    return false;
+
+  // descend from the root with the first key of the leaf; the internal
+  // node which points to the leaf is its parent
+  ups_key_t key = {0};
+  node->key(context, 0, &arena, &key);
+
+  PageManager *page_manager = btree->db()->lenv()->page_manager();
+  uint64_t address = btree->root_address();
+  while (address != page->address()) {
+    Page *p = page_manager->fetch(context, address, PageManager::kReadOnly);
+    BtreeNodeProxy *n = btree->get_node_from_page(p);
+    if (n->is_leaf())
+      return false;
+
+    uint64_t child;
+    n->find_lower_bound(context, &key, &child);
+    if (child == page->address()) {
+      next_parent = forward ? n->right_sibling() : n->left_sibling();
+      return append_children(context, btree, address, child);
+    }
+    address = child;
+  }
+  return false;
+}
+
+void
+BtreeReadahead::extend_window(Context *context, BtreeIndex *btree)
+{
+  if (next_parent == 0)
+    return;
+
+  // remove the leafs which were already visited
+  window.erase(window.begin(), window.begin() + position);
+  issued -= std::min(issued, position);
+  position = 0;
+
+  PageManager *page_manager = btree->db()->lenv()->page_manager();
+  Page *p = page_manager->fetch(context, next_parent,
+                  PageManager::kReadOnly);
+  BtreeNodeProxy *n = btree->get_node_from_page(p);
+  append_children(context, btree, next_parent, 0);
+  next_parent = forward ? n->right_sibling() : n->left_sibling();
+}
+
+bool
+BtreeReadahead::append_children(Context *context, BtreeIndex *btree,
+                uint64_t address, uint64_t after)
+{
+  PageManager *page_manager = btree->db()->lenv()->page_manager();
+  Page *p = page_manager->fetch(context, address, PageManager::kReadOnly);
+  BtreeNodeProxy *n = btree->get_node_from_page(p);
+
+  std::vector<uint64_t> children;
+  children.reserve(n->length() + 1);
+  children.push_back(n->left_child());
+  for (size_t s = 0; s < n->length(); s++)
+    children.push_back(n->record_id(context, s));
+  if (!forward)
+    std::reverse(children.begin(), children.end());
+
+  std::vector<uint64_t>::iterator it = children.begin();
+  if (after != 0) {
+    it = std::find(children.begin(), children.end(), after);
+    if (it == children.end())
+      return false;
+    it++;
+  }
+  window.insert(window.end(), it, children.end());
+  return true;
+}
+
+} // namespace upscaledb
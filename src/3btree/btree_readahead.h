@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Read-ahead of Btree leafs for sequential scans.
+ *
+ * A scan is sequential if it moves from a leaf to its sibling several
+ * times in a row, in the same direction. The leafs only know their
+ * immediate siblings; therefore the addresses of the following leafs are
+ * taken from the parent node (and the siblings of the parent node), and
+ * up to UPS_PARAM_SCAN_READAHEAD of them are passed to
+ * PageManager::prefetch(). Scans which are not (yet) sequential only read
+ * the adjacent leaf ahead.
+ *
+ * @exception_safe: basic
+ * @thread_safe: no
+ */
+
+#ifndef UPS_BTREE_READAHEAD_H
+#define UPS_BTREE_READAHEAD_H
+
+#include "0root/root.h"
+
+#include <vector>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct Context;
+struct BtreeIndex;
+class Page;
+
+struct BtreeReadahead
+{
+  enum {
+    // the number of consecutive moves to a sibling after which a scan
+    // is considered sequential
+    kSequentialThreshold = 2
+  };
+
+  // Constructor
+  BtreeReadahead()
+    : last_leaf(0), run(0), forward(true), failed(false), position(0),
+      issued(0), next_parent(0) {
+  }
+
+  // Called after a scan moved from the leaf at |from| to its sibling
+  // |page| (to the right if |forward| is true). If |sequential| is true
+  // then the caller knows that the scan is sequential (i.e. a UQI query).
+  void advance(Context *context, BtreeIndex *btree, uint64_t from,
+                  Page *page, bool forward, bool sequential = false);
+
+ private:
+  // Fills |window| with the leafs which follow |page|, taken from its
+  // parent. Returns false if the parent was not found.
+  bool fill_window(Context *context, BtreeIndex *btree, Page *page);
+
+  // Appends the leafs of the next parent node to |window|
+  void extend_window(Context *context, BtreeIndex *btree);
+
+  // Appends the children of the internal node at |address| to |window|,
+  // starting after the child |after| (or with the first child if |after|
+  // is 0). Returns false if |after| is not a child of this node.
+  bool append_children(Context *context, BtreeIndex *btree,
+                  uint64_t address, uint64_t after);
+
+  // the leaf which was visited last
+  uint64_t last_leaf;
+
+  // the number of consecutive moves to a sibling
+  size_t run;
+
+  // the direction of the scan
+  bool forward;
+
+  // true if the parent of a leaf was not found; then only the adjacent
+  // leaf is read ahead
+  bool failed;
+
+  // the addresses of the next leafs, in the order of the scan
+  std::vector<uint64_t> window;
+
+  // the index of the next leaf in |window| which is not yet visited
+  size_t position;
+
+  // the number of leafs in |window| which were already read ahead
+  size_t issued;
+
+  // the next parent node whose children are appended to |window|
+  uint64_t next_parent;
+
+  // the first key of a leaf, used to descend to its parent
+  ByteArray arena;
+};
+
+} // namespace upscaledb
+
+#endif // UPS_BTREE_READAHEAD_H
@@ -0,0 +1,709 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * RecordList for compressed numeric records (UPS_COMPRESSOR_NUMERIC)
+ *
+ * The records are stored in the leaf node in blocks of up to 64 records.
+ * Each block bit-packs its records relative to a reference value:
+ *
+ *   |count (1 byte)|width (1 byte)|shift (1 byte)|reference (sizeof(T))|
+ *   |64bit words with the packed values|
+ *
+ * Integer records are stored as the difference to the smallest record of
+ * the block (frame of reference). Floating point records are stored as the
+ * XOR of their bit pattern and the bit pattern of the block's first record
+ * (like Gorilla), which removes the shared sign, exponent and high mantissa
+ * bits. In both cases trailing zero bits which are shared by all values
+ * (|shift|) are stripped before the values are packed with |width| bits.
+ *
+ * The blocks are stored back to back, after a header with the used size:
+ *
+ *   |used size (4 bytes)|block 1|block 2|...|
+ *
+ * Erasing a record never grows a block because the remaining records are
+ * still representable with the parameters of the block. A new slot is
+ * initialized with a copy of its neighbour, which therefore also fits
+ * the block. Only set_record() can grow a block beyond a few bytes; if
+ * the node runs out of space then it throws UPS_LIMITS_REACHED, and the
+ * caller splits the node.
+ */
+
+#ifndef UPS_BTREE_RECORDS_NUMERIC_H
+#define UPS_BTREE_RECORDS_NUMERIC_H
+
+#include "0root/root.h"
+
+#include <string.h>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+#include "3btree/btree_records_base.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+namespace DefLayout {
+
+//
+// Converts integer records to differences from the block's smallest record
+//
+template<typename T>
+struct NumericRecordCodec
+{
+  // Returns the reference value of a block
+  static T reference(const T *data, size_t count) {
+    return *std::min_element(data, data + count);
+  }
+
+  // Returns the value which is packed; wraps around if |value| is
+  // smaller than |ref|
+  static uint64_t encode(T value, T ref) {
+    return (uint64_t)(T)(value - ref);
+  }
+
+  // Restores a record
+  static T decode(uint64_t value, T ref) {
+    return (T)(ref + (T)value);
+  }
+};
+
+//
+// Converts floating point records to the XOR with the block's first record
+//
+template<typename T, typename U>
+struct XorRecordCodec
+{
+  // Returns the reference value of a block
+  static T reference(const T *data, size_t) {
+    return data[0];
+  }
+
+  // Returns the value which is packed
+  static uint64_t encode(T value, T ref) {
+    U v, r;
+    ::memcpy(&v, &value, sizeof(v));
+    ::memcpy(&r, &ref, sizeof(r));
+    return (uint64_t)(v ^ r);
+  }
+
+  // Restores a record
+  static T decode(uint64_t value, T ref) {
+    U r;
+    ::memcpy(&r, &ref, sizeof(r));
+    U v = (U)value ^ r;
+    T t;
+    ::memcpy(&t, &v, sizeof(t));
+    return t;
+  }
+};
+
+template<>
+struct NumericRecordCodec<float> : public XorRecordCodec<float, uint32_t>
+{
+};
+
+template<>
+struct NumericRecordCodec<double> : public XorRecordCodec<double, uint64_t>
+{
+};
+
+template<typename T>
+struct NumericRecordList : public BaseRecordList
+{
+  typedef NumericRecordCodec<T> Codec;
+
+  enum {
+    // A flag whether this RecordList has sequential data
+    kHasSequentialData = 0,
+
+    // This RecordList implements the scan() method
+    kSupportsBlockScans = 1,
+
+    // The maximum number of records in a block
+    kMaxRecordsPerBlock = 64,
+
+    // The size of the header of the range (stores the used size)
+    kRangeHeaderSize = 4,
+
+    // The size of the header of each block
+    kBlockHeaderSize = 3 + sizeof(T),
+
+    // The maximum size of a block
+    kMaxBlockSize = kBlockHeaderSize + kMaxRecordsPerBlock * sizeof(T),
+
+    // Space which is kept free for splitting a block in copy_to()
+    kSplitReserve = kBlockHeaderSize + 8,
+
+    // Space which is required to insert a record and then overwrite it
+    // with an arbitrary value: the insert can split a block (one additional
+    // header and two partially filled words), set_record() can grow a block
+    // to its uncompressed size
+    kHeadroom = kBlockHeaderSize + 16 + kMaxBlockSize + kSplitReserve,
+  };
+
+  // The encoding parameters of a block
+  struct BlockParams {
+    // the reference value
+    T ref;
+
+    // the number of bits per value
+    uint32_t width;
+
+    // the number of stripped trailing zero bits
+    uint32_t shift;
+  };
+
+  // Constructor
+  NumericRecordList(LocalDatabase *, PBtreeNode *)
+    : m_data(0), m_count(0) {
+  }
+
+  // Sets the data pointer
+  void create(uint8_t *ptr, size_t range_size) {
+    m_data = ptr;
+    m_range_size = range_size;
+    m_count = 0;
+    set_used_size(kRangeHeaderSize);
+  }
+
+  // Opens an existing RecordList
+  void open(uint8_t *ptr, size_t range_size, size_t node_count) {
+    m_data = ptr;
+    m_range_size = range_size;
+    m_count = node_count;
+  }
+
+  // Returns the average size of a record including overhead; used by the
+  // node to distribute the available space between keys and records
+  size_t full_record_size() const {
+    if (!m_data || m_count < kMaxRecordsPerBlock)
+      return sizeof(T);
+    size_t size = (used_size() - kRangeHeaderSize + m_count - 1) / m_count;
+    return size > 0 ? size : 1;
+  }
+
+  // Calculates the required size for the current records, including the
+  // space for inserting another record
+  size_t required_range_size(size_t node_count) const {
+    return used_size() + kHeadroom;
+  }
+
+  // Returns the record counter of a key
+  // This record list does not support duplicates, therefore always return 1
+  int record_count(Context *, int) const {
+    return 1;
+  }
+
+  // Returns the record size
+  uint32_t record_size(Context *, int, int = 0) const {
+    return sizeof(T);
+  }
+
+  // Returns the full record and stores it in |dest|. The record is
+  // decompressed, therefore UPS_DIRECT_ACCESS also uses the |arena|.
+  void record(Context *, int slot, ByteArray *arena, ups_record_t *record,
+                  uint32_t flags, int) const {
+    T value = value_at(slot);
+    record->size = sizeof(T);
+
+    if (NOTSET(record->flags, UPS_RECORD_USER_ALLOC)) {
+      arena->resize(record->size);
+      record->data = arena->data();
+    }
+
+    ::memcpy(record->data, &value, sizeof(T));
+  }
+
+  // Updates the record of a key
+  void set_record(Context *, int slot, int, ups_record_t *record,
+                  uint32_t flags, uint32_t * = 0) {
+    assert(record->size == sizeof(T));
+    T value;
+    ::memcpy(&value, record->data, sizeof(T));
+
+    int first;
+    uint8_t *block = find_block(slot, &first);
+    BlockParams params;
+    read_params(block, &params);
+
+    // fast path: the value fits into the block
+    if (fits(params, value)) {
+      store(block + kBlockHeaderSize, params.width, slot - first,
+                      Codec::encode(value, params.ref) >> params.shift);
+      return;
+    }
+
+    // otherwise the block has to be encoded with different parameters
+    T values[kMaxRecordsPerBlock];
+    size_t count = decode_block(block, values);
+    values[slot - first] = value;
+
+    uint8_t buffer[kMaxBlockSize + 8];
+    size_t old_size = block_size(block);
+    size_t new_size = encode_block(buffer, values, count, 0);
+    if (used_size() - old_size + new_size + kSplitReserve > m_range_size)
+      throw Exception(UPS_LIMITS_REACHED);
+    replace(block, old_size, buffer, new_size);
+  }
+
+  // Erases the record. The record is removed immediately afterwards with
+  // erase(); nulling it would only grow the block.
+  void erase_record(Context *, int, int = 0, bool = true) {
+  }
+
+  // Erases a whole slot
+  void erase(Context *, size_t node_count, int slot) {
+    int first;
+    uint8_t *block = find_block(slot, &first);
+    BlockParams params;
+    read_params(block, &params);
+
+    T values[kMaxRecordsPerBlock];
+    size_t count = decode_block(block, values);
+    std::copy(&values[slot - first + 1], &values[count],
+                    &values[slot - first]);
+    count--;
+
+    // the last record of the block? then remove the whole block
+    uint8_t buffer[kMaxBlockSize + 8];
+    size_t new_size = 0;
+    if (count > 0)
+      new_size = encode_block(buffer, values, count, &params);
+    replace(block, block_size(block), buffer, new_size);
+    m_count = node_count - 1;
+  }
+
+  // Creates space for one additional record
+  void insert(Context *, size_t node_count, int slot) {
+    m_count = node_count + 1;
+
+    // the first record: create a new block
+    if (node_count == 0) {
+      T value = 0;
+      uint8_t buffer[kMaxBlockSize + 8];
+      size_t new_size = encode_block(buffer, &value, 1, 0);
+      replace(m_data + used_size(), 0, buffer, new_size);
+      return;
+    }
+
+    // appended records are stored in the last block
+    int first;
+    uint8_t *block = find_block(slot < (int)node_count
+                                    ? slot
+                                    : (int)node_count - 1, &first);
+    BlockParams params;
+    read_params(block, &params);
+
+    T values[kMaxRecordsPerBlock + 1];
+    size_t count = decode_block(block, values);
+    int pos = slot - first;
+    T copy = values[pos > 0 ? pos - 1 : 0];
+    std::copy_backward(&values[pos], &values[count], &values[count + 1]);
+    values[pos] = copy;
+    count++;
+
+    // split the block if it overflows
+    uint8_t buffer[2 * (kMaxBlockSize + 8)];
+    size_t new_size;
+    if (count <= kMaxRecordsPerBlock)
+      new_size = encode_block(buffer, values, count, &params);
+    else {
+      size_t left = count / 2;
+      new_size = encode_block(buffer, values, left, &params);
+      new_size += encode_block(buffer + new_size, &values[left],
+                      count - left, &params);
+    }
+    replace(block, block_size(block), buffer, new_size);
+  }
+
+  // Copies |count| records from this[sstart] to dest[dstart]; the records
+  // are always appended to |dest|. Blocks are copied without decoding them,
+  // only the block at |sstart| is split in two.
+  void copy_to(int sstart, size_t node_count, NumericRecordList<T> &dest,
+                  size_t other_count, int dstart) {
+    assert(dstart == (int)other_count);
+    if (sstart == (int)node_count)
+      return;
+
+    int first;
+    uint8_t *block = find_block(sstart, &first);
+
+    // split the block
+    if (sstart > first) {
+      BlockParams params;
+      read_params(block, &params);
+
+      T values[kMaxRecordsPerBlock];
+      size_t count = decode_block(block, values);
+      size_t left = sstart - first;
+
+      uint8_t buffer[kMaxBlockSize + 8];
+      size_t size = encode_block(buffer, &values[left], count - left,
+                      &params);
+      dest.append(buffer, size);
+
+      size_t old_size = block_size(block);
+      size = encode_block(buffer, values, left, &params);
+      uint8_t *next = block + old_size;
+      uint8_t *end = m_data + used_size();
+      dest.append(next, end - next);
+      replace(block, end - block, buffer, size);
+    }
+    else {
+      uint8_t *end = m_data + used_size();
+      dest.append(block, end - block);
+      set_used_size(block - m_data);
+    }
+
+    dest.m_count = other_count + node_count - sstart;
+    m_count = sstart;
+  }
+
+  // Returns true if there's not enough space for another record
+  bool requires_split(size_t node_count) const {
+    return used_size() + kHeadroom > m_range_size;
+  }
+
+  // Rearranges the list; merges partially filled blocks (i.e. after a
+  // split or after records were erased). The new layout is only used if
+  // it requires less space.
+  void vacuumize(size_t node_count, bool force) {
+    if (node_count == 0) {
+      set_used_size(kRangeHeaderSize);
+      return;
+    }
+
+    ByteArray values_arena;
+    const T *values = (const T *)decode_all(&values_arena, node_count, 0);
+
+    ByteArray arena(used_size());
+    size_t size = kRangeHeaderSize;
+    uint8_t buffer[kMaxBlockSize + 8];
+    for (size_t i = 0; i < node_count; i += kMaxRecordsPerBlock) {
+      size_t count = std::min((size_t)kMaxRecordsPerBlock, node_count - i);
+      size_t block_size = encode_block(buffer, &values[i], count, 0);
+      if (size + block_size >= used_size())
+        return;
+      ::memcpy(arena.data() + size, buffer, block_size);
+      size += block_size;
+    }
+
+    ::memcpy(m_data + kRangeHeaderSize, arena.data() + kRangeHeaderSize,
+                    size - kRangeHeaderSize);
+    set_used_size(size);
+  }
+
+  // Change the capacity; moves the blocks to the new location
+  void change_range_size(size_t node_count, uint8_t *new_data_ptr,
+                  size_t new_range_size, size_t capacity_hint) {
+    assert(used_size() <= new_range_size);
+    ::memmove(new_data_ptr, m_data, used_size());
+    m_data = new_data_ptr;
+    m_range_size = new_range_size;
+  }
+
+  // Iterates all records; decodes them to a contiguous array
+  ScanResult scan(ByteArray *arena, size_t node_count, uint32_t start) {
+    const uint8_t *p = decode_all(arena, node_count, start);
+    return std::make_pair(p, node_count - start);
+  }
+
+  // Checks the integrity of this node. Throws an exception if there is a
+  // violation.
+  void check_integrity(Context *, size_t node_count) const {
+    size_t used = used_size();
+    if (used > m_range_size) {
+      ups_log(("used size %d exceeds range size %d",
+              (int)used, (int)m_range_size));
+      throw Exception(UPS_INTEGRITY_VIOLATED);
+    }
+
+    size_t total = 0;
+    const uint8_t *p = m_data + kRangeHeaderSize;
+    const uint8_t *end = m_data + used;
+    while (p < end) {
+      if (p[0] == 0 || p[0] > kMaxRecordsPerBlock
+          || p[1] + p[2] > (int)sizeof(T) * 8) {
+        ups_log(("invalid block header (count %d, width %d, shift %d)",
+                (int)p[0], (int)p[1], (int)p[2]));
+        throw Exception(UPS_INTEGRITY_VIOLATED);
+      }
+      total += p[0];
+      p += block_size(p);
+    }
+
+    if (p != end || total != node_count) {
+      ups_log(("blocks store %d records, expected %d",
+              (int)total, (int)node_count));
+      throw Exception(UPS_INTEGRITY_VIOLATED);
+    }
+  }
+
+  // Fills the btree_metrics structure
+  void fill_metrics(btree_metrics_t *metrics, size_t node_count) {
+    BaseRecordList::fill_metrics(metrics, node_count);
+    BtreeStatistics::update_min_max_avg(&metrics->recordlist_unused,
+                        m_range_size - used_size());
+  }
+
+  // Prints a slot to |out| (for debugging)
+  void print(Context *context, int slot, std::stringstream &out) const {
+    out << value_at(slot);
+  }
+
+  // Returns the used size of the range
+  size_t used_size() const {
+    uint32_t size;
+    ::memcpy(&size, m_data, sizeof(size));
+    return size;
+  }
+
+  // Sets the used size of the range
+  void set_used_size(size_t size) {
+    uint32_t s = (uint32_t)size;
+    ::memcpy(m_data, &s, sizeof(s));
+  }
+
+  // Returns the record at |slot|
+  T value_at(int slot) const {
+    int first;
+    const uint8_t *block = find_block(slot, &first);
+    BlockParams params;
+    read_params(block, &params);
+    return Codec::decode(load(block + kBlockHeaderSize, params.width,
+                            slot - first) << params.shift, params.ref);
+  }
+
+  // Returns the block which stores |slot|; |*first| receives the slot of
+  // the block's first record
+  uint8_t *find_block(int slot, int *first) const {
+    uint8_t *p = m_data + kRangeHeaderSize;
+    int f = 0;
+    while (slot >= f + p[0]) {
+      f += p[0];
+      p += block_size(p);
+      assert(p < m_data + used_size());
+    }
+    *first = f;
+    return p;
+  }
+
+  // Appends raw blocks to the end of the range
+  void append(const uint8_t *blocks, size_t size) {
+    size_t used = used_size();
+    assert(used + size <= m_range_size);
+    ::memcpy(m_data + used, blocks, size);
+    set_used_size(used + size);
+  }
+
+  // Replaces |old_size| bytes at |p| with the |new_size| bytes of |buffer|
+  void replace(uint8_t *p, size_t old_size, const uint8_t *buffer,
+                  size_t new_size) {
+    size_t used = used_size();
+    uint8_t *end = m_data + used;
+    assert(used - old_size + new_size <= m_range_size);
+    if (old_size != new_size)
+      ::memmove(p + new_size, p + old_size, end - (p + old_size));
+    ::memcpy(p, buffer, new_size);
+    set_used_size(used - old_size + new_size);
+  }
+
+  // Decodes all records, starting at |start|, to the |arena|
+  const uint8_t *decode_all(ByteArray *arena, size_t node_count,
+                  size_t start) const {
+    arena->resize((node_count - start) * sizeof(T));
+    if (node_count == start)
+      return arena->data();
+
+    T *out = (T *)arena->data();
+    T values[kMaxRecordsPerBlock];
+    int first;
+    const uint8_t *p = find_block(start, &first);
+    const uint8_t *end = m_data + used_size();
+
+    // the first block is only partially copied
+    size_t count = decode_block(p, values);
+    out = std::copy(&values[start - first], &values[count], out);
+    for (p += block_size(p); p < end; p += block_size(p))
+      out += decode_block(p, out);
+    return arena->data();
+  }
+
+  // Returns the size of a block
+  static size_t block_size(const uint8_t *block) {
+    return kBlockHeaderSize + packed_size(block[0], block[1]);
+  }
+
+  // Returns the size of |count| packed values with |width| bits
+  static size_t packed_size(size_t count, uint32_t width) {
+    return 8 * ((count * width + 63) / 64);
+  }
+
+  // Reads the parameters of a block
+  static void read_params(const uint8_t *block, BlockParams *params) {
+    params->width = block[1];
+    params->shift = block[2];
+    ::memcpy(&params->ref, block + 3, sizeof(T));
+  }
+
+  // Returns true if |value| can be stored with the |params|
+  static bool fits(const BlockParams &params, T value) {
+    uint64_t v = Codec::encode(value, params.ref);
+    if (params.shift > 0 && (v & ((1ull << params.shift) - 1)) != 0)
+      return false;
+    v >>= params.shift;
+    return params.width >= 64 || v < (1ull << params.width);
+  }
+
+  // Calculates the best parameters for |count| |values|
+  static void calc_params(const T *values, size_t count,
+                  BlockParams *params) {
+    params->ref = Codec::reference(values, count);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++)
+      mask |= Codec::encode(values[i], params->ref);
+    params->shift = mask ? ctz64(mask) : 0;
+    params->width = bits64(mask >> params->shift);
+  }
+
+  // Encodes a block; uses the |old| parameters if all values fit and if
+  // they require less space than newly calculated parameters. The
+  // |old| parameters guarantee that a block does not grow if records are
+  // removed.
+  static size_t encode_block(uint8_t *out, const T *values, size_t count,
+                  const BlockParams *old) {
+    BlockParams params;
+    calc_params(values, count, &params);
+    if (old && old->width < params.width) {
+      size_t i;
+      for (i = 0; i < count; i++)
+        if (!fits(*old, values[i]))
+          break;
+      if (i == count)
+        params = *old;
+    }
+
+    size_t size = packed_size(count, params.width);
+    out[0] = (uint8_t)count;
+    out[1] = (uint8_t)params.width;
+    out[2] = (uint8_t)params.shift;
+    ::memcpy(out + 3, &params.ref, sizeof(T));
+    uint8_t *words = out + kBlockHeaderSize;
+    ::memset(words, 0, size);
+    for (size_t i = 0; i < count; i++)
+      store(words, params.width, i,
+                  Codec::encode(values[i], params.ref) >> params.shift);
+    return kBlockHeaderSize + size;
+  }
+
+  // Decodes a block to |out|; returns the number of records
+  static size_t decode_block(const uint8_t *block, T *out) {
+    BlockParams params;
+    read_params(block, &params);
+    size_t count = block[0];
+    const uint8_t *words = block + kBlockHeaderSize;
+    for (size_t i = 0; i < count; i++)
+      out[i] = Codec::decode(load(words, params.width, i) << params.shift,
+                      params.ref);
+    return count;
+  }
+
+  // Stores |value| at position |i|; overwrites the previous value
+  static void store(uint8_t *words, uint32_t width, size_t i,
+                  uint64_t value) {
+    if (width == 0)
+      return;
+    uint64_t mask = width < 64 ? (1ull << width) - 1 : ~0ull;
+    uint64_t pos = (uint64_t)i * width;
+    uint8_t *w = words + 8 * (pos / 64);
+    uint32_t shift = pos % 64;
+    store64(w, (load64(w) & ~(mask << shift)) | (value << shift));
+    if (shift + width > 64)
+      store64(w + 8, (load64(w + 8) & ~(mask >> (64 - shift)))
+                      | (value >> (64 - shift)));
+  }
+
+  // Returns the value at position |i|
+  static uint64_t load(const uint8_t *words, uint32_t width, size_t i) {
+    if (width == 0)
+      return 0;
+    uint64_t pos = (uint64_t)i * width;
+    const uint8_t *w = words + 8 * (pos / 64);
+    uint32_t shift = pos % 64;
+    uint64_t v = load64(w) >> shift;
+    if (shift + width > 64)
+      v |= load64(w + 8) << (64 - shift);
+    if (width < 64)
+      v &= (1ull << width) - 1;
+    return v;
+  }
+
+  // Reads an unaligned 64bit word
+  static uint64_t load64(const uint8_t *p) {
+    uint64_t v;
+    ::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  // Writes an unaligned 64bit word
+  static void store64(uint8_t *p, uint64_t v) {
+    ::memcpy(p, &v, sizeof(v));
+  }
+
+  // Returns the number of bits required to store |v|
+  static uint32_t bits64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long answer;
+    if (v == 0)
+      return 0;
+    _BitScanReverse64(&answer, v);
+    return answer + 1;
+#else
+    return v == 0 ? 0 : 64 - __builtin_clzll(v);
+#endif
+  }
+
+  // Returns the number of trailing zero bits of |v| (which is not 0)
+  static uint32_t ctz64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long answer;
+    _BitScanForward64(&answer, v);
+    return answer;
+#else
+    return __builtin_ctzll(v);
+#endif
+  }
+
+  // The range with the blocks
+  uint8_t *m_data;
+
+  // The number of records
+  size_t m_count;
+};
+
+} // namespace DefLayout
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_RECORDS_NUMERIC_H */
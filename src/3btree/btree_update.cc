@@ -18,6 +18,7 @@
 #include "0root/root.h"
 
 #include <string.h>
+#include <algorithm>
 
 // Always verify that a file of level N does not include headers > N!
 #include "1base/error.h"
@@ -81,25 +82,30 @@ pivot_position(BtreeUpdateAction &state, BtreeNodeProxy *old_node,
   return pivot;
 }
 
-// Allocates a new root page and sets it up in the btree
-static inline Page *
-allocate_new_root(BtreeUpdateAction &state, Page *old_root)
+// Shortens the separator key of a leaf split (suffix truncation). The
+// separator only has to be greater than the last key of the left node,
+// therefore everything after the first byte which differs from that key
+// is cut off. Only valid if the keys are sorted like memcmp(3), which is
+// the case for prefix compressed keys (UPS_COMPRESSOR_PREFIX).
+static void
+truncate_separator(Context *context, BtreeNodeProxy *left_node,
+                ups_key_t *pivot_key)
 {
-  LocalEnvironment *env = state.btree->db()->lenv();
-
-  Page *new_root = env->page_manager()->alloc(state.context, Page::kTypeBroot);
-  BtreeNodeProxy *new_node = state.btree->get_node_from_page(new_root);
-  new_node->set_left_child(old_root->address());
-
-  state.btree->set_root_address(new_root->address());
-  Page *header = env->page_manager()->fetch(state.context, 0);
-  header->set_dirty(true);
-
-  old_root->set_type(Page::kTypeBindex);
-
-  return new_root;
+  ByteArray arena;
+  ups_key_t left = {0};
+  left_node->key(context, left_node->length() - 1, &arena, &left);
+
+  const uint8_t *lhs = (const uint8_t *)left.data;
+  const uint8_t *rhs = (const uint8_t *)pivot_key->data;
+  uint16_t size = std::min(left.size, pivot_key->size);
+  uint16_t i = 0;
+  while (i < size && lhs[i] == rhs[i])
+    i++;
+  if (i < pivot_key->size)
+    pivot_key->size = i + 1;
 }
 
+
 /* Merges the |sibling| into |page|, returns the merged page and moves
  * the sibling to the freelist */ 
 static inline Page *
@@ -243,6 +249,24 @@ BtreeUpdateAction::traverse_tree(const ups_key_t *key,
   return page;
 }
 
+Page *
+BtreeUpdateAction::allocate_new_root(Page *old_root)
+{
+  LocalEnvironment *env = btree->db()->lenv();
+
+  Page *new_root = env->page_manager()->alloc(context, Page::kTypeBroot);
+  BtreeNodeProxy *new_node = btree->get_node_from_page(new_root);
+  new_node->set_left_child(old_root->address());
+
+  btree->set_root_address(new_root->address());
+  Page *header = env->page_manager()->fetch(context, 0);
+  header->set_dirty(true);
+
+  old_root->set_type(Page::kTypeBindex);
+
+  return new_root;
+}
+
 Page *
 BtreeUpdateAction::split_page(Page *old_page, Page *parent,
                 const ups_key_t *key, BtreeStatistics::InsertHints &hints)
@@ -261,11 +285,13 @@ BtreeUpdateAction::split_page(Page *old_page, Page *parent,
   /* no parent page? then we're splitting the root page. allocate
    * a new root page */
   if (unlikely(!parent))
-    parent = allocate_new_root(*this, old_page);
+    parent = allocate_new_root(old_page);
 
   Page *to_return = 0;
   ByteArray pivot_key_arena;
   ups_key_t pivot_key = {0};
+  bool truncate_pivot = old_node->is_leaf()
+          && btree->db()->config().key_compressor == UPS_COMPRESSOR_PREFIX;
 
   /* if the key is appended then don't split the page; simply allocate
    * a new page and insert the new key. */
@@ -276,6 +302,8 @@ BtreeUpdateAction::split_page(Page *old_page, Page *parent,
       to_return = new_page;
       pivot_key = *key;
       pivot = old_node->length();
+      if (truncate_pivot)
+        truncate_separator(context, old_node, &pivot_key);
     }
   }
 
@@ -296,6 +324,8 @@ BtreeUpdateAction::split_page(Page *old_page, Page *parent,
 
     /* now move some of the key/rid-tuples to the new page */
     old_node->split(context, new_node, pivot);
+    if (truncate_pivot)
+      truncate_separator(context, old_node, &pivot_key);
 
     // if the new key is >= the pivot key then continue with the right page,
     // otherwise continue with the left page
@@ -376,9 +406,18 @@ BtreeUpdateAction::insert_in_page(Page *page, ups_key_t *key,
   uint32_t new_duplicate_id = 0;
   if (exists) {
     if (node->is_leaf()) {
-      // overwrite record blob
-      node->set_record(context, result.slot, record, duplicate_index,
-                      hints.flags, &new_duplicate_id);
+      // overwrite record blob; compressed RecordLists can grow if a record
+      // is overwritten. If the node is full then the caller splits the
+      // page and tries again.
+      try {
+        node->set_record(context, result.slot, record, duplicate_index,
+                        hints.flags, &new_duplicate_id);
+      }
+      catch (Exception &ex) {
+        if (ex.code != UPS_LIMITS_REACHED)
+          throw ex;
+        return UPS_LIMITS_REACHED;
+      }
 
       hints.processed_leaf_page = page;
       hints.processed_slot = result.slot;
@@ -411,6 +450,8 @@ BtreeUpdateAction::insert_in_page(Page *page, ups_key_t *key,
     catch (Exception &ex) {
       if (result.slot < (int)node->length())
         node->erase(context, result.slot);
+      if (ex.code == UPS_LIMITS_REACHED)
+        return UPS_LIMITS_REACHED;
       throw ex;
     }
   }
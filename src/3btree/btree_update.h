@@ -60,6 +60,9 @@ struct BtreeUpdateAction
   Page *split_page(Page *old_page, Page *parent, const ups_key_t *key,
                       BtreeStatistics::InsertHints &hints);
 
+  // Allocates a new root page above |old_root| and sets it up in the btree
+  Page *allocate_new_root(Page *old_root);
+
   // Inserts a key in a page
   ups_status_t insert_in_page(Page *page, ups_key_t *key,
                       ups_record_t *record,
@@ -113,5 +113,51 @@ BtreeIndex::visit_nodes(Context *context, BtreeVisitor &visitor,
   bva.run();
 }
 
+void
+BtreeIndex::partition_leafs(Context *context, size_t count,
+              std::vector<uint64_t> *leafs)
+{
+  PageManager *page_manager = db()->lenv()->page_manager();
+  leafs->clear();
+
+  // collect the nodes of each level until a level has enough subtrees
+  std::vector<uint64_t> level(1, root_address());
+  bool is_leaf = false;
+  while (level.size() < count) {
+    std::vector<uint64_t> children;
+    for (std::vector<uint64_t>::iterator it = level.begin();
+                    it != level.end(); it++) {
+      Page *page = page_manager->fetch(context, *it, PageManager::kReadOnly);
+      BtreeNodeProxy *node = get_node_from_page(page);
+      if (node->is_leaf()) {
+        is_leaf = true;
+        break;
+      }
+      children.push_back(node->left_child());
+      for (size_t s = 0; s < node->length(); s++)
+        children.push_back(node->record_id(context, s));
+    }
+    if (is_leaf)
+      break;
+    level.swap(children);
+  }
+
+  // pick |count| subtrees in regular intervals, then descend to their
+  // leftmost leaf
+  size_t ranges = std::min(count, level.size());
+  for (size_t i = 0; i < ranges; i++) {
+    uint64_t address = level[(i * level.size()) / ranges];
+    while (!is_leaf) {
+      Page *page = page_manager->fetch(context, address,
+                      PageManager::kReadOnly);
+      BtreeNodeProxy *node = get_node_from_page(page);
+      if (node->is_leaf())
+        break;
+      address = node->left_child();
+    }
+    leafs->push_back(address);
+  }
+}
+
 } // namespace upscaledb
 
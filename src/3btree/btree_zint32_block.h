@@ -22,9 +22,14 @@
 #ifndef UPS_BTREE_KEYS_BLOCK_H
 #define UPS_BTREE_KEYS_BLOCK_H
 
+#include <string.h>
+#include <algorithm>
+#include <limits>
+
 #include "0root/root.h"
 
 // Always verify that a file of level N does not include headers > N!
+#include "2simd/simd.h"
 #include "3btree/btree_node.h"
 #include "3btree/btree_keys_base.h"
 
@@ -60,21 +65,55 @@ sort_by_offset(const SortHelper &lhs, const SortHelper &rhs) {
 // The BlockCache is used to speed up multiple select() operations for
 // a single block. This is frequently used when iterating over a block
 // with a cursor.
-struct BlockCache {
-  BlockCache()
+template<typename T>
+struct BasicBlockCache {
+  BasicBlockCache()
     : is_active(false) {
   }
 
   bool is_active;
-  uint32_t index_value;
-  uint32_t data[256]; // TODO replace with kMaxKeysPerBlock
+  T index_value;
+  T data[256]; // TODO replace with kMaxKeysPerBlock
 };
 
+typedef BasicBlockCache<uint32_t> BlockCache;
+
+// Returns the position of the first of the |count| sorted keys in |data|
+// which is not less than |key|; used to search the decoded blocks
+template<typename T>
+static inline int
+block_lower_bound(const T *data, int count, T key)
+{
+  return ((int)(std::lower_bound(data, data + count, key) - data));
+}
+
+#ifdef __SSE2__
+template<>
+inline int
+block_lower_bound<uint32_t>(const uint32_t *data, int count, uint32_t key)
+{
+  return (lower_bound_sse(data, count, key));
+}
+#endif
+
+#ifdef __SSE4_2__
+template<>
+inline int
+block_lower_bound<uint64_t>(const uint64_t *data, int count, uint64_t key)
+{
+  return (lower_bound_sse(data, count, key));
+}
+#endif
+
 // This structure is an "index" entry which describes the location
-// of a variable-length block
+// of a variable-length block. |T| is the type of the (uncompressed) keys.
 #include "1base/packstart.h"
-UPS_PACK_0 class UPS_PACK_1 IndexBase {
+template<typename T>
+UPS_PACK_0 class UPS_PACK_1 BasicIndexBase {
   public:
+    // the type of the keys
+    typedef T value_type;
+
     // initialize this block index
     void initialize(uint32_t offset, uint8_t *data, size_t data_size) {
       ::memset(this, 0, sizeof(*this));
@@ -92,22 +131,22 @@ UPS_PACK_0 class UPS_PACK_1 IndexBase {
     }
 
     // returns the initial value
-    uint32_t value() const {
+    T value() const {
       return (m_value);
     }
 
     // sets the initial value
-    void set_value(uint32_t value) {
+    void set_value(T value) {
       m_value = value;
     }
 
     // returns the highest value
-    uint32_t highest() const {
+    T highest() const {
       return (m_highest);
     }
 
     // sets the highest value
-    void set_highest(uint32_t highest) {
+    void set_highest(T highest) {
       m_highest = highest;
     }
 
@@ -117,17 +156,21 @@ UPS_PACK_0 class UPS_PACK_1 IndexBase {
     uint16_t m_offset;
 
     // the start value of this block
-    uint32_t m_value;
+    T m_value;
 
     // the highest value of this block
-    uint32_t m_highest;
+    T m_highest;
 } UPS_PACK_2;
 #include "1base/packstop.h"
 
+typedef BasicIndexBase<uint32_t> IndexBase;
+
 // Base class for a BlockCodec
 template <typename Index>
 struct BlockCodecBase
 {
+  typedef typename Index::value_type T;
+
   enum {
     kHasCompressApi = 0,
     kHasFindLowerBoundApi = 0,
@@ -138,32 +181,32 @@ struct BlockCodecBase
     kCompressInPlace = 0,
   };
 
-  static uint32_t compress_block(Index *index, const uint32_t *in,
+  static uint32_t compress_block(Index *index, const T *in,
                   uint32_t *out) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
-  static uint32_t *uncompress_block(Index *index, const uint32_t *block_data,
-                  uint32_t *out) {
+  static T *uncompress_block(Index *index, const uint32_t *block_data,
+                  T *out) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
   static int find_lower_bound(Index *index, const uint32_t *block_data,
-                  uint32_t key, uint32_t *result) {
+                  T key, T *result) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
   static bool insert(Index *index, uint32_t *block_data,
-                  uint32_t key, int *pslot) {
+                  T key, int *pslot) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
   static bool append(Index *index, uint32_t *block_data,
-                  uint32_t key, int *pslot) {
+                  T key, int *pslot) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
@@ -175,7 +218,7 @@ struct BlockCodecBase
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
-  static uint32_t select(Index *index, uint32_t *block_data, int slot) {
+  static T select(Index *index, uint32_t *block_data, int slot) {
     assert(!"shouldn't be here");
     throw Exception(UPS_INTERNAL_ERROR);
   }
@@ -186,9 +229,11 @@ struct Zint32Codec
 {
   typedef BlockIndex Index;
   typedef BlockCodec Codec;
+  typedef typename Index::value_type T;
+  typedef BasicBlockCache<T> Cache;
 
-  static uint32_t compress_block(Index *index, BlockCache *block_cache,
-                    const uint32_t *in, uint32_t *out) {
+  static uint32_t compress_block(Index *index, Cache *block_cache,
+                    const T *in, uint32_t *out) {
     block_cache->is_active = false;
 
     if (Codec::kHasCompressApi)
@@ -197,8 +242,8 @@ struct Zint32Codec
     throw Exception(UPS_INTERNAL_ERROR);
   }
 
-  static uint32_t *uncompress_block(Index *index, const uint32_t *block_data,
-                  uint32_t *out) {
+  static T *uncompress_block(Index *index, const uint32_t *block_data,
+                  T *out) {
     if (index->key_count() > 1)
       return (Codec::uncompress_block(index, block_data, out));
     else
@@ -206,40 +251,40 @@ struct Zint32Codec
   }
 
   static int find_lower_bound(Index *index, const uint32_t *block_data,
-                  uint32_t key, uint32_t *result) {
+                  T key, T *result) {
     if (Codec::kHasFindLowerBoundApi)
       return (Codec::find_lower_bound(index, block_data, key, result));
 
-    uint32_t tmp[Index::kMaxKeysPerBlock];
-    uint32_t *begin = uncompress_block(index, block_data, &tmp[0]);
-    uint32_t *end = begin + index->key_count() - 1;
-    uint32_t *it = std::lower_bound(begin, end, key);
+    T tmp[Index::kMaxKeysPerBlock];
+    T *begin = uncompress_block(index, block_data, &tmp[0]);
+    T *end = begin + index->key_count() - 1;
+    T *it = std::lower_bound(begin, end, key);
     *result = *it;
     return (it - begin);
   }
 
-  static bool insert(Index *index, BlockCache *block_cache,
-                    uint32_t *block_data, uint32_t key, int *pslot) {
+  static bool insert(Index *index, Cache *block_cache,
+                    uint32_t *block_data, T key, int *pslot) {
     block_cache->is_active = false;
 
     if (Codec::kHasInsertApi)
       return (Codec::insert(index, block_data, key, pslot));
 
     // now decode the block
-    uint32_t datap[Index::kMaxKeysPerBlock];
-    uint32_t *data = uncompress_block(index, block_data, datap);
+    T datap[Index::kMaxKeysPerBlock];
+    T *data = uncompress_block(index, block_data, datap);
 
     // swap |key| and |index->value|
     if (key < index->value()) {
-      uint32_t tmp = index->value();
+      T tmp = index->value();
       index->set_value(key);
       key = tmp;
     }
 
     // locate the position of the new key
-    uint32_t *it = data;
-    uint32_t *begin = &data[0];
-    uint32_t *end = &data[index->key_count() - 1];
+    T *it = data;
+    T *begin = &data[0];
+    T *end = &data[index->key_count() - 1];
 
     if (index->key_count() > 1) {
       it = std::lower_bound(begin, end, key);
@@ -252,7 +297,7 @@ struct Zint32Codec
 
       // insert the new key
       if (it < end)
-        ::memmove(it + 1, it, (end - it) * sizeof(uint32_t));
+        ::memmove(it + 1, it, (end - it) * sizeof(T));
     }
 
     *it = key;
@@ -265,19 +310,19 @@ struct Zint32Codec
     return (true);
   }
 
-  static bool append(Index *index, BlockCache *block_cache,
-                    uint32_t *block_data, uint32_t key, int *pslot) {
+  static bool append(Index *index, Cache *block_cache,
+                    uint32_t *block_data, T key, int *pslot) {
     block_cache->is_active = false;
 
     if (Codec::kHasAppendApi)
       return (Codec::append(index, block_data, key, pslot));
 
     // decode the block
-    uint32_t datap[Index::kMaxKeysPerBlock];
-    uint32_t *data = uncompress_block(index, block_data, datap);
+    T datap[Index::kMaxKeysPerBlock];
+    T *data = uncompress_block(index, block_data, datap);
 
     // append the new key
-    uint32_t *it = &data[index->key_count() - 1];
+    T *it = &data[index->key_count() - 1];
     *it = key;
     *pslot = it - &data[0] + 1;
 
@@ -289,7 +334,7 @@ struct Zint32Codec
   }
 
   template<typename GrowHandler>
-  static void del(Index *index, BlockCache *block_cache, uint32_t *block_data,
+  static void del(Index *index, Cache *block_cache, uint32_t *block_data,
                     int slot, GrowHandler *grow_handler) {
     block_cache->is_active = false;
 
@@ -297,8 +342,8 @@ struct Zint32Codec
       return (Codec::del(index, block_data, slot, grow_handler));
 
     // uncompress the block and remove the key
-    uint32_t datap[Index::kMaxKeysPerBlock];
-    uint32_t *data = uncompress_block(index, block_data, datap);
+    T datap[Index::kMaxKeysPerBlock];
+    T *data = uncompress_block(index, block_data, datap);
 
     // delete the first value?
     if (slot == 0) {
@@ -308,7 +353,7 @@ struct Zint32Codec
 
     if (slot < (int)index->key_count() - 1) {
       ::memmove(&data[slot - 1], &data[slot],
-              sizeof(uint32_t) * (index->key_count() - slot - 1));
+              sizeof(T) * (index->key_count() - slot - 1));
     }
 
     // adjust key count
@@ -330,7 +375,7 @@ struct Zint32Codec
       index->set_used_size(0);
   }
 
-  static uint32_t select(Index *index, BlockCache *block_cache,
+  static T select(Index *index, Cache *block_cache,
                     uint32_t *block_data, int position_in_block) {
     if (position_in_block == 0)
       return (index->value());
@@ -342,7 +387,7 @@ struct Zint32Codec
 
     block_cache->is_active = true;
     block_cache->index_value = index->value();
-    uint32_t *data = uncompress_block(index, block_data, block_cache->data);
+    T *data = uncompress_block(index, block_data, block_cache->data);
     return (data[position_in_block - 1]);
   }
 };
@@ -353,6 +398,9 @@ class BlockKeyList : public BaseKeyList
   public:
     typedef typename Zint32Codec::Index Index;
 
+    // The type of the keys
+    typedef typename Index::value_type value_type;
+
     enum {
       // A flag whether this KeyList has sequential data
       kHasSequentialData = 0,
@@ -360,6 +408,9 @@ class BlockKeyList : public BaseKeyList
       // A flag whether this KeyList supports the scan() call
       kSupportsBlockScans = 1,
 
+      // A flag whether this KeyList supports the scan_range() call
+      kSupportsRangeScans = 1,
+
       // This KeyList has a custom find() implementation
       kCustomFind = 1,
 
@@ -454,7 +505,7 @@ class BlockKeyList : public BaseKeyList
 
       size_t total_keys = 0;
       int used_size = 0;
-      // uint32_t highest = 0;
+      // value_type highest = 0;
 
       for (; index < end; index++) {
         assert(index->used_size() <= index->block_size());
@@ -475,8 +526,8 @@ class BlockKeyList : public BaseKeyList
         if (index->key_count() > 1) {
           assert(index->used_size() > 0);
 #if 0
-          uint32_t data[Index::kMaxKeysPerBlock];
-          uint32_t *pdata = uncompress_block(index, &data[0]);
+          value_type data[Index::kMaxKeysPerBlock];
+          value_type *pdata = uncompress_block(index, &data[0]);
           assert(pdata[0] > index->value());
           assert(highest <= index->value());
 
@@ -518,7 +569,7 @@ class BlockKeyList : public BaseKeyList
     // but never called
     size_t get_key_size(int slot) const {
       assert(!"shouldn't be here");
-      return (sizeof(uint32_t));
+      return (sizeof(value_type));
     }
 
     // Returns a pointer to the key's data; only required to appease the
@@ -600,7 +651,7 @@ class BlockKeyList : public BaseKeyList
 
       *pcmp = 0;
 
-      uint32_t key = *(uint32_t *)hkey->data;
+      value_type key = *(value_type *)hkey->data;
       int slot = 0;
 
       // first perform a linear search through the index
@@ -616,13 +667,24 @@ class BlockKeyList : public BaseKeyList
       if (index->value() == key)
         return (slot);
 
+      // the codecs return the position of the first key >= |key| in the
+      // compressed keys (some return the last key if all keys are smaller);
       // increment result by 1 because index 0 is index->value()
-      uint32_t result;
-      int s = Zint32Codec::find_lower_bound(index,
-                      (uint32_t *)get_block_data(index), key, &result);
-      if (result != key || s == (int)index->key_count())
-        *pcmp = +1;
-      return (slot + s + 1);
+      value_type result = 0;
+      int count = (int)index->key_count() - 1;
+      int s = count > 0
+                ? Zint32Codec::find_lower_bound(index,
+                      (uint32_t *)get_block_data(index), key, &result)
+                : 0;
+      if (s < count && result <= key) {
+        if (result != key)
+          *pcmp = +1;
+        return (slot + s + 1);
+      }
+
+      // otherwise return the largest key which is smaller than |key|
+      *pcmp = +1;
+      return (slot + std::min(s, count));
     }
 
     // Inserts a key
@@ -631,9 +693,9 @@ class BlockKeyList : public BaseKeyList
                     const ups_key_t *hkey, uint32_t flags, Cmp &comparator,
                     int /* unused */ slot) {
       assert(check_integrity(0, node_count));
-      assert(hkey->size == sizeof(uint32_t));
+      assert(hkey->size == sizeof(value_type));
 
-      uint32_t key = *(uint32_t *)hkey->data;
+      value_type key = *(value_type *)hkey->data;
 
       // if a split is required: vacuumize the node, then retry
       try {
@@ -716,7 +778,7 @@ class BlockKeyList : public BaseKeyList
                                 (uint32_t *)get_block_data(index),
                                 position_in_block);
 
-      dest->size = sizeof(uint32_t);
+      dest->size = sizeof(value_type);
       if (deep_copy == false) {
         dest->data = (uint8_t *)&m_dummy;
         return;
@@ -728,7 +790,7 @@ class BlockKeyList : public BaseKeyList
         dest->data = arena->data();
       }
 
-      *(uint32_t *)dest->data = m_dummy;
+      *(value_type *)dest->data = m_dummy;
     }
 
     // Prints a key to |out| (for debugging)
@@ -744,12 +806,13 @@ class BlockKeyList : public BaseKeyList
 
     // Scans all keys; used for the UQI APIs.
     ScanResult scan(ByteArray *arena, size_t node_count, uint32_t start) {
-      arena->resize((get_block_count() * (Index::kMaxKeysPerBlock + 1)) * 4);
+      arena->resize((get_block_count() * (Index::kMaxKeysPerBlock + 1))
+                      * sizeof(value_type));
 
       Index *it = get_block_index(0);
       Index *end = get_block_index(get_block_count());
 
-      uint32_t *out = (uint32_t *)arena->data();
+      value_type *out = (value_type *)arena->data();
 
       for (; it < end; it++) {
         if (start > it->key_count()) {
@@ -762,10 +825,92 @@ class BlockKeyList : public BaseKeyList
         out += it->key_count();
       }
 
-      out = (uint32_t *)arena->data();
+      out = (value_type *)arena->data();
       return std::make_pair(out + start, node_count - start);
     }
 
+    // Scans the keys which are accepted by the built-in comparison
+    // |predicate|; used for the UQI APIs. The keys are sorted, therefore the
+    // matching keys are consecutive. Blocks which are out of range are
+    // skipped by looking at their index (the lowest and highest key).
+    // Blocks which are completely in range are only decoded if |decode| is
+    // true; otherwise only their keys are counted. The blocks at the
+    // boundaries of the range are decoded and searched.
+    //
+    // |*pfirst| receives the slot of the first matching key.
+    template<typename Predicate>
+    ScanResult scan_range(ByteArray *arena, size_t node_count, uint32_t start,
+                    const Predicate &predicate, bool decode,
+                    uint32_t *pfirst) {
+      value_type lo, hi;
+      *pfirst = start;
+      if (!predicate.bounds(&lo, &hi))
+        return std::make_pair((const void *)0, (size_t)0);
+
+      value_type *out = 0;
+      if (decode) {
+        arena->resize((get_block_count() * (Index::kMaxKeysPerBlock + 1))
+                      * sizeof(value_type));
+        out = (value_type *)arena->data();
+      }
+
+      Index *it = get_block_index(0);
+      Index *end = get_block_index(get_block_count());
+
+      size_t count = 0;
+      uint32_t slot = 0; // the slot of the block's first key
+      for (; it < end; slot += it->key_count(), it++) {
+        if (it->key_count() == 0 || slot + it->key_count() <= start)
+          continue;
+        if (it->highest() < lo)
+          continue;
+        // all remaining blocks are out of range
+        if (it->value() > hi)
+          break;
+
+        int first = start > slot ? (int)(start - slot) : 0;
+
+        // the whole block is in range?
+        if (first == 0 && it->value() >= lo && it->highest() <= hi) {
+          if (count == 0)
+            *pfirst = slot;
+          if (decode) {
+            *out = it->value();
+            uncompress_block(it, out + 1);
+            out += it->key_count();
+          }
+          count += it->key_count();
+          continue;
+        }
+
+        // otherwise decode the block and search the boundaries of the range
+        value_type data[Index::kMaxKeysPerBlock + 1];
+        data[0] = it->value();
+        uncompress_block(it, &data[1]);
+
+        int n = (int)it->key_count();
+        int b = std::max(first, block_lower_bound(&data[0], n, lo));
+        int e = hi == std::numeric_limits<value_type>::max()
+                  ? n
+                  : block_lower_bound(&data[0], n, (value_type)(hi + 1));
+        if (b < e) {
+          if (count == 0)
+            *pfirst = slot + b;
+          if (decode) {
+            ::memcpy(out, &data[b], (e - b) * sizeof(value_type));
+            out += e - b;
+          }
+          count += e - b;
+        }
+
+        // all remaining keys are out of range
+        if (e < n)
+          break;
+      }
+
+      return std::make_pair(decode ? (const void *)arena->data() : 0, count);
+    }
+
     // Copies all keys from this[sstart] to dest[dstart]; this method
     // is used to split and merge btree nodes.
     void copy_to(int sstart, size_t node_count, BlockKeyList &dest,
@@ -795,12 +940,12 @@ class BlockKeyList : public BaseKeyList
       // If start offset or destination offset > 0: uncompress both blocks,
       // merge them
       if (src_position_in_block > 0 || dst_position_in_block > 0) {
-        uint32_t sdata_buf[Index::kMaxKeysPerBlock];
-        uint32_t ddata_buf[Index::kMaxKeysPerBlock];
-        uint32_t *sdata = uncompress_block(srci, &sdata_buf[0]);
-        uint32_t *ddata = dest.uncompress_block(dsti, &ddata_buf[0]);
+        value_type sdata_buf[Index::kMaxKeysPerBlock];
+        value_type ddata_buf[Index::kMaxKeysPerBlock];
+        value_type *sdata = uncompress_block(srci, &sdata_buf[0]);
+        value_type *ddata = dest.uncompress_block(dsti, &ddata_buf[0]);
 
-        uint32_t *d = &ddata[srci->key_count()];
+        value_type *d = &ddata[srci->key_count()];
 
         if (src_position_in_block == 0) {
           assert(dst_position_in_block != 0);
@@ -885,7 +1030,8 @@ class BlockKeyList : public BaseKeyList
       set_used_size(kSizeofOverhead);
       add_block(0, Index::kInitialBlockSize);
       m_block_cache.is_active = false;
-      assert(sizeof(m_block_cache.data) >= 4 * (Index::kMaxKeysPerBlock - 1));
+      assert(sizeof(m_block_cache.data)
+                      >= sizeof(value_type) * (Index::kMaxKeysPerBlock - 1));
     }
 
     // Calculates the used size and updates the stored value
@@ -903,7 +1049,7 @@ class BlockKeyList : public BaseKeyList
 
     // Implementation for insert()
     virtual PBtreeNode::InsertResult insert_impl(size_t node_count,
-                    uint32_t key, uint32_t flags) {
+                    value_type key, uint32_t flags) {
       int slot = 0;
 
       // perform a linear search through the index and get the block
@@ -925,8 +1071,8 @@ class BlockKeyList : public BaseKeyList
         return (PBtreeNode::InsertResult(UPS_DUPLICATE_KEY,
                     slot + index->key_count() - 1));
 
-      uint32_t new_data[Index::kMaxKeysPerBlock];
-      uint32_t datap[Index::kMaxKeysPerBlock];
+      value_type new_data[Index::kMaxKeysPerBlock];
+      value_type datap[Index::kMaxKeysPerBlock];
 
       // A split is required if the block overflows
       bool requires_split = index->key_count() + 1 >= Index::kMaxKeysPerBlock;
@@ -972,11 +1118,11 @@ class BlockKeyList : public BaseKeyList
         // to the new block.
         //
         // The pivot position is aligned to 4.
-        uint32_t *data = uncompress_block(index, datap);
+        value_type *data = uncompress_block(index, datap);
         uint32_t to_copy = (index->key_count() / 2) & ~0x03;
         assert(to_copy > 0);
         uint32_t new_key_count = index->key_count() - to_copy - 1;
-        uint32_t new_value = data[to_copy];
+        value_type new_value = data[to_copy];
 
         // once more check if the key already exists
         if (new_value == key)
@@ -984,7 +1130,7 @@ class BlockKeyList : public BaseKeyList
 
         to_copy++;
         ::memmove(&new_data[0], &data[to_copy],
-                    sizeof(int32_t) * (index->key_count() - to_copy));
+                    sizeof(value_type) * (index->key_count() - to_copy));
 
         // Now create a new block. This can throw, but so far we have not
         // modified existing data.
@@ -995,7 +1141,7 @@ class BlockKeyList : public BaseKeyList
 
         // add_block() can invalid the data pointer, therefore fetch it again
         if (Zint32Codec::Codec::kCompressInPlace)
-          data = (uint32_t *)get_block_data(index);
+          data = (value_type *)get_block_data(index);
 
         // Adjust the size of the old block
         index->set_key_count(index->key_count() - new_key_count);
@@ -1018,7 +1164,7 @@ class BlockKeyList : public BaseKeyList
           // hack for BlockIndex: fetch data pointer once more because
           // it was invalidated when the new block was added
           if (Zint32Codec::Codec::kCompressInPlace)
-            data = (uint32_t *)get_block_data(index);
+            data = (value_type *)get_block_data(index);
         }
 
         // the block was modified and needs to be compressed again, even if
@@ -1054,8 +1200,8 @@ class BlockKeyList : public BaseKeyList
     void print_block(Index *index) const {
       std::cout << "0: " << index->value() << std::endl;
 
-      uint32_t datap[Index::kMaxKeysPerBlock];
-      uint32_t *data = uncompress_block(index, datap);
+      value_type datap[Index::kMaxKeysPerBlock];
+      value_type *data = uncompress_block(index, datap);
 
       for (uint32_t i = 1; i < index->key_count(); i++)
         std::cout << i << ": " << data[i - 1] << std::endl;
@@ -1082,7 +1228,7 @@ class BlockKeyList : public BaseKeyList
 
     // Performs a linear search through the index; returns the index
     // and the slot of the first key in this block in |*pslot|.
-    Index *find_index(uint32_t key, int *pslot) {
+    Index *find_index(value_type key, int *pslot) {
       Index *index = get_block_index(0);
       Index *iend = get_block_index(get_block_count());
 
@@ -1222,9 +1368,9 @@ class BlockKeyList : public BaseKeyList
     }
 
     // Performs a lower bound search
-    int lower_bound_search(uint32_t *begin, uint32_t *end, uint32_t key,
+    int lower_bound_search(value_type *begin, value_type *end, value_type key,
                     int *pcmp) const {
-      uint32_t *it = std::lower_bound(begin, end, key);
+      value_type *it = std::lower_bound(begin, end, key);
       if (it != end) {
         *pcmp = (*it == key) ? 0 : +1;
       }
@@ -1267,13 +1413,13 @@ class BlockKeyList : public BaseKeyList
     }
 
     // Compresses a block of data
-    uint32_t compress_block(Index *index, uint32_t *in) {
+    uint32_t compress_block(Index *index, value_type *in) {
       return (Zint32Codec::compress_block(index, &m_block_cache,
                               in, (uint32_t *)get_block_data(index)));
     }
 
     // Uncompresses a block of data
-    uint32_t *uncompress_block(Index *index, uint32_t *out) const {
+    value_type *uncompress_block(Index *index, value_type *out) const {
       return (Zint32Codec::uncompress_block(index,
                               (uint32_t *)get_block_data(index), out));
     }
@@ -1285,10 +1431,10 @@ class BlockKeyList : public BaseKeyList
     size_t m_range_size;
 
     // helper variable to avoid returning pointers to local memory
-    uint32_t m_dummy;
+    value_type m_dummy;
 
     // Cache for speeding up the select() operation
-    BlockCache m_block_cache;
+    typename Zint32Codec::Cache m_block_cache;
 
     // Cached pointer to the last index used in get_key()
     Index *m_cached_index;
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Compressed 64bit integer keys; shared code of the codecs.
+ *
+ * The 64bit codecs use the same block machinery as the 32bit codecs
+ * (Zint32::BlockKeyList); only the block index and the codecs differ.
+ */
+
+#ifndef UPS_BTREE_KEYS_ZINT64_BLOCK_H
+#define UPS_BTREE_KEYS_ZINT64_BLOCK_H
+
+#include <string.h>
+#include <algorithm>
+
+#include "0root/root.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "2simd/simd.h"
+#include "3btree/btree_zint32_block.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+//
+// The template classes in this file are wrapped in a separate namespace
+// to avoid naming clashes with other KeyLists
+//
+namespace Zint64 {
+
+// This structure is an "index" entry which describes the location
+// of a variable-length block. The 32bit indices use 11bit fields for the
+// sizes, which are too small for 256 uncompressed 64bit keys.
+#include "1base/packstart.h"
+UPS_PACK_0 class UPS_PACK_1 BlockIndex
+        : public Zint32::BasicIndexBase<uint64_t> {
+  public:
+    enum {
+      // Initial size of a new block
+      kInitialBlockSize = 32,
+
+      // Maximum keys per block
+      kMaxKeysPerBlock = 256 + 1,
+    };
+
+    // initialize this block index
+    void initialize(uint32_t offset, uint8_t *block_data, size_t block_size) {
+      Zint32::BasicIndexBase<uint64_t>::initialize(offset, block_data,
+                      block_size);
+      m_block_size = (uint16_t)block_size;
+      m_used_size = 0;
+      m_key_count = 0;
+    }
+
+    // returns the used size of the block
+    uint32_t used_size() const {
+      return (m_used_size);
+    }
+
+    // sets the used size of the block
+    void set_used_size(uint32_t size) {
+      m_used_size = (uint16_t)size;
+    }
+
+    // returns the total block size
+    uint32_t block_size() const {
+      return (m_block_size);
+    }
+
+    // sets the total block size
+    void set_block_size(uint32_t size) {
+      m_block_size = (uint16_t)size;
+    }
+
+    // returns the key count
+    uint32_t key_count() const {
+      return (m_key_count);
+    }
+
+    // sets the key count
+    void set_key_count(uint32_t key_count) {
+      m_key_count = (uint16_t)key_count;
+    }
+
+    // copies this block to the |dest| block
+    void copy_to(const uint8_t *block_data, BlockIndex *dest,
+                    uint8_t *dest_data) {
+      dest->set_value(value());
+      dest->set_key_count(key_count());
+      dest->set_used_size(used_size());
+      dest->set_highest(highest());
+      ::memcpy(dest_data, block_data, block_size());
+    }
+
+  private:
+    // the total size of this block
+    uint16_t m_block_size;
+
+    // used size of this block
+    uint16_t m_used_size;
+
+    // the number of keys in this block
+    uint16_t m_key_count;
+} UPS_PACK_2;
+#include "1base/packstop.h"
+
+// Searches the |count| decoded keys in |data| for |key|. Returns the
+// position of the first key which is >= |key| (|count| if there is none),
+// like the Zint32 codecs. |*result| receives the key at this position.
+static inline int
+find_lower_bound(const uint64_t *data, int count, uint64_t key,
+                uint64_t *result)
+{
+#ifdef __SSE4_2__
+  int s = lower_bound_sse(data, count, key);
+#else
+  int s = (int)(std::lower_bound(data, data + count, key) - data);
+#endif
+  *result = s < count ? data[s] : key + 1;
+  return (s);
+}
+
+// Returns the number of bits required to store |v|
+static inline uint32_t
+bits(uint64_t v)
+{
+#ifdef _MSC_VER
+  unsigned long answer;
+  if (v == 0)
+    return 0;
+  _BitScanReverse64(&answer, v);
+  return answer + 1;
+#else
+  return v == 0 ? 0 : 64 - __builtin_clzll(v);
+#endif
+}
+
+// Reads an unaligned 64bit word
+static inline uint64_t
+load64(const uint8_t *p)
+{
+  uint64_t v;
+  ::memcpy(&v, p, sizeof(v));
+  return (v);
+}
+
+// Writes an unaligned 64bit word
+static inline void
+store64(uint8_t *p, uint64_t v)
+{
+  ::memcpy(p, &v, sizeof(v));
+}
+
+} // namespace Zint64
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_KEYS_ZINT64_BLOCK_H */
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Compressed 64bit integer keys (Frame Of Reference)
+ *
+ * Each key of a block is stored as the difference to the first key of the
+ * block (the "frame of reference"), bit-packed with the bit width of the
+ * largest difference. The block layout is
+ *
+ *   |bits (1 byte)|64bit words with the packed differences|
+ *
+ * Keys can be accessed without decoding their predecessors, and keys which
+ * are appended (i.e. ascending timestamps) usually fit into the current
+ * bit width and are packed in place.
+ */
+
+#ifndef UPS_BTREE_KEYS_ZINT64_FOR_H
+#define UPS_BTREE_KEYS_ZINT64_FOR_H
+
+#include "0root/root.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "3btree/btree_zint64_block.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+//
+// The template classes in this file are wrapped in a separate namespace
+// to avoid naming clashes with other KeyLists
+//
+namespace Zint64 {
+
+struct ForCodecImpl : public Zint32::BlockCodecBase<BlockIndex>
+{
+  enum {
+    kHasCompressApi = 1,
+    kHasFindLowerBoundApi = 1,
+    kHasAppendApi = 1,
+  };
+
+  static uint64_t *uncompress_block(BlockIndex *index,
+                  const uint32_t *block_data, uint64_t *out) {
+    const uint8_t *p = (const uint8_t *)block_data;
+    uint32_t b = p[0];
+    uint64_t base = index->value();
+    uint32_t count = index->key_count() - 1;
+    for (uint32_t i = 0; i < count; i++)
+      out[i] = base + unpack(p + 1, b, i);
+    return (out);
+  }
+
+  static uint32_t compress_block(BlockIndex *index, const uint64_t *in,
+                  uint32_t *out32) {
+    assert(index->key_count() > 0);
+    uint32_t count = index->key_count() - 1;
+    if (count == 0) {
+      index->set_used_size(0);
+      return (0);
+    }
+
+    uint8_t *out = (uint8_t *)out32;
+    uint64_t base = index->value();
+    uint32_t b = bits(in[count - 1] - base);
+    uint32_t size = packed_size(count, b);
+    out[0] = (uint8_t)b;
+    ::memset(out + 1, 0, size);
+    for (uint32_t i = 0; i < count; i++)
+      pack(out + 1, b, i, in[i] - base);
+
+    index->set_used_size(1 + size);
+    return (1 + size);
+  }
+
+  static bool append(BlockIndex *index, uint32_t *block_data32,
+                  uint64_t key, int *pslot) {
+    uint8_t *p = (uint8_t *)block_data32;
+    uint32_t count = index->key_count() - 1;
+    uint64_t delta = key - index->value();
+
+    // repack the block if the new key does not fit into the current
+    // bit width
+    if (count == 0 || bits(delta) > p[0]) {
+      uint64_t data[BlockIndex::kMaxKeysPerBlock];
+      if (count > 0)
+        uncompress_block(index, block_data32, data);
+      data[count] = key;
+      index->set_key_count(index->key_count() + 1);
+      compress_block(index, data, block_data32);
+    }
+    else {
+      uint32_t b = p[0];
+      uint32_t size = packed_size(count + 1, b);
+      if (size > packed_size(count, b))
+        store64(p + 1 + size - 8, 0);
+      pack(p + 1, b, count, delta);
+      index->set_key_count(index->key_count() + 1);
+      index->set_used_size(1 + size);
+    }
+
+    *pslot += index->key_count() - 1;
+    return (true);
+  }
+
+  static int find_lower_bound(BlockIndex *index, const uint32_t *block_data,
+                  uint64_t key, uint64_t *result) {
+    if (index->key_count() <= 1) {
+      *result = key + 1;
+      return (0);
+    }
+
+    uint64_t data[BlockIndex::kMaxKeysPerBlock];
+    uncompress_block(index, block_data, data);
+    return (Zint64::find_lower_bound(data, index->key_count() - 1, key,
+                            result));
+  }
+
+  static uint32_t estimate_required_size(BlockIndex *index,
+                  uint8_t *block_data, uint64_t key) {
+    uint64_t lo = std::min(key, index->value());
+    uint64_t hi = std::max(key, index->highest());
+    uint32_t b = bits(hi - lo);
+    // an appended key is packed with the current bit width
+    if (index->key_count() > 1 && block_data[0] > b)
+      b = block_data[0];
+    return (1 + packed_size(index->key_count(), b));
+  }
+
+  // Returns the size of |count| packed values with |b| bits
+  static uint32_t packed_size(uint32_t count, uint32_t b) {
+    return (8 * (((uint64_t)count * b + 63) / 64));
+  }
+
+  // Stores |value| at position |i|; the target bits have to be zeroed
+  static void pack(uint8_t *words, uint32_t b, uint32_t i, uint64_t value) {
+    uint64_t pos = (uint64_t)i * b;
+    uint8_t *w = words + 8 * (pos / 64);
+    uint32_t shift = pos % 64;
+    store64(w, load64(w) | (value << shift));
+    if (shift + b > 64)
+      store64(w + 8, load64(w + 8) | (value >> (64 - shift)));
+  }
+
+  // Returns the value at position |i|
+  static uint64_t unpack(const uint8_t *words, uint32_t b, uint32_t i) {
+    uint64_t pos = (uint64_t)i * b;
+    const uint8_t *w = words + 8 * (pos / 64);
+    uint32_t shift = pos % 64;
+    uint64_t v = load64(w) >> shift;
+    if (shift + b > 64)
+      v |= load64(w + 8) << (64 - shift);
+    if (b < 64)
+      v &= (1ull << b) - 1;
+    return (v);
+  }
+};
+
+typedef Zint32::Zint32Codec<BlockIndex, ForCodecImpl> ForCodec;
+
+class ForKeyList : public Zint32::BlockKeyList<ForCodec>
+{
+  public:
+    // Constructor
+    ForKeyList(LocalDatabase *db)
+      : Zint32::BlockKeyList<ForCodec>(db) {
+    }
+};
+
+} // namespace Zint64
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_KEYS_ZINT64_FOR_H */
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Compressed 64bit integer keys (Stream VByte)
+ *
+ * Each key of a block is stored as the difference to its predecessor
+ * (the "delta"), using 1 to 8 bytes. The lengths are not stored in the
+ * data bytes (as in the classic varbyte encoding) but in separate control
+ * bytes, one for two deltas (3 bits each). The block layout is
+ *
+ *   |control bytes|data bytes|
+ *
+ * This allows decoding two deltas at once with a single SSE shuffle
+ * instruction; the prefix sum is then also calculated with SSE.
+ */
+
+#ifndef UPS_BTREE_KEYS_ZINT64_STREAMVBYTE_H
+#define UPS_BTREE_KEYS_ZINT64_STREAMVBYTE_H
+
+#include "0root/root.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "3btree/btree_zint64_block.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+//
+// The template classes in this file are wrapped in a separate namespace
+// to avoid naming clashes with other KeyLists
+//
+namespace Zint64 {
+
+#ifdef __SSE4_1__
+// Shuffle masks for decoding two deltas; the index is
+// (length of the first delta - 1) | (length of the second delta - 1) << 3
+static const uint8_t kStreamVbyteShuffleTable[64][16] = {
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0x05, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0x06, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0x07, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0x08, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0x0a, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0x05, 0x06, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0x06, 0x07, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0x07, 0x08, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0x09, 0x0a, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0xff, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0xff, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0xff, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xff},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xff},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0xff},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0xff},
+  {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08},
+  {0x00, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09},
+  {0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a},
+  {0x00, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff, 0xff,
+   0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0xff, 0xff, 0xff,
+   0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0xff,
+   0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xff,
+   0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e},
+  {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f},
+};
+#endif // __SSE4_1__
+
+struct StreamVbyteCodecImpl : public Zint32::BlockCodecBase<BlockIndex>
+{
+  enum {
+    kHasCompressApi = 1,
+    kHasFindLowerBoundApi = 1,
+  };
+
+  static uint64_t *uncompress_block(BlockIndex *index,
+                  const uint32_t *block_data, uint64_t *out) {
+    uint32_t count = index->key_count() - 1;
+    const uint8_t *control = (const uint8_t *)block_data;
+    const uint8_t *data = control + control_size(count);
+    const uint8_t *end = control + index->used_size();
+    uint64_t prev = index->value();
+    uint32_t i = 0;
+
+#ifdef __SSE4_1__
+    // decode two deltas per iteration, as long as 16 bytes can be loaded
+    // without reading past the end of the block
+    __m128i p = _mm_set1_epi64x((long long)prev);
+    for (; i + 2 <= count && data + 16 <= end; i += 2) {
+      uint8_t c = control[i / 2];
+      __m128i mask = _mm_loadu_si128((const __m128i *)
+                      kStreamVbyteShuffleTable[(c & 7) | ((c >> 1) & 0x38)]);
+      __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data),
+                      mask);
+      // the prefix sum of both deltas, plus the previous key
+      v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+      v = _mm_add_epi64(v, p);
+      _mm_storeu_si128((__m128i *)&out[i], v);
+      p = _mm_unpackhi_epi64(v, v);
+      data += (c & 7) + ((c >> 4) & 7) + 2;
+    }
+    if (i > 0)
+      prev = out[i - 1];
+#endif
+
+    for (; i < count; i++) {
+      uint32_t length = ((control[i / 2] >> (4 * (i & 1))) & 7) + 1;
+      uint64_t delta = 0;
+      ::memcpy(&delta, data, length);
+      data += length;
+      prev += delta;
+      out[i] = prev;
+    }
+    return (out);
+  }
+
+  static uint32_t compress_block(BlockIndex *index, const uint64_t *in,
+                  uint32_t *out32) {
+    assert(index->key_count() > 0);
+    uint32_t count = index->key_count() - 1;
+    uint8_t *control = (uint8_t *)out32;
+    uint8_t *data = control + control_size(count);
+    uint64_t prev = index->value();
+
+    ::memset(control, 0, control_size(count));
+    for (uint32_t i = 0; i < count; i++) {
+      uint64_t delta = in[i] - prev;
+      uint32_t length = delta_size(delta);
+      control[i / 2] |= (uint8_t)((length - 1) << (4 * (i & 1)));
+      ::memcpy(data, &delta, length);
+      data += length;
+      prev = in[i];
+    }
+    return ((uint32_t)(data - control));
+  }
+
+  static int find_lower_bound(BlockIndex *index, const uint32_t *block_data,
+                  uint64_t key, uint64_t *result) {
+    if (index->key_count() <= 1) {
+      *result = key + 1;
+      return (0);
+    }
+
+    uint64_t data[BlockIndex::kMaxKeysPerBlock];
+    uncompress_block(index, block_data, data);
+    return (Zint64::find_lower_bound(data, index->key_count() - 1, key,
+                            result));
+  }
+
+  static uint32_t estimate_required_size(BlockIndex *index,
+                  uint8_t *block_data, uint64_t key) {
+    // a new key requires at most one more control byte and 8 bytes; the
+    // deltas of the neighbours do not grow
+    return (index->used_size() + 1 + 8);
+  }
+
+  // Returns the number of control bytes for |count| deltas
+  static uint32_t control_size(uint32_t count) {
+    return ((count + 1) / 2);
+  }
+
+  // Returns the number of bytes required for |delta|
+  static uint32_t delta_size(uint64_t delta) {
+    uint32_t b = bits(delta);
+    return (b == 0 ? 1 : (b + 7) / 8);
+  }
+};
+
+typedef Zint32::Zint32Codec<BlockIndex, StreamVbyteCodecImpl>
+        StreamVbyteCodec;
+
+class StreamVbyteKeyList : public Zint32::BlockKeyList<StreamVbyteCodec>
+{
+  public:
+    // Constructor
+    StreamVbyteKeyList(LocalDatabase *db)
+      : Zint32::BlockKeyList<StreamVbyteCodec>(db) {
+    }
+};
+
+} // namespace Zint64
+
+} // namespace upscaledb
+
+#endif /* UPS_BTREE_KEYS_ZINT64_STREAMVBYTE_H */
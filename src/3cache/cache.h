@@ -25,6 +25,19 @@
  * at the head. The tail therefore points to the page which was not used
  * in a long time, and is the primary candidate for purging.
  *
+ * The hash table is split into several shards. Each shard has its own
+ * lock, its own linked list and its own replacement state, and is purged
+ * independently. Concurrent threads therefore do not serialize on a
+ * single lock when accessing the cache.
+ *
+ * With UPS_CACHE_POLICY_2Q, the cache is scan-resistant: newly loaded pages
+ * are first stored in a "probation" queue. Pages in this queue are not
+ * moved when they are accessed, and they are purged in FIFO order before
+ * any page of the "totallist". The addresses of purged probation pages are
+ * remembered in a "ghost" queue; if such a page is loaded again then it
+ * is immediately stored in the totallist. A full table scan therefore only
+ * recycles the probation queue, but does not evict the hot pages.
+ *
  * @exception_safe: nothrow
  * @thread_safe: yes
  */
@@ -63,18 +76,19 @@ struct Cache
 {
   template<typename Purger>
   struct PurgeIfSelector {
-    PurgeIfSelector(Cache *cache, Purger &purger)
-      : cache_(cache), purger_(purger) {
+    PurgeIfSelector(Cache *cache, CacheShard &shard, Purger &purger)
+      : cache_(cache), shard_(shard), purger_(purger) {
     }
 
     bool operator()(Page *page) {
       if (purger_(page))
-        cache_->del(page);
+        cache_->del_nolock(shard_, page);
       // don't remove page from list; it was already removed above
       return false;
     }
 
     Cache *cache_;
+    CacheShard &shard_;
     Purger &purger_;
   };
 
@@ -84,85 +98,155 @@ struct Cache
   }
 
   // Fills in the current metrics
-  void fill_metrics(ups_env_metrics_t *metrics) const {
-    metrics->cache_hits = state.cache_hits;
-    metrics->cache_misses = state.cache_misses;
+  void fill_metrics(ups_env_metrics_t *metrics) {
+    metrics->cache_hits = 0;
+    metrics->cache_misses = 0;
+    metrics->cache_ghost_hits = 0;
+    metrics->cache_probation_pages = 0;
+    metrics->cache_policy = state.policy;
+    metrics->cache_shards = (uint32_t)state.num_shards;
+
+    for (size_t i = 0; i < state.num_shards; i++) {
+      CacheShard &shard = state.shards[i];
+      ScopedSpinlock lock(shard.mutex);
+      metrics->cache_hits += shard.cache_hits;
+      metrics->cache_misses += shard.cache_misses;
+      metrics->cache_ghost_hits += shard.ghost_hits;
+      metrics->cache_probation_pages += shard.probation.size();
+    }
   }
 
   // Retrieves a page from the cache, also removes the page from the cache
   // and re-inserts it at the front. Returns null if the page was not cached.
   Page *get(uint64_t address) {
     size_t hash = Impl::calc_hash(address);
+    CacheShard &shard = shard_of(hash);
+    ScopedSpinlock lock(shard.mutex);
 
-    Page *page = state.buckets[hash].get(address);
+    Page *page = shard.buckets[hash / state.num_shards].get(address);
     if (!page) {
-      state.cache_misses++;
+      shard.cache_misses++;
       return 0;
     }
 
-    // Now re-insert the page at the head of the "totallist", and
-    // thus move far away from the tail. The pages at the tail are highest
-    // candidates to be deleted when the cache is purged.
-    state.totallist.del(page);
-    state.totallist.put(page);
-    state.cache_hits++;
+    touch(shard, page);
+    shard.cache_hits++;
     return page;
   }
 
+  // Returns true if a page is cached; neither updates the LRU order nor
+  // the statistics
+  bool has(uint64_t address) {
+    size_t hash = Impl::calc_hash(address);
+    CacheShard &shard = shard_of(hash);
+    ScopedSpinlock lock(shard.mutex);
+    return shard.buckets[hash / state.num_shards].get(address) != 0;
+  }
+
   // Stores a page in the cache
   void put(Page *page) {
     size_t hash = Impl::calc_hash(page->address());
+    CacheShard &shard = shard_of(hash);
+    ScopedSpinlock lock(shard.mutex);
 
-    /* First remove the page from the cache, if it's already cached
-     *
-     * Then re-insert the page at the head of the list. The tail will
-     * point to the least recently used page.
-     */
-    state.totallist.del(page);
-    state.totallist.put(page);
-    if (page->is_allocated())
-      state.alloc_elements++;
-
-    state.buckets[hash].put(page);
+    // Already cached? Then treat this like an access
+    if (shard.totallist.has(page)) {
+      touch(shard, page);
+    }
+    else {
+      // 2Q: only pages which were recently evicted from the probation
+      // queue are directly stored in the totallist; all other pages first
+      // have to prove that they are accessed more than once
+      if (state.policy == UPS_CACHE_POLICY_2Q
+            && !forget_ghost(shard, page->address()))
+        shard.probation.put(page);
+
+      // Insert the page at the head of the list. The tail will
+      // point to the least recently used page.
+      shard.totallist.put(page);
+      if (page->is_allocated())
+        shard.alloc_elements++;
+    }
+
+    shard.buckets[hash / state.num_shards].put(page);
   }
 
   // Removes a page from the cache
   void del(Page *page) {
     assert(page->address() != 0);
 
+    CacheShard &shard = shard_of(Impl::calc_hash(page->address()));
+    ScopedSpinlock lock(shard.mutex);
+    del_nolock(shard, page);
+  }
+
+  // Removes a page from a shard; the caller holds the shard's lock
+  void del_nolock(CacheShard &shard, Page *page) {
     /* remove it from the list of all cached pages */
-    if (state.totallist.del(page) && page->is_allocated())
-      state.alloc_elements--;
+    if (shard.totallist.del(page) && page->is_allocated())
+      shard.alloc_elements--;
+    shard.probation.del(page);
 
     /* remove the page from the cache buckets */
     size_t hash = Impl::calc_hash(page->address());
-    state.buckets[hash].del(page);
+    shard.buckets[hash / state.num_shards].del(page);
   }
 
-  // Purges the cache. Implements a LRU eviction algorithm. Dirty pages are
-  // forwarded to the |processor()| for flushing.
+  // Removes a page from the cache because it was purged. With the 2Q
+  // policy, the addresses of purged probation pages are remembered in
+  // the ghost queue.
+  void evict(Page *page) {
+    assert(page->address() != 0);
+
+    CacheShard &shard = shard_of(Impl::calc_hash(page->address()));
+    ScopedSpinlock lock(shard.mutex);
+    if (shard.probation.has(page))
+      remember_ghost(shard, page->address());
+    del_nolock(shard, page);
+  }
+
+  // Purges the cache. Implements a LRU eviction algorithm (or 2Q, if
+  // enabled). Dirty pages are forwarded to the |processor()| for flushing.
   // The |ignore_page| is passed by the caller; this page will not be purged
   // under any circumstance. This is used by the PageManager to make sure
   // that the "last blob page" is not evicted by the cache.
+  //
+  // Each shard is purged independently as soon as it exceeds its share
+  // of the capacity.
   void purge_candidates(std::vector<uint64_t> &candidates,
                   std::vector<Page *> &garbage,
                   Page *ignore_page) {
-    int limit = (int)(current_elements()
-                      - (state.capacity_bytes / state.page_size_bytes));
-
-    Page *page = state.totallist.tail();
-    for (int i = 0; i < limit && page != 0; i++) {
-      if (page->mutex().try_lock()) {
-        if (page->cursor_list() == 0 && page != ignore_page) {
-          if (page->is_dirty())
-            candidates.push_back(page->address());
-          else
-            garbage.push_back(page);
+    for (size_t s = 0; s < state.num_shards; s++) {
+      CacheShard &shard = state.shards[s];
+      ScopedSpinlock lock(shard.mutex);
+
+      int limit = (int)shard.totallist.size() - (int)state.shard_capacity;
+      if (limit <= 0)
+        continue;
+
+      // 2Q: first purge the oldest pages of the probation queue, as long as
+      // the queue exceeds its share of the cache
+      if (state.policy == UPS_CACHE_POLICY_2Q) {
+        int excess = (int)shard.probation.size() - (int)state.probation_limit;
+        Page *page = shard.probation.tail();
+        for (int i = 0; i < excess && limit > 0 && page != 0; i++, limit--) {
+          select_purge_candidate(page, candidates, garbage, ignore_page);
+          page = page->previous(Page::kListCacheProbation);
         }
-        page->mutex().unlock();
       }
 
-      page = page->previous(Page::kListCache);
+      // then purge the least recently used pages; probation pages were
+      // already considered above
+      Page *page = shard.totallist.tail();
+      for (int i = 0; i < limit && page != 0; ) {
+        if (state.policy != UPS_CACHE_POLICY_2Q
+              || !shard.probation.has(page)) {
+          select_purge_candidate(page, candidates, garbage, ignore_page);
+          i++;
+        }
+
+        page = page->previous(Page::kListCache);
+      }
     }
   }
 
@@ -171,13 +255,17 @@ struct Cache
   // to flush (and delete) pages.
   template<typename Purger>
   void purge_if(Purger &purger) {
-    PurgeIfSelector<Purger> selector(this, purger);
-    state.totallist.extract(selector);
+    for (size_t s = 0; s < state.num_shards; s++) {
+      CacheShard &shard = state.shards[s];
+      ScopedSpinlock lock(shard.mutex);
+      PurgeIfSelector<Purger> selector(this, shard, purger);
+      shard.totallist.extract(selector);
+    }
   }
 
   // Returns true if the capacity limits are exceeded
-  bool is_cache_full() const {
-    return state.totallist.size() * state.page_size_bytes
+  bool is_cache_full() {
+    return current_elements() * state.page_size_bytes
             > state.capacity_bytes;
   }
 
@@ -187,17 +275,88 @@ struct Cache
   }
 
   // Returns the number of currently cached elements
-  size_t current_elements() const {
-    return state.totallist.size();
+  size_t current_elements() {
+    size_t size = 0;
+    for (size_t s = 0; s < state.num_shards; s++) {
+      ScopedSpinlock lock(state.shards[s].mutex);
+      size += state.shards[s].totallist.size();
+    }
+    return size;
   }
 
   // Returns the number of currently cached elements (excluding those that
   // are mmapped)
-  size_t allocated_elements() const {
-    return state.alloc_elements;
+  size_t allocated_elements() {
+    size_t size = 0;
+    for (size_t s = 0; s < state.num_shards; s++) {
+      ScopedSpinlock lock(state.shards[s].mutex);
+      size += state.shards[s].alloc_elements;
+    }
+    return size;
   }
 
   CacheState state;
+
+  private:
+    // Returns the shard which stores the pages with the specified |hash|
+    CacheShard &shard_of(size_t hash) {
+      return state.shards[hash % state.num_shards];
+    }
+
+    // Marks a page as "recently used". With LRU, the page is re-inserted
+    // at the head of the "totallist", and thus moved far away from the
+    // tail. The pages at the tail are highest candidates to be deleted
+    // when the cache is purged.
+    // With 2Q, pages in the probation queue are not moved.
+    void touch(CacheShard &shard, Page *page) {
+      if (state.policy == UPS_CACHE_POLICY_2Q && shard.probation.has(page))
+        return;
+      shard.totallist.del(page);
+      shard.totallist.put(page);
+    }
+
+    // Adds a page to the |candidates| (if it's dirty and needs to be
+    // flushed) or to the |garbage| (if it can be deleted immediately)
+    void select_purge_candidate(Page *page, std::vector<uint64_t> &candidates,
+                  std::vector<Page *> &garbage, Page *ignore_page) {
+      if (page->mutex().try_lock()) {
+        if (page->cursor_list() == 0 && page != ignore_page) {
+          if (page->is_dirty())
+            candidates.push_back(page->address());
+          else
+            garbage.push_back(page);
+        }
+        page->mutex().unlock();
+      }
+    }
+
+    // 2Q: stores the address of an evicted page in the ghost queue; the
+    // oldest addresses are dropped if the queue is full
+    void remember_ghost(CacheShard &shard, uint64_t address) {
+      uint64_t sequence = ++shard.ghost_sequence;
+      shard.ghost_map[address] = sequence;
+      shard.ghost_queue.push_back(std::make_pair(address, sequence));
+
+      while (shard.ghost_queue.size() > state.ghost_limit) {
+        std::pair<uint64_t, uint64_t> &front = shard.ghost_queue.front();
+        // only remove the map entry if it was not updated in the meantime
+        CacheShard::GhostMap::iterator it = shard.ghost_map.find(front.first);
+        if (it != shard.ghost_map.end() && it->second == front.second)
+          shard.ghost_map.erase(it);
+        shard.ghost_queue.pop_front();
+      }
+    }
+
+    // 2Q: removes an address from the ghost queue; returns true if the
+    // address was found (a "ghost hit")
+    bool forget_ghost(CacheShard &shard, uint64_t address) {
+      CacheShard::GhostMap::iterator it = shard.ghost_map.find(address);
+      if (it == shard.ghost_map.end())
+        return false;
+      shard.ghost_map.erase(it);
+      shard.ghost_hits++;
+      return true;
+    }
 };
 
 } // namespace upscaledb
@@ -21,10 +21,14 @@
 #include "0root/root.h"
 
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <map>
 
 #include "ups/types.h"
 
 // Always verify that a file of level N does not include headers > N!
+#include "1base/spinlock.h"
 #include "2page/page.h"
 #include "2page/page_collection.h"
 #include "2config/env_config.h"
@@ -35,23 +39,100 @@
 
 namespace upscaledb {
 
-struct CacheState
+// A single shard of the cache. Each shard manages the pages of a subset of
+// the hash buckets and has its own lock and its own replacement state.
+struct CacheShard
 {
   typedef PageCollection<Page::kListBucket> CacheLine;
 
+  // Maps the address of an evicted page to its sequence number in the
+  // ghost queue
+  typedef std::map<uint64_t, uint64_t> GhostMap;
+
+  CacheShard()
+    : alloc_elements(0), ghost_sequence(0), cache_hits(0), cache_misses(0),
+      ghost_hits(0) {
+  }
+
+  // protects all members of this shard
+  Spinlock mutex;
+
+  // the current number of cached elements that were allocated (and not
+  // mapped)
+  size_t alloc_elements;
+
+  // linked list of ALL cached pages of this shard
+  PageCollection<Page::kListCache> totallist;
+
+  // 2Q: the pages which were accessed only once since they were loaded;
+  // they are evicted in FIFO order before the pages in the |totallist|
+  PageCollection<Page::kListCacheProbation> probation;
+
+  // 2Q: the addresses of pages which were recently evicted from the
+  // |probation| queue, in FIFO order (with their sequence numbers)
+  std::deque<std::pair<uint64_t, uint64_t> > ghost_queue;
+
+  // 2Q: the same addresses, for fast lookups
+  GhostMap ghost_map;
+
+  // 2Q: the next sequence number for the |ghost_queue|
+  uint64_t ghost_sequence;
+
+  // The hash table buckets - each is a linked list of Page pointers
+  std::vector<CacheLine> buckets;
+
+  // counts the cache hits
+  uint64_t cache_hits;
+
+  // counts the cache misses
+  uint64_t cache_misses;
+
+  // 2Q: counts the misses of pages which were still in the |ghost_queue|
+  uint64_t ghost_hits;
+};
+
+struct CacheState
+{
   enum {
     // The number of buckets should be a prime number or similar, as it
     // is used in a MODULO hash scheme
     kBucketSize = 10317,
+
+    // The max. number of shards
+    kMaxShards = 16,
+
+    // The min. number of pages per shard; small caches are not sharded
+    kMinPagesPerShard = 64,
+
+    // 2Q: the share (in percent) of the cache which is used for the
+    // probation queue
+    kProbationPercent = 25,
+
+    // 2Q: the number of remembered ghost pages (in percent of the cache
+    // capacity)
+    kGhostPercent = 50,
   };
 
   CacheState(const EnvConfig &config)
     : capacity_bytes(ISSET(config.flags, UPS_CACHE_UNLIMITED)
                             ? std::numeric_limits<uint64_t>::max()
                             : config.cache_size_bytes),
-      page_size_bytes(config.page_size_bytes), alloc_elements(0),
-      buckets(kBucketSize), cache_hits(0), cache_misses(0) {
+      page_size_bytes(config.page_size_bytes),
+      policy(config.cache_policy) {
     assert(capacity_bytes > 0);
+    uint64_t capacity_pages = capacity_bytes / page_size_bytes;
+    num_shards = (size_t)std::min<uint64_t>(kMaxShards,
+                    std::max<uint64_t>(1, capacity_pages / kMinPagesPerShard));
+    shard_capacity = (size_t)std::min<uint64_t>(
+                    std::numeric_limits<size_t>::max(),
+                    capacity_pages / num_shards);
+    probation_limit = (size_t)std::max<uint64_t>(1,
+                    capacity_pages * kProbationPercent / 100 / num_shards);
+    ghost_limit = (size_t)std::max<uint64_t>(1,
+                    capacity_pages * kGhostPercent / 100 / num_shards);
+
+    for (size_t i = 0; i < num_shards; i++)
+      shards[i].buckets.resize(kBucketSize / num_shards + 1);
   }
 
   // the capacity (in bytes)
@@ -60,21 +141,23 @@ struct CacheState
   // the current page size (in bytes)
   uint64_t page_size_bytes;
 
-  // the current number of cached elements that were allocated (and not
-  // mapped)
-  size_t alloc_elements;
+  // the page replacement policy (UPS_CACHE_POLICY_*)
+  int policy;
 
-  // linked list of ALL cached pages
-  PageCollection<Page::kListCache> totallist;
+  // the number of shards that are in use
+  size_t num_shards;
 
-  // The hash table buckets - each is a linked list of Page pointers
-  std::vector<CacheLine> buckets;
+  // the capacity of a single shard (in pages)
+  size_t shard_capacity;
 
-  // counts the cache hits
-  uint64_t cache_hits;
+  // 2Q: the max. number of pages in the |probation| queue of a shard
+  size_t probation_limit;
 
-  // counts the cache misses
-  uint64_t cache_misses;
+  // 2Q: the max. number of addresses in the |ghost_queue| of a shard
+  size_t ghost_limit;
+
+  // the shards
+  CacheShard shards[kMaxShards];
 };
 
 } // namespace upscaledb
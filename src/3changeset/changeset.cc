@@ -19,6 +19,9 @@
 
 #include "0root/root.h"
 
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+
 // Always verify that a file of level N does not include headers > N!
 #include "1base/signal.h"
 #include "1errorinducer/errorinducer.h"
@@ -64,10 +67,24 @@ struct FlushChangesetVisitor
   std::vector<Page *> list;
 };
 
+struct PageAddressComparator
+{
+  bool operator()(const Page *lhs, const Page *rhs) const {
+    return lhs->address() < rhs->address();
+  }
+};
+
+// A Changeset is only split into multiple chunks if each chunk has at
+// least this many pages
+enum { kMinPagesPerChunk = 8 };
+
+// Counts the chunks of a Changeset which were not yet written
+typedef boost::shared_ptr<boost::atomic<size_t> > PendingCounter;
+
 static void
 async_flush_changeset(std::vector<Page *> list, Device *device,
                 Journal *journal, uint64_t lsn,
-                bool enable_fsync, int fd_index)
+                bool enable_fsync, int fd_index, PendingCounter pending)
 {
   std::vector<Page *>::iterator it = list.begin();
   for (; it != list.end(); it++) {
@@ -81,12 +98,28 @@ async_flush_changeset(std::vector<Page *> list, Device *device,
 
     if (likely(page->is_without_header() == false))
       page->set_lsn(lsn);
+  }
 
-    page->flush();
-    page->mutex().unlock();
+  // the pages are sorted by address; write each run of adjacent pages
+  // with a single (vectored) write
+  size_t i = 0;
+  while (i < list.size()) {
+    size_t j = i + 1;
+    while (j < list.size()
+            && list[j - 1]->address() + list[j - 1]->persisted_data.size
+                    == list[j]->address())
+      j++;
+
+    Page::flush(&list[i], j - i);
+    for (; i < j; i++)
+      list[i]->mutex().unlock();
     UPS_INDUCE_ERROR(ErrorInducer::kChangesetFlush);
   }
 
+  // the last chunk of this Changeset completes the flush
+  if (--*pending > 0)
+    return;
+
   /* flush the file handle (if required) */
   if (enable_fsync)
     device->flush();
@@ -134,11 +167,34 @@ Changeset::flush(uint64_t lsn)
   if (unlikely(g_CHANGESET_POST_LOG_HOOK != 0))
     g_CHANGESET_POST_LOG_HOOK();
 
-  /* The modified pages are now flushed (and unlocked) asynchronously. */
-  env->page_manager()->run_async(boost::bind(&async_flush_changeset,
-                          visitor.list, env->device(), env->journal(), lsn,
-                          ISSET(env->config().flags, UPS_ENABLE_FSYNC),
-                          fd_index));
+  /* The modified pages are now flushed (and unlocked) asynchronously.
+   * The pages are sorted by address and split into contiguous chunks,
+   * one per flusher thread. The journal only requires that all pages
+   * of this Changeset are written before it is notified. */
+  std::sort(visitor.list.begin(), visitor.list.end(),
+                  PageAddressComparator());
+
+  size_t chunks = std::min((size_t)env->page_manager()->flush_threads(),
+                  visitor.list.size() / kMinPagesPerChunk);
+  if (chunks == 0)
+    chunks = 1;
+
+  PendingCounter pending(new boost::atomic<size_t>(chunks));
+  bool enable_fsync = ISSET(env->config().flags, UPS_ENABLE_FSYNC);
+  size_t per_chunk = (visitor.list.size() + chunks - 1) / chunks;
+
+  std::vector<Page *>::iterator begin = visitor.list.begin();
+  for (size_t i = 0; i < chunks; i++) {
+    std::vector<Page *>::iterator end = begin;
+    std::advance(end, std::min(per_chunk,
+                  (size_t)std::distance(begin, visitor.list.end())));
+    env->page_manager()->run_async_parallel(boost::bind(
+                          &async_flush_changeset,
+                          std::vector<Page *>(begin, end), env->device(),
+                          env->journal(), lsn, enable_fsync, fd_index,
+                          pending));
+    begin = end;
+  }
 }
 
 } // namespace upscaledb
@@ -675,7 +675,10 @@ JournalState::JournalState(LocalEnvironment *env_)
   : env(env_), current_fd(0),
     threshold(env_->config().journal_switch_threshold),
     disable_logging(false), count_bytes_flushed(0),
-    count_bytes_before_compression(0), count_bytes_after_compression(0)
+    count_bytes_before_compression(0), count_bytes_after_compression(0),
+    group_commit_usec(env_->config().journal_group_commit_usec),
+    group_written(0), group_synced(0), group_has_leader(false),
+    count_group_commits(0), count_group_fsyncs(0)
 {
   if (threshold == 0)
     threshold = kSwitchTxnThreshold;
@@ -800,10 +803,73 @@ Journal::append_txn_commit(LocalTransaction *txn, uint64_t lsn)
 
   append_entry(state, idx, (uint8_t *)&entry, sizeof(entry));
 
+  // with group commit, the fsync is deferred till the leader of the group
+  // syncs all files (see wait_for_group_commit())
+  if (state.group_commit_usec > 0
+        && ISSET(state.env->get_flags(), UPS_ENABLE_FSYNC)) {
+    flush_buffer(state, idx);
+    ScopedLock lock(state.group_mutex);
+    state.group_written++;
+    return;
+  }
+
   // and flush the file
   flush_buffer(state, idx, ISSET(state.env->get_flags(), UPS_ENABLE_FSYNC));
 }
 
+uint64_t
+Journal::group_commit_ticket()
+{
+  ScopedLock lock(state.group_mutex);
+  return (state.group_written > state.group_synced ? state.group_written : 0);
+}
+
+void
+Journal::wait_for_group_commit(uint64_t ticket)
+{
+  ScopedLock lock(state.group_mutex);
+
+  while (state.group_synced < ticket) {
+    // someone else is already syncing; wait for the result. If the leader
+    // did not cover our ticket then we might become the next leader
+    if (state.group_has_leader) {
+      state.group_cond.wait(lock);
+      continue;
+    }
+
+    state.group_has_leader = true;
+    lock.unlock();
+
+    // give the other committers a chance to append their entries, then
+    // sync everything that was written so far
+    boost::this_thread::sleep(boost::posix_time::microseconds(
+                            state.group_commit_usec));
+
+    lock.lock();
+    uint64_t written = state.group_written;
+    lock.unlock();
+
+    try {
+      for (int i = 0; i < 2; i++)
+        if (state.files[i].is_open())
+          state.files[i].flush();
+    }
+    catch (Exception &) {
+      lock.lock();
+      state.group_has_leader = false;
+      state.group_cond.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    state.count_group_fsyncs++;
+    state.count_group_commits += written - state.group_synced;
+    state.group_synced = written;
+    state.group_has_leader = false;
+    state.group_cond.notify_all();
+  }
+}
+
 void
 Journal::append_insert(Database *db, LocalTransaction *txn,
                 ups_key_t *key, ups_record_t *record, uint32_t flags,
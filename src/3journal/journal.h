@@ -181,6 +181,16 @@ struct Journal
   // Appends a journal entry for ups_txn_commit/kEntryTypeTxnCommit
   void append_txn_commit(LocalTransaction *txn, uint64_t lsn);
 
+  // Returns a ticket for the most recent commit entry if it still has to
+  // be synced by a group commit, otherwise 0
+  uint64_t group_commit_ticket();
+
+  // Blocks till the commit entry of |ticket| was synced to disk. The first
+  // waiter becomes the leader, waits for more commits to arrive and then
+  // syncs all of them at once. Must not be called while holding the
+  // Environment mutex.
+  void wait_for_group_commit(uint64_t ticket);
+
   // Appends a journal entry for ups_insert/kEntryTypeInsert
   void append_insert(Database *db, LocalTransaction *txn,
                   ups_key_t *key, ups_record_t *record, uint32_t flags,
@@ -220,6 +230,10 @@ struct Journal
             = state.count_bytes_before_compression;
     metrics->journal_bytes_after_compression
             = state.count_bytes_after_compression;
+
+    ScopedLock lock(state.group_mutex);
+    metrics->journal_group_commits = state.count_group_commits;
+    metrics->journal_group_fsyncs = state.count_group_fsyncs;
   }
 
   // Flushes all buffers to disk. Used for testing.
@@ -26,6 +26,7 @@
 #include "ups/types.h" // for metrics
 
 #include "1base/dynamic_array.h"
+#include "1base/mutex.h"
 #include "1base/scoped_ptr.h"
 #include "1os/file.h"
 #include "2page/page_collection.h"
@@ -90,6 +91,31 @@ struct JournalState
 
   // The compressor; can be null
   ScopedPtr<Compressor> compressor;
+
+  // The time window for group commits (in microseconds); 0 if disabled
+  uint32_t group_commit_usec;
+
+  // Protects the group commit counters below; the Environment mutex
+  // is not held while waiting for a group commit
+  Mutex group_mutex;
+
+  // Signals the end of a group commit
+  Condition group_cond;
+
+  // Number of commit entries which were written to the files
+  uint64_t group_written;
+
+  // Number of commit entries which were synced to disk
+  uint64_t group_synced;
+
+  // True while a committer (the "leader") syncs the files for the group
+  bool group_has_leader;
+
+  // Counting the commits synced by group commits (for ups_env_get_metrics)
+  uint64_t count_group_commits;
+
+  // Counting the fsyncs of group commits (for ups_env_get_metrics)
+  uint64_t count_group_fsyncs;
 };
 
 } // namespace upscaledb
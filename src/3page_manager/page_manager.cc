@@ -372,7 +372,7 @@ PageManagerState::PageManagerState(LocalEnvironment *_env)
     state_page(0), last_blob_page(0), last_blob_page_id(0),
     page_count_fetched(0), page_count_index(0), page_count_blob(0),
     page_count_page_manager(0), cache_hits(0), cache_misses(0), message(0),
-    worker(new WorkerPool(1))
+    worker(new WorkerPool(config.flush_threads))
 {
 }
 
@@ -433,6 +433,19 @@ PageManager::fetch(Context *context, uint64_t address, uint32_t flags)
   return fetch_unlocked(state.get(), context, address, flags);
 }
 
+void
+PageManager::prefetch(uint64_t address)
+{
+  if (ISSET(state->config.flags, UPS_IN_MEMORY))
+    return;
+
+  // the cache has its own locks; the Device is not called while
+  // holding the PageManager's lock because it might block
+  if (address == 0 || state->cache.has(address))
+    return;
+  state->device->prefetch_page(address);
+}
+
 Page *
 PageManager::alloc(Context *context, uint32_t page_type, uint32_t flags)
 {
@@ -522,6 +535,9 @@ struct FlushAllPagesVisitor
 void
 PageManager::flush_all_pages()
 {
+  // wait till the pending Changesets are written
+  state->worker->wait_for_parallel();
+
   Signal signal;
   AsyncFlushMessage *message = new AsyncFlushMessage(this, state->device,
                                     &signal);
@@ -583,7 +599,7 @@ PageManager::purge_cache(Context *context)
     Page *page = *it;
     if (likely(page->mutex().try_lock())) {
       assert(page->cursor_list() == 0);
-      state->cache.del(page);
+      state->cache.evict(page);
       page->mutex().unlock();
       delete page;
     }
@@ -650,6 +666,9 @@ struct CloseDatabaseVisitor
 void
 PageManager::close_database(Context *context, LocalDatabase *db)
 {
+  // wait till the pending Changesets are written
+  state->worker->wait_for_parallel();
+
   Signal signal;
   AsyncFlushMessage *message = new AsyncFlushMessage(this, state->device,
                                     &signal);
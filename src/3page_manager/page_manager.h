@@ -87,6 +87,11 @@ struct PageManager
   // The page is locked and stored in |context->changeset|.
   Page *fetch(Context *context, uint64_t address, uint32_t flags = 0);
 
+  // Asks the Device to read a page in the background if it is not
+  // cached; a subsequent fetch() then does not have to wait for the disk.
+  // Used by the cursors to read the next leaf ahead during scans.
+  void prefetch(uint64_t address);
+
   // Allocates a new page. |page_type| is one of Page::kType* in page.h.
   // |flags| are either 0 or kClearWithZero
   // The page is locked and stored in |context->changeset|.
@@ -148,6 +153,18 @@ struct PageManager
     return state->worker->enqueue(message);
   }
 
+  // Adds a message to the worker's queue; the message can be processed
+  // in parallel to other messages
+  template<typename WorkerMessage>
+  void run_async_parallel(WorkerMessage message) {
+    return state->worker->enqueue_parallel(message);
+  }
+
+  // Returns the number of threads which flush pages in the background
+  size_t flush_threads() const {
+    return state->worker->num_threads();
+  }
+
   // Stores the state to disk. Returns the page-Id with the persisted state.
   // Exposed here because it's required by the unittests.
   uint64_t test_store_state();
@@ -25,6 +25,7 @@
 
 #include "0root/root.h"
 
+#include "1base/dynamic_array.h"
 #include "3changeset/changeset.h"
 
 namespace upscaledb {
@@ -38,7 +39,8 @@ struct Context
 {
   Context(LocalEnvironment *env, LocalTransaction *txn = 0,
                   LocalDatabase *db = 0)
-    : env(env), txn(txn), db(db), changeset(env) {
+    : env(env), txn(txn), db(db), changeset(env), key_arena(0),
+      record_arena(0) {
   }
 
   ~Context() {
@@ -51,6 +53,12 @@ struct Context
 
   // Each operation has its own changeset which stores all locked pages
   Changeset changeset;
+
+  // Optional memory arenas for scans; if null then the arenas of the
+  // database are used. Threads which scan in parallel require their own
+  // arenas.
+  ByteArray *key_arena;
+  ByteArray *record_arena;
 };
 
 } // namespace upscaledb
@@ -102,13 +102,16 @@ LocalCursor::update_dupecache(Context *context, uint32_t what)
     if (!node)
       return;
 
+    LocalTransaction *txn = (LocalTransaction *)get_txn();
+
     /* now start integrating the items from the transactions */
     op = node->get_oldest_op();
     while (op) {
-      Transaction *optxn = op->get_txn();
+      LocalTransaction *optxn = op->get_txn();
       /* collect all ops that are valid (even those that are
-       * from conflicting transactions) */
-      if (!optxn->is_aborted()) {
+       * from conflicting transactions), unless they are not part
+       * of the current snapshot */
+      if (!optxn->is_aborted() && !(txn && txn->hides(optxn))) {
         /* a normal (overwriting) insert will overwrite ALL dupes,
          * but an overwrite of a duplicate will only overwrite
          * an entry in the dupecache */
@@ -109,6 +109,10 @@ class Database
     virtual ups_status_t insert(Cursor *cursor, Transaction *txn,
                     ups_key_t *key, ups_record_t *record, uint32_t flags) = 0;
 
+    // Inserts a batch of sorted key/value pairs (ups_db_bulk_insert)
+    virtual ups_status_t bulk_insert(ups_key_t *keys, ups_record_t *records,
+                    uint32_t count, uint32_t fill_factor, uint32_t flags) = 0;
+
     // Erase a key/value pair (ups_db_erase, ups_cursor_erase)
     virtual ups_status_t erase(Cursor *cursor, Transaction *txn, ups_key_t *key,
                     uint32_t flags) = 0;
@@ -17,6 +17,9 @@
 
 #include "0root/root.h"
 
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
 // Always verify that a file of level N does not include headers > N!
 #include "1globals/callbacks.h"
 #include "3page_manager/page_manager.h"
@@ -24,9 +27,11 @@
 #include "3blob_manager/blob_manager.h"
 #include "3btree/btree_index.h"
 #include "3btree/btree_index_factory.h"
+#include "3btree/btree_readahead.h"
 #include "4db/db_local.h"
 #include "4context/context.h"
 #include "4cursor/cursor_local.h"
+#include "4env/env_local.h"
 #include "4txn/txn_local.h"
 #include "4txn/txn_cursor.h"
 #include "4uqi/statements.h"
@@ -273,8 +278,9 @@ LocalDatabase::is_key_erased(Context *context, ups_key_t *key)
   /* now traverse the tree, check if the key was erased */
   TransactionOperation *op = node->get_newest_op();
   while (op) {
-    Transaction *optxn = op->get_txn();
-    if (optxn->is_aborted())
+    LocalTransaction *optxn = op->get_txn();
+    if (optxn->is_aborted()
+        || (context->txn && context->txn->hides(optxn)))
       ; /* nop */
     else if (optxn->is_committed() || context->txn == optxn) {
       if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -330,8 +336,9 @@ retry:
   if (node)
     op = node->get_newest_op();
   while (op) {
-    Transaction *optxn = op->get_txn();
-    if (optxn->is_aborted())
+    LocalTransaction *optxn = op->get_txn();
+    if (optxn->is_aborted()
+        || (context->txn && context->txn->hides(optxn)))
       ; /* nop */
     else if (optxn->is_committed() || context->txn == optxn) {
       if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -610,6 +617,9 @@ LocalDatabase::create(Context *context, PBtreeHeader *btree_header)
   uint32_t persistent_flags = get_flags();
   persistent_flags &= ~(UPS_CACHE_UNLIMITED
             | UPS_DISABLE_MMAP
+            | UPS_ENABLE_IO_URING
+            | UPS_ENABLE_DIRECT_IO
+            | UPS_ENABLE_HUGE_PAGES
             | UPS_ENABLE_FSYNC
             | UPS_READ_ONLY
             | UPS_AUTO_RECOVERY
@@ -679,7 +689,9 @@ LocalDatabase::create(Context *context, PBtreeHeader *btree_header)
   /* initialize the btree */
   m_btree_index->create(context, btree_header, &m_config);
 
-  if (m_config.record_compressor) {
+  // numeric records are compressed in the leaf nodes, without a Compressor
+  if (m_config.record_compressor
+        && m_config.record_compressor != UPS_COMPRESSOR_NUMERIC) {
     m_record_compressor.reset(CompressorFactory::create(
                                     m_config.record_compressor));
   }
@@ -729,7 +741,8 @@ LocalDatabase::open(Context *context, PBtreeHeader *btree_header)
   }
 
   /* is record compression enabled? */
-  if (m_config.record_compressor) {
+  if (m_config.record_compressor
+        && m_config.record_compressor != UPS_COMPRESSOR_NUMERIC) {
     m_record_compressor.reset(CompressorFactory::create(
                                     m_config.record_compressor));
   }
@@ -1139,6 +1152,60 @@ LocalDatabase::insert(Cursor *hcursor, Transaction *txn, ups_key_t *key,
   }
 }
 
+ups_status_t
+LocalDatabase::bulk_insert(ups_key_t *keys, ups_record_t *records,
+            uint32_t count, uint32_t fill_factor, uint32_t flags)
+{
+  Context context(lenv(), 0, this);
+
+  try {
+    if (m_config.flags & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64)) {
+      ups_trace(("bulk insert is not supported for record number databases"));
+      return (UPS_INV_PARAMETER);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      if (m_config.key_size != UPS_KEY_SIZE_UNLIMITED
+          && keys[i].size != m_config.key_size) {
+        ups_trace(("invalid key size (%u instead of %u)",
+              keys[i].size, m_config.key_size));
+        return (UPS_INV_KEY_SIZE);
+      }
+      if (m_config.record_size != UPS_RECORD_SIZE_UNLIMITED
+          && records[i].size != m_config.record_size) {
+        ups_trace(("invalid record size (%u instead of %u)",
+              records[i].size, m_config.record_size));
+        return (UPS_INV_RECORD_SIZE);
+      }
+    }
+
+    /* the keys are written directly to the btree; all committed
+     * Transactions are flushed first, and no other Transaction must be
+     * active */
+    if (get_flags() & UPS_ENABLE_TRANSACTIONS) {
+      lenv()->txn_manager()->flush_committed_txns(&context);
+      if (lenv()->txn_manager()->get_oldest_txn() != 0) {
+        ups_trace(("bulk insert is not allowed while a Transaction "
+                   "is active"));
+        return (UPS_TXN_STILL_OPEN);
+      }
+    }
+
+    lenv()->page_manager()->purge_cache(&context);
+
+    ups_status_t st = m_btree_index->bulk_insert(&context, keys, records,
+                            count, fill_factor);
+
+    /* the whole batch is logged as a single changeset */
+    if (st == 0 && lenv()->journal())
+      context.changeset.flush(lenv()->next_lsn());
+    return (st);
+  }
+  catch (Exception &ex) {
+    return (ex.code);
+  }
+}
+
 ups_status_t
 LocalDatabase::erase(Cursor *hcursor, Transaction *txn, ups_key_t *key,
                 uint32_t flags)
@@ -1524,6 +1591,203 @@ are_cursors_identical(LocalCursor *c1, LocalCursor *c2)
   return (k1 == k2);
 }
 
+// A range of leafs which is scanned by one of the query threads
+struct ParallelScanRange
+{
+  ParallelScanRange(LocalDatabase *db_, SelectStatement *stmt_,
+                  ScanVisitor *visitor_, uint64_t first_leaf_,
+                  uint64_t end_leaf_, const ups_key_t *lo_key_,
+                  const ups_key_t *hi_key_)
+    : db(db_), stmt(stmt_), visitor(visitor_), first_leaf(first_leaf_),
+      end_leaf(end_leaf_), lo_key(lo_key_), hi_key(hi_key_), status(0) {
+  }
+
+  LocalDatabase *db;
+  SelectStatement *stmt;
+  ScanVisitor *visitor;
+
+  // the first leaf of this range
+  uint64_t first_leaf;
+
+  // the first leaf of the next range, or 0 if this is the last range
+  uint64_t end_leaf;
+
+  // the bounds of a built-in comparison of the keys; can be null
+  const ups_key_t *lo_key;
+  const ups_key_t *hi_key;
+
+  // the memory arenas of this thread
+  ByteArray key_arena;
+  ByteArray record_arena;
+
+  // the result of the scan
+  ups_status_t status;
+};
+
+// Scans a range of leafs. Runs in a query thread; exceptions must therefore
+// not escape.
+static void
+scan_leaf_range(ParallelScanRange *range)
+{
+  LocalDatabase *db = range->db;
+  BtreeIndex *btree = db->btree_index();
+  PageManager *page_manager = db->lenv()->page_manager();
+
+  Context context(db->lenv(), 0, db);
+  context.key_arena = &range->key_arena;
+  context.record_arena = &range->record_arena;
+
+  /* the leafs of the range are scanned sequentially */
+  BtreeReadahead readahead;
+
+  try {
+    uint64_t previous = 0;
+    uint64_t address = range->first_leaf;
+    while (address != 0 && address != range->end_leaf) {
+      Page *page = page_manager->fetch(&context, address,
+                      PageManager::kReadOnly);
+      readahead.advance(&context, btree, previous, page, true, true);
+      BtreeNodeProxy *node = btree->get_node_from_page(page);
+      previous = address;
+      address = node->right_sibling();
+
+      if (node->length() > 0) {
+        /* the remaining leafs are out of the range of the comparison? */
+        if (range->hi_key && node->compare(&context, range->hi_key, 0) < 0)
+          break;
+        /* skip the leaf if all keys are below the range */
+        if (!range->lo_key || node->compare(&context, range->lo_key,
+                                node->length() - 1) <= 0)
+          node->scan(&context, range->visitor, range->stmt, 0,
+                          range->stmt->distinct);
+      }
+
+      /* unlock the page; the next range might be scanned by another
+       * thread */
+      context.changeset.clear();
+    }
+  }
+  catch (Exception &ex) {
+    range->status = ex.code;
+  }
+}
+
+bool
+LocalDatabase::can_select_in_parallel(SelectStatement *stmt,
+                ScanVisitor *visitor)
+{
+  if (!lenv()->query_pool())
+    return (false);
+
+  /* duplicate keys and transactional keys require cursors */
+  if (ISSET(get_flags(), UPS_ENABLE_DUPLICATES))
+    return (false);
+  if (m_txn_index && m_txn_index->get_first())
+    return (false);
+
+  /* extended keys and records in blobs are read from blob pages which are
+   * shared by several leafs; they could be locked by more than one thread */
+  if (stmt->requires_keys && m_config.key_size == UPS_KEY_SIZE_UNLIMITED)
+    return (false);
+  if (stmt->requires_records
+        && !ISSET(m_config.flags, UPS_FORCE_RECORDS_INLINE))
+    return (false);
+
+  return (visitor->supports_merge());
+}
+
+ups_status_t
+LocalDatabase::select_range_parallel(SelectStatement *stmt,
+                ScanVisitor *visitor, Result **presult)
+{
+  WorkerPool *pool = lenv()->query_pool();
+  uint64_t lo_data = 0, hi_data = 0;
+  ups_key_t lo_key = {0};
+  ups_key_t hi_key = {0};
+  bool has_key_range = false;
+  std::vector<uint64_t> leafs;
+  std::vector<ParallelScanRange *> ranges;
+  ups_status_t st = 0;
+
+  Context context(lenv(), 0, this);
+
+  Result *result = new Result;
+
+  try {
+    /* purge cache if necessary */
+    lenv()->page_manager()->purge_cache(&context);
+
+    /* a built-in comparison of the keys skips the leafs which are out
+     * of range */
+    if (stmt->comparison.is_active()
+          && stmt->comparison.is_numeric()
+          && stmt->comparison.stream == UQI_STREAM_KEY) {
+      uint16_t size;
+      if (!stmt->comparison.bounds(&lo_data, &hi_data, &size))
+        goto bail;
+      lo_key = ups_make_key(&lo_data, size);
+      hi_key = ups_make_key(&hi_data, size);
+      has_key_range = true;
+    }
+
+    /* split the leafs into one range per thread; then release the pages,
+     * otherwise the query threads would block */
+    m_btree_index->partition_leafs(&context, pool->num_threads(), &leafs);
+    context.changeset.clear();
+
+    /* the first range uses |visitor|, all others get their own visitor */
+    for (size_t i = 0; i < leafs.size(); i++) {
+      ScanVisitor *v = visitor;
+      if (i > 0) {
+        v = ScanVisitorFactory::from_select(stmt, this);
+        if (!v) {
+          st = UPS_PARSER_ERROR;
+          goto bail;
+        }
+      }
+      ranges.push_back(new ParallelScanRange(this, stmt, v, leafs[i],
+                              i + 1 < leafs.size() ? leafs[i + 1] : 0,
+                              has_key_range ? &lo_key : 0,
+                              has_key_range ? &hi_key : 0));
+    }
+
+    for (size_t i = 0; i < ranges.size(); i++) {
+      boost::function<void ()> f = boost::bind(&scan_leaf_range, ranges[i]);
+      pool->enqueue_parallel(f);
+    }
+    pool->wait_for_parallel();
+
+    /* merge the partial results in the order of the keys */
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (!st)
+        st = ranges[i]->status;
+      if (!st && i > 0)
+        visitor->merge(ranges[i]->visitor);
+    }
+
+bail:
+    if (!st)
+      visitor->assign_result((uqi_result_t *)result);
+  }
+  catch (Exception &ex) {
+    st = ex.code;
+  }
+
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (i > 0)
+      delete ranges[i]->visitor;
+    delete ranges[i];
+  }
+
+  if (st) {
+    delete result;
+    return (st);
+  }
+
+  *presult = result;
+  return (0);
+}
+
 ups_status_t
 LocalDatabase::select_range(SelectStatement *stmt, LocalCursor *begin,
                 LocalCursor *end, Result **presult)
@@ -1533,6 +1797,9 @@ LocalDatabase::select_range(SelectStatement *stmt, LocalCursor *begin,
   int slot;
   ups_key_t key = {0};
   ups_record_t record = {0};
+  uint64_t lo_data = 0, hi_data = 0;
+  ups_key_t hi_key = {0};
+  bool has_key_range = false;
  
   LocalCursor *cursor = begin;
   if (cursor && cursor->is_nil())
@@ -1546,7 +1813,16 @@ LocalDatabase::select_range(SelectStatement *stmt, LocalCursor *begin,
   if (!visitor.get())
     return (UPS_PARSER_ERROR);
 
-  Context context(lenv(), 0, this);
+  /* without cursors the leafs can be scanned by several threads in
+   * parallel */
+  if (!begin && !end && can_select_in_parallel(stmt, visitor.get()))
+    return (select_range_parallel(stmt, visitor.get(), presult));
+
+  /* if the cursor is attached to a Transaction then use it; this allows
+   * queries on a consistent snapshot (see UPS_TXN_SNAPSHOT) */
+  Context context(lenv(), cursor
+                            ? (LocalTransaction *)cursor->get_txn()
+                            : 0, this);
 
   Result *result = new Result;
 
@@ -1554,10 +1830,30 @@ LocalDatabase::select_range(SelectStatement *stmt, LocalCursor *begin,
     /* purge cache if necessary */
     lenv()->page_manager()->purge_cache(&context);
 
-    /* create a cursor, move it to the first key */
+    /* a built-in comparison of the keys restricts the scan to the leafs
+     * in the range of the comparison. This is not done for paginated
+     * queries because they have to return the position of the last
+     * processed key in |begin|. */
+    if (!cursor && stmt->comparison.is_active()
+          && stmt->comparison.is_numeric()
+          && stmt->comparison.stream == UQI_STREAM_KEY) {
+      uint16_t size;
+      if (!stmt->comparison.bounds(&lo_data, &hi_data, &size))
+        goto bail;
+      hi_key = ups_make_key(&hi_data, size);
+      key = ups_make_key(&lo_data, size);
+      has_key_range = true;
+    }
+
+    /* create a cursor, move it to the first key (or to the first key in
+     * the range of the comparison) */
     if (!cursor) {
       cursor = (LocalCursor *)cursor_create_impl(0);
-      st = cursor_move_impl(&context, cursor, &key, &record, UPS_CURSOR_FIRST);
+      if (has_key_range)
+        st = find(cursor, 0, &key, &record, UPS_FIND_GEQ_MATCH);
+      else
+        st = cursor_move_impl(&context, cursor, &key, &record,
+                        UPS_CURSOR_FIRST);
       if (st)
         goto bail;
     }
@@ -1642,6 +1938,12 @@ LocalDatabase::select_range(SelectStatement *stmt, LocalCursor *begin,
       /* fastest code path */
       if (use_cursors == false) {
         node->scan(&context, visitor.get(), stmt, slot, stmt->distinct);
+        /* the remaining leafs are out of the range of the comparison? */
+        if (has_key_range && node->length() > 0
+              && node->compare(&context, &hi_key, node->length() - 1) < 0) {
+          st = 0;
+          goto bail;
+        }
         st = cursor->get_btree_cursor()->move_to_next_page(&context);
         if (st == UPS_KEY_NOT_FOUND)
           break;
@@ -115,6 +115,10 @@ class LocalDatabase : public Database {
     virtual ups_status_t insert(Cursor *cursor, Transaction *txn,
                     ups_key_t *key, ups_record_t *record, uint32_t flags);
 
+    // Inserts a batch of sorted key/value pairs (ups_db_bulk_insert)
+    virtual ups_status_t bulk_insert(ups_key_t *keys, ups_record_t *records,
+                    uint32_t count, uint32_t fill_factor, uint32_t flags);
+
     // Erase a key/value pair (ups_db_erase, ups_cursor_erase)
     virtual ups_status_t erase(Cursor *cursor, Transaction *txn, ups_key_t *key,
                     uint32_t flags);
@@ -204,6 +208,16 @@ class LocalDatabase : public Database {
     // Returns true if this database is modified by an active transaction
     bool is_modified_by_active_transaction();
 
+    // Returns true if a query can be executed by several threads in
+    // parallel (see select_range_parallel())
+    bool can_select_in_parallel(SelectStatement *stmt, ScanVisitor *visitor);
+
+    // Performs a range select over the whole Database; the leafs are split
+    // into ranges which are scanned by the Environment's query threads.
+    // |visitor| receives the merged result.
+    ups_status_t select_range_parallel(SelectStatement *stmt,
+                    ScanVisitor *visitor, Result **result);
+
     // Returns true if a (btree) key was erased in a Transaction
     bool is_key_erased(Context *context, ups_key_t *key);
 
@@ -242,7 +242,10 @@ Environment::txn_commit(Transaction *txn, uint32_t flags)
 {
   try {
     ScopedLock lock(m_mutex);
-    return (do_txn_commit(txn, flags));
+    ups_status_t st = do_txn_commit(txn, flags);
+    if (st == 0)
+      st = do_txn_sync(lock);
+    return (st);
   }
   catch (Exception &ex) {
     return (ex.code);
@@ -190,6 +190,12 @@ class Environment
     // Commits a transaction (ups_txn_commit)
     virtual ups_status_t do_txn_commit(Transaction *txn, uint32_t flags) = 0;
 
+    // Waits till a committed transaction is durable; called after
+    // do_txn_commit(). Implementations can release |lock| while waiting.
+    virtual ups_status_t do_txn_sync(ScopedLock &) {
+      return (0);
+    }
+
     // Commits a transaction (ups_txn_abort)
     virtual ups_status_t do_txn_abort(Transaction *txn, uint32_t flags) = 0;
 
@@ -433,6 +433,21 @@ LocalEnvironment::do_get_parameters(ups_parameter_t *param)
       case UPS_PARAM_POSIX_FADVISE:
         p->value = m_config.posix_advice;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        p->value = m_config.cache_policy;
+        break;
+      case UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC:
+        p->value = m_config.journal_group_commit_usec;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        p->value = m_config.flush_threads;
+        break;
+      case UPS_PARAM_QUERY_THREADS:
+        p->value = m_config.query_threads;
+        break;
+      case UPS_PARAM_SCAN_READAHEAD:
+        p->value = m_config.scan_readahead;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)p->name));
         return (UPS_INV_PARAMETER);
@@ -477,14 +492,16 @@ LocalEnvironment::do_create_db(Database **pdb, DbConfig &config,
     for (; param->name; param++) {
       switch (param->name) {
         case UPS_PARAM_RECORD_COMPRESSION:
-          if (!CompressorFactory::is_available(param->value)) {
+          if (param->value != UPS_COMPRESSOR_NUMERIC
+                && !CompressorFactory::is_available(param->value)) {
             ups_trace(("unknown algorithm for record compression"));
             return (UPS_INV_PARAMETER);
           }
           config.record_compressor = (int)param->value;
           break;
         case UPS_PARAM_KEY_COMPRESSION:
-          if (!CompressorFactory::is_available(param->value)) {
+          if (param->value != UPS_COMPRESSOR_PREFIX
+                && !CompressorFactory::is_available(param->value)) {
             ups_trace(("unknown algorithm for key compression"));
             return (UPS_INV_PARAMETER);
           }
@@ -585,11 +602,26 @@ LocalEnvironment::do_create_db(Database **pdb, DbConfig &config,
     }
   }
 
-  // all heavy-weight compressors are only allowed for
-  // variable-length binary keys
+  // uint64 compression is only allowed for uint64-keys
+  if (config.key_compressor == UPS_COMPRESSOR_UINT64_FOR
+      || config.key_compressor == UPS_COMPRESSOR_UINT64_STREAMVBYTE) {
+    if (config.key_type != UPS_TYPE_UINT64) {
+      ups_trace(("Uint64 compression only allowed for uint64 keys "
+                 "(UPS_TYPE_UINT64)"));
+      return (UPS_INV_PARAMETER);
+    }
+    if (m_config.page_size_bytes != 16 * 1024) {
+      ups_trace(("Uint64 compression only allowed for page size of 16k"));
+      return (UPS_INV_PARAMETER);
+    }
+  }
+
+  // all heavy-weight compressors and the prefix compression are only
+  // allowed for variable-length binary keys
   if (config.key_compressor == UPS_COMPRESSOR_LZF
         || config.key_compressor == UPS_COMPRESSOR_SNAPPY
-        || config.key_compressor == UPS_COMPRESSOR_ZLIB) {
+        || config.key_compressor == UPS_COMPRESSOR_ZLIB
+        || config.key_compressor == UPS_COMPRESSOR_PREFIX) {
     if (config.key_type != UPS_TYPE_BINARY
           || config.key_size != UPS_KEY_SIZE_UNLIMITED) {
       ups_trace(("Key compression only allowed for unlimited binary keys "
@@ -598,6 +630,26 @@ LocalEnvironment::do_create_db(Database **pdb, DbConfig &config,
     }
   }
 
+  // numeric record compression is only allowed for numeric records
+  // without duplicates
+  if (config.record_compressor == UPS_COMPRESSOR_NUMERIC) {
+    if (config.record_type != UPS_TYPE_UINT8
+          && config.record_type != UPS_TYPE_UINT16
+          && config.record_type != UPS_TYPE_UINT32
+          && config.record_type != UPS_TYPE_UINT64
+          && config.record_type != UPS_TYPE_REAL32
+          && config.record_type != UPS_TYPE_REAL64) {
+      ups_trace(("Numeric record compression only allowed for numeric "
+                 "record types"));
+      return (UPS_INV_PARAMETER);
+    }
+    if (config.flags & UPS_ENABLE_DUPLICATE_KEYS) {
+      ups_trace(("Numeric record compression not allowed in combination "
+                 "with UPS_ENABLE_DUPLICATE_KEYS"));
+      return (UPS_INV_PARAMETER);
+    }
+  }
+
   uint32_t mask = UPS_FORCE_RECORDS_INLINE
                     | UPS_ENABLE_DUPLICATE_KEYS
                     | UPS_IGNORE_MISSING_CALLBACK
@@ -836,6 +888,22 @@ LocalEnvironment::do_txn_commit(Transaction *txn, uint32_t flags)
   return (m_txn_manager->commit(txn, flags));
 }
 
+ups_status_t
+LocalEnvironment::do_txn_sync(ScopedLock &lock)
+{
+  if (!m_journal)
+    return (0);
+
+  uint64_t ticket = m_journal->group_commit_ticket();
+  if (ticket == 0)
+    return (0);
+
+  // other threads can proceed (and join the group) while this one waits
+  lock.unlock();
+  m_journal->wait_for_group_commit(ticket);
+  return (0);
+}
+
 ups_status_t
 LocalEnvironment::do_txn_abort(Transaction *txn, uint32_t flags)
 {
@@ -847,6 +915,9 @@ LocalEnvironment::do_close(uint32_t flags)
 {
   Context context(this);
 
+  /* stop the query threads */
+  m_query_pool.reset();
+
   /* flush all committed transactions */
   if (m_txn_manager)
     m_txn_manager->flush_committed_txns(&context);
@@ -885,6 +956,8 @@ LocalEnvironment::do_fill_metrics(ups_env_metrics_t *metrics) const
 {
   // PageManager metrics (incl. cache and freelist)
   m_page_manager->fill_metrics(metrics);
+  // the Device (i.e. io_uring statistics)
+  m_device->fill_metrics(metrics);
   // the BlobManagers
   m_blob_manager->fill_metrics(metrics);
   // the Journal (if available)
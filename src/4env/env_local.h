@@ -30,6 +30,7 @@
 // Always verify that a file of level N does not include headers > N!
 #include "1base/scoped_ptr.h"
 #include "2lsn_manager/lsn_manager.h"
+#include "2worker/worker.h"
 #include "3journal/journal.h"
 #include "4env/env.h"
 #include "4env/env_header.h"
@@ -98,6 +99,15 @@ class LocalEnvironment : public Environment
       return (m_lsn_manager.next());
     }
 
+    // Returns the threads which execute UQI queries in parallel; they are
+    // started with the first query. Returns null if queries are not
+    // parallelized (see UPS_PARAM_QUERY_THREADS).
+    WorkerPool *query_pool() {
+      if (!m_query_pool && m_config.query_threads > 1)
+        m_query_pool.reset(new WorkerPool(m_config.query_threads));
+      return (m_query_pool.get());
+    }
+
     // Performs a UQI select
     virtual ups_status_t select_range(const char *query, Cursor *begin,
                             const Cursor *end, Result **result);
@@ -145,6 +155,9 @@ class LocalEnvironment : public Environment
     // Commits a transaction (ups_txn_commit)
     virtual ups_status_t do_txn_commit(Transaction *txn, uint32_t flags);
 
+    // Waits for the journal's group commit (if enabled)
+    virtual ups_status_t do_txn_sync(ScopedLock &lock);
+
     // Commits a transaction (ups_txn_abort)
     virtual ups_status_t do_txn_abort(Transaction *txn, uint32_t flags);
 
@@ -195,6 +208,9 @@ class LocalEnvironment : public Environment
 
     // The lsn manager
     LsnManager m_lsn_manager;
+
+    // The threads for parallel UQI queries
+    ScopedPtr<WorkerPool> m_query_pool;
 };
 
 } // namespace upscaledb
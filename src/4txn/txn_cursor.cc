@@ -97,7 +97,8 @@ ups_status_t
 TransactionCursor::move_top_in_node(TransactionNode *node,
         TransactionOperation *op, bool ignore_conflicts, uint32_t flags)
 {
-  Transaction *optxn = 0;
+  LocalTransaction *optxn = 0;
+  LocalTransaction *txn = (LocalTransaction *)m_parent->get_txn();
 
   if (!op)
     op = node->get_newest_op();
@@ -106,9 +107,13 @@ TransactionCursor::move_top_in_node(TransactionNode *node,
 
   while (op) {
     optxn = op->get_txn();
+    /* a snapshot ignores everything that was not yet committed when
+     * the snapshot was taken */
+    if (txn && txn->hides(optxn))
+      ; /* nop */
     /* only look at ops from the current transaction and from
      * committed transactions */
-    if (optxn == m_parent->get_txn() || optxn->is_committed()) {
+    else if (optxn == txn || optxn->is_committed()) {
       /* a normal (overwriting) insert will return this key */
       if ((op->get_flags() & TransactionOperation::kInsert)
           || (op->get_flags() & TransactionOperation::kInsertOverwrite)) {
@@ -162,7 +167,16 @@ TransactionCursor::move(uint32_t flags)
     node = get_db()->txn_index()->get_first();
     if (!node)
       return (UPS_KEY_NOT_FOUND);
-    return (move_top_in_node(node, 0, false, flags));
+
+    /* skip nodes which are completely invisible in a snapshot */
+    while (1) {
+      st = move_top_in_node(node, 0, false, flags);
+      if (st != UPS_KEY_NOT_FOUND)
+        return (st);
+      node = node->get_next_sibling();
+      if (!node)
+        return (UPS_KEY_NOT_FOUND);
+    }
   }
   else if (flags & UPS_CURSOR_LAST) {
     /* first set cursor to nil */
@@ -171,7 +185,16 @@ TransactionCursor::move(uint32_t flags)
     node = get_db()->txn_index()->get_last();
     if (!node)
       return (UPS_KEY_NOT_FOUND);
-    return (move_top_in_node(node, 0, false, flags));
+
+    /* skip nodes which are completely invisible in a snapshot */
+    while (1) {
+      st = move_top_in_node(node, 0, false, flags);
+      if (st != UPS_KEY_NOT_FOUND)
+        return (st);
+      node = node->get_previous_sibling();
+      if (!node)
+        return (UPS_KEY_NOT_FOUND);
+    }
   }
   else if (flags & UPS_CURSOR_NEXT) {
     if (is_nil())
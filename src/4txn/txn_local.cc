@@ -220,12 +220,17 @@ LocalTransactionManager::LocalTransactionManager(Environment *env)
 LocalTransaction::LocalTransaction(LocalEnvironment *env, const char *name,
         uint32_t flags)
   : Transaction(env, name, flags), m_log_desc(0), m_oldest_op(0),
-    m_newest_op(0), m_op_counter(0), m_accum_data_size(0)
+    m_newest_op(0), m_op_counter(0), m_accum_data_size(0),
+    m_snapshot_lsn(0), m_commit_lsn(0)
 {
   LocalTransactionManager *ltm = 
         (LocalTransactionManager *)env->txn_manager();
   m_id = ltm->get_incremented_txn_id();
 
+  /* a snapshot sees all Transactions which committed with a lower lsn */
+  if (flags & UPS_TXN_SNAPSHOT)
+    m_snapshot_lsn = env->lsn_manager()->current;
+
   /* append journal entry */
   if (env->journal() && !(flags & UPS_TXN_TEMPORARY)) {
     env->journal()->append_txn_begin(this, name, env->next_lsn());
@@ -406,7 +411,7 @@ struct KeyCounter : public TransactionIndex::Visitor
     op = node->get_newest_op();
     while (op) {
       LocalTransaction *optxn = op->get_txn();
-      if (optxn->is_aborted())
+      if (optxn->is_aborted() || (txn && txn->hides(optxn)))
         ; // nop
       else if (optxn->is_committed() || txn == optxn) {
         if (op->get_flags() & TransactionOperation::kIsFlushed)
@@ -484,9 +489,12 @@ LocalTransactionManager::commit(Transaction *htxn, uint32_t flags)
   try {
     txn->commit(flags);
 
+    /* the commit lsn decides whether snapshots can see this Transaction */
+    txn->set_commit_lsn(lenv()->next_lsn());
+
     /* append journal entry */
     if (lenv()->journal() && !(txn->get_flags() & UPS_TXN_TEMPORARY))
-      lenv()->journal()->append_txn_commit(txn, lenv()->next_lsn());
+      lenv()->journal()->append_txn_commit(txn, txn->get_commit_lsn());
 
     /* flush committed transactions */
     maybe_flush_committed_txns(&context);
@@ -547,10 +555,18 @@ LocalTransactionManager::flush_committed_txns_impl(Context *context)
 
   assert(context->changeset.is_empty());
 
+  /* Transactions which committed after the oldest active snapshot was
+   * taken must stay in the TransactionIndex, otherwise the snapshot would
+   * see their changes in the btree */
+  uint64_t snapshot_lsn = get_oldest_snapshot_lsn();
+
   /* always get the oldest transaction; if it was committed: flush
    * it; if it was aborted: discard it; otherwise return */
   while ((oldest = (LocalTransaction *)get_oldest_txn())) {
     if (oldest->is_committed()) {
+      if (snapshot_lsn && oldest->get_commit_lsn() >= snapshot_lsn)
+        break;
+
       uint64_t lsn = flush_txn(context, (LocalTransaction *)oldest);
       if (lsn > highest_lsn)
         highest_lsn = lsn;
@@ -580,6 +596,21 @@ LocalTransactionManager::flush_committed_txns_impl(Context *context)
   assert(context->changeset.is_empty());
 }
 
+uint64_t
+LocalTransactionManager::get_oldest_snapshot_lsn()
+{
+  uint64_t lsn = 0;
+
+  for (Transaction *t = get_oldest_txn(); t != 0; t = t->get_next()) {
+    if (t->is_committed() || t->is_aborted())
+      continue;
+    uint64_t snapshot_lsn = ((LocalTransaction *)t)->get_snapshot_lsn();
+    if (snapshot_lsn && (lsn == 0 || snapshot_lsn < lsn))
+      lsn = snapshot_lsn;
+  }
+  return (lsn);
+}
+
 uint64_t
 LocalTransactionManager::flush_txn(Context *context, LocalTransaction *txn)
 {
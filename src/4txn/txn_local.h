@@ -386,7 +386,8 @@ class LocalTransaction : public Transaction
 {
   public:
     // Constructor; "begins" the Transaction
-    // supported flags: UPS_TXN_READ_ONLY, UPS_TXN_TEMPORARY
+    // supported flags: UPS_TXN_READ_ONLY, UPS_TXN_TEMPORARY,
+    // UPS_TXN_SNAPSHOT
     LocalTransaction(LocalEnvironment *env, const char *name, uint32_t flags);
 
     // Destructor; frees all TransactionOperation structures associated
@@ -436,6 +437,32 @@ class LocalTransaction : public Transaction
       return (m_accum_data_size);
     }
 
+    // Returns the lsn of the snapshot, or 0 if this is not a snapshot
+    // Transaction (see UPS_TXN_SNAPSHOT)
+    uint64_t get_snapshot_lsn() const {
+      return (m_snapshot_lsn);
+    }
+
+    // Returns the lsn which was assigned when this Transaction committed
+    uint64_t get_commit_lsn() const {
+      return (m_commit_lsn);
+    }
+
+    // Sets the lsn which was assigned when this Transaction committed
+    void set_commit_lsn(uint64_t lsn) {
+      m_commit_lsn = lsn;
+    }
+
+    // Returns true if this is a snapshot Transaction and the operations of
+    // |other| are not part of the snapshot, because |other| was still
+    // active (or not even started) when the snapshot was taken
+    bool hides(const LocalTransaction *other) const {
+      return (m_snapshot_lsn != 0
+              && other != this
+              && (!other->is_committed()
+                  || other->m_commit_lsn >= m_snapshot_lsn));
+    }
+
   private:
     friend struct Journal;
     friend struct TxnFixture;
@@ -471,6 +498,12 @@ class LocalTransaction : public Transaction
     // The approximate accumulated memory consumed by this Transaction
     // (sums up key->size and record->size over all operations)
     int m_accum_data_size;
+
+    // The lsn of the snapshot; only set for UPS_TXN_SNAPSHOT
+    uint64_t m_snapshot_lsn;
+
+    // The lsn which was assigned when this Transaction committed
+    uint64_t m_commit_lsn;
 };
 
 
@@ -516,6 +549,10 @@ class LocalTransactionManager : public TransactionManager
   private:
     void flush_committed_txns_impl(Context *context);
 
+    // Returns the lsn of the oldest active snapshot Transaction, or 0
+    // if there is none
+    uint64_t get_oldest_snapshot_lsn();
+
     // Flushes a single committed Transaction; returns the lsn of the
     // last operation in this transaction
     uint64_t flush_txn(Context *context, LocalTransaction *txn);
@@ -153,6 +153,29 @@ struct AverageIfScanVisitor : public NumericalScanVisitor {
     }
   }
 
+  // Operates on keys and records which already passed the predicate
+  virtual void prefiltered(const void *key_data, const void *record_data,
+                  size_t length) {
+    if (ISSET(statement->function.flags, UQI_STREAM_KEY)) {
+      typename Key::type *it = (typename Key::type *)key_data;
+      typename Key::type *end = it + length;
+      for (; it != end; it++)
+        sum += *it;
+    }
+    else {
+      typename Record::type *it = (typename Record::type *)record_data;
+      typename Record::type *end = it + length;
+      for (; it != end; it++)
+        sum += *it;
+    }
+    count += length;
+  }
+
+  // Only the aggregated stream is required
+  virtual uint32_t prefiltered_streams() const {
+    return (statement->function.flags);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     double avg = sum / (double)count;
@@ -0,0 +1,545 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Built-in comparison predicates for the WHERE clause, i.e.
+ * "WHERE between($key, 10, 20)" or "WHERE $record > 5".
+ *
+ * All numeric comparisons are converted to a closed interval [lo, hi] of
+ * the compared stream's type. The btree uses this interval to skip leafs
+ * and compressed blocks which cannot contain matching keys. Arrays of
+ * keys or records are filtered with SIMD instructions; the positions of
+ * the matching rows are stored in a selection vector.
+ *
+ * "starts_with" compares binary keys or records with a prefix.
+ *
+ * @thread_safe: no
+ * @exception_safe: nothrow
+ */
+
+#ifndef UPS_UPSCALEDB_COMPARISON_H
+#define UPS_UPSCALEDB_COMPARISON_H
+
+#include "0root/root.h"
+
+#include <math.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <limits>
+
+#include "ups/upscaledb_uqi.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/dynamic_array.h"
+#ifdef __SSE__
+#  include "2simd/simd.h"
+#endif
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+struct ComparisonPredicate {
+  enum {
+    kNone = 0,
+    kEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kBetween,
+    kStartsWith
+  };
+
+  ComparisonPredicate()
+    : op(kNone), stream(0), type(UPS_TYPE_BINARY), is_empty(true),
+      ulo(0), uhi(0), dlo(0), dhi(0) {
+  }
+
+  // Returns the operator of a built-in predicate (i.e. "between"), or
+  // kNone if |name| is not a built-in predicate
+  static int lookup(const std::string &name) {
+    if (name == "eq")
+      return (kEqual);
+    if (name == "lt")
+      return (kLess);
+    if (name == "le")
+      return (kLessEqual);
+    if (name == "gt")
+      return (kGreater);
+    if (name == "ge")
+      return (kGreaterEqual);
+    if (name == "between")
+      return (kBetween);
+    if (name == "starts_with")
+      return (kStartsWith);
+    return (kNone);
+  }
+
+  // Returns true if the WHERE clause is a built-in comparison
+  bool is_active() const {
+    return (op != kNone);
+  }
+
+  // Returns true if the compared values are numbers; only then is the
+  // comparison an interval
+  bool is_numeric() const {
+    return (op != kStartsWith);
+  }
+
+  // Returns the number of arguments which are expected by |op|
+  size_t expected_arguments() const {
+    return (op == kBetween ? 2 : 1);
+  }
+
+  // Converts the arguments to an interval of the stream's |type|. Returns
+  // false if the type is not numeric or if an argument is not a number.
+  // "starts_with" requires a binary stream.
+  bool bind(int new_type) {
+    type = new_type;
+    if (arguments.size() != expected_arguments())
+      return (false);
+
+    if (op == kStartsWith) {
+      is_empty = false;
+      return (type == UPS_TYPE_BINARY || type == UPS_TYPE_CUSTOM);
+    }
+    if (type == UPS_TYPE_BINARY || type == UPS_TYPE_CUSTOM)
+      return (false);
+
+    Bound a, b;
+    if (!a.parse(arguments[0]))
+      return (false);
+    if (op == kBetween && !b.parse(arguments[1]))
+      return (false);
+
+    switch (type) {
+      case UPS_TYPE_UINT8:
+        return (bind_integer(a, b, std::numeric_limits<uint8_t>::max()));
+      case UPS_TYPE_UINT16:
+        return (bind_integer(a, b, std::numeric_limits<uint16_t>::max()));
+      case UPS_TYPE_UINT32:
+        return (bind_integer(a, b, std::numeric_limits<uint32_t>::max()));
+      case UPS_TYPE_UINT64:
+        return (bind_integer(a, b, std::numeric_limits<uint64_t>::max()));
+      case UPS_TYPE_REAL32:
+      case UPS_TYPE_REAL64:
+        return (bind_real(a, b));
+      default:
+        return (false);
+    }
+  }
+
+  // Returns the bounds of the interval; returns false if the interval is
+  // empty. |T| must be the type which was passed to bind().
+  template<typename T>
+  bool bounds(T *lo, T *hi) const {
+    if (is_empty)
+      return (false);
+    assign(lo, hi);
+    return (true);
+  }
+
+  // Copies the bounds of the interval to |lo| and |hi| (each at least 8
+  // bytes) and their size to |size|; returns false if the interval is
+  // empty
+  bool bounds(void *lo, void *hi, uint16_t *size) const {
+    switch (type) {
+      case UPS_TYPE_UINT8:
+        return (copy_bounds<uint8_t>(lo, hi, size));
+      case UPS_TYPE_UINT16:
+        return (copy_bounds<uint16_t>(lo, hi, size));
+      case UPS_TYPE_UINT32:
+        return (copy_bounds<uint32_t>(lo, hi, size));
+      case UPS_TYPE_UINT64:
+        return (copy_bounds<uint64_t>(lo, hi, size));
+      case UPS_TYPE_REAL32:
+        return (copy_bounds<float>(lo, hi, size));
+      case UPS_TYPE_REAL64:
+        return (copy_bounds<double>(lo, hi, size));
+      default:
+        return (false);
+    }
+  }
+
+  // Returns true if |data| (the value of the compared stream) is accepted
+  bool matches(const void *data, uint32_t size) const {
+    if (op == kStartsWith) {
+      const std::string &prefix = arguments[0];
+      return (size >= prefix.size()
+                && ::memcmp(data, prefix.data(), prefix.size()) == 0);
+    }
+
+    switch (type) {
+      case UPS_TYPE_UINT8:
+        return (matches_integer(*(const uint8_t *)data));
+      case UPS_TYPE_UINT16:
+        return (matches_integer(*(const uint16_t *)data));
+      case UPS_TYPE_UINT32:
+        return (matches_integer(*(const uint32_t *)data));
+      case UPS_TYPE_UINT64:
+        return (matches_integer(*(const uint64_t *)data));
+      case UPS_TYPE_REAL32:
+        return (matches_real(*(const float *)data));
+      case UPS_TYPE_REAL64:
+        return (matches_real(*(const double *)data));
+      default:
+        return (false);
+    }
+  }
+
+  // Stores the positions of the accepted values of |array| (|length|
+  // values of |size| bytes each) in |selection| and returns their number.
+  // |selection| must have room for |length| + 16 positions.
+  size_t select(const void *array, uint32_t size, size_t length,
+                  uint32_t *selection) const {
+    switch (type) {
+      case UPS_TYPE_UINT8:
+        return (select_range<uint8_t>(array, length, selection));
+      case UPS_TYPE_UINT16:
+        return (select_range<uint16_t>(array, length, selection));
+      case UPS_TYPE_UINT32:
+        return (select_range<uint32_t>(array, length, selection));
+      case UPS_TYPE_UINT64:
+        return (select_range<uint64_t>(array, length, selection));
+      case UPS_TYPE_REAL32:
+        return (select_range<float>(array, length, selection));
+      case UPS_TYPE_REAL64:
+        return (select_range<double>(array, length, selection));
+      default: {
+        const uint8_t *p = (const uint8_t *)array;
+        size_t n = 0;
+        for (size_t i = 0; i < length; i++, p += size) {
+          selection[n] = (uint32_t)i;
+          n += matches(p, size);
+        }
+        return (n);
+      }
+    }
+  }
+
+  // The operator; one of the enum values above
+  int op;
+
+  // The compared stream (UQI_STREAM_KEY or UQI_STREAM_RECORD)
+  uint32_t stream;
+
+  // The unparsed arguments
+  std::vector<std::string> arguments;
+
+  // The type of the compared stream; set in bind()
+  int type;
+
+  // True if no value can match
+  bool is_empty;
+
+  // The interval for integer types
+  uint64_t ulo, uhi;
+
+  // The interval for floating point types
+  double dlo, dhi;
+
+ private:
+  // A parsed argument; integers are stored without loss of precision
+  struct Bound {
+    Bound()
+      : is_integer(false), u(0), d(0) {
+    }
+
+    bool parse(const std::string &s) {
+      const char *p = s.c_str();
+      char *end;
+      errno = 0;
+      d = ::strtod(p, &end);
+      if (end == p || *end != '\0' || d != d) // empty, garbage or NaN
+        return (false);
+
+      is_integer = ::strspn(p, "0123456789") == s.size();
+      if (is_integer) {
+        errno = 0;
+        u = ::strtoull(p, &end, 10);
+        if (errno == ERANGE)
+          is_integer = false;
+      }
+      return (true);
+    }
+
+    // The smallest integer which is >= this value (or > this value if
+    // |strict| is true); returns false if there is none
+    bool lower(bool strict, uint64_t *result) const {
+      if (is_integer) {
+        if (strict && u == std::numeric_limits<uint64_t>::max())
+          return (false);
+        *result = strict ? u + 1 : u;
+        return (true);
+      }
+      if (d < 0) {
+        *result = 0;
+        return (true);
+      }
+      double v = strict ? ::floor(d) + 1 : ::ceil(d);
+      if (v >= 18446744073709551616.0)
+        return (false);
+      *result = (uint64_t)v;
+      return (true);
+    }
+
+    // The largest integer which is <= this value (or < this value if
+    // |strict| is true); returns false if there is none
+    bool upper(bool strict, uint64_t *result) const {
+      if (is_integer) {
+        if (strict && u == 0)
+          return (false);
+        *result = strict ? u - 1 : u;
+        return (true);
+      }
+      double v = strict ? ::ceil(d) - 1 : ::floor(d);
+      if (v < 0)
+        return (false);
+      if (v >= 18446744073709551616.0)
+        *result = std::numeric_limits<uint64_t>::max();
+      else
+        *result = (uint64_t)v;
+      return (true);
+    }
+
+    bool is_integer;
+    uint64_t u;
+    double d;
+  };
+
+  bool bind_integer(const Bound &a, const Bound &b, uint64_t max) {
+    bool has_lo = true, has_hi = true;
+    ulo = 0;
+    uhi = max;
+
+    switch (op) {
+      case kEqual:
+        has_lo = a.lower(false, &ulo);
+        has_hi = a.upper(false, &uhi);
+        break;
+      case kLess:
+        has_hi = a.upper(true, &uhi);
+        break;
+      case kLessEqual:
+        has_hi = a.upper(false, &uhi);
+        break;
+      case kGreater:
+        has_lo = a.lower(true, &ulo);
+        break;
+      case kGreaterEqual:
+        has_lo = a.lower(false, &ulo);
+        break;
+      case kBetween:
+        has_lo = a.lower(false, &ulo);
+        has_hi = b.upper(false, &uhi);
+        break;
+    }
+
+    if (uhi > max)
+      uhi = max;
+    is_empty = !has_lo || !has_hi || ulo > uhi;
+    dlo = (double)ulo;
+    dhi = (double)uhi;
+    return (true);
+  }
+
+  bool bind_real(const Bound &a, const Bound &b) {
+    const double inf = std::numeric_limits<double>::infinity();
+    dlo = -inf;
+    dhi = inf;
+
+    switch (op) {
+      case kEqual:
+        dlo = dhi = a.d;
+        break;
+      case kLess:
+        dhi = ::nextafter(a.d, -inf);
+        break;
+      case kLessEqual:
+        dhi = a.d;
+        break;
+      case kGreater:
+        dlo = ::nextafter(a.d, inf);
+        break;
+      case kGreaterEqual:
+        dlo = a.d;
+        break;
+      case kBetween:
+        dlo = a.d;
+        dhi = b.d;
+        break;
+    }
+
+    // a float is only in range if its double value is in range
+    if (type == UPS_TYPE_REAL32) {
+      float flo = (float)dlo;
+      if ((double)flo < dlo)
+        flo = ::nextafterf(flo, std::numeric_limits<float>::infinity());
+      float fhi = (float)dhi;
+      if ((double)fhi > dhi)
+        fhi = ::nextafterf(fhi, -std::numeric_limits<float>::infinity());
+      dlo = flo;
+      dhi = fhi;
+    }
+
+    is_empty = !(dlo <= dhi);
+    return (true);
+  }
+
+  template<typename T>
+  void assign(T *lo, T *hi) const {
+    *lo = (T)ulo;
+    *hi = (T)uhi;
+  }
+
+  void assign(float *lo, float *hi) const {
+    *lo = (float)dlo;
+    *hi = (float)dhi;
+  }
+
+  void assign(double *lo, double *hi) const {
+    *lo = dlo;
+    *hi = dhi;
+  }
+
+  template<typename T>
+  bool copy_bounds(void *lo, void *hi, uint16_t *size) const {
+    T l, h;
+    if (!bounds(&l, &h))
+      return (false);
+    ::memcpy(lo, &l, sizeof(T));
+    ::memcpy(hi, &h, sizeof(T));
+    *size = (uint16_t)sizeof(T);
+    return (true);
+  }
+
+  template<typename T>
+  size_t select_range(const void *array, size_t length,
+                  uint32_t *selection) const {
+    T lo, hi;
+    if (!bounds(&lo, &hi))
+      return (0);
+    const T *data = (const T *)array;
+#ifdef __SSE__
+    return (select_range_simd(data, length, lo, hi, selection));
+#else
+    size_t n = 0;
+    for (size_t i = 0; i < length; i++) {
+      selection[n] = (uint32_t)i;
+      n += (data[i] >= lo) & (data[i] <= hi);
+    }
+    return (n);
+#endif
+  }
+
+  template<typename T>
+  bool matches_integer(T value) const {
+    return (!is_empty && (uint64_t)value >= ulo && (uint64_t)value <= uhi);
+  }
+
+  template<typename T>
+  bool matches_real(T value) const {
+    return ((double)value >= dlo && (double)value <= dhi);
+  }
+};
+
+//
+// Filters arrays of keys and records with a built-in comparison; the rows
+// which are accepted are copied to contiguous arrays. Each thread requires
+// its own instance.
+//
+struct ComparisonSelection {
+  // Filters the |length| rows of |key_array| and |record_array| and
+  // returns the number of accepted rows. |*pkeys| and |*precords| receive
+  // the arrays of the accepted rows; a stream is only copied if it is
+  // set in |streams|, otherwise its array is null.
+  size_t apply(const ComparisonPredicate &cmp, const void *key_array,
+                  uint32_t key_size, const void *record_array,
+                  uint32_t record_size, size_t length, uint32_t streams,
+                  const void **pkeys, const void **precords) {
+    indices.resize((length + 16) * sizeof(uint32_t));
+    uint32_t *selection = (uint32_t *)indices.data();
+
+    size_t n = cmp.stream == UQI_STREAM_KEY
+                  ? cmp.select(key_array, key_size, length, selection)
+                  : cmp.select(record_array, record_size, length, selection);
+
+    *pkeys = 0;
+    *precords = 0;
+    if (streams & UQI_STREAM_KEY)
+      *pkeys = n == length
+                ? key_array
+                : gather(&keys, key_array, key_size, selection, n);
+    if (streams & UQI_STREAM_RECORD)
+      *precords = n == length
+                ? record_array
+                : gather(&records, record_array, record_size, selection, n);
+    return (n);
+  }
+
+  // Copies the selected values of |array| to |arena|
+  static const void *gather(ByteArray *arena, const void *array,
+                  uint32_t size, const uint32_t *selection, size_t n) {
+    switch (size) {
+      case 1:
+        return (gather_pod<uint8_t>(arena, array, selection, n));
+      case 2:
+        return (gather_pod<uint16_t>(arena, array, selection, n));
+      case 4:
+        return (gather_pod<uint32_t>(arena, array, selection, n));
+      case 8:
+        return (gather_pod<uint64_t>(arena, array, selection, n));
+      default:
+        break;
+    }
+
+    arena->resize(n * size);
+    uint8_t *out = (uint8_t *)arena->data();
+    const uint8_t *in = (const uint8_t *)array;
+    for (size_t i = 0; i < n; i++, out += size)
+      ::memcpy(out, in + (size_t)selection[i] * size, size);
+    return (arena->data());
+  }
+
+  template<typename T>
+  static const void *gather_pod(ByteArray *arena, const void *array,
+                  const uint32_t *selection, size_t n) {
+    arena->resize(n * sizeof(T));
+    T *out = (T *)arena->data();
+    const T *in = (const T *)array;
+    for (size_t i = 0; i < n; i++)
+      out[i] = in[selection[i]];
+    return (arena->data());
+  }
+
+  // The selection vector
+  ByteArray indices;
+
+  // The keys and records of the accepted rows
+  ByteArray keys;
+  ByteArray records;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_UPSCALEDB_COMPARISON_H */
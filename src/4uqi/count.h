@@ -19,8 +19,11 @@
 
 #include "1base/error.h"
 #include "2config/db_config.h"
-#include "4uqi/scanvisitor.h"
+#include "4uqi/plugin_wrapper.h"
+#include "4uqi/type_wrapper.h"
 #include "4uqi/statements.h"
+#include "4uqi/scanvisitor.h"
+#include "4uqi/scanvisitorfactoryhelper.h"
 
 // Always verify that a file of level N does not include headers > N!
 
@@ -52,6 +55,16 @@ struct CountScanVisitor : public ScanVisitor {
     count += length;
   }
 
+  // Counters can be added
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Adds the counter of |other|
+  virtual void merge(ScanVisitor *other) {
+    count += static_cast<CountScanVisitor *>(other)->count;
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     uqi_result_initialize(result, UPS_TYPE_BINARY, UPS_TYPE_UINT64);
@@ -73,7 +86,7 @@ struct CountScanVisitorFactory
 };
 
 
-template<typename PodType>
+template<typename Key, typename Record>
 struct CountIfScanVisitor : public ScanVisitor {
   enum {
     // only requires the target stream
@@ -81,9 +94,7 @@ struct CountIfScanVisitor : public ScanVisitor {
   };
 
   CountIfScanVisitor(const DbConfig *dbconf, SelectStatement *stmt)
-    : count(0), plugin(dbconf, stmt) {
-    key_size = dbconf->key_size;
-    record_size = dbconf->record_size;
+    : ScanVisitor(stmt), count(0), plugin(dbconf, stmt) {
   }
 
   // Operates on a single key
@@ -96,21 +107,38 @@ struct CountIfScanVisitor : public ScanVisitor {
   // Operates on an array of keys
   virtual void operator()(const void *key_data, const void *record_data,
                   size_t length) {
-    PodType *key_array = (PodType *)key_data;
-    PodType *record_array = (PodType *)record_data;
-    PodType *stream;
-
-    if (ISSET(statement->function.flags, UQI_STREAM_KEY))
-      stream = key_array;
-    else
-      stream = record_array;
+    Sequence<Key> keys(key_data, length);
+    Sequence<Record> records(record_data, length);
+    typename Sequence<Key>::iterator kit = keys.begin();
+    typename Sequence<Record>::iterator rit = records.begin();
 
-    for (size_t i = 0; i < length; i++, stream++) {
-      if (plugin.pred(&key_array[i], key_size, &record_array[i], record_size))
+    for (; kit != keys.end(); kit++, rit++) {
+      if (plugin.pred(kit, kit->size(), rit, rit->size()))
         count++;
     }
   }
 
+  // Operates on keys which already passed the predicate
+  virtual void prefiltered(const void *key_array, const void *record_array,
+                  size_t length) {
+    count += length;
+  }
+
+  // Counting does not require the keys or records
+  virtual uint32_t prefiltered_streams() const {
+    return (0);
+  }
+
+  // Counters can be added
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Adds the counter of |other|
+  virtual void merge(ScanVisitor *other) {
+    count += static_cast<CountIfScanVisitor *>(other)->count;
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     uqi_result_initialize(result, UPS_TYPE_BINARY, UPS_TYPE_UINT64);
@@ -122,12 +150,6 @@ struct CountIfScanVisitor : public ScanVisitor {
 
   // The predicate plugin
   PredicatePluginWrapper plugin;
-
-  // The key size
-  uint32_t key_size;
-
-  // The record size
-  uint32_t record_size;
 };
 
 struct CountIfScanVisitorFactory
@@ -138,22 +160,7 @@ struct CountIfScanVisitorFactory
     assert(stmt->predicate.name != "");
 
     // COUNT with predicate
-    switch (cfg->key_type) {
-      case UPS_TYPE_UINT8:
-        return (new CountIfScanVisitor<uint8_t>(cfg, stmt));
-      case UPS_TYPE_UINT16:
-        return (new CountIfScanVisitor<uint16_t>(cfg, stmt));
-      case UPS_TYPE_UINT32:
-        return (new CountIfScanVisitor<uint32_t>(cfg, stmt));
-      case UPS_TYPE_UINT64:
-        return (new CountIfScanVisitor<uint64_t>(cfg, stmt));
-      case UPS_TYPE_REAL32:
-        return (new CountIfScanVisitor<float>(cfg, stmt));
-      case UPS_TYPE_REAL64:
-        return (new CountIfScanVisitor<double>(cfg, stmt));
-      default:
-        return (new CountIfScanVisitor<uint8_t>(cfg, stmt));
-    }
+    return (ScanVisitorFactoryHelper::create<CountIfScanVisitor>(cfg, stmt));
   }
 };
 
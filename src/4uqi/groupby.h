@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Queries with several aggregate functions and/or with a GROUP BY clause,
+ * i.e. "SUM($key), MAX($record) FROM DATABASE 1 GROUP BY prefix($key, 2)".
+ *
+ * Each function has its own ScanVisitor; all functions are calculated in
+ * a single scan. The groups are stored in a map. Consecutive rows of the
+ * same group (which is the common case if the keys are grouped by their
+ * prefix) are passed as a single array to the ScanVisitors of the group.
+ *
+ * @thread_safe: no
+ * @exception_safe: strong
+ */
+
+#ifndef UPS_UPSCALEDB_GROUPBY_H
+#define UPS_UPSCALEDB_GROUPBY_H
+
+#include "0root/root.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "ups/upscaledb_uqi.h"
+
+// Always verify that a file of level N does not include headers > N!
+#include "1base/error.h"
+#include "2config/db_config.h"
+#include "4uqi/result.h"
+#include "4uqi/scanvisitor.h"
+#include "4uqi/scanvisitorfactory.h"
+#include "4uqi/statements.h"
+
+#ifndef UPS_ROOT_H
+#  error "root.h was not included"
+#endif
+
+namespace upscaledb {
+
+typedef std::vector<uint8_t> ByteVector;
+
+// Returns the value which was calculated by a single function: the record
+// of the first row of its |result|, or the key if MIN or MAX of the keys
+// was calculated
+static inline void
+aggregate_value(const SelectStatement *stmt, Result &result,
+                const void **data, uint32_t *size, uint32_t *type)
+{
+  *data = 0;
+  *size = 0;
+  *type = result.record_type;
+  if (result.row_count == 0)
+    return;
+
+  const std::string &name = stmt->function.name;
+  if (stmt->function.library.empty()
+        && (name == "min" || name == "max")
+        && stmt->function.flags == UQI_STREAM_KEY) {
+    ups_key_t key;
+    result.key(0, &key);
+    *data = key.data;
+    *size = key.size;
+    *type = result.key_type;
+  }
+  else {
+    ups_record_t record;
+    result.record(0, &record);
+    *data = record.data;
+    *size = record.size;
+  }
+}
+
+//
+// Calculates several aggregate functions in a single scan
+//
+struct MultiScanVisitor : public ScanVisitor {
+  MultiScanVisitor(SelectStatement *stmt,
+                  const std::vector<SelectStatement *> &statements_,
+                  bool owns_statements_)
+    : ScanVisitor(stmt), statements(statements_),
+      owns_statements(owns_statements_) {
+  }
+
+  ~MultiScanVisitor() {
+    for (size_t i = 0; i < visitors.size(); i++)
+      delete visitors[i];
+    if (owns_statements) {
+      for (size_t i = 0; i < statements.size(); i++)
+        delete statements[i];
+    }
+  }
+
+  // Creates a ScanVisitor for each function of |statements|. Returns null
+  // if one of the functions is invalid. If |owns_statements| is true then
+  // the statements are deleted with the MultiScanVisitor (also if this
+  // function fails).
+  static MultiScanVisitor *create(SelectStatement *stmt,
+                  const std::vector<SelectStatement *> &statements,
+                  LocalDatabase *db, bool owns_statements) {
+    MultiScanVisitor *multi = new MultiScanVisitor(stmt, statements,
+                    owns_statements);
+    for (size_t i = 0; i < statements.size(); i++) {
+      ScanVisitor *v = ScanVisitorFactory::from_select(statements[i], db);
+      if (!v) {
+        delete multi;
+        return (0);
+      }
+      multi->visitors.push_back(v);
+    }
+    return (multi);
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    for (size_t i = 0; i < visitors.size(); i++)
+      (*visitors[i])(key_data, key_size, record_data, record_size);
+  }
+
+  // Operates on an array of keys and/or records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t length) {
+    for (size_t i = 0; i < visitors.size(); i++)
+      (*visitors[i])(key_array, record_array, length);
+  }
+
+  // Operates on keys and records which already passed the predicate
+  virtual void prefiltered(const void *key_array, const void *record_array,
+                  size_t length) {
+    for (size_t i = 0; i < visitors.size(); i++)
+      visitors[i]->prefiltered(key_array, record_array, length);
+  }
+
+  // Requires the streams of all functions
+  virtual uint32_t prefiltered_streams() const {
+    uint32_t streams = 0;
+    for (size_t i = 0; i < visitors.size(); i++)
+      streams |= visitors[i]->prefiltered_streams();
+    return (streams);
+  }
+
+  // Can be merged if all functions can be merged
+  virtual bool supports_merge() const {
+    for (size_t i = 0; i < visitors.size(); i++)
+      if (!visitors[i]->supports_merge())
+        return (false);
+    return (true);
+  }
+
+  // Merges the functions of |other|
+  virtual void merge(ScanVisitor *other) {
+    MultiScanVisitor *o = static_cast<MultiScanVisitor *>(other);
+    for (size_t i = 0; i < visitors.size(); i++)
+      visitors[i]->merge(o->visitors[i]);
+  }
+
+  // Appends one row per function to |result|; the key of each row is
+  // |key|, or the upper-case function name if |key| is null
+  void append_rows(Result *result, const void *key, uint32_t key_size,
+                  uint32_t *record_type) {
+    for (size_t i = 0; i < visitors.size(); i++) {
+      Result tmp;
+      visitors[i]->assign_result((uqi_result_t *)&tmp);
+
+      const void *data;
+      uint32_t size, type;
+      aggregate_value(statements[i], tmp, &data, &size, &type);
+
+      // the record type is only set if all functions return the same type
+      if (result->row_count == 0)
+        *record_type = type;
+      else if (*record_type != type)
+        *record_type = UPS_TYPE_BINARY;
+
+      if (key) {
+        result->add_row(key, key_size, data, size);
+      }
+      else {
+        std::string name = statements[i]->function.name;
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        result->add_row(name.c_str(), (uint32_t)name.size() + 1, data, size);
+      }
+    }
+  }
+
+  // Assigns the result to |result|
+  virtual void assign_result(uqi_result_t *result) {
+    Result *r = (Result *)result;
+    uint32_t record_type = UPS_TYPE_BINARY;
+    append_rows(r, 0, 0, &record_type);
+    r->initialize(UPS_TYPE_BINARY, record_type);
+  }
+
+  // The statements of the functions
+  std::vector<SelectStatement *> statements;
+
+  // True if |statements| are deleted in the destructor
+  bool owns_statements;
+
+  // The ScanVisitors of the functions
+  std::vector<ScanVisitor *> visitors;
+};
+
+//
+// Compares the values of two groups; numeric values are compared if the
+// whole key (or record) is grouped, otherwise the bytes are compared
+//
+struct GroupCompare {
+  GroupCompare(int type_ = UPS_TYPE_BINARY)
+    : type(type_) {
+  }
+
+  bool operator()(const ByteVector &lhs, const ByteVector &rhs) const {
+    switch (type) {
+      case UPS_TYPE_UINT8:
+        return (less<uint8_t>(lhs, rhs));
+      case UPS_TYPE_UINT16:
+        return (less<uint16_t>(lhs, rhs));
+      case UPS_TYPE_UINT32:
+        return (less<uint32_t>(lhs, rhs));
+      case UPS_TYPE_UINT64:
+        return (less<uint64_t>(lhs, rhs));
+      case UPS_TYPE_REAL32:
+        return (less<float>(lhs, rhs));
+      case UPS_TYPE_REAL64:
+        return (less<double>(lhs, rhs));
+      default:
+        return (lhs < rhs);
+    }
+  }
+
+  template<typename T>
+  bool less(const ByteVector &lhs, const ByteVector &rhs) const {
+    if (lhs.size() != sizeof(T) || rhs.size() != sizeof(T))
+      return (lhs < rhs);
+    T l, r;
+    ::memcpy(&l, &lhs[0], sizeof(T));
+    ::memcpy(&r, &rhs[0], sizeof(T));
+    return (l < r);
+  }
+
+  int type;
+};
+
+//
+// Calculates the aggregate functions for each group
+//
+struct GroupByScanVisitor : public ScanVisitor {
+  typedef std::map<ByteVector, MultiScanVisitor *, GroupCompare> GroupMap;
+
+  GroupByScanVisitor(const DbConfig *cfg, SelectStatement *stmt,
+                  LocalDatabase *db_, MultiScanVisitor *prototype_)
+    : ScanVisitor(stmt), db(db_), prototype(prototype_),
+      groups(GroupCompare(group_type(cfg, stmt))), last(0),
+      key_size(cfg->key_size), record_size(cfg->record_size) {
+  }
+
+  ~GroupByScanVisitor() {
+    for (GroupMap::iterator it = groups.begin(); it != groups.end(); it++)
+      delete it->second;
+    delete prototype;
+  }
+
+  // Returns the type of the group values
+  static int group_type(const DbConfig *cfg, SelectStatement *stmt) {
+    if (stmt->group.offset != 0 || stmt->group.size != 0)
+      return (UPS_TYPE_BINARY);
+    return (stmt->group.stream == UQI_STREAM_KEY
+                ? cfg->key_type
+                : cfg->record_type);
+  }
+
+  // Operates on a single key
+  virtual void operator()(const void *key_data, uint16_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    MultiScanVisitor *multi = group(key_data, key_size,
+                    record_data, record_size);
+    (*multi)(key_data, key_size, record_data, record_size);
+  }
+
+  // Operates on an array of keys and/or records
+  virtual void operator()(const void *key_array, const void *record_array,
+                  size_t length) {
+    process(key_array, record_array, length, false);
+  }
+
+  // Operates on keys and records which already passed the predicate
+  virtual void prefiltered(const void *key_array, const void *record_array,
+                  size_t length) {
+    process(key_array, record_array, length, true);
+  }
+
+  // Requires the streams of all functions and the grouped stream
+  virtual uint32_t prefiltered_streams() const {
+    return (prototype->prefiltered_streams() | statement->group.stream);
+  }
+
+  // Can be merged if all functions can be merged
+  virtual bool supports_merge() const {
+    return (prototype->supports_merge());
+  }
+
+  // Merges the groups of |other|; groups which only exist in |other| are
+  // moved
+  virtual void merge(ScanVisitor *other) {
+    GroupByScanVisitor *o = static_cast<GroupByScanVisitor *>(other);
+    for (GroupMap::iterator it = o->groups.begin();
+                    it != o->groups.end(); it++) {
+      GroupMap::iterator g = groups.find(it->first);
+      if (g == groups.end()) {
+        groups.insert(GroupMap::value_type(it->first, it->second));
+      }
+      else {
+        g->second->merge(it->second);
+        delete it->second;
+      }
+    }
+    o->groups.clear();
+    o->last = 0;
+  }
+
+  // Assigns the result to |result|; one row per group and function
+  virtual void assign_result(uqi_result_t *result) {
+    Result *r = (Result *)result;
+    uint32_t record_type = UPS_TYPE_BINARY;
+    for (GroupMap::iterator it = groups.begin(); it != groups.end(); it++) {
+      const ByteVector &value = it->first;
+      it->second->append_rows(r, value.empty() ? (const void *)"" : &value[0],
+                      (uint32_t)value.size(), &record_type);
+    }
+    r->initialize(groups.key_comp().type, record_type);
+  }
+
+  // Extracts the group value from |data|
+  void group_value(const void *data, uint32_t size,
+                  const uint8_t **pvalue, uint32_t *pvalue_size) const {
+    uint32_t offset = std::min(statement->group.offset, size);
+    uint32_t length = size - offset;
+    if (statement->group.size != 0)
+      length = std::min(statement->group.size, length);
+    *pvalue = (const uint8_t *)data + offset;
+    *pvalue_size = length;
+  }
+
+  // Returns the functions of the group of a key/record pair
+  MultiScanVisitor *group(const void *key_data, uint32_t key_size,
+                  const void *record_data, uint32_t record_size) {
+    const uint8_t *value;
+    uint32_t size;
+    if (statement->group.stream == UQI_STREAM_KEY)
+      group_value(key_data, key_size, &value, &size);
+    else
+      group_value(record_data, record_size, &value, &size);
+
+    // consecutive rows very often belong to the same group
+    if (last && last_value.size() == size
+          && (size == 0 || ::memcmp(&last_value[0], value, size) == 0))
+      return (last);
+
+    last_value.assign(value, value + size);
+    GroupMap::iterator it = groups.find(last_value);
+    if (it == groups.end()) {
+      MultiScanVisitor *multi = MultiScanVisitor::create(statement,
+                      prototype->statements, db, false);
+      if (!multi)
+        throw Exception(UPS_PARSER_ERROR);
+      it = groups.insert(GroupMap::value_type(last_value, multi)).first;
+    }
+    last = it->second;
+    return (last);
+  }
+
+  // Splits the arrays into runs of rows of the same group; each run is
+  // passed to the functions of its group
+  void process(const void *key_array, const void *record_array,
+                  size_t length, bool is_prefiltered) {
+    const uint8_t *keys = (const uint8_t *)key_array;
+    const uint8_t *records = (const uint8_t *)record_array;
+
+    size_t start = 0;
+    while (start < length) {
+      MultiScanVisitor *multi = group(
+                      keys ? keys + start * key_size : 0, key_size,
+                      records ? records + start * record_size : 0,
+                      record_size);
+
+      size_t end = start + 1;
+      while (end < length
+              && group(keys ? keys + end * key_size : 0, key_size,
+                      records ? records + end * record_size : 0,
+                      record_size) == multi)
+        end++;
+
+      const void *k = keys ? keys + start * key_size : 0;
+      const void *r = records ? records + start * record_size : 0;
+      if (is_prefiltered)
+        multi->prefiltered(k, r, end - start);
+      else
+        (*multi)(k, r, end - start);
+      start = end;
+    }
+  }
+
+  // The database; required to create the functions of new groups
+  LocalDatabase *db;
+
+  // The functions of an empty group; owns the statements of the functions
+  MultiScanVisitor *prototype;
+
+  // The groups, sorted by their value
+  GroupMap groups;
+
+  // The most recently used group and its value
+  MultiScanVisitor *last;
+  ByteVector last_value;
+
+  // The size of the keys and records in the arrays
+  uint32_t key_size;
+  uint32_t record_size;
+};
+
+} // namespace upscaledb
+
+#endif /* UPS_UPSCALEDB_GROUPBY_H */
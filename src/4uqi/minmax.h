@@ -58,6 +58,55 @@ struct MinMaxScanVisitorBase : public NumericalScanVisitor {
     other.copy((const uint8_t *)data, size);
   }
 
+  // Updates the minimum/maximum with an array of keys and records
+  template<template<typename T> class Compare>
+  void process_array(const void *key_data, const void *record_data,
+                  size_t length) {
+    Sequence<Key> keys(key_data, length);
+    Sequence<Record> records(record_data, length);
+    typename Sequence<Key>::iterator kit = keys.begin();
+    typename Sequence<Record>::iterator rit = records.begin();
+
+    if (ISSET(statement->function.flags, UQI_STREAM_KEY)) {
+      Compare<typename Key::type> cmp;
+      for (; kit != keys.end(); kit++, rit++) {
+        if (cmp(kit->value, key.value)) {
+          key = kit->value;
+          copy_value(&rit->value, rit->size());
+        }
+      }
+    }
+    else {
+      Compare<typename Record::type> cmp;
+      for (; kit != keys.end(); kit++, rit++) {
+        if (cmp(rit->value, record.value)) {
+          record = rit->value;
+          copy_value(&kit->value, kit->size());
+        }
+      }
+    }
+  }
+
+  // Merges the state of |o|; on ties the current value is kept, because it
+  // was found first
+  template<template<typename T> class Compare>
+  void merge_values(MinMaxScanVisitorBase *o) {
+    if (ISSET(statement->function.flags, UQI_STREAM_KEY)) {
+      Compare<typename Key::type> cmp;
+      if (cmp(o->key.value, key.value)) {
+        key = o->key;
+        copy_value(o->other.data(), o->other.size());
+      }
+    }
+    else {
+      Compare<typename Record::type> cmp;
+      if (cmp(o->record.value, record.value)) {
+        record = o->record;
+        copy_value(o->other.data(), o->other.size());
+      }
+    }
+  }
+
   // The current minimum/maximum key
   Key key;
 
@@ -83,6 +132,16 @@ struct MinMaxScanVisitor : public MinMaxScanVisitorBase<Key, Record> {
                     initial_key, initial_record) {
   }
 
+  // The minimum/maximum of two partitions can be merged
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Merges the minimum/maximum of |other|
+  virtual void merge(ScanVisitor *other) {
+    P::template merge_values<Compare>(static_cast<P *>(other));
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   const void *record_data, uint32_t record_size) {
@@ -107,29 +166,7 @@ struct MinMaxScanVisitor : public MinMaxScanVisitorBase<Key, Record> {
   // Operates on an array of keys
   virtual void operator()(const void *key_data, const void *record_data,
                   size_t length) {
-    Sequence<Key> keys(key_data, length);
-    Sequence<Record> records(record_data, length);
-    typename Sequence<Key>::iterator kit = keys.begin();
-    typename Sequence<Record>::iterator rit = records.begin();
-
-    if (ISSET(P::statement->function.flags, UQI_STREAM_KEY)) {
-      Compare<typename Key::type> cmp;
-      for (; kit != keys.end(); kit++, rit++) {
-        if (cmp(kit->value, P::key.value)) {
-          P::key = kit->value;
-          P::copy_value(&rit->value, rit->size());
-        }
-      }
-    }
-    else {
-      Compare<typename Record::type> cmp;
-      for (; kit != keys.end(); kit++, rit++) {
-        if (cmp(rit->value, P::record.value)) {
-          P::record = rit->value;
-          P::copy_value(&kit->value, kit->size());
-        }
-      }
-    }
+    P::template process_array<Compare>(key_data, record_data, length);
   }
 };
 
@@ -181,6 +218,16 @@ struct MinMaxIfScanVisitor : public MinMaxScanVisitorBase<Key, Record> {
         plugin(cfg, stmt) {
   }
 
+  // The minimum/maximum of two partitions can be merged
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Merges the minimum/maximum of |other|
+  virtual void merge(ScanVisitor *other) {
+    P::template merge_values<Compare>(static_cast<P *>(other));
+  }
+
   // Operates on a single key
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   const void *record_data, uint32_t record_size) {
@@ -234,6 +281,12 @@ struct MinMaxIfScanVisitor : public MinMaxScanVisitorBase<Key, Record> {
     }
   }
 
+  // Operates on keys and records which already passed the predicate
+  virtual void prefiltered(const void *key_data, const void *record_data,
+                  size_t length) {
+    P::template process_array<Compare>(key_data, record_data, length);
+  }
+
   PredicatePluginWrapper plugin;
 };
 
@@ -47,6 +47,9 @@ static qi::rule<const char *, int(), ascii::space_type> limit_clause;
 static qi::rule<const char *, short(), ascii::space_type> from_clause;
 static qi::rule<const char *, short(), ascii::space_type> number;
 static qi::rule<const char *, int(), ascii::space_type> input_clause;
+static qi::rule<const char *, std::string(), ascii::space_type> argument;
+static qi::rule<const char *, std::string(), ascii::space_type>
+        comparison_operator;
 
 static void
 initialize_parsers()
@@ -76,12 +79,43 @@ initialize_parsers()
         | lit("$key")[_val = UQI_STREAM_KEY]
         | lit("$record")[_val = UQI_STREAM_RECORD]
       ;
+  argument %= quoted_string | lexeme[ +(alnum | char_(".+-"))][_val];
+  comparison_operator =
+        lit(">=")[_val = "ge"]
+        | lit("<=")[_val = "le"]
+        | lit("==")[_val = "eq"]
+        | lit('>')[_val = "gt"]
+        | lit('<')[_val = "lt"]
+        | lit('=')[_val = "eq"]
+      ;
+}
+
+// Splits the name of |function|; delimiter character is '@' (optional).
+// The function name is reduced to lower-case, and the plugin is loaded. If
+// a library name is specified then loading the plugin MUST succeed. If not
+// then it can fail - then most likely a builtin function was specified.
+static ups_status_t
+resolve_function(FunctionDesc &function, uqi_plugin_t **plugin)
+{
+  size_t delim = function.name.find('@');
+  if (delim != std::string::npos) {
+    function.library = function.name.data() + delim + 1;
+    function.name = function.name.substr(0, delim);
+    boost::algorithm::to_lower(function.name);
+    return (PluginManager::import(function.library.c_str(),
+                                function.name.c_str()));
+  }
+
+  boost::algorithm::to_lower(function.name);
+  *plugin = PluginManager::get(function.name.c_str());
+  return (0);
 }
 
 ups_status_t
 Parser::parse_select(const char *query, SelectStatement &stmt)
 {
   using qi::int_;
+  using qi::uint_;
   using qi::lexeme;
   using qi::alnum;
   using qi::lit;
@@ -103,47 +137,84 @@ Parser::parse_select(const char *query, SelectStatement &stmt)
 
   qi::rule<const char *, SelectStatement(), ascii::space_type> parser;
 
+  std::vector<std::string> names;
+  std::vector<int> flags;
+
   stmt.function.flags = 0;
   stmt.predicate.flags = 0;
+  stmt.comparison.arguments.clear();
+  stmt.functions.clear();
+  stmt.function_plgs.clear();
+  stmt.group = GroupDesc();
 
-  parser %=
+  parser =
       -no_case[lit("distinct")] [ref(stmt.distinct) = true]
-      >> plugin_name[boost::phoenix::ref(stmt.function.name) = _1]
-        >> '(' >> input_clause [ref(stmt.function.flags) = _1] >> ')'
+      >> (plugin_name[boost::phoenix::push_back(
+                        boost::phoenix::ref(names), _1)]
+        >> '(' >> input_clause [boost::phoenix::push_back(
+                        boost::phoenix::ref(flags), _1)]
+        >> ')') % ','
       >> from_clause [ref(stmt.dbid) = _1]
-      >> -(where_clause[boost::phoenix::ref(stmt.predicate.name) = _1]
-        >> '(' >> input_clause [ref(stmt.predicate.flags) = _1] >> ')')
+      >> -((where_clause[boost::phoenix::ref(stmt.predicate.name) = _1]
+          >> '(' >> input_clause [ref(stmt.predicate.flags) = _1]
+          >> *(',' >> argument[boost::phoenix::push_back(
+                        boost::phoenix::ref(stmt.comparison.arguments), _1)])
+          >> ')')
+        | (no_case[lit("where")]
+          >> input_clause [ref(stmt.predicate.flags) = _1]
+          >> ((comparison_operator
+                  [boost::phoenix::ref(stmt.predicate.name) = _1]
+                >> argument[boost::phoenix::push_back(
+                        boost::phoenix::ref(stmt.comparison.arguments), _1)])
+            | (no_case[lit("between")]
+                  [boost::phoenix::ref(stmt.predicate.name) = "between"]
+                >> argument[boost::phoenix::push_back(
+                        boost::phoenix::ref(stmt.comparison.arguments), _1)]
+                >> no_case[lit("and")]
+                >> argument[boost::phoenix::push_back(
+                        boost::phoenix::ref(stmt.comparison.arguments),
+                        _1)]))))
+      >> -(no_case[lit("group")] >> no_case[lit("by")]
+        >> ((no_case[lit("prefix")] >> '('
+              >> input_clause [ref(stmt.group.stream) = _1]
+              >> ',' >> uint_ [ref(stmt.group.size) = _1] >> ')')
+          | (no_case[lit("field")] >> '('
+              >> input_clause [ref(stmt.group.stream) = _1]
+              >> ',' >> uint_ [ref(stmt.group.offset) = _1]
+              >> ',' >> uint_ [ref(stmt.group.size) = _1] >> ')')
+          | input_clause [ref(stmt.group.stream) = _1]))
       >> -limit_clause [ref(stmt.limit) = _1]
       >> -char_(';')
       ;
 
   bool r = phrase_parse(first, last, parser, space);
-  if (!r || first != last)
+  if (!r || first != last || names.size() != flags.size())
     return (UPS_PARSER_ERROR);
 
   ups_status_t st;
 
-  // Split |function|; delimiter character is '@' (optional). The function
-  // name is reduced to lower-case, and the plugin is loaded. If a library
-  // name is specified then loading the plugin MUST succeed. If not then it
-  // can fail - then most likely a builtin function was specified.
-  size_t delim = stmt.function.name.find('@');
-  if (delim != std::string::npos) {
-    stmt.function.library = stmt.function.name.data() + delim + 1;
-    stmt.function.name = stmt.function.name.substr(0, delim);
-    boost::algorithm::to_lower(stmt.function.name);
-    if ((st = PluginManager::import(stmt.function.library.c_str(),
-                                stmt.function.name.c_str())))
+  // resolve the function plugins; a query with several functions stores
+  // all of them in |functions|, and the first one in |function|
+  for (size_t i = 0; i < names.size(); i++) {
+    FunctionDesc function;
+    function.name = names[i];
+    function.flags = flags[i];
+    uqi_plugin_t *plugin = 0;
+    if ((st = resolve_function(function, &plugin)))
       return (st);
-  }
-  else {
-    boost::algorithm::to_lower(stmt.function.name);
-    stmt.function_plg = PluginManager::get(stmt.function.name.c_str());
+    if (i == 0) {
+      stmt.function = function;
+      stmt.function_plg = plugin;
+    }
+    if (names.size() > 1) {
+      stmt.functions.push_back(function);
+      stmt.function_plgs.push_back(plugin);
+    }
   }
 
   // the predicate is formatted in the same way, but is completeley optional
   if (!stmt.predicate.name.empty()) {
-    delim = stmt.predicate.name.find('@');
+    size_t delim = stmt.predicate.name.find('@');
     if (delim != std::string::npos) {
       stmt.predicate.library = stmt.predicate.name.data() + delim + 1;
       stmt.predicate.name = stmt.predicate.name.substr(0, delim);
@@ -154,7 +225,56 @@ Parser::parse_select(const char *query, SelectStatement &stmt)
     }
     else {
       boost::algorithm::to_lower(stmt.predicate.name);
-      stmt.predicate_plg = PluginManager::get(stmt.predicate.name.c_str());
+      stmt.comparison.op = ComparisonPredicate::lookup(stmt.predicate.name);
+      if (!stmt.comparison.is_active())
+        stmt.predicate_plg = PluginManager::get(stmt.predicate.name.c_str());
+    }
+  }
+
+  // only built-in comparisons accept arguments; they compare a single
+  // stream
+  if (stmt.comparison.is_active()) {
+    if (stmt.comparison.arguments.size()
+            != stmt.comparison.expected_arguments()) {
+      ups_trace(("'%s' expects %d argument(s)", stmt.predicate.name.c_str(),
+                  (int)stmt.comparison.expected_arguments()));
+      return (UPS_PARSER_ERROR);
+    }
+    if (stmt.predicate.flags != UQI_STREAM_KEY
+            && stmt.predicate.flags != UQI_STREAM_RECORD) {
+      ups_trace(("'%s' compares either $key or $record",
+                  stmt.predicate.name.c_str()));
+      return (UPS_PARSER_ERROR);
+    }
+    stmt.comparison.stream = stmt.predicate.flags;
+  }
+  else if (!stmt.comparison.arguments.empty()) {
+    ups_trace(("predicate '%s' does not accept arguments",
+                stmt.predicate.name.c_str()));
+    return (UPS_PARSER_ERROR);
+  }
+
+  // GROUP BY uses a single stream
+  if (stmt.group.is_active()
+          && stmt.group.stream != UQI_STREAM_KEY
+          && stmt.group.stream != UQI_STREAM_RECORD) {
+    ups_trace(("GROUP BY uses either $key or $record"));
+    return (UPS_PARSER_ERROR);
+  }
+
+  // queries with several functions or with GROUP BY calculate one value
+  // per function (and group); functions which return several rows are
+  // not allowed
+  if (stmt.functions.size() > 1 || stmt.group.is_active()) {
+    for (size_t i = 0; i < names.size(); i++) {
+      const std::string &name = i == 0
+                                  ? stmt.function.name
+                                  : stmt.functions[i].name;
+      if (name == "top" || name == "bottom" || name == "value") {
+        ups_trace(("'%s' not allowed with GROUP BY or with several "
+                    "functions", name.c_str()));
+        return (UPS_PARSER_ERROR);
+      }
     }
   }
 
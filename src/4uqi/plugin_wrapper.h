@@ -40,14 +40,14 @@ struct SelectStatement;
 struct PluginWrapperBase {
   PluginWrapperBase(const DbConfig *cfg, uqi_plugin_t *p, uint32_t init_flags)
     : plugin(p), state(0) {
-    if (plugin->init)
+    if (plugin && plugin->init)
       state = plugin->init(init_flags, cfg->key_type, cfg->key_size,
                       cfg->record_type, cfg->record_size, 0);
   }
 
   // clean up the plugin's state
   ~PluginWrapperBase() {
-    if (plugin->cleanup) {
+    if (plugin && plugin->cleanup) {
       plugin->cleanup(state);
       state = 0;
     }
@@ -62,13 +62,22 @@ struct PluginWrapperBase {
 
 struct PredicatePluginWrapper : PluginWrapperBase {
   PredicatePluginWrapper(const DbConfig *cfg, SelectStatement *stmt)
-    : PluginWrapperBase(cfg, stmt->predicate_plg, stmt->predicate.flags) {
+    : PluginWrapperBase(cfg, stmt->predicate_plg, stmt->predicate.flags),
+      comparison(stmt->comparison.is_active() ? &stmt->comparison : 0) {
   }
 
   bool pred(const void *key_data, uint32_t key_size,
                   const void *record_data, uint32_t record_size) {
+    // built-in comparisons are evaluated directly, without a plugin
+    if (comparison)
+      return comparison->stream == UQI_STREAM_KEY
+                ? comparison->matches(key_data, key_size)
+                : comparison->matches(record_data, record_size);
     return plugin->pred(state, key_data, key_size, record_data, record_size);
   }
+
+  // The built-in comparison predicate; null if a plugin is used
+  const ComparisonPredicate *comparison;
 };
 
 struct AggregatePluginWrapper : PluginWrapperBase {
@@ -87,6 +96,16 @@ struct AggregatePluginWrapper : PluginWrapperBase {
     plugin->agg_many(state, key_data, record_data, length);
   }
 
+  // Returns true if the plugin can merge the state of another instance
+  bool supports_merge() const {
+    return (plugin->plugin_version >= 1 && plugin->merge != 0);
+  }
+
+  // Merges the state of |other| into this state
+  void merge(AggregatePluginWrapper *other) {
+    plugin->merge(state, other->state);
+  }
+
   // Assigns and collects the results of the query
   void assign_result(uqi_result_t *result) {
     plugin->results(state, result);
@@ -17,6 +17,8 @@
 
 #include "0root/root.h"
 
+#include <stddef.h>
+#include <string.h>
 #include <string>
 #include <map>
 #include <vector>
@@ -127,9 +129,9 @@ PluginManager::import(const char *library, const char *plugin_name)
 ups_status_t
 PluginManager::add(uqi_plugin_t *plugin)
 {
-  if (plugin->plugin_version != 0) {
-    ups_log(("Failed to load plugin %s: invalid version (%d != %d)",
-            plugin->name, 0, plugin->plugin_version));
+  if (plugin->plugin_version > 1) {
+    ups_log(("Failed to load plugin %s: invalid version (%d > %d)",
+            plugin->name, plugin->plugin_version, 1));
     return UPS_PLUGIN_NOT_FOUND;
   }
 
@@ -159,8 +161,16 @@ PluginManager::add(uqi_plugin_t *plugin)
       return UPS_PLUGIN_NOT_FOUND;
   }
 
+  // version 0 descriptors end before |merge|; do not read beyond them
+  uqi_plugin_t copy;
+  ::memset(&copy, 0, sizeof(copy));
+  if (plugin->plugin_version == 0)
+    ::memcpy(&copy, plugin, offsetof(uqi_plugin_t, merge));
+  else
+    copy = *plugin;
+
   ScopedLock lock(mutex);
-  plugins.insert(PluginMap::value_type(plugin->name, *plugin));
+  plugins.insert(PluginMap::value_type(plugin->name, copy));
   return 0;
 }
 
@@ -72,6 +72,24 @@ struct Result
     std::swap(record_data, other.record_data);
   }
 
+  // Appends all rows of |other|
+  void append(const Result &other) {
+    for (std::vector<uint32_t>::const_iterator it = other.key_offsets.begin();
+                    it != other.key_offsets.end(); it++)
+      key_offsets.push_back(next_key_offset + *it);
+    for (std::vector<uint32_t>::const_iterator it
+                    = other.record_offsets.begin();
+                    it != other.record_offsets.end(); it++)
+      record_offsets.push_back(next_record_offset + *it);
+    key_data.insert(key_data.end(), other.key_data.begin(),
+                    other.key_data.end());
+    record_data.insert(record_data.end(), other.record_data.begin(),
+                    other.record_data.end());
+    next_key_offset += other.next_key_offset;
+    next_record_offset += other.next_record_offset;
+    row_count += other.row_count;
+  }
+
   uint32_t row_count;
   uint32_t key_type;
   uint32_t record_type;
@@ -51,6 +51,10 @@ struct ScanVisitor {
     : statement(stmt) {
   }
 
+  // Destructor
+  virtual ~ScanVisitor() {
+  }
+
   // Operates on a single key/value pair
   virtual void operator()(const void *key_data, uint16_t key_size, 
                   const void *record_data, uint32_t record_size) = 0;
@@ -59,11 +63,42 @@ struct ScanVisitor {
   virtual void operator()(const void *key_array, const void *record_array,
                   size_t key_count) = 0;
 
+  // Operates on an array of keys and/or records which were already
+  // filtered by the btree with the built-in comparison predicate of the
+  // statement. The default implementation evaluates the predicate again.
+  virtual void prefiltered(const void *key_array, const void *record_array,
+                  size_t key_count) {
+    (*this)(key_array, record_array, key_count);
+  }
+
+  // Returns the streams which are required by prefiltered(); if a stream is
+  // not required then its array can be null, and the btree can skip
+  // decoding it. By default both streams are required.
+  virtual uint32_t prefiltered_streams() const {
+    return (UQI_STREAM_KEY | UQI_STREAM_RECORD);
+  }
+
+  // Returns true if merge() is supported; only then can the query be
+  // executed by several threads in parallel
+  virtual bool supports_merge() const {
+    return (false);
+  }
+
+  // Merges the state of |other| (which scanned the keys following the keys
+  // of this visitor) into this visitor
+  virtual void merge(ScanVisitor *other) {
+    assert(!"shouldn't be here");
+  }
+
   // Assigns the internal result to |result|
   virtual void assign_result(uqi_result_t *result) = 0;
 
   // The select statement
   SelectStatement *statement;
+
+  // Buffers for the rows which were accepted by the built-in comparison
+  // predicate of the statement; used by the btree
+  ComparisonSelection selection;
 };
 
 //
@@ -27,6 +27,7 @@
 #include "4uqi/average.h"
 #include "4uqi/bottom.h"
 #include "4uqi/count.h"
+#include "4uqi/groupby.h"
 #include "4uqi/minmax.h"
 #include "4uqi/sum.h"
 #include "4uqi/top.h"
@@ -67,6 +68,16 @@ struct PluginProxyScanVisitor : public ScanVisitor {
       plugin.agg_many(key_data, record_data, length);
   }
 
+  // Merging is supported if the plugin implements |merge|
+  virtual bool supports_merge() const {
+    return (plugin.supports_merge());
+  }
+
+  // Merges the plugin state of |other|
+  virtual void merge(ScanVisitor *other) {
+    plugin.merge(&static_cast<PluginProxyScanVisitor *>(other)->plugin);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     plugin.assign_result(result);
@@ -124,6 +135,16 @@ struct PluginProxyIfScanVisitor : public ScanVisitor {
     }
   }
 
+  // Merging is supported if the plugin implements |merge|
+  virtual bool supports_merge() const {
+    return (agg_plugin.supports_merge());
+  }
+
+  // Merges the plugin state of |other|
+  virtual void merge(ScanVisitor *other) {
+    agg_plugin.merge(&static_cast<PluginProxyIfScanVisitor *>(other)->agg_plugin);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     agg_plugin.assign_result(result);
@@ -136,18 +157,72 @@ struct PluginProxyIfScanVisitor : public ScanVisitor {
   PredicatePluginWrapper pred_plugin;
 };
 
+// Creates the ScanVisitor of a query with several functions or with a
+// GROUP BY clause; each function is calculated with its own statement
+static ScanVisitor *
+multi_from_select(SelectStatement *stmt, LocalDatabase *db)
+{
+  std::vector<SelectStatement *> statements;
+  size_t count = stmt->functions.empty() ? 1 : stmt->functions.size();
+  for (size_t i = 0; i < count; i++) {
+    SelectStatement *s = new SelectStatement(*stmt);
+    if (!stmt->functions.empty()) {
+      s->function = stmt->functions[i];
+      s->function_plg = stmt->function_plgs[i];
+    }
+    s->functions.clear();
+    s->function_plgs.clear();
+    s->group = GroupDesc();
+    statements.push_back(s);
+  }
+
+  MultiScanVisitor *multi = MultiScanVisitor::create(stmt, statements, db,
+                                true);
+  if (!multi)
+    return (0);
+
+  // the scan requires the streams of all functions, and the grouped stream
+  stmt->requires_keys = stmt->group.stream == UQI_STREAM_KEY;
+  stmt->requires_records = stmt->group.stream == UQI_STREAM_RECORD;
+  for (size_t i = 0; i < statements.size(); i++) {
+    stmt->requires_keys |= statements[i]->requires_keys;
+    stmt->requires_records |= statements[i]->requires_records;
+  }
+
+  if (!stmt->group.is_active())
+    return (multi);
+  return (new GroupByScanVisitor(&db->config(), stmt, db, multi));
+}
+
 ScanVisitor *
 ScanVisitorFactory::from_select(SelectStatement *stmt, LocalDatabase *db)
 {
   const DbConfig *cfg = &db->config();
 
   // Predicate plugin required?
-  if (!stmt->predicate.name.empty() && stmt->predicate_plg == 0) {
+  if (!stmt->predicate.name.empty() && stmt->predicate_plg == 0
+        && !stmt->comparison.is_active()) {
     ups_trace(("Invalid or unknown predicate function '%s'",
                 stmt->predicate.name.c_str()));
     return (0);
   }
 
+  // Built-in comparison: convert the arguments to the compared type
+  if (stmt->comparison.is_active()) {
+    int type = stmt->comparison.stream == UQI_STREAM_KEY
+                  ? cfg->key_type
+                  : cfg->record_type;
+    if (!stmt->comparison.bind(type)) {
+      ups_trace(("'%s' requires a numeric stream and numeric arguments",
+                  stmt->predicate.name.c_str()));
+      return (0);
+    }
+  }
+
+  // several functions, or GROUP BY?
+  if (stmt->functions.size() > 1 || stmt->group.is_active())
+    return (multi_from_select(stmt, db));
+
   // AVERAGE ... WHERE ...
   if (stmt->function.library.empty() && stmt->function.name == "average") {
     if (stmt->predicate.name == "")
@@ -219,7 +294,7 @@ ScanVisitorFactory::from_select(SelectStatement *stmt, LocalDatabase *db)
   }
 
   // custom plugin function without predicate?
-  if (stmt->predicate_plg == 0)
+  if (stmt->predicate.name.empty())
     return new PluginProxyScanVisitor(cfg, stmt);
   // otherwise it's a custom plugin function WITH predicate
   return ScanVisitorFactoryHelper::create<PluginProxyIfScanVisitor>(cfg, stmt);
@@ -74,8 +74,9 @@ struct ScanVisitorFactoryHelper
     if (!T< TW(uint8_t), TW(uint8_t) >::kRequiresBothStreams) {
       stmt->requires_keys = ISSET(stmt->function.flags, UQI_STREAM_KEY);
       stmt->requires_records = ISSET(stmt->function.flags, UQI_STREAM_RECORD);
-      if (stmt->predicate_plg) {
-        if (ISSET(stmt->predicate_plg->flags, UQI_PLUGIN_REQUIRE_BOTH_STREAMS)) {
+      if (stmt->predicate_plg || stmt->comparison.is_active()) {
+        if (stmt->predicate_plg && ISSET(stmt->predicate_plg->flags,
+                                UQI_PLUGIN_REQUIRE_BOTH_STREAMS)) {
           stmt->requires_keys = true;
           stmt->requires_records = true;
         }
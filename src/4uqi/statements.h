@@ -28,9 +28,12 @@
 #include "0root/root.h"
 
 #include <string>
+#include <vector>
 
 #include "ups/upscaledb_uqi.h"
 
+#include "4uqi/comparison.h"
+
 // Always verify that a file of level N does not include headers > N!
 
 #ifndef UPS_ROOT_H
@@ -49,6 +52,23 @@ struct FunctionDesc {
   std::string library;
 };
 
+// The GROUP BY clause; the rows are grouped by a range of bytes of the key
+// or the record
+struct GroupDesc {
+  GroupDesc()
+    : stream(0), offset(0), size(0) {
+  }
+
+  // Returns true if the query has a GROUP BY clause
+  bool is_active() const {
+    return (stream != 0);
+  }
+
+  uint32_t stream;   // UQI_STREAM_KEY or UQI_STREAM_RECORD
+  uint32_t offset;   // the first byte of the group value
+  uint32_t size;     // the length of the group value; 0: till the end
+};
+
 struct SelectStatement {
   // constructor
   SelectStatement()
@@ -77,12 +97,25 @@ struct SelectStatement {
   // the resolved function plugin
   uqi_plugin_t *function_plg;
 
+  // all aggregate functions if more than one function is calculated;
+  // |function| is the first of them
+  std::vector<FunctionDesc> functions;
+
+  // the resolved plugins of |functions|
+  std::vector<uqi_plugin_t *> function_plgs;
+
+  // the optional GROUP BY clause
+  GroupDesc group;
+
   // an optional predicate function (for the WHERE clause)
   FunctionDesc predicate;
 
   // the resolved predicate plugin
   uqi_plugin_t *predicate_plg;
 
+  // the built-in comparison predicate, if |predicate| is not a plugin
+  ComparisonPredicate comparison;
+
   // internal flag for the Btree scan
   bool requires_keys;
 
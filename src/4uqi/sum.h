@@ -75,6 +75,17 @@ struct SumScanVisitor : public NumericalScanVisitor {
     }
   }
 
+  // Integer sums can be added; floating point sums are not merged because
+  // the result would depend on the order of the additions
+  virtual bool supports_merge() const {
+    return (UpsResultType == UPS_TYPE_UINT64);
+  }
+
+  // Adds the sum of |other|
+  virtual void merge(ScanVisitor *other) {
+    sum += static_cast<SumScanVisitor *>(other)->sum;
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     uqi_result_initialize(result, UPS_TYPE_BINARY, UpsResultType);
@@ -183,6 +194,39 @@ struct SumIfScanVisitor : public NumericalScanVisitor {
     }
   }
 
+  // Operates on keys and records which already passed the predicate
+  virtual void prefiltered(const void *key_data, const void *record_data,
+                  size_t length) {
+    if (ISSET(statement->function.flags, UQI_STREAM_KEY)) {
+      typename Key::type *it = (typename Key::type *)key_data;
+      typename Key::type *end = it + length;
+      for (; it != end; it++)
+        sum += *it;
+    }
+    else {
+      typename Record::type *it = (typename Record::type *)record_data;
+      typename Record::type *end = it + length;
+      for (; it != end; it++)
+        sum += *it;
+    }
+  }
+
+  // Only the aggregated stream is required
+  virtual uint32_t prefiltered_streams() const {
+    return (statement->function.flags);
+  }
+
+  // Integer sums can be added; floating point sums are not merged because
+  // the result would depend on the order of the additions
+  virtual bool supports_merge() const {
+    return (UpsResultType == UPS_TYPE_UINT64);
+  }
+
+  // Adds the sum of |other|
+  virtual void merge(ScanVisitor *other) {
+    sum += static_cast<SumIfScanVisitor *>(other)->sum;
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     uqi_result_initialize(result, UPS_TYPE_BINARY, UpsResultType);
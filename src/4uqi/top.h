@@ -76,6 +76,22 @@ struct TopScanVisitorBase : public NumericalScanVisitor {
       statement->limit = 1;
   }
 
+  // Partial results can only be merged if the values are unique, otherwise
+  // the result would depend on the order of the values; therefore only
+  // the key stream is supported
+  virtual bool supports_merge() const {
+    return (ISSET(statement->function.flags, UQI_STREAM_KEY));
+  }
+
+  // Merges the keys stored by |other|
+  virtual void merge(ScanVisitor *other) {
+    TopScanVisitorBase *o = static_cast<TopScanVisitorBase *>(other);
+    for (typename KeyMap::iterator it = o->stored_keys.begin();
+                    it != o->stored_keys.end(); it++)
+      min_key = store_min_value(it->first, min_key, it->second.data(),
+                      it->second.size(), stored_keys, statement->limit);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     uqi_result_initialize(result, key_type, record_type);
@@ -76,6 +76,16 @@ struct ValueScanVisitor : public ScanVisitor {
       aggregator.add_row(kdata, sizeof(Key), rdata, sizeof(Record));
   }
 
+  // The rows of the next partition are appended
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Appends the rows of |other|
+  virtual void merge(ScanVisitor *other) {
+    aggregator.append(static_cast<ValueScanVisitor *>(other)->aggregator);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     Result *final_result = (Result *)result;
@@ -146,6 +156,16 @@ struct ValueIfScanVisitor : public ScanVisitor {
     }
   }
 
+  // The rows of the next partition are appended
+  virtual bool supports_merge() const {
+    return (true);
+  }
+
+  // Appends the rows of |other|
+  virtual void merge(ScanVisitor *other) {
+    aggregator.append(static_cast<ValueIfScanVisitor *>(other)->aggregator);
+  }
+
   // Assigns the result to |result|
   virtual void assign_result(uqi_result_t *result) {
     Result *final_result = (Result *)result;
@@ -114,6 +114,12 @@ check_recno_key(ups_key_t *key, uint32_t flags)
   return (0);
 }
 
+static inline bool
+is_snapshot_txn(Transaction *txn)
+{
+  return (txn && ISSET(txn->get_flags(), UPS_TXN_SNAPSHOT));
+}
+
 ups_status_t
 ups_txn_begin(ups_txn_t **htxn, ups_env_t *henv, const char *name,
                 void *, uint32_t flags)
@@ -132,6 +138,12 @@ ups_txn_begin(ups_txn_t **htxn, ups_env_t *henv, const char *name,
     return (UPS_INV_PARAMETER);
   }
 
+  if (unlikely(ISSET(flags, UPS_TXN_SNAPSHOT)
+        && NOTSET(flags, UPS_TXN_READ_ONLY))) {
+    ups_trace(("flag UPS_TXN_SNAPSHOT requires UPS_TXN_READ_ONLY"));
+    return (UPS_INV_PARAMETER);
+  }
+
   Environment *env = (Environment *)henv;
 
   return (env->txn_begin(ptxn, name, flags));
@@ -339,6 +351,26 @@ ups_env_create(ups_env_t **henv, const char *filename,
       case UPS_PARAM_JOURNAL_SWITCH_THRESHOLD:
         config.journal_switch_threshold = (uint32_t)param->value;
         break;
+      case UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC:
+        config.journal_group_commit_usec = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        if (param->value == 0) {
+          ups_trace(("invalid value for UPS_PARAM_FLUSH_THREADS"));
+          return (UPS_INV_PARAMETER);
+        }
+        config.flush_threads = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_QUERY_THREADS:
+        if (param->value == 0) {
+          ups_trace(("invalid value for UPS_PARAM_QUERY_THREADS"));
+          return (UPS_INV_PARAMETER);
+        }
+        config.query_threads = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_SCAN_READAHEAD:
+        config.scan_readahead = (uint32_t)param->value;
+        break;
       case UPS_PARAM_LOG_DIRECTORY:
         config.log_filename = (const char *)param->value;
         break;
@@ -364,6 +396,14 @@ ups_env_create(ups_env_t **henv, const char *filename,
       case UPS_PARAM_POSIX_FADVISE:
         config.posix_advice = (int)param->value;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        if (param->value != UPS_CACHE_POLICY_LRU
+              && param->value != UPS_CACHE_POLICY_2Q) {
+          ups_trace(("unknown cache policy %d", (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.cache_policy = (int)param->value;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)param->name));
         return (UPS_INV_PARAMETER);
@@ -543,6 +583,26 @@ ups_env_open(ups_env_t **henv, const char *filename, uint32_t flags,
       case UPS_PARAM_JOURNAL_SWITCH_THRESHOLD:
         config.journal_switch_threshold = (uint32_t)param->value;
         break;
+      case UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC:
+        config.journal_group_commit_usec = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_FLUSH_THREADS:
+        if (param->value == 0) {
+          ups_trace(("invalid value for UPS_PARAM_FLUSH_THREADS"));
+          return (UPS_INV_PARAMETER);
+        }
+        config.flush_threads = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_QUERY_THREADS:
+        if (param->value == 0) {
+          ups_trace(("invalid value for UPS_PARAM_QUERY_THREADS"));
+          return (UPS_INV_PARAMETER);
+        }
+        config.query_threads = (uint32_t)param->value;
+        break;
+      case UPS_PARAM_SCAN_READAHEAD:
+        config.scan_readahead = (uint32_t)param->value;
+        break;
       case UPS_PARAM_LOG_DIRECTORY:
         config.log_filename = (const char *)param->value;
         break;
@@ -562,6 +622,14 @@ ups_env_open(ups_env_t **henv, const char *filename, uint32_t flags,
       case UPS_PARAM_POSIX_FADVISE:
         config.posix_advice = (int)param->value;
         break;
+      case UPS_PARAM_CACHE_POLICY:
+        if (param->value != UPS_CACHE_POLICY_LRU
+              && param->value != UPS_CACHE_POLICY_2Q) {
+          ups_trace(("unknown cache policy %d", (int)param->value));
+          return (UPS_INV_PARAMETER);
+        }
+        config.cache_policy = (int)param->value;
+        break;
       default:
         ups_trace(("unknown parameter %d", (int)param->name));
         return (UPS_INV_PARAMETER);
@@ -882,6 +950,10 @@ ups_db_insert(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
     ups_trace(("cannot insert in a read-only database"));
     return (UPS_WRITE_PROTECTED);
   }
+  if (unlikely(is_snapshot_txn(txn))) {
+    ups_trace(("cannot insert in a snapshot transaction"));
+    return (UPS_WRITE_PROTECTED);
+  }
   if (unlikely(ISSET(flags, UPS_DUPLICATE)
       && NOTSET(db->get_flags(), UPS_ENABLE_DUPLICATE_KEYS))) {
     ups_trace(("database does not support duplicate keys "
@@ -898,6 +970,43 @@ ups_db_insert(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key,
   return (db->insert(0, txn, key, record, flags));
 }
 
+UPS_EXPORT ups_status_t UPS_CALLCONV
+ups_db_bulk_insert(ups_db_t *hdb, ups_key_t *keys, ups_record_t *records,
+                uint32_t count, uint32_t fill_factor, uint32_t flags)
+{
+  Database *db = (Database *)hdb;
+
+  if (unlikely(!db)) {
+    ups_trace(("parameter 'db' must not be NULL"));
+    return UPS_INV_PARAMETER;
+  }
+  if (unlikely(count > 0 && (!keys || !records))) {
+    ups_trace(("parameters 'keys' and 'records' must not be NULL"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (unlikely(fill_factor > 100)) {
+    ups_trace(("parameter 'fill_factor' must not exceed 100"));
+    return (UPS_INV_PARAMETER);
+  }
+  if (unlikely(flags != 0)) {
+    ups_trace(("parameter 'flags' is unused, set to 0"));
+    return (UPS_INV_PARAMETER);
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (unlikely(!prepare_key(&keys[i]) || !prepare_record(&records[i])))
+      return (UPS_INV_PARAMETER);
+  }
+
+  ScopedLock lock(db->get_env()->mutex());
+
+  if (unlikely(ISSET(db->get_flags(), UPS_READ_ONLY))) {
+    ups_trace(("cannot insert in a read-only database"));
+    return (UPS_WRITE_PROTECTED);
+  }
+
+  return (db->bulk_insert(keys, records, count, fill_factor, flags));
+}
+
 UPS_EXPORT ups_status_t UPS_CALLCONV
 ups_db_erase(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key, uint32_t flags)
 {
@@ -924,6 +1033,10 @@ ups_db_erase(ups_db_t *hdb, ups_txn_t *htxn, ups_key_t *key, uint32_t flags)
     ups_trace(("cannot erase from a read-only database"));
     return (UPS_WRITE_PROTECTED);
   }
+  if (unlikely(is_snapshot_txn(txn))) {
+    ups_trace(("cannot erase in a snapshot transaction"));
+    return (UPS_WRITE_PROTECTED);
+  }
 
   return (db->erase(0, txn, key, flags));
 }
@@ -1047,6 +1160,10 @@ ups_cursor_overwrite(ups_cursor_t *hcursor, ups_record_t *record,
     ups_trace(("cannot overwrite in a read-only database"));
     return (UPS_WRITE_PROTECTED);
   }
+  if (unlikely(is_snapshot_txn(cursor->get_txn()))) {
+    ups_trace(("cannot overwrite in a snapshot transaction"));
+    return (UPS_WRITE_PROTECTED);
+  }
 
   return (cursor->overwrite(record, flags));
 }
@@ -1144,6 +1261,10 @@ ups_cursor_insert(ups_cursor_t *hcursor, ups_key_t *key, ups_record_t *record,
     ups_trace(("cannot insert to a read-only database"));
     return (UPS_WRITE_PROTECTED);
   }
+  if (unlikely(is_snapshot_txn(cursor->get_txn()))) {
+    ups_trace(("cannot insert in a snapshot transaction"));
+    return (UPS_WRITE_PROTECTED);
+  }
   if (unlikely(ISSET(flags, UPS_DUPLICATE)
       && NOTSET(db->get_flags(), UPS_ENABLE_DUPLICATE_KEYS))) {
     ups_trace(("database does not support duplicate keys "
@@ -1187,6 +1308,10 @@ ups_cursor_erase(ups_cursor_t *hcursor, uint32_t flags)
     ups_trace(("cannot erase from a read-only database"));
     return (UPS_WRITE_PROTECTED);
   }
+  if (unlikely(is_snapshot_txn(cursor->get_txn()))) {
+    ups_trace(("cannot erase in a snapshot transaction"));
+    return (UPS_WRITE_PROTECTED);
+  }
 
   return (db->erase(cursor, cursor->get_txn(), 0, flags));
 }
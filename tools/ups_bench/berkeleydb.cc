@@ -521,6 +521,12 @@ BerkeleyDatabase::do_cursor_close(Cursor *cursor)
   return (0);
 }
 
+ups_status_t
+BerkeleyDatabase::do_select(const char *query)
+{
+  return (UPS_NOT_IMPLEMENTED);
+}
+
 ups_status_t 
 BerkeleyDatabase::db2ham(int ret)
 {
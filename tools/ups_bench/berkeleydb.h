@@ -85,6 +85,7 @@ class BerkeleyDatabase : public Database
     virtual ups_status_t do_cursor_get_next(Cursor *cursor, ups_key_t *key, 
                     ups_record_t *record, bool skip_duplicates);
     virtual ups_status_t do_cursor_close(Cursor *cursor);
+    virtual ups_status_t do_select(const char *query);
 
   private:
     ups_status_t db2ham(int ret);
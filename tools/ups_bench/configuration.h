@@ -81,9 +81,13 @@ struct Configuration
       key_is_fixed_size(false), rec_size(kDefaultRecsize),
       erase_pct(0), find_pct(0), table_scan_pct(0), use_encryption(false),
       use_remote(false), duplicate(kDuplicateDisabled), overwrite(false),
-      transactions_nth(0), use_fsync(false), inmemory(false),
-      use_transactions(false), no_mmap(false),
-      cacheunlimited(false), cachesize(0), hints(0), pagesize(0),
+      transactions_nth(0), use_fsync(false), journal_group_commit_usec(0),
+      flush_threads(1), scan_readahead(8),
+      inmemory(false),
+      use_transactions(false), no_mmap(false), use_io_uring(false),
+      use_direct_io(false), use_huge_pages(false),
+      cacheunlimited(false), cachesize(0),
+      cache_policy(UPS_CACHE_POLICY_LRU), hints(0), pagesize(0),
       num_threads(1), use_cursors(false),
       use_berkeleydb(false), use_upscaledb(true), fullcheck(kFullcheckDefault),
       fullcheck_frequency(1000), metrics(kMetricsDefault),
@@ -133,6 +137,10 @@ struct Configuration
       "zint32_maskedvbyte",
       "zint32_for",
       "zint32_simdfor",
+      "prefix",
+      "zint64_for",
+      "zint64_streamvbyte",
+      "numeric",
     };
     std::cout << "Configuration: --seed=" << seed << " ";
     if (journal_compression)
@@ -150,6 +158,13 @@ struct Configuration
       std::cout << "--use-remote ";
     if (use_fsync)
       std::cout << "--use-fsync ";
+    if (journal_group_commit_usec)
+      std::cout << "--journal-group-commit=" << journal_group_commit_usec
+          << " ";
+    if (flush_threads != 1)
+      std::cout << "--flush-threads=" << flush_threads << " ";
+    if (scan_readahead != 8)
+      std::cout << "--scan-readahead=" << scan_readahead << " ";
     if (disable_recovery)
       std::cout << "--disable-recovery ";
     if (use_cursors)
@@ -164,10 +179,18 @@ struct Configuration
       std::cout << "--inmemorydb ";
     if (no_mmap)
       std::cout << "--no-mmap ";
+    if (use_io_uring)
+      std::cout << "--io-uring ";
+    if (use_direct_io)
+      std::cout << "--direct-io ";
+    if (use_huge_pages)
+      std::cout << "--huge-pages ";
     if (cacheunlimited)
       std::cout << "--cache=unlimited ";
     if (cachesize)
       std::cout << "--cache=" << cachesize << " ";
+    if (cache_policy == UPS_CACHE_POLICY_2Q)
+      std::cout << "--cache-policy=2q ";
     if (pagesize)
       std::cout << "--pagesize=" << pagesize << " ";
     if (num_threads > 1)
@@ -251,6 +274,8 @@ struct Configuration
         std::cout << "--find-pct=" << find_pct << " ";
       if (table_scan_pct)
         std::cout << "--table-scan-pct=" << table_scan_pct << " ";
+      if (!table_scan_query.empty())
+        std::cout << "--table-scan-query=\"" << table_scan_query << "\" ";
       if (read_only)
         std::cout << "--read-only ";
       std::cout << std::endl;
@@ -279,17 +304,25 @@ struct Configuration
   int erase_pct;
   int find_pct;
   int table_scan_pct;
+  std::string table_scan_query;
   bool use_encryption;
   bool use_remote;
   int duplicate;
   bool overwrite;
   uint32_t transactions_nth;
   bool use_fsync;
+  uint32_t journal_group_commit_usec;
+  uint32_t flush_threads;
+  uint32_t scan_readahead;
   bool inmemory;
   bool use_transactions;
   bool no_mmap;
+  bool use_io_uring;
+  bool use_direct_io;
+  bool use_huge_pages;
   bool cacheunlimited;
   int cachesize;
+  int cache_policy;
   int hints;
   int pagesize;
   int num_threads;
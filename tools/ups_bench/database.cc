@@ -151,3 +151,9 @@ Database::cursor_close(Database::Cursor *cursor)
   return (do_cursor_close(cursor));
 }
 
+ups_status_t 
+Database::select(const char *query)
+{
+  return (do_select(query));
+}
+
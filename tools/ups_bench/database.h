@@ -97,6 +97,9 @@ class Database
                     ups_record_t *record, bool skip_duplicates);
     ups_status_t cursor_close(Cursor *cursor);
 
+    // Runs a UQI query and discards the result
+    ups_status_t select(const char *query);
+
     // Fills |metrics| with additional metrics
     virtual void get_metrics(Metrics *metrics, bool live = false) = 0;
 
@@ -131,6 +134,7 @@ class Database
     virtual ups_status_t do_cursor_get_next(Cursor *cursor, ups_key_t *key, 
                     ups_record_t *record, bool skip_duplicates) = 0;
     virtual ups_status_t do_cursor_close(Cursor *cursor) = 0;
+    virtual ups_status_t do_select(const char *query) = 0;
 
     int m_id;
     Configuration *m_config;
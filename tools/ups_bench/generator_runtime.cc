@@ -487,6 +487,18 @@ RuntimeGenerator::tablescan()
 {
   tee("TABLESCAN");
 
+  // run a UQI query instead of iterating a cursor? Only supported by
+  // upscaledb
+  if (!m_config->table_scan_query.empty()) {
+    ups_status_t st = m_db->select(m_config->table_scan_query.c_str());
+    if (st == 0)
+      return;
+    if (st != UPS_NOT_IMPLEMENTED) {
+      printf("[FAIL] Unexpected status %d in table scan query\n", st);
+      exit(-1);
+    }
+  }
+
   Database::Cursor *cursor = m_cursor;
   if (!cursor)
     cursor = m_db->cursor_create();
@@ -95,6 +95,14 @@
 #define ARG_RECORD_NUMBER64                     70
 #define ARG_POSIX_FADVICE                       71
 #define ARG_SIMULATE_CRASHES                    72
+#define ARG_CACHE_POLICY                        73
+#define ARG_JOURNAL_GROUP_COMMIT                74
+#define ARG_FLUSH_THREADS                       75
+#define ARG_IO_URING                            76
+#define ARG_DIRECT_IO                           77
+#define ARG_HUGE_PAGES                          78
+#define ARG_TABLE_SCAN_QUERY                    79
+#define ARG_SCAN_READAHEAD                      80
 
 /*
  * command line parameters
@@ -266,6 +274,12 @@ static option_t opts[] = {
     "cache",
     "Sets the cachesize (use 0 for default) or 'unlimited'",
     GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_CACHE_POLICY,
+    0,
+    "cache-policy",
+    "Sets the page replacement policy of the cache: 'lru' (default), '2q'",
+    GETOPTS_NEED_ARGUMENT },
   {
     ARG_HINTING,
     0,
@@ -288,6 +302,44 @@ static option_t opts[] = {
     "use-fsync",
     "Calls fsync() when flushing to disk",
     0 },
+  {
+    ARG_JOURNAL_GROUP_COMMIT,
+    0,
+    "journal-group-commit",
+    "Syncs concurrent commits with a single fsync; sets the time window "
+      "in microseconds (requires --use-fsync)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_FLUSH_THREADS,
+    0,
+    "flush-threads",
+    "Number of background threads which flush modified pages (default: 1)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_IO_URING,
+    0,
+    "io-uring",
+    "Uses io_uring for page I/O and prefetches leaf pages during scans",
+    0 },
+  {
+    ARG_SCAN_READAHEAD,
+    0,
+    "scan-readahead",
+    "Number of leaf pages which are read ahead during sequential scans "
+      "(default: 8; 0 disables the read-ahead)",
+    GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_DIRECT_IO,
+    0,
+    "direct-io",
+    "Bypasses the page cache of the operating system (O_DIRECT)",
+    0 },
+  {
+    ARG_HUGE_PAGES,
+    0,
+    "huge-pages",
+    "Allocates the page buffers from huge pages",
+    0 },
   {
     ARG_USE_BERKELEYDB,
     0,
@@ -324,6 +376,13 @@ static option_t opts[] = {
     "table-scan-pct",
     "Percentage of table-scans (default: 0)",
     GETOPTS_NEED_ARGUMENT },
+  {
+    ARG_TABLE_SCAN_QUERY,
+    0,
+    "table-scan-query",
+    "Runs a UQI query (i.e. 'COUNT($key) FROM DATABASE 1 WHERE $record > 5') "
+      "instead of iterating a cursor in each table-scan",
+    GETOPTS_NEED_ARGUMENT },
   {
     ARG_STOP_TIME,
     0,
@@ -388,13 +447,15 @@ static option_t opts[] = {
     ARG_RECORD_COMPRESSION,
     0,
     "record-compression",
-    "Pro: Enables record compression ('none', 'zlib', 'snappy', 'lzf')",
+    "Pro: Enables record compression ('none', 'zlib', 'snappy', 'lzf', "
+            "'numeric')",
     GETOPTS_NEED_ARGUMENT },
   {
     ARG_KEY_COMPRESSION,
     0,
     "key-compression",
-    "Pro: Enables key compression ('none', 'zlib', 'snappy', 'lzf')",
+    "Pro: Enables key compression ('none', 'zlib', 'snappy', 'lzf', "
+            "'prefix', 'zint64_for', 'zint64_streamvbyte')",
     GETOPTS_NEED_ARGUMENT },
   {
     ARG_READ_ONLY,
@@ -460,11 +521,20 @@ parse_compression_type(std::string param)
     return (UPS_COMPRESSOR_UINT32_STREAMVBYTE);
   if (param == "zint32_maskedvbyte")
     return (UPS_COMPRESSOR_UINT32_MASKEDVBYTE);
+  if (param == "prefix")
+    return (UPS_COMPRESSOR_PREFIX);
+  if (param == "zint64_for")
+    return (UPS_COMPRESSOR_UINT64_FOR);
+  if (param == "zint64_streamvbyte")
+    return (UPS_COMPRESSOR_UINT64_STREAMVBYTE);
+  if (param == "numeric")
+    return (UPS_COMPRESSOR_NUMERIC);
   ::printf("invalid compression specifier '%s': expecting 'none', 'zlib', "
               "'snappy', 'lzf', 'zint32_varbyte', 'zint32_simdcomp', "
               "'zint32_groupvarint', 'zint32_streamvbyte', "
               "'zint32_maskedvbyte', 'zint32_for', "
-              "'zint32_simdfor'\n",
+              "'zint32_simdfor', 'prefix', 'zint64_for', "
+              "'zint64_streamvbyte', 'numeric'\n",
               param.c_str());
   ::exit(-1);
 }
@@ -628,6 +698,16 @@ parse_config(int argc, char **argv, Configuration *c)
       else
         c->cachesize = strtoul(param, 0, 0);
     }
+    else if (opt == ARG_CACHE_POLICY) {
+      if (!strcmp(param, "lru"))
+        c->cache_policy = UPS_CACHE_POLICY_LRU;
+      else if (!strcmp(param, "2q"))
+        c->cache_policy = UPS_CACHE_POLICY_2Q;
+      else {
+        printf("[FAIL] invalid parameter for 'cache-policy'\n");
+        exit(-1);
+      }
+    }
     else if (opt == ARG_HINTING) {
       if (!param) {
         ::printf("[FAIL] missing parameter for '--hints'\n");
@@ -645,6 +725,28 @@ parse_config(int argc, char **argv, Configuration *c)
     else if (opt == ARG_USE_FSYNC) {
       c->use_fsync = true;
     }
+    else if (opt == ARG_JOURNAL_GROUP_COMMIT) {
+      c->journal_group_commit_usec = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_FLUSH_THREADS) {
+      c->flush_threads = strtoul(param, 0, 0);
+      if (!c->flush_threads) {
+        ::printf("[FAIL] invalid parameter for --flush-threads\n");
+        exit(-1);
+      }
+    }
+    else if (opt == ARG_IO_URING) {
+      c->use_io_uring = true;
+    }
+    else if (opt == ARG_SCAN_READAHEAD) {
+      c->scan_readahead = strtoul(param, 0, 0);
+    }
+    else if (opt == ARG_DIRECT_IO) {
+      c->use_direct_io = true;
+    }
+    else if (opt == ARG_HUGE_PAGES) {
+      c->use_huge_pages = true;
+    }
     else if (opt == ARG_USE_BERKELEYDB) {
       c->use_berkeleydb = true;
     }
@@ -740,6 +842,13 @@ parse_config(int argc, char **argv, Configuration *c)
         exit(-1);
       }
     }
+    else if (opt == ARG_TABLE_SCAN_QUERY) {
+      if (!param) {
+        printf("[FAIL] missing parameter for 'table-scan-query'\n");
+        exit(-1);
+      }
+      c->table_scan_query = param;
+    }
     else if (opt == ARG_STOP_TIME) {
       c->limit_seconds = strtoul(param, 0, 0);
       if (!c->limit_seconds) {
@@ -985,6 +1094,10 @@ print_metrics(Metrics *metrics, Configuration *conf)
           (long unsigned int)metrics->upscaledb_metrics.cache_hits);
   printf("\tupscaledb cache_misses                %lu\n",
           (long unsigned int)metrics->upscaledb_metrics.cache_misses);
+  printf("\tupscaledb cache_ghost_hits            %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.cache_ghost_hits);
+  printf("\tupscaledb cache_shards                %u\n",
+          (unsigned)metrics->upscaledb_metrics.cache_shards);
   printf("\tupscaledb blob_total_allocated        %lu\n",
           (long unsigned int)metrics->upscaledb_metrics.blob_total_allocated);
   printf("\tupscaledb blob_total_read             %lu\n",
@@ -999,6 +1112,32 @@ print_metrics(Metrics *metrics, Configuration *conf)
           (long unsigned int)metrics->upscaledb_metrics.extended_duptables);
   printf("\tupscaledb journal_bytes_flushed       %lu\n",
           (long unsigned int)metrics->upscaledb_metrics.journal_bytes_flushed);
+  printf("\tupscaledb journal_group_commits       %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.journal_group_commits);
+  printf("\tupscaledb journal_group_fsyncs        %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.journal_group_fsyncs);
+  printf("\tupscaledb io_uring_submissions        %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.io_uring_submissions);
+  printf("\tupscaledb io_uring_max_queue_depth     %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.io_uring_max_queue_depth);
+  printf("\tupscaledb io_uring_latency_usec        %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.io_uring_latency_usec);
+  printf("\tupscaledb page_count_prefetched        %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_count_prefetched);
+  printf("\tupscaledb page_count_prefetch_hits     %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_count_prefetch_hits);
+  printf("\tupscaledb page_count_prefetch_wasted   %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_count_prefetch_wasted);
+  printf("\tupscaledb page_buffer_bytes            %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_buffer_bytes);
+  printf("\tupscaledb page_buffers_pooled          %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_buffers_pooled);
+  printf("\tupscaledb page_buffers_in_use          %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_buffers_in_use);
+  printf("\tupscaledb page_buffer_huge_page_bytes  %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_buffer_huge_page_bytes);
+  printf("\tupscaledb page_buffer_overflows        %lu\n",
+          (long unsigned int)metrics->upscaledb_metrics.page_buffer_overflows);
   printf("\tupscaledb simd_lane_width             %d\n",
           metrics->upscaledb_metrics.simd_lane_width);
 }
@@ -1054,6 +1193,8 @@ add_metrics(Metrics *metrics, const Metrics *other)
   metrics->erase_latency_total += other->erase_latency_total;
   metrics->find_latency_total += other->find_latency_total;
   metrics->txn_commit_latency_total += other->txn_commit_latency_total;
+  if (other->elapsed_wallclock_seconds > metrics->elapsed_wallclock_seconds)
+    metrics->elapsed_wallclock_seconds = other->elapsed_wallclock_seconds;
 }
 
 template<typename DatabaseType, typename GeneratorType>
@@ -1099,9 +1240,9 @@ run_single_test(Configuration *conf)
   std::vector<Callable *>::iterator cit = callables.begin();
   for (it = threads.begin(); it != threads.end(); it++, cit++) {
     Metrics m;
+    (*it)->join();
     (*cit)->get_metrics(&m);
     add_metrics(&metrics, &m);
-    (*it)->join();
     delete *it;
     delete *cit;
   }
@@ -1123,6 +1264,14 @@ run_single_test(Configuration *conf)
     if (!conf->quiet || conf->metrics != Configuration::kMetricsNone) {
       printf("\ttotal elapsed time (sec)                 %f\n",
                   metrics.elapsed_wallclock_seconds);
+      // the throughput of all threads, measured against the wall clock
+      if (conf->num_threads > 1)
+        printf("\ttotal throughput (%d threads)           %f/sec\n",
+                  conf->num_threads,
+                  (double)(metrics.insert_ops + metrics.erase_ops
+                        + metrics.find_ops + metrics.txn_commit_ops
+                        + metrics.other_ops)
+                      / metrics.elapsed_wallclock_seconds);
       print_metrics(&metrics, conf);
     }
   }
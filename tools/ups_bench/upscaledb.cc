@@ -19,6 +19,7 @@
 #include <boost/filesystem.hpp>
 
 #include <ups/upscaledb_int.h>
+#include <ups/upscaledb_uqi.h>
 
 #include "metrics.h"
 #include "configuration.h"
@@ -72,7 +73,7 @@ UpscaleDatabase::do_create_env()
 {
   ups_status_t st = 0;
   uint32_t flags = 0;
-  ups_parameter_t params[6] = {{0, 0}};
+  ups_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -92,6 +93,18 @@ UpscaleDatabase::do_create_env()
     params[p].name = UPS_PARAM_POSIX_FADVISE;
     params[p].value = m_config->posix_fadvice;
     p++;
+    params[p].name = UPS_PARAM_CACHE_POLICY;
+    params[p].value = m_config->cache_policy;
+    p++;
+    params[p].name = UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC;
+    params[p].value = m_config->journal_group_commit_usec;
+    p++;
+    params[p].name = UPS_PARAM_FLUSH_THREADS;
+    params[p].value = m_config->flush_threads;
+    p++;
+    params[p].name = UPS_PARAM_SCAN_READAHEAD;
+    params[p].value = m_config->scan_readahead;
+    p++;
     if (m_config->use_encryption) {
       params[p].name = UPS_PARAM_ENCRYPTION_KEY;
       params[p].value = (uint64_t)"1234567890123456";
@@ -105,6 +118,9 @@ UpscaleDatabase::do_create_env()
 
     flags |= m_config->inmemory ? UPS_IN_MEMORY : 0; 
     flags |= m_config->no_mmap ? UPS_DISABLE_MMAP : 0; 
+    flags |= m_config->use_io_uring ? UPS_ENABLE_IO_URING : 0;
+    flags |= m_config->use_direct_io ? UPS_ENABLE_DIRECT_IO : 0;
+    flags |= m_config->use_huge_pages ? UPS_ENABLE_HUGE_PAGES : 0;
     flags |= m_config->cacheunlimited ? UPS_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions ? UPS_ENABLE_TRANSACTIONS : 0;
     flags |= m_config->use_fsync ? UPS_ENABLE_FSYNC : 0;
@@ -154,7 +170,7 @@ UpscaleDatabase::do_open_env()
 {
   ups_status_t st = 0;
   uint32_t flags = 0;
-  ups_parameter_t params[6] = {{0, 0}};
+  ups_parameter_t params[12] = {{0, 0}};
 
   ScopedLock lock(ms_mutex);
 
@@ -172,6 +188,18 @@ UpscaleDatabase::do_open_env()
     params[p].name = UPS_PARAM_POSIX_FADVISE;
     params[p].value = m_config->posix_fadvice;
     p++;
+    params[p].name = UPS_PARAM_CACHE_POLICY;
+    params[p].value = m_config->cache_policy;
+    p++;
+    params[p].name = UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC;
+    params[p].value = m_config->journal_group_commit_usec;
+    p++;
+    params[p].name = UPS_PARAM_FLUSH_THREADS;
+    params[p].value = m_config->flush_threads;
+    p++;
+    params[p].name = UPS_PARAM_SCAN_READAHEAD;
+    params[p].value = m_config->scan_readahead;
+    p++;
     if (m_config->use_encryption) {
       params[p].name = UPS_PARAM_ENCRYPTION_KEY;
       params[p].value = (uint64_t)"1234567890123456";
@@ -179,6 +207,9 @@ UpscaleDatabase::do_open_env()
     }
 
     flags |= m_config->no_mmap ? UPS_DISABLE_MMAP : 0; 
+    flags |= m_config->use_io_uring ? UPS_ENABLE_IO_URING : 0;
+    flags |= m_config->use_direct_io ? UPS_ENABLE_DIRECT_IO : 0;
+    flags |= m_config->use_huge_pages ? UPS_ENABLE_HUGE_PAGES : 0;
     flags |= m_config->cacheunlimited ? UPS_CACHE_UNLIMITED : 0;
     flags |= m_config->use_transactions
                 ? (UPS_ENABLE_TRANSACTIONS | UPS_AUTO_RECOVERY)
@@ -229,6 +260,8 @@ UpscaleDatabase::do_close_env()
 
   if (m_env)
     ups_env_get_metrics(m_env, &m_upscaledb_metrics);
+  else if (ms_env)
+    ups_env_get_metrics(ms_env, &m_upscaledb_metrics);
 
   if (ms_refcount == 0) {
     assert(m_env == 0);
@@ -399,7 +432,7 @@ UpscaleDatabase::do_create_db(int id)
 ups_status_t
 UpscaleDatabase::do_open_db(int id)
 {
-  ups_parameter_t params[6] = {{0, 0}};
+  ups_parameter_t params[8] = {{0, 0}};
   ups_register_compare("cmp", compare_keys);
 
   ups_status_t st = ups_env_open_db(m_env ? m_env : ms_env,
@@ -611,3 +644,17 @@ UpscaleDatabase::do_cursor_close(Cursor *cursor)
   return (ups_cursor_close((ups_cursor_t *)cursor));
 }
 
+ups_status_t
+UpscaleDatabase::do_select(const char *query)
+{
+  uqi_result_t *result;
+  ups_status_t st = uqi_select(m_env ? m_env : ms_env, query, &result);
+  if (st) {
+    LOG_ERROR(("uqi_select failed with error %d (%s)\n",
+                st, ups_strerror(st)));
+    return (st);
+  }
+  uqi_result_close(result);
+  return (0);
+}
+
@@ -86,6 +86,7 @@ class UpscaleDatabase : public Database
     virtual ups_status_t do_cursor_get_next(Cursor *cursor, ups_key_t *key, 
                     ups_record_t *record, bool skip_duplicates);
     virtual ups_status_t do_cursor_close(Cursor *cursor);
+    virtual ups_status_t do_select(const char *query);
 
   private:
     static Mutex ms_mutex;
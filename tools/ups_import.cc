@@ -20,6 +20,9 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#include <string>
+#include <vector>
+
 #include <ups/upscaledb.h>
 
 #include "getopts.h"
@@ -30,6 +33,10 @@
 #define ARG_STDIN         2
 #define ARG_MERGE         3
 
+// The number of items which are inserted with a single call to
+// ups_db_bulk_insert()
+#define BULK_INSERT_BATCH 10000
+
 
 /*
  * command line parameters
@@ -82,12 +89,13 @@ class BinaryImporter : public Importer {
   public:
     BinaryImporter(FILE *f, ups_env_t *env, const char *outfilename)
       : Importer(f, env, outfilename), m_db(0), m_insert_flags(0),
-        m_db_counter(0), m_item_counter(0) {
+        m_use_bulk_insert(false), m_db_counter(0), m_item_counter(0) {
       m_buffer = (char *)malloc(1024 * 1024);
     }
 
     ~BinaryImporter() {
       free(m_buffer);
+      flush_items();
       if (m_env)
         ups_env_close(m_env, UPS_AUTO_CLEANUP);
       printf("Imported %u databases with %u items.\n",
@@ -169,6 +177,7 @@ class BinaryImporter : public Importer {
       };
 
       if (m_db) {
+        flush_items();
         ups_db_close(m_db, 0);
         m_db = 0;
       }
@@ -184,6 +193,11 @@ class BinaryImporter : public Importer {
       open_flags &= ~UPS_ENABLE_DUPLICATE_KEYS;
       open_flags &= ~UPS_IGNORE_MISSING_CALLBACK;
 
+      // the exported items are sorted; they are bulk-loaded unless the
+      // database stores duplicate keys
+      m_use_bulk_insert = !(db.flags() & UPS_ENABLE_DUPLICATE_KEYS)
+                && !(db.flags() & (UPS_RECORD_NUMBER32 | UPS_RECORD_NUMBER64));
+
       ups_status_t st = ups_env_open_db(m_env, &m_db, db.name(), open_flags, 0);
       if (st == 0)
         return;
@@ -198,9 +212,18 @@ class BinaryImporter : public Importer {
     void read_item(HamsterTool::Datum &datum) {
       const HamsterTool::Item &item = datum.item();
 
-      const std::string &skey(item.key());
-      const std::string &srec(item.record());
+      if (m_use_bulk_insert) {
+        m_keys.push_back(item.key());
+        m_records.push_back(item.record());
+        if (m_keys.size() == BULK_INSERT_BATCH)
+          flush_items();
+        return;
+      }
+
+      insert_item(item.key(), item.record());
+    }
 
+    void insert_item(const std::string &skey, const std::string &srec) {
       ups_key_t k = {};
       k.data = (void *)skey.data();
       k.size = skey.size();
@@ -213,6 +236,36 @@ class BinaryImporter : public Importer {
         error("ups_db_insert", st);
     }
 
+    // Inserts the buffered items with ups_db_bulk_insert(); falls back
+    // to ups_db_insert() if this fails, i.e. because the items are merged
+    // into existing data
+    void flush_items() {
+      if (m_keys.empty())
+        return;
+
+      std::vector<ups_key_t> keys(m_keys.size());
+      std::vector<ups_record_t> records(m_keys.size());
+      for (size_t i = 0; i < m_keys.size(); i++) {
+        keys[i].data = (void *)m_keys[i].data();
+        keys[i].size = m_keys[i].size();
+        records[i].data = (void *)m_records[i].data();
+        records[i].size = m_records[i].size();
+      }
+
+      ups_status_t st = ups_db_bulk_insert(m_db, &keys[0], &records[0],
+                            (uint32_t)keys.size(), 0, 0);
+      if (st == UPS_INV_PARAMETER || st == UPS_NOT_IMPLEMENTED) {
+        m_use_bulk_insert = false;
+        for (size_t i = 0; i < m_keys.size(); i++)
+          insert_item(m_keys[i], m_records[i]);
+      }
+      else if (st)
+        error("ups_db_bulk_insert", st);
+
+      m_keys.clear();
+      m_records.clear();
+    }
+
     uint32_t read_size() {
       int n;
       uint32_t size;
@@ -230,6 +283,9 @@ class BinaryImporter : public Importer {
     char *m_buffer;
     ups_db_t *m_db;
     uint32_t m_insert_flags;
+    bool m_use_bulk_insert;
+    std::vector<std::string> m_keys;
+    std::vector<std::string> m_records;
     size_t m_db_counter;
     size_t m_item_counter;
 };
@@ -96,6 +96,14 @@ get_compressor_name(int library) {
       return ("for");
     case UPS_COMPRESSOR_UINT32_MASKEDVBYTE:
       return ("maskedvbyte");
+    case UPS_COMPRESSOR_PREFIX:
+      return ("prefix");
+    case UPS_COMPRESSOR_UINT64_FOR:
+      return ("zint64_for");
+    case UPS_COMPRESSOR_UINT64_STREAMVBYTE:
+      return ("zint64_streamvbyte");
+    case UPS_COMPRESSOR_NUMERIC:
+      return ("numeric");
     default:
       return ("???");
   }
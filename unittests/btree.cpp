@@ -17,6 +17,9 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <string>
+#include <vector>
+
 #include "utils.h"
 #include "os.hpp"
 
@@ -382,6 +385,123 @@ struct BtreeFixture {
 
     REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
   }
+
+  // Compares the lookups in the root node (which uses the BtreeFenceIndex)
+  // with a linear search
+  void verifyRootNode(ups_db_t *db, std::vector<std::string> &probes) {
+    LocalEnvironment *lenv = ((LocalDatabase *)db)->lenv();
+    BtreeIndex *btree = ((LocalDatabase *)db)->btree_index();
+    Context context(lenv, 0, 0);
+
+    Page *page = lenv->page_manager()->fetch(&context, btree->root_address());
+    context.changeset.clear(); // unlock pages
+    BtreeNodeProxy *node = btree->get_node_from_page(page);
+    REQUIRE(node->is_leaf() == false);
+    REQUIRE(node->length() >= (uint32_t)BtreeFenceIndex::kMinimumLength);
+
+    for (size_t p = 0; p < probes.size(); p++) {
+      ups_key_t key = ups_make_key((void *)probes[p].data(),
+                            (uint16_t)probes[p].size());
+
+      int expected_slot = -1;
+      int expected_cmp = -1;
+      for (int i = 0; i < (int)node->length(); i++) {
+        int cmp = node->compare(&context, &key, i);
+        if (cmp < 0)
+          break;
+        expected_slot = i;
+        expected_cmp = cmp == 0 ? 0 : 1;
+      }
+
+      uint64_t record_id;
+      int cmp;
+      int slot = node->find_lower_bound(&context, &key, &record_id, &cmp);
+      REQUIRE(slot == expected_slot);
+      REQUIRE((cmp < 0 ? -1 : (cmp > 0 ? 1 : 0)) == expected_cmp);
+      if (slot == -1)
+        REQUIRE(record_id == node->left_child());
+      else
+        REQUIRE(record_id == node->record_id(&context, slot));
+    }
+  }
+
+  void fenceIndexTest(uint32_t key_size, int compressor = 0) {
+    ups_db_t *db;
+    ups_env_t *env;
+    ups_parameter_t p[] = {
+        { UPS_PARAM_KEY_TYPE, UPS_TYPE_BINARY },
+        { UPS_PARAM_KEY_SIZE, key_size },
+        { compressor ? UPS_PARAM_KEY_COMPRESSION : 0, (uint64_t)compressor },
+        { 0, 0 }
+    };
+
+    REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+    REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &p[0]));
+
+    // url-like keys with a long common prefix
+    const int kMaxKeys = 20000;
+    std::vector<std::string> keys;
+    for (int i = 0; i < kMaxKeys; i++) {
+      char buffer[64];
+      ::snprintf(buffer, sizeof(buffer), "http://www.example.com/%08d%s",
+                      i * 2, key_size == UPS_KEY_SIZE_UNLIMITED
+                                ? &"/index.html"[i % 11]
+                                : "");
+      std::string s(buffer);
+      if (key_size != UPS_KEY_SIZE_UNLIMITED)
+        s.resize(key_size, '\0');
+      keys.push_back(s);
+    }
+
+    ups_record_t rec = {0};
+    for (int i = 0; i < kMaxKeys; i++) {
+      ups_key_t key = ups_make_key((void *)keys[i].data(),
+                            (uint16_t)keys[i].size());
+      REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+    }
+
+    // probe the existing keys, the keys in between and keys which are
+    // smaller or greater than all other keys
+    std::vector<std::string> probes(keys);
+    for (int i = 0; i < kMaxKeys; i += 7) {
+      std::string s = keys[i];
+      s[30] = '1';
+      probes.push_back(s);
+    }
+    probes.push_back(std::string(key_size == UPS_KEY_SIZE_UNLIMITED
+                            ? 0 : key_size, '\0'));
+    probes.push_back(std::string(key_size == UPS_KEY_SIZE_UNLIMITED
+                            ? 16 : key_size, '\xff'));
+    if (key_size == UPS_KEY_SIZE_UNLIMITED) {
+      probes.push_back("http://");
+      probes.push_back("http://www.example.com/");
+      probes.push_back("http://www.example.com/0001");
+    }
+    verifyRootNode(db, probes);
+
+    // modify the btree, then verify again (the index is rebuilt)
+    for (int i = 0; i < kMaxKeys; i += 3) {
+      ups_key_t key = ups_make_key((void *)keys[i].data(),
+                            (uint16_t)keys[i].size());
+      REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+    }
+    for (int i = 0; i < kMaxKeys; i += 7) {
+      ups_key_t key = ups_make_key((void *)probes[kMaxKeys + i / 7].data(),
+                            (uint16_t)probes[kMaxKeys + i / 7].size());
+      REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, UPS_OVERWRITE));
+    }
+    verifyRootNode(db, probes);
+
+    // and make sure that all keys are found
+    for (int i = 0; i < kMaxKeys; i++) {
+      ups_key_t key = ups_make_key((void *)keys[i].data(),
+                            (uint16_t)keys[i].size());
+      REQUIRE((i % 3 == 0 ? UPS_KEY_NOT_FOUND : 0)
+                      == ups_db_find(db, 0, &key, &rec, 0));
+    }
+
+    REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  }
 };
 
 TEST_CASE("Btree/binaryTypeTest", "")
@@ -468,5 +588,23 @@ TEST_CASE("Btree/forceInternalNodeTest", "")
   f.forceInternalNodeTest();
 }
 
+TEST_CASE("Btree/fenceIndexVariableKeysTest", "")
+{
+  BtreeFixture f;
+  f.fenceIndexTest(UPS_KEY_SIZE_UNLIMITED);
+}
+
+TEST_CASE("Btree/fenceIndexFixedKeysTest", "")
+{
+  BtreeFixture f;
+  f.fenceIndexTest(40);
+}
+
+TEST_CASE("Btree/fenceIndexCompressedKeysTest", "")
+{
+  BtreeFixture f;
+  f.fenceIndexTest(UPS_KEY_SIZE_UNLIMITED, UPS_COMPRESSOR_LZF);
+}
+
 
 } // namespace upscaledb
@@ -17,6 +17,9 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include "utils.h"
 #include "os.hpp"
 
@@ -199,3 +202,232 @@ TEST_CASE("BtreeInsert/sequentialInsertPivotTest", "")
   f.sequentialInsertPivotTest();
 }
 
+
+struct BulkInsertFixture {
+  ups_db_t *m_db;
+  ups_env_t *m_env;
+  uint32_t m_env_flags;
+  bool m_binary_keys;
+
+  BulkInsertFixture(uint32_t env_flags = 0, uint32_t key_type = UPS_TYPE_UINT32)
+    : m_db(0), m_env(0), m_env_flags(env_flags),
+      m_binary_keys(key_type == UPS_TYPE_BINARY) {
+    ups_parameter_t params[] = {
+      { UPS_PARAM_KEY_TYPE, key_type },
+      { 0, 0 }
+    };
+
+    os::unlink(Utils::opath(".test"));
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"), env_flags, 0644, 0));
+    REQUIRE(0 ==
+        ups_env_create_db(m_env, &m_db, 1, 0, &params[0]));
+  }
+
+  ~BulkInsertFixture() {
+    if (m_env)
+	  REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+  }
+
+  // Returns the key data for |i|; binary keys are stored in big-endian
+  // format, otherwise memcmp() would not sort them numerically
+  uint32_t key_data(uint32_t i) const {
+    if (!m_binary_keys)
+      return i;
+    return ((i & 0xff) << 24) | ((i & 0xff00) << 8)
+            | ((i >> 8) & 0xff00) | (i >> 24);
+  }
+
+  // bulk-inserts the keys [start, end[ in batches of |batch| keys
+  void bulk_insert(uint32_t start, uint32_t end, uint32_t batch,
+                  uint32_t fill_factor = 0) {
+    std::vector<uint32_t> data(batch);
+    std::vector<uint32_t> key_buffer(batch);
+    std::vector<ups_key_t> keys(batch);
+    std::vector<ups_record_t> records(batch);
+
+    for (uint32_t i = start; i < end; i += batch) {
+      uint32_t count = std::min(batch, end - i);
+      for (uint32_t j = 0; j < count; j++) {
+        data[j] = i + j;
+        key_buffer[j] = key_data(i + j);
+        keys[j] = ups_make_key(&key_buffer[j], sizeof(key_buffer[j]));
+        records[j] = ups_make_record(&data[j], sizeof(data[j]));
+      }
+      REQUIRE(0 == ups_db_bulk_insert(m_db, &keys[0], &records[0], count,
+                              fill_factor, 0));
+    }
+  }
+
+  // verifies that the keys [start, end[ exist
+  void verify(uint32_t start, uint32_t end) {
+    for (uint32_t i = start; i < end; i++) {
+      uint32_t k = key_data(i);
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == sizeof(i));
+      REQUIRE(*(uint32_t *)rec.data == i);
+    }
+
+    uint64_t count;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(count == end - start);
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+  }
+
+  void reopen() {
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), m_env_flags, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  void bulkInsertTest() {
+    bulk_insert(0, 100000, 10000);
+    verify(0, 100000);
+
+    // the keys are in sorted order
+    ups_cursor_t *cursor;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    for (uint32_t i = 0; i < 100000; i++) {
+      REQUIRE(0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+      REQUIRE(*(uint32_t *)key.data == key_data(i));
+    }
+    REQUIRE(UPS_KEY_NOT_FOUND
+              == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    reopen();
+    verify(0, 100000);
+
+    // continue with another batch, then with regular inserts
+    bulk_insert(100000, 120000, 5000);
+    for (uint32_t i = 120000; i < 130000; i++) {
+      uint32_t k = key_data(i);
+      key = ups_make_key(&k, sizeof(k));
+      rec = ups_make_record(&i, sizeof(i));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    verify(0, 130000);
+  }
+
+  void invalidKeysTest() {
+    uint32_t data[3] = {10, 20, 30};
+    ups_key_t keys[3];
+    ups_record_t records[3] = {{0}};
+    for (int i = 0; i < 3; i++)
+      keys[i] = ups_make_key(&data[i], sizeof(data[i]));
+
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(0, keys, records, 3, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(m_db, 0, records, 3, 0, 0));
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(m_db, keys, records, 3, 101, 0));
+    REQUIRE(0 == ups_db_bulk_insert(m_db, keys, records, 0, 0, 0));
+
+    // keys are not sorted
+    data[1] = 5;
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(m_db, keys, records, 3, 0, 0));
+    // keys are not unique
+    data[1] = 10;
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(m_db, keys, records, 3, 0, 0));
+    data[1] = 20;
+    REQUIRE(0 == ups_db_bulk_insert(m_db, keys, records, 3, 0, 0));
+
+    // keys are not greater than the existing keys
+    REQUIRE(UPS_INV_PARAMETER
+              == ups_db_bulk_insert(m_db, &keys[2], &records[2], 1, 0, 0));
+    uint64_t count;
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(count == 3);
+  }
+
+  void fillFactorTest() {
+    ups_env_metrics_t metrics;
+    bulk_insert(0, 50000, 50000, 100);
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    uint64_t packed = metrics.page_count_type_index;
+
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 ==
+        ups_env_create(&m_env, Utils::opath(".test"), m_env_flags, 0644, 0));
+    ups_parameter_t params[] = {
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+      { 0, 0 }
+    };
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, &params[0]));
+
+    bulk_insert(0, 50000, 50000, 50);
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.page_count_type_index > packed * 18 / 10);
+    verify(0, 50000);
+
+    // the free space is used by subsequent inserts
+    for (uint32_t i = 0; i < 50000; i++) {
+      uint32_t k = 100000 + i;
+      ups_key_t key = ups_make_key(&k, sizeof(k));
+      ups_record_t rec = ups_make_record(&k, sizeof(k));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+  }
+
+  void transactionTest() {
+    ups_txn_t *txn;
+    uint32_t data = 1;
+    ups_key_t key = ups_make_key(&data, sizeof(data));
+    ups_record_t rec = ups_make_record(&data, sizeof(data));
+
+    // a committed Transaction is flushed before the keys are inserted
+    REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+    REQUIRE(0 == ups_db_insert(m_db, txn, &key, &rec, 0));
+    REQUIRE(0 == ups_txn_commit(txn, 0));
+    bulk_insert(2, 1000, 1000);
+
+    // an active Transaction blocks the bulk insert
+    REQUIRE(0 == ups_txn_begin(&txn, m_env, 0, 0, 0));
+    data = 1000;
+    REQUIRE(UPS_TXN_STILL_OPEN
+              == ups_db_bulk_insert(m_db, &key, &rec, 1, 0, 0));
+    REQUIRE(0 == ups_txn_abort(txn, 0));
+    REQUIRE(0 == ups_db_bulk_insert(m_db, &key, &rec, 1, 0, 0));
+
+    reopen();
+    verify(1, 1001);
+  }
+};
+
+TEST_CASE("BtreeInsert/bulkInsertTest", "")
+{
+  BulkInsertFixture f;
+  f.bulkInsertTest();
+}
+
+TEST_CASE("BtreeInsert/bulkInsertInvalidKeysTest", "")
+{
+  BulkInsertFixture f;
+  f.invalidKeysTest();
+}
+
+TEST_CASE("BtreeInsert/bulkInsertFillFactorTest", "")
+{
+  BulkInsertFixture f;
+  f.fillFactorTest();
+}
+
+TEST_CASE("BtreeInsert/bulkInsertBinaryKeysTest", "")
+{
+  BulkInsertFixture f(0, UPS_TYPE_BINARY);
+  f.bulkInsertTest();
+}
+
+TEST_CASE("BtreeInsert/bulkInsertTransactionTest", "")
+{
+  BulkInsertFixture f(UPS_ENABLE_TRANSACTIONS);
+  f.transactionTest();
+}
@@ -124,5 +124,54 @@ TEST_CASE("Changeset/clear",
     delete page[i];
 }
 
-} // namespace upscaledb
+TEST_CASE("Changeset/parallelFlushTest",
+          "Flushes large Changesets with multiple flusher threads")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  ups_parameter_t params[] = {
+      {UPS_PARAM_PAGE_SIZE, 1024},
+      {UPS_PARAM_FLUSH_THREADS, 4},
+      {0, 0}
+  };
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"),
+              UPS_ENABLE_TRANSACTIONS | UPS_ENABLE_FSYNC, 0644, &params[0]));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, 0));
+
+  ups_parameter_t query[] = {
+      {UPS_PARAM_FLUSH_THREADS, 0},
+      {0, 0}
+  };
+  REQUIRE(0 == ups_env_get_parameters(env, &query[0]));
+  REQUIRE(4u == query[0].value);
+
+  // a zero thread count is rejected
+  ups_env_t *env2;
+  params[1].value = 0;
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create(&env2,
+              Utils::opath(".test2"), 0, 0644, &params[0]));
+
+  // a single Transaction creates a single (large) Changeset
+  ups_txn_t *txn;
+  char buffer[200] = {0};
+  REQUIRE(0 == ups_txn_begin(&txn, env, 0, 0, 0));
+  for (uint32_t i = 0; i < 2000; i++) {
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t rec = ups_make_record(&buffer[0], sizeof(buffer));
+    REQUIRE(0 == ups_db_insert(db, txn, &key, &rec, 0));
+  }
+  REQUIRE(0 == ups_txn_commit(txn, 0));
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+
+  REQUIRE(0 == ups_env_open(&env, Utils::opath(".test"), 0, 0));
+  REQUIRE(0 == ups_env_open_db(env, &db, 1, 0, 0));
+  for (uint32_t i = 0; i < 2000; i++) {
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t rec = {0};
+    REQUIRE(0 == ups_db_find(db, 0, &key, &rec, 0));
+    REQUIRE(sizeof(buffer) == rec.size);
+  }
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
 
+} // namespace upscaledb
@@ -17,6 +17,15 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ups/upscaledb_uqi.h>
+
 #include "utils.h"
 
 #include "1base/dynamic_array.h"
@@ -473,3 +482,485 @@ TEST_CASE("Compression/unknownCompressorTest", "")
 
   REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
 }
+
+// Creates a URL-like key; keys with a multiple of 7 have a different host,
+// keys with a multiple of 50 are long enough to become extended keys
+static void
+make_url_key(int i, std::string *s)
+{
+  char buffer[64];
+  sprintf(buffer, "%08d", i);
+  if (i % 7 == 0)
+    *s = std::string("http://cdn.example.org/static/") + buffer + ".png";
+  else
+    *s = std::string("https://www.example.com/catalog/products/item-")
+            + buffer + ".html";
+  if (i % 50 == 0)
+    s->append(300, 'x');
+}
+
+// Inserts |count| URL-like keys in random order, verifies them with
+// lookups and a cursor, erases every other key and reopens the
+// Database. Returns the file size.
+static long
+url_key_test(int library, int count)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_RECORD_SIZE, sizeof(int)},
+    {UPS_PARAM_KEY_COMPRESSION, (uint64_t)library},
+    {0, 0}
+  };
+  if (library == UPS_COMPRESSOR_NONE)
+    params[1].name = 0;
+  ups_db_t *db;
+  ups_env_t *env;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  std::vector<int> numbers(count);
+  for (int i = 0; i < count; i++)
+    numbers[i] = i;
+  srand(42);
+  std::random_shuffle(numbers.begin(), numbers.end());
+
+  std::string s;
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  for (int i = 0; i < count; i++) {
+    make_url_key(numbers[i], &s);
+    key.data = (void *)s.data();
+    key.size = (uint16_t)s.size();
+    rec.data = &numbers[i];
+    rec.size = sizeof(int);
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  // erase every other key
+  for (int i = 1; i < count; i += 2) {
+    make_url_key(i, &s);
+    key.data = (void *)s.data();
+    key.size = (uint16_t)s.size();
+    REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  REQUIRE(0 == ups_env_open(&env, Utils::opath("test.db"), 0, 0));
+  REQUIRE(0 == ups_env_open_db(env, &db, 1, 0, 0));
+
+  std::set<std::string> remaining;
+  for (int i = 0; i < count; i += 2) {
+    make_url_key(i, &s);
+    remaining.insert(s);
+  }
+
+  for (int i = 0; i < count; i++) {
+    make_url_key(i, &s);
+    key.data = (void *)s.data();
+    key.size = (uint16_t)s.size();
+    if (i % 2) {
+      REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(db, 0, &key, &rec, 0));
+      // an approximate match returns the next larger key
+      std::set<std::string>::iterator it = remaining.lower_bound(s);
+      ups_key_t k = key;
+      if (it == remaining.end()) {
+        REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(db, 0, &k, &rec,
+                                UPS_FIND_GEQ_MATCH));
+      }
+      else {
+        REQUIRE(0 == ups_db_find(db, 0, &k, &rec, UPS_FIND_GEQ_MATCH));
+        REQUIRE(*it == std::string((const char *)k.data, k.size));
+      }
+    }
+    else {
+      REQUIRE(0 == ups_db_find(db, 0, &key, &rec, 0));
+      REQUIRE(*(int *)rec.data == i);
+    }
+  }
+
+  // the cursor returns all keys in sorted order
+  ups_cursor_t *cursor;
+  REQUIRE(0 == ups_cursor_create(&cursor, db, 0, 0));
+  std::string last;
+  int found = 0;
+  while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT)) {
+    std::string current((const char *)key.data, key.size);
+    REQUIRE(last < current);
+    make_url_key(*(int *)rec.data, &s);
+    REQUIRE(s == current);
+    last = current;
+    found++;
+  }
+  REQUIRE(found == (count + 1) / 2);
+  REQUIRE(0 == ups_cursor_close(cursor));
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+
+  FILE *f = fopen(Utils::opath("test.db"), "rb");
+  REQUIRE(f != 0);
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fclose(f);
+  return size;
+}
+
+TEST_CASE("Compression/PrefixKeyTest", "")
+{
+  long uncompressed = url_key_test(UPS_COMPRESSOR_NONE, 20000);
+  long compressed = url_key_test(UPS_COMPRESSOR_PREFIX, 20000);
+  REQUIRE(compressed < uncompressed * 3 / 4);
+}
+
+TEST_CASE("Compression/PrefixKeyTinyPageTest", "")
+{
+  ups_parameter_t env_params[] = {
+    {UPS_PARAM_PAGE_SIZE, 1024},
+    {0, 0}
+  };
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_COMPRESSION, UPS_COMPRESSOR_PREFIX},
+    {0, 0}
+  };
+  ups_db_t *db;
+  ups_env_t *env;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0,
+                          &env_params[0]));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  // sequential inserts, then erase all keys in reverse order
+  std::string s;
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  for (int i = 0; i < 3000; i++) {
+    make_url_key(i, &s);
+    key.data = (void *)s.data();
+    key.size = (uint16_t)s.size();
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+  for (int i = 2999; i >= 0; i--) {
+    make_url_key(i, &s);
+    key.data = (void *)s.data();
+    key.size = (uint16_t)s.size();
+    REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Compression/negativePrefixKeyTest", "")
+{
+  ups_parameter_t param1[] = {
+    {UPS_PARAM_KEY_COMPRESSION, UPS_COMPRESSOR_PREFIX},
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+    {0, 0}
+  };
+
+  ups_parameter_t param2[] = {
+    {UPS_PARAM_KEY_COMPRESSION, UPS_COMPRESSOR_PREFIX},
+    {UPS_PARAM_KEY_SIZE, 16},
+    {0, 0}
+  };
+
+  ups_parameter_t param3[] = {
+    {UPS_PARAM_RECORD_COMPRESSION, UPS_COMPRESSOR_PREFIX},
+    {0, 0}
+  };
+
+  ups_db_t *db;
+  ups_env_t *env;
+
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &param1[0]));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &param2[0]));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &param3[0]));
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+// Inserts |count| keys in random order with slowly increasing numeric
+// records, overwrites some of them with random values, erases every third
+// key and verifies the remaining records after reopening the Database.
+// Returns the file size.
+template<typename T>
+static long
+numeric_record_test(uint16_t type, int library, int count)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT64},
+    {UPS_PARAM_RECORD_TYPE, type},
+    {UPS_PARAM_RECORD_COMPRESSION, (uint64_t)library},
+    {0, 0}
+  };
+  if (library == UPS_COMPRESSOR_NONE)
+    params[2].name = 0;
+  ups_db_t *db;
+  ups_env_t *env;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  std::vector<uint64_t> numbers(count);
+  for (int i = 0; i < count; i++)
+    numbers[i] = i;
+  srand(42);
+  std::random_shuffle(numbers.begin(), numbers.end());
+
+  std::vector<T> expected(count);
+  for (int i = 0; i < count; i++)
+    expected[i] = (T)(1000 + i / 4) + (T)(i % 4) / (T)4;
+
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  for (int i = 0; i < count; i++) {
+    uint64_t k = numbers[i];
+    key = ups_make_key(&k, sizeof(k));
+    rec = ups_make_record(&expected[k], sizeof(T));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  // overwrite every 7th record in the first eighth of the key range with
+  // a random bit pattern; this grows the compressed blocks and splits
+  // the nodes
+  bool is_real = type == UPS_TYPE_REAL32 || type == UPS_TYPE_REAL64;
+  for (uint64_t k = 0; k < (uint64_t)count / 8; k += 7) {
+    uint64_t r = ((uint64_t)rand() << 40) ^ ((uint64_t)rand() << 20) ^ rand();
+    ::memcpy(&expected[k], &r, sizeof(T));
+    // avoid NaN, infinity and overflows when summing up the values
+    if (is_real && !(::fabs((double)expected[k]) < 1e9))
+      expected[k] = 0;
+    key = ups_make_key(&k, sizeof(k));
+    rec = ups_make_record(&expected[k], sizeof(T));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, UPS_OVERWRITE));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  // erase every third key
+  for (uint64_t k = 0; k < (uint64_t)count; k += 3) {
+    key = ups_make_key(&k, sizeof(k));
+    REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+  REQUIRE(0 == ups_env_open(&env, Utils::opath("test.db"), 0, 0));
+  REQUIRE(0 == ups_env_open_db(env, &db, 1, 0, 0));
+
+  for (uint64_t k = 0; k < (uint64_t)count; k++) {
+    key = ups_make_key(&k, sizeof(k));
+    if (k % 3 == 0) {
+      REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(db, 0, &key, &rec, 0));
+    }
+    else {
+      REQUIRE(0 == ups_db_find(db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == sizeof(T));
+      REQUIRE(0 == ::memcmp(rec.data, &expected[k], sizeof(T)));
+    }
+  }
+
+  // the cursor returns all records in sorted order
+  ups_cursor_t *cursor;
+  REQUIRE(0 == ups_cursor_create(&cursor, db, 0, 0));
+  uint64_t next = 1;
+  int found = 0;
+  while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT)) {
+    REQUIRE(*(uint64_t *)key.data == next);
+    REQUIRE(0 == ::memcmp(rec.data, &expected[next], sizeof(T)));
+    next += next % 3 == 1 ? 1 : 2;
+    found++;
+  }
+  REQUIRE(found == count - (count + 2) / 3);
+  REQUIRE(0 == ups_cursor_close(cursor));
+
+  // UQI scans the decoded records
+  uqi_result_t *result;
+  uint32_t size;
+  REQUIRE(0 == uqi_select(env, "SUM($record) from database 1", &result));
+  if (is_real) {
+    double sum = 0, abs_sum = 0;
+    for (int k = 0; k < count; k++) {
+      if (k % 3 != 0) {
+        sum += expected[k];
+        abs_sum += ::fabs((double)expected[k]);
+      }
+    }
+    double d = *(double *)uqi_result_get_record_data(result, &size);
+    REQUIRE(::fabs(d - sum) <= abs_sum * 1e-9);
+  }
+  else {
+    uint64_t sum = 0;
+    for (int k = 0; k < count; k++)
+      if (k % 3 != 0)
+        sum += (uint64_t)expected[k];
+    REQUIRE(*(uint64_t *)uqi_result_get_record_data(result, &size) == sum);
+  }
+  uqi_result_close(result);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+
+  FILE *f = fopen(Utils::opath("test.db"), "rb");
+  REQUIRE(f != 0);
+  fseek(f, 0, SEEK_END);
+  long filesize = ftell(f);
+  fclose(f);
+  return filesize;
+}
+
+TEST_CASE("Compression/NumericRecordUint8Test", "")
+{
+  numeric_record_test<uint8_t>(UPS_TYPE_UINT8, UPS_COMPRESSOR_NUMERIC, 20000);
+}
+
+TEST_CASE("Compression/NumericRecordUint16Test", "")
+{
+  numeric_record_test<uint16_t>(UPS_TYPE_UINT16, UPS_COMPRESSOR_NUMERIC,
+                  20000);
+}
+
+TEST_CASE("Compression/NumericRecordUint32Test", "")
+{
+  numeric_record_test<uint32_t>(UPS_TYPE_UINT32, UPS_COMPRESSOR_NUMERIC,
+                  20000);
+}
+
+TEST_CASE("Compression/NumericRecordUint64Test", "")
+{
+  long uncompressed = numeric_record_test<uint64_t>(UPS_TYPE_UINT64,
+                  UPS_COMPRESSOR_NONE, 50000);
+  long compressed = numeric_record_test<uint64_t>(UPS_TYPE_UINT64,
+                  UPS_COMPRESSOR_NUMERIC, 50000);
+  REQUIRE(compressed < uncompressed * 3 / 4);
+}
+
+TEST_CASE("Compression/NumericRecordReal32Test", "")
+{
+  numeric_record_test<float>(UPS_TYPE_REAL32, UPS_COMPRESSOR_NUMERIC, 20000);
+}
+
+TEST_CASE("Compression/NumericRecordReal64Test", "")
+{
+  long uncompressed = numeric_record_test<double>(UPS_TYPE_REAL64,
+                  UPS_COMPRESSOR_NONE, 50000);
+  long compressed = numeric_record_test<double>(UPS_TYPE_REAL64,
+                  UPS_COMPRESSOR_NUMERIC, 50000);
+  REQUIRE(compressed < uncompressed * 3 / 4);
+}
+
+TEST_CASE("Compression/NumericRecordAppendTest", "")
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_RECORD_COMPRESSION, UPS_COMPRESSOR_NUMERIC},
+    {0, 0}
+  };
+  ups_db_t *db;
+  ups_env_t *env;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"),
+                          UPS_ENABLE_TRANSACTIONS, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  // ascending keys with counters, then erase all keys in reverse order
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  for (uint32_t i = 0; i < 100000; i++) {
+    uint32_t r = i * 10;
+    key = ups_make_key(&i, sizeof(i));
+    rec = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  uqi_result_t *result;
+  uint32_t size;
+  REQUIRE(0 == uqi_select(env, "SUM($record) from database 1", &result));
+  REQUIRE(*(uint64_t *)uqi_result_get_record_data(result, &size)
+                  == 10ull * 99999 * 100000 / 2);
+  uqi_result_close(result);
+
+  for (uint32_t i = 100000; i-- > 0; ) {
+    key = ups_make_key(&i, sizeof(i));
+    REQUIRE(0 == ups_db_erase(db, 0, &key, 0));
+  }
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Compression/NumericRecordCursorTest", "")
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT64},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT64},
+    {UPS_PARAM_RECORD_COMPRESSION, UPS_COMPRESSOR_NUMERIC},
+    {0, 0}
+  };
+  ups_db_t *db;
+  ups_env_t *env;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  uint64_t r = 0;
+  for (uint64_t i = 0; i < 20000; i++) {
+    key = ups_make_key(&i, sizeof(i));
+    rec = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+
+  // overwriting the records with large values grows the nodes; the cursor
+  // stays coupled to its key if the node is split
+  ups_cursor_t *cursor;
+  REQUIRE(0 == ups_cursor_create(&cursor, db, 0, 0));
+  uint64_t i = 0;
+  while (0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_NEXT)) {
+    REQUIRE(*(uint64_t *)key.data == i);
+    r = ~i;
+    rec = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_cursor_overwrite(cursor, &rec, 0));
+    i++;
+  }
+  REQUIRE(i == 20000);
+  REQUIRE(0 == ups_cursor_close(cursor));
+  REQUIRE(0 == ups_db_check_integrity(db, 0));
+
+  for (i = 0; i < 20000; i++) {
+    key = ups_make_key(&i, sizeof(i));
+    REQUIRE(0 == ups_db_find(db, 0, &key, &rec, 0));
+    REQUIRE(*(uint64_t *)rec.data == ~i);
+  }
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Compression/negativeNumericRecordTest", "")
+{
+  ups_parameter_t param1[] = {
+    {UPS_PARAM_RECORD_COMPRESSION, UPS_COMPRESSOR_NUMERIC},
+    {0, 0}
+  };
+
+  ups_parameter_t param2[] = {
+    {UPS_PARAM_RECORD_COMPRESSION, UPS_COMPRESSOR_NUMERIC},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {0, 0}
+  };
+
+  ups_parameter_t param3[] = {
+    {UPS_PARAM_KEY_COMPRESSION, UPS_COMPRESSOR_NUMERIC},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {0, 0}
+  };
+
+  ups_db_t *db;
+  ups_env_t *env;
+
+  REQUIRE(0 == ups_env_create(&env, Utils::opath("test.db"), 0, 0, 0));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &param1[0]));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1,
+                          UPS_ENABLE_DUPLICATE_KEYS, &param2[0]));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &param3[0]));
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
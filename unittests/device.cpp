@@ -17,7 +17,11 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <ups/upscaledb_uqi.h>
+
 #include "2device/device.h"
+#include "1mem/buffer_pool.h"
+#include "2device/device_disk.h"
 #include "4env/env_local.h"
 
 #include "utils.h"
@@ -31,12 +35,12 @@ struct DeviceFixture
   ups_env_t *m_env;
   Device *m_dev;
 
-  DeviceFixture(bool inmemory) {
+  DeviceFixture(bool inmemory, uint32_t flags = 0) {
     (void)os::unlink(Utils::opath(".test"));
 
     REQUIRE(0 ==
         ups_env_create(&m_env, Utils::opath(".test"),
-            inmemory ? UPS_IN_MEMORY : 0, 0644, 0));
+            (inmemory ? UPS_IN_MEMORY : 0) | flags, 0644, 0));
     REQUIRE(0 ==
         ups_env_create_db(m_env, &m_db, 1, 0, 0));
     m_dev = ((LocalEnvironment *)m_env)->device();
@@ -195,6 +199,319 @@ struct DeviceFixture
       delete pages[i];
     }
   }
+
+  void writevPrefetchTest() {
+    int i;
+    Page *pages[8];
+    const void *buffers[8];
+    size_t lengths[8];
+    uint32_t ps = UPS_DEFAULT_PAGE_SIZE;
+    uint8_t *temp = (uint8_t *)malloc(ps);
+
+    EnvConfig &cfg = const_cast<EnvConfig &>(((LocalEnvironment *)m_env)->config());
+    cfg.flags |= UPS_DISABLE_MMAP;
+
+    REQUIRE(true == m_dev->is_open());
+    uint64_t address = m_dev->alloc(ps * 8);
+    for (i = 0; i < 8; i++) {
+      buffers[i] = malloc(ps);
+      lengths[i] = ps;
+      memset((void *)buffers[i], i + 1, ps);
+    }
+    m_dev->writev(address, buffers, lengths, 8);
+
+    for (i = 0; i < 8; i++)
+      m_dev->prefetch_page(address + i * ps);
+
+    // overwrite a prefetched page; the prefetched buffer must be discarded
+    memset((void *)buffers[3], 0x33, ps);
+    m_dev->write(address + 3 * ps, (void *)buffers[3], ps);
+
+    for (i = 0; i < 8; i++) {
+      pages[i] = new Page(m_dev);
+      pages[i]->set_address(address + i * ps);
+      m_dev->read_page(pages[i], address + i * ps);
+      memset(temp, i == 3 ? 0x33 : i + 1, ps);
+      REQUIRE(0 == memcmp(pages[i]->data(), temp, ps));
+      delete pages[i];
+      free((void *)buffers[i]);
+    }
+
+    ups_env_metrics_t metrics = {0};
+    m_dev->fill_metrics(&metrics);
+    // without a ring the pages are read ahead with posix_fadvise(), but
+    // not with direct I/O
+    if (metrics.page_count_prefetched > 0) {
+      REQUIRE(metrics.page_count_prefetched == 8);
+      REQUIRE(metrics.page_count_prefetch_hits == 7);
+      REQUIRE(metrics.page_count_prefetch_wasted == 1);
+    }
+    if (metrics.io_uring_submissions > 0) {
+      REQUIRE(metrics.io_uring_submissions >= 9);
+      REQUIRE(metrics.io_uring_max_queue_depth >= 1);
+    }
+    free(temp);
+  }
+
+  void cursorScanTest() {
+    ups_cursor_t *cursor;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    char buffer[64] = {0};
+
+    for (int i = 0; i < 5000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      rec.data = buffer;
+      rec.size = sizeof(buffer);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"),
+                            UPS_ENABLE_IO_URING | UPS_DISABLE_MMAP, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+
+    int count = 0;
+    while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT))
+      count++;
+    REQUIRE(count == 5000);
+    REQUIRE(0 == ups_cursor_close(cursor));
+  }
+
+  void scanReadaheadTest(uint32_t flags) {
+    const int kCount = 20000;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    char buffer[64] = {0};
+    ups_env_metrics_t metrics;
+    ups_cursor_t *cursor;
+    uqi_result_t *result;
+    uint32_t size;
+    int count;
+
+    // small pages: the leafs are spread over many parent nodes
+    ups_parameter_t create_params[] = {
+      {UPS_PARAM_PAGE_SIZE, 1024},
+      {0, 0}
+    };
+    ups_parameter_t db_params[] = {
+      {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+      {UPS_PARAM_RECORD_SIZE, sizeof(buffer)},
+      {0, 0}
+    };
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"), 0, 0644,
+                            &create_params[0]));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, &db_params[0]));
+    for (int i = 0; i < kCount; i++) {
+      key = ups_make_key(&i, sizeof(i));
+      rec = ups_make_record(buffer, sizeof(buffer));
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    ups_parameter_t open_params[] = {
+      {UPS_PARAM_SCAN_READAHEAD, 16},
+      {0, 0}
+    };
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), flags,
+                            &open_params[0]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    ups_parameter_t get_params[] = {
+      {UPS_PARAM_SCAN_READAHEAD, 0},
+      {0, 0}
+    };
+    REQUIRE(0 == ups_env_get_parameters(m_env, &get_params[0]));
+    REQUIRE(get_params[0].value == 16);
+
+    // a sequential scan reads the leafs ahead
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    count = 0;
+    while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT)) {
+      REQUIRE(*(int *)key.data == count);
+      count++;
+    }
+    REQUIRE(count == kCount);
+
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.page_count_prefetched > 0);
+    REQUIRE(metrics.page_count_prefetch_hits > 0);
+    REQUIRE(metrics.page_count_prefetch_hits
+                    <= metrics.page_count_prefetched);
+
+    // ... also backwards
+    while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_PREVIOUS)) {
+      count--;
+      REQUIRE(*(int *)key.data == count - 1);
+    }
+    REQUIRE(count == 1);
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    // and UQI queries
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), flags,
+                            &open_params[0]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    REQUIRE(0 == uqi_select(m_env, "COUNT($key) FROM DATABASE 1", &result));
+    REQUIRE(*(uint64_t *)uqi_result_get_record_data(result, &size)
+                    == (uint64_t)kCount);
+    uqi_result_close(result);
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.page_count_prefetched > 0);
+    REQUIRE(metrics.page_count_prefetch_hits > 0);
+
+    // the read-ahead can be disabled
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    open_params[0].value = 0;
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), flags,
+                            &open_params[0]));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    count = 0;
+    while (0 == ups_cursor_move(cursor, &key, &rec, UPS_CURSOR_NEXT))
+      count++;
+    REQUIRE(count == kCount);
+    REQUIRE(0 == ups_cursor_close(cursor));
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.page_count_prefetched == 0);
+  }
+
+  void growMappingTest() {
+    uint32_t ps = UPS_DEFAULT_PAGE_SIZE;
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    char buffer[1024] = {0};
+
+    // the new file is mapped while it grows
+    for (int i = 0; i < 20000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      rec.data = buffer;
+      rec.size = sizeof(buffer);
+      *(int *)buffer = i;
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+
+    uint64_t file_size = m_dev->file_size();
+    REQUIRE(file_size > 10 * 1024 * 1024);
+    REQUIRE(true == m_dev->is_mapped(0, ps));
+    REQUIRE(true == m_dev->is_mapped(file_size - ps, ps));
+    REQUIRE(false == m_dev->is_mapped(file_size - ps, 2 * ps));
+
+    // pages in the mapped range use the mapped memory
+    REQUIRE(0 == ups_env_flush(m_env, 0));
+    Page *page = new Page(m_dev, (LocalDatabase *)m_db);
+    m_dev->read_page(page, file_size - ps);
+    REQUIRE(false == page->is_allocated());
+    REQUIRE((uint8_t *)page->data()
+            == ((DiskDevice *)m_dev)->mapped_pointer(file_size - ps));
+    delete page;
+
+    // the mapped range follows the file size
+    m_dev->truncate(file_size + ps);
+    REQUIRE(true == m_dev->is_mapped(file_size, ps));
+    m_dev->truncate(file_size);
+    REQUIRE(false == m_dev->is_mapped(file_size, ps));
+    REQUIRE(true == m_dev->is_mapped(file_size - ps, ps));
+
+    // all records are still available after reopening the file
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), 0, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    m_dev = ((LocalEnvironment *)m_env)->device();
+    file_size = m_dev->file_size();
+    REQUIRE(true == m_dev->is_mapped(file_size - ps, ps));
+
+    for (int i = 0; i < 20000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == sizeof(buffer));
+      REQUIRE(*(int *)rec.data == i);
+    }
+
+    // the file keeps growing after it was reopened
+    for (int i = 20000; i < 30000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      rec.data = buffer;
+      rec.size = sizeof(buffer);
+      *(int *)buffer = i;
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    file_size = m_dev->file_size();
+    REQUIRE(true == m_dev->is_mapped(file_size - ps, ps));
+    for (int i = 0; i < 30000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(*(int *)rec.data == i);
+    }
+  }
+
+  void directIoTest() {
+    uint32_t ps = UPS_DEFAULT_PAGE_SIZE;
+    uint8_t temp[UPS_DEFAULT_PAGE_SIZE];
+
+    // page buffers are aligned for O_DIRECT
+    Page *page = new Page(m_dev, (LocalDatabase *)m_db);
+    m_dev->alloc_page(page);
+    REQUIRE(((uintptr_t)page->data() % File::kDirectIoAlignment) == 0);
+    uint64_t address = page->address();
+    memset(page->payload(), 0x13, ps - Page::kSizeofPersistentHeader);
+    page->set_dirty(true);
+    page->flush();
+    uint8_t *data = (uint8_t *)page->data();
+    delete page;
+
+    // the buffer was returned to the pool, and is reused
+    ups_env_metrics_t metrics = {0};
+    m_dev->fill_metrics(&metrics);
+    REQUIRE(metrics.page_buffers_pooled >= 1);
+    REQUIRE(metrics.page_buffer_bytes >= ps);
+
+    page = new Page(m_dev, (LocalDatabase *)m_db);
+    m_dev->read_page(page, address);
+    REQUIRE((uint8_t *)page->data() == data);
+    memset(temp, 0x13, sizeof(temp));
+    REQUIRE(0 == memcmp(page->payload(), temp,
+                            ps - Page::kSizeofPersistentHeader));
+    delete page;
+
+    // unaligned reads and writes (i.e. for the header page) still work
+    uint8_t buffer[100];
+    m_dev->read(17, buffer, sizeof(buffer));
+    m_dev->write(address + 17, buffer, sizeof(buffer));
+
+    ups_key_t key = {0};
+    ups_record_t rec = {0};
+    for (int i = 0; i < 5000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      rec.data = &i;
+      rec.size = sizeof(i);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &rec, 0));
+    }
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"),
+                            UPS_ENABLE_DIRECT_IO, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+    m_dev = ((LocalEnvironment *)m_env)->device();
+    // direct I/O disables mmap
+    if (((DiskDevice *)m_dev)->is_direct_io())
+      REQUIRE(false == m_dev->is_mapped(0, ps));
+
+    for (int i = 0; i < 5000; i++) {
+      key.data = &i;
+      key.size = sizeof(i);
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(rec.size == sizeof(i));
+      REQUIRE(*(int *)rec.data == i);
+    }
+  }
 };
 
 TEST_CASE("Device/newDelete", "")
@@ -247,11 +564,162 @@ TEST_CASE("Device/readWrite", "")
 
 TEST_CASE("Device/readWritePage", "")
 {
-  DeviceFixture f(false);
+  DeviceFixture f(false, UPS_DISABLE_MMAP);
   f. readWritePageTest();
 }
 
 
+TEST_CASE("Device-uring/readWritePage", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_IO_URING | UPS_DISABLE_MMAP);
+  f. readWritePageTest();
+}
+
+TEST_CASE("Device-uring/writevPrefetch", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_IO_URING | UPS_DISABLE_MMAP);
+  f. writevPrefetchTest();
+}
+
+TEST_CASE("Device-uring/cursorScan", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_IO_URING);
+  f. cursorScanTest();
+}
+
+TEST_CASE("Device-direct/readWritePage", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_DIRECT_IO);
+  f.readWritePageTest();
+}
+
+TEST_CASE("Device-direct/directIo", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_DIRECT_IO);
+  f.directIoTest();
+}
+
+TEST_CASE("Device-direct/ioUring", "")
+{
+  DeviceFixture f(false, UPS_ENABLE_DIRECT_IO | UPS_ENABLE_IO_URING);
+  f.writevPrefetchTest();
+}
+
+TEST_CASE("Device/scanReadahead", "")
+{
+  DeviceFixture f(false);
+  f.scanReadaheadTest(UPS_DISABLE_MMAP);
+}
+
+TEST_CASE("Device/scanReadaheadMapped", "")
+{
+  DeviceFixture f(false);
+  f.scanReadaheadTest(0);
+}
+
+TEST_CASE("Device-uring/scanReadahead", "")
+{
+  DeviceFixture f(false);
+  f.scanReadaheadTest(UPS_ENABLE_IO_URING | UPS_DISABLE_MMAP);
+}
+
+TEST_CASE("Device/growMapping", "")
+{
+  DeviceFixture f(false);
+  f.growMappingTest();
+}
+
+TEST_CASE("Device/bufferPool", "")
+{
+  const size_t ps = 16 * 1024;
+  BufferPool pool(File::kDirectIoAlignment, 2 * BufferPool::kSlabSize, false);
+  ups_env_metrics_t metrics = {0};
+
+  // the first allocation creates a slab
+  uint8_t *p1 = pool.alloc(ps);
+  REQUIRE(((uintptr_t)p1 % File::kDirectIoAlignment) == 0);
+  pool.fill_metrics(&metrics);
+  REQUIRE(metrics.page_buffer_bytes == BufferPool::kSlabSize);
+  REQUIRE(metrics.page_buffers_in_use == 1);
+  REQUIRE(metrics.page_buffers_pooled == BufferPool::kSlabSize / ps - 1);
+  REQUIRE(metrics.page_buffer_capacity == 2 * BufferPool::kSlabSize);
+
+  // released buffers are recycled
+  pool.release(p1);
+  uint8_t *p2 = pool.alloc(ps);
+  REQUIRE(p1 == p2);
+  pool.release(p2);
+
+  // exhaust the capacity; the remaining buffers are allocated from the heap
+  std::vector<uint8_t *> v;
+  for (size_t i = 0; i < 2 * BufferPool::kSlabSize / ps + 10; i++) {
+    v.push_back(pool.alloc(ps));
+    ::memset(v.back(), (int)i, ps);
+  }
+  pool.fill_metrics(&metrics);
+  REQUIRE(metrics.page_buffer_overflows == 10);
+  REQUIRE(metrics.page_buffers_pooled == 0);
+  REQUIRE(metrics.page_buffer_bytes == 2 * BufferPool::kSlabSize + 10 * ps);
+
+  for (size_t i = 0; i < v.size(); i++)
+    pool.release(v[i]);
+  pool.fill_metrics(&metrics);
+  REQUIRE(metrics.page_buffers_in_use == 0);
+  REQUIRE(metrics.page_buffers_pooled == 2 * BufferPool::kSlabSize / ps);
+  REQUIRE(metrics.page_buffer_bytes == 2 * BufferPool::kSlabSize);
+
+  // a new buffer size discards the slabs
+  uint8_t *p3 = pool.alloc(ps * 2);
+  pool.fill_metrics(&metrics);
+  REQUIRE(metrics.page_buffers_in_use == 1);
+  REQUIRE(metrics.page_buffer_bytes == BufferPool::kSlabSize);
+  pool.release(p3);
+}
+
+TEST_CASE("Device/bufferPoolHugePages", "")
+{
+  // huge pages are optional; if they are not available then the slabs
+  // are allocated from the heap
+  BufferPool pool(File::kDirectIoAlignment, 0, true);
+  ups_env_metrics_t metrics = {0};
+  uint8_t *p = pool.alloc(UPS_DEFAULT_PAGE_SIZE);
+  ::memset(p, 0, UPS_DEFAULT_PAGE_SIZE);
+  pool.fill_metrics(&metrics);
+  REQUIRE(metrics.page_buffer_bytes == BufferPool::kSlabSize);
+  REQUIRE(metrics.page_buffer_capacity == 0);
+  pool.release(p);
+}
+
+TEST_CASE("Device/pageBufferMetrics", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  ups_parameter_t params[] = {
+    { UPS_PARAM_CACHE_SIZE, 1024 * 1024 },
+    { 0, 0 }
+  };
+
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"),
+                          UPS_ENABLE_HUGE_PAGES | UPS_DISABLE_MMAP, 0644,
+                          &params[0]));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, 0));
+
+  ups_key_t key = {0};
+  ups_record_t rec = {0};
+  for (int i = 0; i < 20000; i++) {
+    key.data = &i;
+    key.size = sizeof(i);
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &rec, 0));
+  }
+
+  ups_env_metrics_t metrics = {0};
+  REQUIRE(0 == ups_env_get_metrics(env, &metrics));
+  REQUIRE(metrics.page_buffer_capacity == 1024 * 1024);
+  REQUIRE(metrics.page_buffers_in_use > 0);
+  REQUIRE(metrics.page_buffer_bytes >= 1024 * 1024);
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
 TEST_CASE("Device-inmem/newDelete", "")
 {
   DeviceFixture f(true);
@@ -17,6 +17,7 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include "1base/mutex.h"
 #include "2lsn_manager/lsn_manager.h"
 #include "3journal/journal.h"
 #include "4txn/txn.h"
@@ -75,6 +76,20 @@ struct EraseLogEntry : public LogEntry {
   ups_key_t *key;
 };
 
+static void
+group_commit_thread(ups_env_t *env, ups_db_t *db, int id, int loops)
+{
+  for (int i = 0; i < loops; i++) {
+    ups_txn_t *txn;
+    int value = id * loops + i;
+    ups_key_t key = ups_make_key(&value, sizeof(value));
+    ups_record_t rec = ups_make_record(&value, sizeof(value));
+    REQUIRE(0 == ups_txn_begin(&txn, env, 0, 0, 0));
+    REQUIRE(0 == ups_db_insert(db, txn, &key, &rec, 0));
+    REQUIRE(0 == ups_txn_commit(txn, 0));
+  }
+}
+
 struct JournalFixture {
   ups_db_t *m_db;
   ups_env_t *m_env;
@@ -1313,6 +1328,50 @@ struct JournalFixture {
     REQUIRE(params[0].value == 44);
   }
 
+  void groupCommitTest() {
+    const int kThreads = 4;
+    const int kLoops = 20;
+
+    teardown();
+
+    ups_parameter_t params[] = {
+      {UPS_PARAM_JOURNAL_GROUP_COMMIT_USEC, 2000},
+      {0, 0}
+    };
+
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"),
+                UPS_ENABLE_TRANSACTIONS | UPS_ENABLE_FSYNC, 0644,
+                &params[0]));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    params[0].value = 0;
+    REQUIRE(0 == ups_env_get_parameters(m_env, &params[0]));
+    REQUIRE(params[0].value == 2000);
+
+    std::vector<Thread *> threads;
+    for (int i = 0; i < kThreads; i++)
+      threads.push_back(new Thread(group_commit_thread, m_env, m_db,
+                              i, kLoops));
+    for (int i = 0; i < kThreads; i++) {
+      threads[i]->join();
+      delete threads[i];
+    }
+
+    // every commit was synced, and commits were grouped
+    ups_env_metrics_t metrics;
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(metrics.journal_group_commits == (uint64_t)(kThreads * kLoops));
+    REQUIRE(metrics.journal_group_fsyncs > 0);
+    REQUIRE(metrics.journal_group_fsyncs < metrics.journal_group_commits);
+
+    for (int i = 0; i < kThreads * kLoops; i++) {
+      ups_key_t key = ups_make_key(&i, sizeof(i));
+      ups_record_t rec = {0};
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &rec, 0));
+      REQUIRE(*(int *)rec.data == i);
+    }
+  }
+
   void issue45Test() {
     ups_txn_t *txn;
     ups_key_t key = {0};
@@ -1514,6 +1573,12 @@ TEST_CASE("Journal/switchThresholdTest", "")
   f.switchThresholdTest();
 }
 
+TEST_CASE("Journal/groupCommitTest", "")
+{
+  JournalFixture f;
+  f.groupCommitTest();
+}
+
 TEST_CASE("Journal/issue45Test", "")
 {
   JournalFixture f;
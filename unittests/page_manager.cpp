@@ -15,6 +15,8 @@
  * See the file COPYING for License information.
  */
 
+#include <algorithm>
+
 #include "3rdparty/catch/catch.hpp"
 
 #include "utils.h"
@@ -38,17 +40,25 @@ struct PageManagerFixture {
   Device *m_device;
   ScopedPtr<Context> m_context;
 
-  PageManagerFixture(bool inmemorydb = false, uint32_t cachesize = 0)
+  PageManagerFixture(bool inmemorydb = false, uint32_t cachesize = 0,
+                  int cache_policy = UPS_CACHE_POLICY_LRU)
       : m_db(0), m_inmemory(inmemorydb), m_device(0) {
     uint32_t flags = 0;
 
     if (m_inmemory)
       flags |= UPS_IN_MEMORY;
 
-    ups_parameter_t params[2] = {{0, 0}, {0, 0}};
+    ups_parameter_t params[3] = {{0, 0}, {0, 0}, {0, 0}};
+    int p = 0;
     if (cachesize) {
-      params[0].name = UPS_PARAM_CACHE_SIZE;
-      params[0].value = cachesize;
+      params[p].name = UPS_PARAM_CACHE_SIZE;
+      params[p].value = cachesize;
+      p++;
+    }
+    if (cache_policy != UPS_CACHE_POLICY_LRU) {
+      params[p].name = UPS_PARAM_CACHE_POLICY;
+      params[p].value = cache_policy;
+      p++;
     }
 
     REQUIRE(0 ==
@@ -256,6 +266,137 @@ struct PageManagerFixture {
     REQUIRE(false == pm->state->cache.is_cache_full());
   }
 
+  void cache2QTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    PageManager *pm = lenv->page_manager();
+    Cache &cache = pm->state->cache;
+
+    ups_parameter_t params[] = {
+        {UPS_PARAM_CACHE_POLICY, 0},
+        {0, 0}
+    };
+    REQUIRE(0 == ups_env_get_parameters(m_env, &params[0]));
+    REQUIRE(UPS_CACHE_POLICY_2Q == params[0].value);
+
+    // small caches are not sharded
+    REQUIRE(1u == cache.state.num_shards);
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+
+    // fill the cache; the existing pages (i.e. the root page of the
+    // database) are moved out of the way
+    size_t existing = cache.current_elements();
+    for (unsigned int i = 0; i < 20; i++) {
+      Page *p = new Page(lenv->device());
+      p->set_without_header(true);
+      p->assign_allocated_buffer(&pers, (i + 100) * UPS_DEFAULT_PAGE_SIZE);
+      v.push_back(p);
+      cache.put(p);
+      // new pages are stored in the probation queue
+      REQUIRE(true == cache.state.shards[0].probation.has(p));
+    }
+
+    // accessing a page in the probation queue does not move it
+    REQUIRE(v[0] == cache.get(v[0]->address()));
+    REQUIRE(true == cache.state.shards[0].probation.has(v[0]));
+
+    // the first purge candidates are the oldest probation pages
+    std::vector<uint64_t> candidates;
+    std::vector<Page *> garbage;
+    cache.purge_candidates(candidates, garbage, 0);
+    size_t purged = candidates.size() + garbage.size();
+    REQUIRE(purged == 20 + existing - 16);
+    REQUIRE(std::find(garbage.begin(), garbage.end(), v[0]) != garbage.end());
+    REQUIRE(std::find(garbage.begin(), garbage.end(), v[1]) != garbage.end());
+    REQUIRE(std::find(garbage.begin(), garbage.end(), v[19]) == garbage.end());
+
+    // evicted probation pages are remembered; when they're loaded again
+    // they're moved to the protected list
+    Page *p = v[0];
+    cache.evict(p);
+    REQUIRE((Page *)0 == cache.get(p->address()));
+    REQUIRE(1u == cache.state.shards[0].ghost_map.size());
+    cache.put(p);
+    REQUIRE(false == cache.state.shards[0].probation.has(p));
+    REQUIRE(true == cache.state.shards[0].totallist.has(p));
+
+    ups_env_metrics_t metrics;
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE(UPS_CACHE_POLICY_2Q == metrics.cache_policy);
+    REQUIRE(1u == metrics.cache_ghost_hits);
+    REQUIRE(cache.state.shards[0].probation.size()
+                    == metrics.cache_probation_pages);
+
+    // protected pages are not purged as long as the probation queue
+    // exceeds its share of the cache
+    garbage.clear();
+    cache.purge_candidates(candidates, garbage, 0);
+    REQUIRE(std::find(garbage.begin(), garbage.end(), p) == garbage.end());
+
+    for (unsigned int i = 0; i < v.size(); i++) {
+      cache.del(v[i]);
+      v[i]->set_data(0);
+      delete v[i];
+    }
+  }
+
+  void cacheShardsTest() {
+    LocalEnvironment *lenv = (LocalEnvironment *)m_env;
+    PageManager *pm = lenv->page_manager();
+    Cache &cache = pm->state->cache;
+
+    REQUIRE((size_t)CacheState::kMaxShards == cache.state.num_shards);
+
+    PPageData pers;
+    memset(&pers, 0, sizeof(pers));
+    std::vector<Page *> v;
+
+    size_t existing = cache.current_elements();
+    for (unsigned int i = 0; i < 2000; i++) {
+      Page *p = new Page(lenv->device());
+      p->set_without_header(true);
+      p->assign_allocated_buffer(&pers, (i + 100) * UPS_DEFAULT_PAGE_SIZE);
+      v.push_back(p);
+      cache.put(p);
+    }
+    REQUIRE(cache.current_elements() == existing + 2000);
+    REQUIRE(true == cache.is_cache_full());
+
+    // the pages are distributed over all shards
+    for (size_t s = 0; s < cache.state.num_shards; s++)
+      REQUIRE(cache.state.shards[s].totallist.size() > 0);
+
+    for (unsigned int i = 0; i < v.size(); i++)
+      REQUIRE(v[i] == cache.get(v[i]->address()));
+
+    ups_env_metrics_t metrics;
+    REQUIRE(0 == ups_env_get_metrics(m_env, &metrics));
+    REQUIRE((uint32_t)CacheState::kMaxShards == metrics.cache_shards);
+    REQUIRE(metrics.cache_hits >= 2000u);
+
+    // each shard is purged till it fits its share of the capacity
+    std::vector<uint64_t> candidates;
+    std::vector<Page *> garbage;
+    cache.purge_candidates(candidates, garbage, 0);
+    size_t purged = candidates.size() + garbage.size();
+    REQUIRE(purged >= existing + 2000 - 1024);
+    for (unsigned int i = 0; i < garbage.size(); i++) {
+      if (garbage[i]->address() >= 100 * UPS_DEFAULT_PAGE_SIZE)
+        cache.evict(garbage[i]);
+    }
+    for (size_t s = 0; s < cache.state.num_shards; s++)
+      REQUIRE(cache.state.shards[s].totallist.size()
+                      <= cache.state.shard_capacity + existing);
+
+    for (unsigned int i = 0; i < v.size(); i++) {
+      cache.del(v[i]);
+      v[i]->set_data(0);
+      delete v[i];
+    }
+  }
+
   void storeStateTest() {
     LocalEnvironment *lenv = (LocalEnvironment *)m_env;
     PageManagerState *state = lenv->page_manager()->state.get();
@@ -509,6 +650,18 @@ TEST_CASE("PageManager/cacheFullTest", "")
   f.cacheFullTest();
 }
 
+TEST_CASE("PageManager/cache2QTest", "")
+{
+  PageManagerFixture f(false, 16 * UPS_DEFAULT_PAGE_SIZE, UPS_CACHE_POLICY_2Q);
+  f.cache2QTest();
+}
+
+TEST_CASE("PageManager/cacheShardsTest", "")
+{
+  PageManagerFixture f(false, 1024 * UPS_DEFAULT_PAGE_SIZE);
+  f.cacheShardsTest();
+}
+
 TEST_CASE("PageManager/storeStateTest", "")
 {
   PageManagerFixture f(false, 16 * UPS_DEFAULT_PAGE_SIZE);
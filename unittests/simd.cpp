@@ -19,8 +19,12 @@
 
 #include "3rdparty/catch/catch.hpp"
 
+#include <limits>
+#include <vector>
+
 #include "utils.h"
 
+#include "1os/os.h"
 #include "2simd/simd.h"
 
 using namespace upscaledb;
@@ -90,4 +94,158 @@ TEST_CASE("Simd/doubleSseTest", "")
     REQUIRE(i == linear_search_sse<double>(&arr[0], 0, MAX, (i + 1)));
 }
 
+// Fills nodes of various sizes with keys around the middle of the value
+// range (to verify the unsigned comparisons; floating point keys are
+// partially negative) and looks up existing and missing keys
+template<typename T>
+void
+test_find(int (*search)(size_t, T *, const ups_key_t *), size_t max_count)
+{
+  for (size_t count = 1; count <= max_count; count++) {
+    T base = std::numeric_limits<T>::is_integer
+                ? (T)(std::numeric_limits<T>::max() / 2 - count + 1)
+                : (T)(-(double)count);
+    std::vector<T> arr(count);
+    for (size_t i = 0; i < count; i++)
+      arr[i] = (T)(base + 2 * i);
+
+    for (size_t i = 0; i < count; i++) {
+      T key = arr[i];
+      ups_key_t hkey = ups_make_key(&key, sizeof(key));
+      REQUIRE((int)i == search(count, &arr[0], &hkey));
+
+      key = (T)(arr[i] + 1);
+      REQUIRE(-1 == search(count, &arr[0], &hkey));
+    }
+
+    T key = (T)(base - 1);
+    ups_key_t hkey = ups_make_key(&key, sizeof(key));
+    REQUIRE(-1 == search(count, &arr[0], &hkey));
+    key = std::numeric_limits<T>::min();
+    REQUIRE(-1 == search(count, &arr[0], &hkey));
+    key = std::numeric_limits<T>::max();
+    REQUIRE(-1 == search(count, &arr[0], &hkey));
+  }
+}
+
+template<typename T>
+void
+test_find_all()
+{
+  size_t max_count = sizeof(T) == 1 ? 120 : 500;
+  if (os_has_avx2())
+    test_find<T>(find_simd_avx2<T>, max_count);
+  if (os_has_avx512())
+    test_find<T>(find_simd_avx512<T>, max_count);
+  test_find<T>(find_simd<T>, max_count);
+}
+
+TEST_CASE("Simd/uint8FindTest", "")
+{
+  test_find_all<uint8_t>();
+}
+
+TEST_CASE("Simd/uint16FindTest", "")
+{
+  test_find_all<uint16_t>();
+}
+
+TEST_CASE("Simd/uint32FindTest", "")
+{
+  test_find_all<uint32_t>();
+}
+
+TEST_CASE("Simd/uint64FindTest", "")
+{
+  test_find_all<uint64_t>();
+}
+
+TEST_CASE("Simd/floatFindTest", "")
+{
+  test_find_all<float>();
+}
+
+TEST_CASE("Simd/doubleFindTest", "")
+{
+  test_find_all<double>();
+}
+
+// Compares the selection vectors of |select| with the scalar selection;
+// the values are around the middle of the value range (floating point
+// values are partially negative)
+template<typename T>
+void
+test_select(size_t (*select)(const T *, size_t, T, T, uint32_t *))
+{
+  std::vector<T> data(300);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = std::numeric_limits<T>::is_integer
+                ? (T)(std::numeric_limits<T>::max() / 2 + (i * 7) % 40)
+                : (T)((double)((i * 7) % 40) - 20);
+
+  T base = data[0];
+  T bounds[][2] = {
+    {(T)(base + 5), (T)(base + 20)},
+    {(T)(base + 10), (T)(base + 10)},
+    {std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min()
+                                       : -std::numeric_limits<T>::max(),
+        std::numeric_limits<T>::max()},
+    {(T)(base + 20), (T)(base + 5)},
+  };
+
+  std::vector<uint32_t> expected(data.size() + 16);
+  std::vector<uint32_t> selection(data.size() + 16);
+  for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+    for (size_t length = 0; length <= data.size(); length++) {
+      size_t n = select_range_scalar<T>(&data[0], length, bounds[b][0],
+                      bounds[b][1], &expected[0]);
+      REQUIRE(n == select(&data[0], length, bounds[b][0], bounds[b][1],
+                      &selection[0]));
+      for (size_t i = 0; i < n; i++)
+        REQUIRE(expected[i] == selection[i]);
+    }
+  }
+}
+
+template<typename T>
+void
+test_select_all()
+{
+  if (os_has_avx2())
+    test_select<T>(select_range_avx2<T>);
+  if (os_has_avx512())
+    test_select<T>(select_range_avx512<T>);
+  test_select<T>(select_range_simd<T>);
+}
+
+TEST_CASE("Simd/uint8SelectTest", "")
+{
+  test_select_all<uint8_t>();
+}
+
+TEST_CASE("Simd/uint16SelectTest", "")
+{
+  test_select_all<uint16_t>();
+}
+
+TEST_CASE("Simd/uint32SelectTest", "")
+{
+  test_select_all<uint32_t>();
+}
+
+TEST_CASE("Simd/uint64SelectTest", "")
+{
+  test_select_all<uint64_t>();
+}
+
+TEST_CASE("Simd/floatSelectTest", "")
+{
+  test_select_all<float>();
+}
+
+TEST_CASE("Simd/doubleSelectTest", "")
+{
+  test_select_all<double>();
+}
+
 #endif // __SSE__
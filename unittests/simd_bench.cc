@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+/*
+ * Micro-benchmark for the in-node search functions. Compares the SSE
+ * search (binary search and a linear SSE search for the last slots),
+ * the AVX2 and AVX-512 searches and std::lower_bound for nodes of
+ * various sizes.
+ *
+ * usage: simd_bench [lookups]
+ */
+
+#include "0root/root.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#define BOOST_CHRONO_HEADER_ONLY
+#include <boost/chrono.hpp>
+
+#include "1os/os.h"
+#include "2simd/simd.h"
+
+using namespace upscaledb;
+
+#ifdef __SSE__
+
+template<typename T>
+static int
+find_std(size_t node_count, T *data, const ups_key_t *hkey)
+{
+  T key = *(T *)hkey->data;
+  T *result = std::lower_bound(data, data + node_count, key);
+  if (result == data + node_count || *result != key)
+    return -1;
+  return (int)(result - data);
+}
+
+template<typename T>
+static int
+find_sse(size_t node_count, T *data, const ups_key_t *hkey)
+{
+  return find_simd_sse<T>(node_count, data, hkey);
+}
+
+// Runs |lookups| searches for random keys and prints the average time
+// per search (in nanoseconds)
+template<typename T>
+static void
+run(const char *name, int (*search)(size_t, T *, const ups_key_t *),
+                std::vector<T> &data, std::vector<T> &keys)
+{
+  typedef boost::chrono::high_resolution_clock clock;
+
+  ups_key_t hkey = {0};
+  hkey.size = sizeof(T);
+
+  long found = 0;
+  clock::time_point start = clock::now();
+  for (size_t i = 0; i < keys.size(); i++) {
+    hkey.data = &keys[i];
+    found += search(data.size(), &data[0], &hkey) >= 0;
+  }
+  clock::duration elapsed = clock::now() - start;
+
+  if (found != (long)keys.size()) {
+    printf("%s: FAILED (%ld of %d keys found)\n", name, found,
+                    (int)keys.size());
+    exit(-1);
+  }
+
+  printf("  %-12s %8.2f ns\n", name,
+        (double)boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                elapsed).count() / keys.size());
+}
+
+template<typename T>
+static void
+bench(const char *type, size_t node_count, size_t lookups)
+{
+  std::vector<T> data(node_count);
+  for (size_t i = 0; i < node_count; i++)
+    data[i] = (T)(i * 3);
+
+  std::vector<T> keys(lookups);
+  for (size_t i = 0; i < lookups; i++)
+    keys[i] = data[rand() % node_count];
+
+  printf("%s, %d keys:\n", type, (int)node_count);
+  run<T>("std", find_std<T>, data, keys);
+  run<T>("sse", find_sse<T>, data, keys);
+  if (os_has_avx2())
+    run<T>("avx2", find_simd_avx2<T>, data, keys);
+  if (os_has_avx512())
+    run<T>("avx512", find_simd_avx512<T>, data, keys);
+  run<T>("dispatch", find_simd<T>, data, keys);
+}
+
+int
+main(int argc, char **argv)
+{
+  size_t lookups = argc > 1 ? (size_t)atol(argv[1]) : 5000000;
+
+  printf("avx2: %s, avx512: %s\n", os_has_avx2() ? "yes" : "no",
+                  os_has_avx512() ? "yes" : "no");
+
+  // node sizes of a 16kb page with a few (internal nodes) or many keys
+  bench<uint8_t>("uint8", 80, lookups);
+  static const size_t sizes[] = {64, 500, 2000};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    bench<uint16_t>("uint16", sizes[i], lookups);
+    bench<uint32_t>("uint32", sizes[i], lookups);
+    bench<uint64_t>("uint64", sizes[i], lookups);
+    bench<float>("float", sizes[i], lookups);
+    bench<double>("double", sizes[i], lookups);
+  }
+  return 0;
+}
+
+#else // !__SSE__
+
+int
+main()
+{
+  printf("SIMD is not available\n");
+  return 0;
+}
+
+#endif // __SSE__
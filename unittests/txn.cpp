@@ -1105,6 +1105,73 @@ struct HighLevelTxnFixture {
     REQUIRE(3ull == count);
   }
 
+  void snapshotReadTest() {
+    ups_txn_t *writer1, *writer2, *writer3, *snapshot;
+    ups_cursor_t *cursor;
+    uint64_t count;
+
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"),
+                        UPS_ENABLE_TRANSACTIONS, 0644, 0));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1, 0, 0));
+
+    REQUIRE(UPS_INV_PARAMETER == ups_txn_begin(&snapshot, m_env, 0, 0,
+                        UPS_TXN_SNAPSHOT));
+
+    REQUIRE(0 == insert(0, "key1", "rec1", 0));
+    REQUIRE(0 == ups_txn_begin(&writer1, m_env, 0, 0, 0));
+    REQUIRE(0 == insert(writer1, "key2", "rec2", 0));
+    REQUIRE(0 == ups_txn_begin(&writer2, m_env, 0, 0, 0));
+    REQUIRE(0 == insert(writer2, "key3", "rec3", 0));
+    REQUIRE(0 == ups_txn_begin(&writer3, m_env, 0, 0, 0));
+    REQUIRE(0 == insert(writer3, "key4", "rec4", 0));
+    REQUIRE(0 == ups_txn_commit(writer3, 0));
+
+    REQUIRE(0 == ups_txn_begin(&snapshot, m_env, 0, 0,
+                        UPS_TXN_READ_ONLY | UPS_TXN_SNAPSHOT));
+
+    // modifications after the snapshot was taken are invisible
+    REQUIRE(0 == ups_txn_commit(writer2, 0));
+    REQUIRE(0 == insert(0, "key1", "rec5", UPS_OVERWRITE));
+
+    REQUIRE(0 == find(snapshot, "key1", "rec1"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(snapshot, "key2", "rec2"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(snapshot, "key3", "rec3"));
+    REQUIRE(0 == find(snapshot, "key4", "rec4"));
+    REQUIRE(UPS_TXN_CONFLICT == find(0, "key2", "rec2"));
+    REQUIRE(0 == find(0, "key1", "rec5"));
+    REQUIRE(0 == ups_db_count(m_db, snapshot, 0, &count));
+    REQUIRE(2ull == count);
+
+    // a snapshot is read-only
+    REQUIRE(UPS_WRITE_PROTECTED == insert(snapshot, "key5", "rec5", 0));
+
+    // the committed Transactions are not flushed while the snapshot is
+    // active
+    REQUIRE(0 == ups_txn_commit(writer1, 0));
+    REQUIRE(0 == find(snapshot, "key1", "rec1"));
+    REQUIRE(UPS_KEY_NOT_FOUND == find(snapshot, "key2", "rec2"));
+
+    ups_key_t key = {0};
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, snapshot, 0));
+    REQUIRE(0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_FIRST));
+    REQUIRE(0 == strcmp("key1", (char *)key.data));
+    REQUIRE(0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_NEXT));
+    REQUIRE(0 == strcmp("key4", (char *)key.data));
+    REQUIRE(UPS_KEY_NOT_FOUND == ups_cursor_move(cursor, &key, 0,
+                        UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_LAST));
+    REQUIRE(0 == strcmp("key4", (char *)key.data));
+    REQUIRE(0 == ups_cursor_close(cursor));
+    REQUIRE(0 == ups_txn_commit(snapshot, 0));
+
+    // afterwards all changes are visible
+    REQUIRE(0 == find(0, "key1", "rec5"));
+    REQUIRE(0 == find(0, "key2", "rec2"));
+    REQUIRE(0 == find(0, "key3", "rec3"));
+    REQUIRE(0 == ups_db_count(m_db, 0, 0, &count));
+    REQUIRE(4ull == count);
+  }
+
   void insertTransactionsWithDelay(int loop) {
     ups_txn_t *txn;
 
@@ -1230,6 +1297,12 @@ TEST_CASE("Txn-high/getKeyCountOverwriteTest", "")
   f.getKeyCountOverwriteTest();
 }
 
+TEST_CASE("Txn-high/snapshotReadTest", "")
+{
+  HighLevelTxnFixture f;
+  f.snapshotReadTest();
+}
+
 TEST_CASE("Txn-high/insertTransactionsWithDelay", "")
 {
   HighLevelTxnFixture f;
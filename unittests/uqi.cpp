@@ -1863,4 +1863,712 @@ TEST_CASE("Uqi/topBottomBinaryTest", "")
   f.topBottomBinaryTest();
 }
 
+static uint64_t
+select_u64(ups_env_t *env, const std::string &query)
+{
+  uqi_result_t *result;
+  REQUIRE(0 == uqi_select(env, query.c_str(), &result));
+  uint32_t size;
+  uint64_t value = *(uint64_t *)uqi_result_get_record_data(result, &size);
+  uqi_result_close(result);
+  return (value);
+}
+
+struct ComparisonQuery {
+  const char *predicate;
+  uint64_t lo;
+  uint64_t hi;
+};
+
+// Runs built-in comparisons on the keys and compares the results with
+// the expected values
+template<typename T>
+static void
+comparison_test(int key_type, int compressor, bool use_transactions)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, (uint64_t)key_type},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_KEY_COMPRESSION, (uint64_t)compressor},
+    {0, 0}
+  };
+  if (compressor == UPS_COMPRESSOR_NONE)
+    params[2].name = 0;
+  ups_env_t *env;
+  ups_db_t *db;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"),
+                          use_transactions ? UPS_ENABLE_TRANSACTIONS : 0,
+                          0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  // the keys are multiples of 3, the records are twice the keys
+  const int count = 100000;
+  std::vector<T> keys;
+  for (int i = 0; i < count; i++) {
+    T k = (T)i * 3;
+    uint32_t r = (uint32_t)k * 2;
+    ups_key_t key = ups_make_key(&k, sizeof(k));
+    ups_record_t record = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &record, 0));
+    keys.push_back(k);
+  }
+
+  ComparisonQuery queries[] = {
+    {"between($key, 1000, 2000)", 1000, 2000},
+    {"lt($key, 3000)", 0, 2999},
+    {"le($key, 3000)", 0, 3000},
+    {"gt($key, 290000)", 290001, 0xffffffffffffffffull},
+    {"ge($key, 290001)", 290001, 0xffffffffffffffffull},
+    {"eq($key, 4500)", 4500, 4500},
+    {"eq($key, 4501)", 4501, 4501},
+    {"between($key, 2000, 1000)", 2000, 1000},
+    {"gt($key, 18446744073709551615)", 1, 0},
+    {"lt($key, 0)", 1, 0},
+    {"between($key, -5, 10.5)", 0, 10},
+    {"between($key, 0, 1e12)", 0, 0xffffffffffffffffull},
+  };
+
+  for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+    uint64_t c = 0, sum = 0, rsum = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if ((uint64_t)keys[i] >= queries[q].lo
+            && (uint64_t)keys[i] <= queries[q].hi) {
+        c++;
+        sum += (uint64_t)keys[i];
+        rsum += (uint32_t)keys[i] * 2;
+      }
+    }
+
+    std::string where = std::string(" from database 1 where ")
+                          + queries[q].predicate;
+    REQUIRE(select_u64(env, "COUNT($key)" + where) == c);
+    REQUIRE(select_u64(env, "SUM($key)" + where) == sum);
+    REQUIRE(select_u64(env, "SUM($record)" + where) == rsum);
+  }
+
+  // compare the records
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where lt($record, 2000)") == 334);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/comparisonTest", "")
+{
+  comparison_test<uint32_t>(UPS_TYPE_UINT32, UPS_COMPRESSOR_NONE, false);
+}
+
+TEST_CASE("Uqi/comparisonTxnTest", "")
+{
+  comparison_test<uint32_t>(UPS_TYPE_UINT32, UPS_COMPRESSOR_NONE, true);
+}
+
+TEST_CASE("Uqi/comparisonUint64Test", "")
+{
+  comparison_test<uint64_t>(UPS_TYPE_UINT64, UPS_COMPRESSOR_NONE, false);
+}
+
+TEST_CASE("Uqi/comparisonZint32Test", "")
+{
+  int compressors[] = {
+    UPS_COMPRESSOR_UINT32_VARBYTE,
+    UPS_COMPRESSOR_UINT32_SIMDCOMP,
+    UPS_COMPRESSOR_UINT32_GROUPVARINT,
+    UPS_COMPRESSOR_UINT32_STREAMVBYTE,
+    UPS_COMPRESSOR_UINT32_MASKEDVBYTE,
+    UPS_COMPRESSOR_UINT32_FOR,
+    UPS_COMPRESSOR_UINT32_SIMDFOR,
+  };
+  for (size_t i = 0; i < sizeof(compressors) / sizeof(compressors[0]); i++)
+    comparison_test<uint32_t>(UPS_TYPE_UINT32, compressors[i], false);
+}
+
+TEST_CASE("Uqi/comparisonZint64Test", "")
+{
+  comparison_test<uint64_t>(UPS_TYPE_UINT64, UPS_COMPRESSOR_UINT64_FOR, false);
+  comparison_test<uint64_t>(UPS_TYPE_UINT64,
+                  UPS_COMPRESSOR_UINT64_STREAMVBYTE, false);
+}
+
+TEST_CASE("Uqi/comparisonRealTest", "")
+{
+  UqiFixture f(false, UPS_TYPE_REAL32);
+  for (int i = 0; i < 20; i++) {
+    float k = (float)i / 2;
+    ups_key_t key = ups_make_key(&k, sizeof(k));
+    ups_record_t record = {0};
+    REQUIRE(0 == ups_db_insert(f.m_db, 0, &key, &record, 0));
+  }
+
+  REQUIRE(select_u64(f.m_env, "COUNT($key) from database 1 "
+                          "where lt($key, 2.5)") == 5);
+  REQUIRE(select_u64(f.m_env, "COUNT($key) from database 1 "
+                          "where le($key, 2.5)") == 6);
+  REQUIRE(select_u64(f.m_env, "COUNT($key) from database 1 "
+                          "where gt($key, 0.1)") == 19);
+  REQUIRE(select_u64(f.m_env, "COUNT($key) from database 1 "
+                          "where between($key, 1, 2)") == 3);
+  REQUIRE(select_u64(f.m_env, "COUNT($key) from database 1 "
+                          "where eq($key, 9.5)") == 1);
+}
+
+TEST_CASE("Uqi/negativeComparisonTest", "")
+{
+  UqiFixture f(false, UPS_TYPE_UINT32);
+  uqi_result_t *result;
+
+  // wrong number of arguments
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where between($key, 1)", &result));
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where lt($key)", &result));
+  // only one stream can be compared
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where lt($key, $record, 1)", &result));
+  // plugins do not accept arguments
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where foo($key, 1)", &result));
+  // binary records cannot be compared
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where lt($record, 1)", &result));
+  // the arguments must be numbers
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where lt($key, abc)", &result));
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where lt($key, 1x)", &result));
+}
+
+static void *
+merge_sum_init(int flags, int key_type, uint32_t key_size, int record_type,
+                uint32_t record_size, const char *reserved)
+{
+  return (new uint64_t(0));
+}
+
+static void
+merge_sum_cleanup(void *state)
+{
+  delete (uint64_t *)state;
+}
+
+static void
+merge_sum_single(void *state, const void *key_data, uint32_t key_size,
+                const void *record_data, uint32_t record_size)
+{
+  *(uint64_t *)state += *(const uint32_t *)key_data;
+}
+
+static void
+merge_sum_many(void *state, const void *key_data, const void *record_data,
+                size_t list_length)
+{
+  const uint32_t *keys = (const uint32_t *)key_data;
+  for (size_t i = 0; i < list_length; i++)
+    *(uint64_t *)state += keys[i];
+}
+
+static int merge_sum_calls;
+
+static void
+merge_sum_merge(void *state, void *other_state)
+{
+  *(uint64_t *)state += *(uint64_t *)other_state;
+  merge_sum_calls++;
+}
+
+static void
+merge_sum_results(void *state, uqi_result_t *result)
+{
+  uqi_result_initialize(result, UPS_TYPE_BINARY, UPS_TYPE_UINT64);
+  uqi_result_add_row(result, "SUM", 4, state, sizeof(uint64_t));
+}
+
+// Returns true if both queries return identical result sets
+static bool
+is_same_result(ups_env_t *env1, const std::string &query1,
+                ups_env_t *env2, const std::string &query2)
+{
+  uqi_result_t *r1, *r2;
+  REQUIRE(0 == uqi_select(env1, query1.c_str(), &r1));
+  REQUIRE(0 == uqi_select(env2, query2.c_str(), &r2));
+
+  bool same = uqi_result_get_row_count(r1) == uqi_result_get_row_count(r2);
+  for (uint32_t i = 0; same && i < uqi_result_get_row_count(r1); i++) {
+    ups_key_t k1, k2;
+    ups_record_t rec1, rec2;
+    uqi_result_get_key(r1, i, &k1);
+    uqi_result_get_key(r2, i, &k2);
+    uqi_result_get_record(r1, i, &rec1);
+    uqi_result_get_record(r2, i, &rec2);
+    same = k1.size == k2.size
+            && rec1.size == rec2.size
+            && 0 == ::memcmp(k1.data, k2.data, k1.size)
+            && 0 == ::memcmp(rec1.data, rec2.data, rec1.size);
+  }
+
+  uqi_result_close(r1);
+  uqi_result_close(r2);
+  return (same);
+}
+
+// Returns true if the query returns identical result sets in both
+// Environments
+static bool
+is_same_result(ups_env_t *env1, ups_env_t *env2, const std::string &query)
+{
+  return (is_same_result(env1, query, env2, query));
+}
+
+// Runs the same queries on a serial and on a parallel Environment
+static void
+parallel_test(int compressor)
+{
+  ups_parameter_t env_params[] = {
+    {UPS_PARAM_QUERY_THREADS, 4},
+    {0, 0}
+  };
+  ups_parameter_t db_params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_KEY_COMPRESSION, (uint64_t)compressor},
+    {0, 0}
+  };
+  if (compressor == UPS_COMPRESSOR_NONE)
+    db_params[2].name = 0;
+
+  ups_env_t *env1, *env2;
+  ups_db_t *db1, *db2;
+  REQUIRE(0 == ups_env_create(&env1, Utils::opath(".test"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create(&env2, Utils::opath(".test2"), 0, 0,
+                          &env_params[0]));
+  REQUIRE(0 == ups_env_create_db(env1, &db1, 1, 0, &db_params[0]));
+  REQUIRE(0 == ups_env_create_db(env2, &db2, 1, 0, &db_params[0]));
+
+  ups_parameter_t query_threads[] = {
+    {UPS_PARAM_QUERY_THREADS, 0},
+    {0, 0}
+  };
+  REQUIRE(0 == ups_env_get_parameters(env2, &query_threads[0]));
+  REQUIRE(query_threads[0].value == 4);
+
+  // the records are ascending, but not unique
+  const int count = 200000;
+  for (int i = 0; i < count; i++) {
+    uint32_t k = (uint32_t)i * 7;
+    uint32_t r = (uint32_t)i / 3;
+    ups_key_t key = ups_make_key(&k, sizeof(k));
+    ups_record_t record = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(db1, 0, &key, &record, 0));
+    REQUIRE(0 == ups_db_insert(db2, 0, &key, &record, 0));
+  }
+
+  uqi_plugin_t plugin = {0};
+  plugin.name = "merge_sum";
+  plugin.type = UQI_PLUGIN_AGGREGATE;
+  plugin.plugin_version = 1;
+  plugin.init = merge_sum_init;
+  plugin.cleanup = merge_sum_cleanup;
+  plugin.agg_single = merge_sum_single;
+  plugin.agg_many = merge_sum_many;
+  plugin.merge = merge_sum_merge;
+  plugin.results = merge_sum_results;
+  uqi_register_plugin(&plugin);
+
+  const char *functions[][2] = {
+    {"COUNT($key)", ""},
+    {"SUM($key)", ""},
+    {"SUM($record)", ""},
+    {"AVERAGE($key)", ""},
+    {"MIN($key)", ""},
+    {"MAX($key)", ""},
+    {"MIN($record)", ""},
+    {"MAX($record)", ""},
+    {"TOP($key)", " LIMIT 20"},
+    {"BOTTOM($key)", " LIMIT 20"},
+    {"TOP($record)", " LIMIT 20"},
+    {"VALUE($key)", ""},
+    {"merge_sum($key)", ""},
+    {"COUNT($key), SUM($record), MIN($key), MAX($record)", ""},
+    {"COUNT($key), SUM($key)", " GROUP BY $record"},
+    {"COUNT($key), MAX($key)", " GROUP BY field($key, 1, 1)"},
+  };
+  const char *predicates[] = {
+    "",
+    " where between($key, 7000, 700000)",
+    " where lt($key, 100)",
+    " where gt($record, 60000)",
+    " where eq($key, 8)",
+  };
+
+  for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+    for (size_t p = 0; p < sizeof(predicates) / sizeof(predicates[0]); p++) {
+      std::string query = std::string(functions[f][0]) + " from database 1"
+                            + predicates[p] + functions[f][1];
+      REQUIRE(is_same_result(env1, env2, query));
+    }
+  }
+
+  // the plugin's states were merged, i.e. the query was parallelized
+  merge_sum_calls = 0;
+  REQUIRE(select_u64(env2, "merge_sum($key) from database 1")
+                  == 7ull * count * (count - 1) / 2);
+  REQUIRE(merge_sum_calls > 0);
+  merge_sum_calls = 0;
+  REQUIRE(select_u64(env1, "merge_sum($key) from database 1")
+                  == 7ull * count * (count - 1) / 2);
+  REQUIRE(merge_sum_calls == 0);
+
+  REQUIRE(0 == ups_env_close(env1, UPS_AUTO_CLEANUP));
+  REQUIRE(0 == ups_env_close(env2, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/parallelTest", "")
+{
+  parallel_test(UPS_COMPRESSOR_NONE);
+
+  ups_parameter_t params[] = {
+    {UPS_PARAM_QUERY_THREADS, 0},
+    {0, 0}
+  };
+  ups_env_t *env;
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create(&env, Utils::opath(".test"),
+                          0, 0, &params[0]));
+}
+
+TEST_CASE("Uqi/parallelZint32Test", "")
+{
+  parallel_test(UPS_COMPRESSOR_UINT32_VARBYTE);
+  parallel_test(UPS_COMPRESSOR_UINT32_SIMDFOR);
+}
+
+// Creates a database with uint32 keys 0..999; the records are the keys
+// modulo 10
+static void
+create_group_database(ups_env_t **env, ups_db_t **db)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_RECORD_TYPE, UPS_TYPE_UINT32},
+    {0, 0}
+  };
+  REQUIRE(0 == ups_env_create(env, Utils::opath(".test"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(*env, db, 1, 0, &params[0]));
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    uint32_t r = i % 10;
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t record = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(*db, 0, &key, &record, 0));
+  }
+}
+
+static uint64_t
+row_u64(uqi_result_t *result, uint32_t row)
+{
+  ups_record_t record;
+  uqi_result_get_record(result, row, &record);
+  REQUIRE(record.size == sizeof(uint64_t));
+  return (*(uint64_t *)record.data);
+}
+
+TEST_CASE("Uqi/multiFunctionTest", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  create_group_database(&env, &db);
+
+  uqi_result_t *result;
+  ups_key_t key;
+  ups_record_t record;
+
+  // one row per function; the key is the function name
+  REQUIRE(0 == uqi_select(env, "COUNT($key), SUM($key), MAX($key) "
+                          "from database 1", &result));
+  REQUIRE(uqi_result_get_row_count(result) == 3);
+  REQUIRE(uqi_result_get_key_type(result) == UPS_TYPE_BINARY);
+  REQUIRE(uqi_result_get_record_type(result) == UPS_TYPE_BINARY);
+  uqi_result_get_key(result, 0, &key);
+  REQUIRE(0 == ::strcmp((const char *)key.data, "COUNT"));
+  REQUIRE(row_u64(result, 0) == 1000);
+  uqi_result_get_key(result, 1, &key);
+  REQUIRE(0 == ::strcmp((const char *)key.data, "SUM"));
+  REQUIRE(row_u64(result, 1) == 499500);
+  uqi_result_get_key(result, 2, &key);
+  REQUIRE(0 == ::strcmp((const char *)key.data, "MAX"));
+  uqi_result_get_record(result, 2, &record);
+  REQUIRE(record.size == sizeof(uint32_t));
+  REQUIRE(*(uint32_t *)record.data == 999);
+  uqi_result_close(result);
+
+  // all values have the same type
+  REQUIRE(0 == uqi_select(env, "COUNT($key), SUM($record) from database 1 "
+                          "where lt($key, 100)", &result));
+  REQUIRE(uqi_result_get_row_count(result) == 2);
+  REQUIRE(uqi_result_get_record_type(result) == UPS_TYPE_UINT64);
+  REQUIRE(row_u64(result, 0) == 100);
+  REQUIRE(row_u64(result, 1) == 450);
+  uqi_result_close(result);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/groupByTest", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  create_group_database(&env, &db);
+
+  uqi_result_t *result;
+  ups_key_t key;
+
+  // group by the whole record; one row per group and function
+  REQUIRE(0 == uqi_select(env, "COUNT($key), SUM($key) from database 1 "
+                          "GROUP BY $record", &result));
+  REQUIRE(uqi_result_get_row_count(result) == 20);
+  REQUIRE(uqi_result_get_key_type(result) == UPS_TYPE_UINT32);
+  REQUIRE(uqi_result_get_record_type(result) == UPS_TYPE_UINT64);
+  for (uint32_t g = 0; g < 10; g++) {
+    uqi_result_get_key(result, g * 2, &key);
+    REQUIRE(key.size == sizeof(uint32_t));
+    REQUIRE(*(uint32_t *)key.data == g);
+    uqi_result_get_key(result, g * 2 + 1, &key);
+    REQUIRE(*(uint32_t *)key.data == g);
+    REQUIRE(row_u64(result, g * 2) == 100);
+    REQUIRE(row_u64(result, g * 2 + 1) == 49500 + 100 * g);
+  }
+  uqi_result_close(result);
+
+  // group by the second byte of the key
+  REQUIRE(0 == uqi_select(env, "COUNT($key) from database 1 "
+                          "GROUP BY field($key, 1, 1)", &result));
+  REQUIRE(uqi_result_get_row_count(result) == 4);
+  REQUIRE(uqi_result_get_key_type(result) == UPS_TYPE_BINARY);
+  for (uint32_t g = 0; g < 4; g++) {
+    uqi_result_get_key(result, g, &key);
+    REQUIRE(key.size == 1);
+    REQUIRE(*(uint8_t *)key.data == g);
+    REQUIRE(row_u64(result, g) == (g < 3 ? 256u : 232u));
+  }
+  uqi_result_close(result);
+
+  // group by the first byte of the key; the groups are not consecutive
+  REQUIRE(0 == uqi_select(env, "COUNT($key) from database 1 "
+                          "where lt($key, 300) GROUP BY prefix($key, 1)",
+                          &result));
+  REQUIRE(uqi_result_get_row_count(result) == 256);
+  for (uint32_t g = 0; g < 256; g++) {
+    uqi_result_get_key(result, g, &key);
+    REQUIRE(*(uint8_t *)key.data == g);
+    REQUIRE(row_u64(result, g) == (g < 44 ? 2u : 1u));
+  }
+  uqi_result_close(result);
+
+  // no row matches
+  REQUIRE(0 == uqi_select(env, "COUNT($key) from database 1 "
+                          "where gt($key, 5000) GROUP BY $record", &result));
+  REQUIRE(uqi_result_get_row_count(result) == 0);
+  uqi_result_close(result);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/negativeGroupByTest", "")
+{
+  UqiFixture f(false, UPS_TYPE_UINT32);
+  uqi_result_t *result;
+
+  // functions which return several rows are not allowed
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key), TOP($key) "
+                          "from database 1", &result));
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "VALUE($key) "
+                          "from database 1 GROUP BY $key", &result));
+  // only one stream can be grouped
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) "
+                          "from database 1 GROUP BY $key, $record", &result));
+  // GROUP BY is specified after WHERE
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) "
+                          "from database 1 GROUP BY $key where lt($key, 3)",
+                          &result));
+  // unknown function
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key), "
+                          "foo($key) from database 1", &result));
+}
+
+// Compares the records (which are not sorted) with built-in comparisons;
+// the arrays of records are filtered with a selection vector
+template<typename T>
+static void
+record_comparison_test(int record_type, int compressor)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32},
+    {UPS_PARAM_RECORD_TYPE, (uint64_t)record_type},
+    {UPS_PARAM_RECORD_COMPRESSION, (uint64_t)compressor},
+    {0, 0}
+  };
+  if (compressor == UPS_COMPRESSOR_NONE)
+    params[2].name = 0;
+  ups_env_t *env;
+  ups_db_t *db;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  const uint32_t count = 50000;
+  for (uint32_t i = 0; i < count; i++) {
+    T r = (T)((i * 37) % 1000);
+    ups_key_t key = ups_make_key(&i, sizeof(i));
+    ups_record_t record = ups_make_record(&r, sizeof(r));
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &record, 0));
+  }
+
+  ComparisonQuery queries[] = {
+    {"$record < 100", 0, 99},
+    {"$record <= 100", 0, 100},
+    {"$record > 899", 900, 999},
+    {"$record >= 900", 900, 999},
+    {"$record = 500", 500, 500},
+    {"$record == 501", 501, 501},
+    {"$record between 100 and 199", 100, 199},
+    {"$record between 200 and 100", 1, 0},
+    {"between($record, 0, 999)", 0, 999},
+  };
+
+  for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+    uint64_t c = 0, sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t r = (i * 37) % 1000;
+      if (r >= queries[q].lo && r <= queries[q].hi) {
+        c++;
+        sum += i;
+      }
+    }
+
+    std::string where = std::string(" from database 1 where ")
+                          + queries[q].predicate;
+    REQUIRE(select_u64(env, "COUNT($key)" + where) == c);
+    REQUIRE(select_u64(env, "SUM($key)" + where) == sum);
+  }
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/recordComparisonTest", "")
+{
+  record_comparison_test<uint16_t>(UPS_TYPE_UINT16, UPS_COMPRESSOR_NONE);
+  record_comparison_test<uint32_t>(UPS_TYPE_UINT32, UPS_COMPRESSOR_NONE);
+  record_comparison_test<uint64_t>(UPS_TYPE_UINT64, UPS_COMPRESSOR_NONE);
+  record_comparison_test<float>(UPS_TYPE_REAL32, UPS_COMPRESSOR_NONE);
+  record_comparison_test<double>(UPS_TYPE_REAL64, UPS_COMPRESSOR_NONE);
+  record_comparison_test<uint32_t>(UPS_TYPE_UINT32, UPS_COMPRESSOR_NUMERIC);
+  record_comparison_test<uint64_t>(UPS_TYPE_UINT64, UPS_COMPRESSOR_NUMERIC);
+}
+
+TEST_CASE("Uqi/infixComparisonTest", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  create_group_database(&env, &db);
+
+  // the infix syntax is identical to the function syntax
+  const char *predicates[][2] = {
+    {"$key > 500", "gt($key, 500)"},
+    {"$key>=500", "ge($key, 500)"},
+    {"$key < 20", "lt($key, 20)"},
+    {"$key <= 20", "le($key, 20)"},
+    {"$key = 77", "eq($key, 77)"},
+    {"$record BETWEEN 3 AND 5", "between($record, 3, 5)"},
+    {"$record > 7", "gt($record, 7)"},
+  };
+  const char *functions[] = {
+    "COUNT($key)",
+    "SUM($record)",
+    "MIN($key)",
+    "MAX($record)",
+    "TOP($key)",
+    "VALUE($record)",
+  };
+
+  for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+    for (size_t p = 0; p < sizeof(predicates) / sizeof(predicates[0]); p++) {
+      std::string q1 = std::string(functions[f]) + " from database 1 where "
+                          + predicates[p][0];
+      std::string q2 = std::string(functions[f]) + " from database 1 where "
+                          + predicates[p][1];
+      REQUIRE(is_same_result(env, q1, env, q2));
+    }
+  }
+
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where $record between 3 and 5") == 300);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where $key >= 990") == 10);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+// Compares binary keys with a prefix
+static void
+starts_with_test(uint32_t key_size)
+{
+  ups_parameter_t params[] = {
+    {UPS_PARAM_KEY_TYPE, UPS_TYPE_BINARY},
+    {UPS_PARAM_KEY_SIZE, key_size},
+    {0, 0}
+  };
+  ups_env_t *env;
+  ups_db_t *db;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"), 0, 0, 0));
+  REQUIRE(0 == ups_env_create_db(env, &db, 1, 0, &params[0]));
+
+  for (int i = 0; i < 2000; i++) {
+    char buffer[16];
+    ::sprintf(buffer, "key%05d", i);
+    ups_key_t key = ups_make_key(buffer, 8);
+    ups_record_t record = ups_make_record(buffer, 8);
+    REQUIRE(0 == ups_db_insert(db, 0, &key, &record, 0));
+  }
+
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($key, key001)") == 100);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($key, \"key01\")") == 1000);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($key, \"key00000\")") == 1);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($key, \"key000000\")") == 0);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($record, key0199)") == 10);
+  REQUIRE(select_u64(env, "COUNT($key) from database 1 "
+                          "where starts_with($key, x)") == 0);
+
+  REQUIRE(0 == ups_env_close(env, UPS_AUTO_CLEANUP));
+}
+
+TEST_CASE("Uqi/startsWithTest", "")
+{
+  starts_with_test(UPS_KEY_SIZE_UNLIMITED);
+  starts_with_test(8);
+}
+
+TEST_CASE("Uqi/negativeInfixComparisonTest", "")
+{
+  UqiFixture f(false, UPS_TYPE_UINT32);
+  uqi_result_t *result;
+
+  // the argument must be a number
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where $key > abc", &result));
+  // only one stream can be compared
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where $key, $record > 1", &result));
+  // "between" requires two arguments
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where $key between 1", &result));
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where $key > ", &result));
+  // starts_with requires binary keys
+  REQUIRE(UPS_PARSER_ERROR == uqi_select(f.m_env, "COUNT($key) from "
+                          "database 1 where starts_with($key, 1)", &result));
+}
+
 } // namespace upscaledb
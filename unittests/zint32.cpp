@@ -161,6 +161,48 @@ struct Zint32Fixture {
     uqi_result_close(result);
   }
 
+  void approxMatchTest() {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    // keys are multiples of 3; search for each key and for its neighbours
+    // (which do not exist)
+    const uint32_t max = 30000;
+    for (uint32_t i = 0; i < max; i++) {
+      uint32_t k = 1 + i * 3;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+    }
+
+    for (uint32_t k = 0; k < max * 3 + 2; k++) {
+      uint32_t kk = k;
+      key.data = (void *)&kk;
+      key.size = sizeof(kk);
+      ups_status_t st = ups_db_find(m_db, 0, &key, &record,
+                        UPS_FIND_GEQ_MATCH);
+      if (k > 1 + (max - 1) * 3)
+        REQUIRE(st == UPS_KEY_NOT_FOUND);
+      else {
+        REQUIRE(st == 0);
+        REQUIRE(*(uint32_t *)key.data == k + (3 - (k + 2) % 3) % 3);
+      }
+
+      kk = k;
+      key.data = (void *)&kk;
+      key.size = sizeof(kk);
+      st = ups_db_find(m_db, 0, &key, &record, UPS_FIND_LEQ_MATCH);
+      if (k < 1)
+        REQUIRE(st == UPS_KEY_NOT_FOUND);
+      else {
+        REQUIRE(st == 0);
+        REQUIRE(*(uint32_t *)key.data
+                    == std::min(k - (k + 2) % 3, 1 + (max - 1) * 3));
+      }
+    }
+  }
+
   void uqiTestDuplicate() {
     ups_key_t key = {0};
     ups_record_t record = {0};
@@ -610,6 +652,26 @@ TEST_CASE("Zint32/SimdFOR/uqiTest-duplicate", "")
 #endif
 }
 
+TEST_CASE("Zint32/Zint32/approxMatchTest", "")
+{
+  uint64_t compressors[] = {
+    UPS_COMPRESSOR_UINT32_VARBYTE,
+    UPS_COMPRESSOR_UINT32_GROUPVARINT,
+    UPS_COMPRESSOR_UINT32_STREAMVBYTE,
+    UPS_COMPRESSOR_UINT32_MASKEDVBYTE,
+    UPS_COMPRESSOR_UINT32_FOR,
+#ifdef HAVE_SSE2
+    UPS_COMPRESSOR_UINT32_SIMDCOMP,
+    UPS_COMPRESSOR_UINT32_SIMDFOR,
+#endif
+  };
+
+  for (size_t i = 0; i < sizeof(compressors) / sizeof(compressors[0]); i++) {
+    Zint32Fixture f(compressors[i], false, 0);
+    f.approxMatchTest();
+  }
+}
+
 TEST_CASE("Zint32/Zint32/invalidPagesizeTest", "")
 {
   ups_parameter_t p1[] = {
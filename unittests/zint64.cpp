@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2005-2016 Christoph Rupp (chris@crupp.de).
+ * All Rights Reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See the file COPYING for License information.
+ */
+
+#include <stdio.h>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include <ups/upscaledb_uqi.h>
+
+#include "3rdparty/catch/catch.hpp"
+
+#include "utils.h"
+#include "os.hpp"
+
+namespace upscaledb {
+
+struct Zint64Fixture {
+  ups_db_t *m_db;
+  ups_env_t *m_env;
+
+  typedef std::vector<uint64_t> IntVector;
+
+  Zint64Fixture(uint64_t compressor, bool use_duplicates, uint64_t record_size)
+    : m_db(0), m_env(0) {
+    ups_parameter_t p[] = {
+      { UPS_PARAM_RECORD_SIZE, record_size },
+      { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT64 },
+      { UPS_PARAM_KEY_COMPRESSION, compressor },
+      { 0, 0 }
+    };
+
+    if (compressor == 0) {
+      p[2].name = 0;
+      p[2].value = 0;
+    }
+
+    REQUIRE(0 == ups_env_create(&m_env, Utils::opath(".test"), 0, 0644, 0));
+    REQUIRE(0 == ups_env_create_db(m_env, &m_db, 1,
+                    use_duplicates ? UPS_ENABLE_DUPLICATES : 0,
+                    &p[0]));
+  }
+
+  ~Zint64Fixture() {
+    if (m_env)
+      REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+  }
+
+  void reopen() {
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    REQUIRE(0 == ups_env_open(&m_env, Utils::opath(".test"), 0, 0));
+    REQUIRE(0 == ups_env_open_db(m_env, &m_db, 1, 0, 0));
+  }
+
+  void insertFindEraseFind(const IntVector &ivec) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    for (IntVector::const_iterator it = ivec.begin(); it != ivec.end(); it++) {
+      uint64_t k = *it;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+      record.data = (void *)&k;
+      record.size = sizeof(k);
+
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+    }
+
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+    reopen();
+
+    for (IntVector::const_iterator it = ivec.begin();
+                    it != ivec.end(); it++) {
+      uint64_t k = *it;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+
+      REQUIRE(0 == ups_db_find(m_db, 0, &key, &record, 0));
+      REQUIRE(record.size == sizeof(uint64_t));
+      REQUIRE(*(uint64_t *)record.data == k);
+    }
+
+    for (IntVector::const_iterator it = ivec.begin();
+                    it != ivec.end(); it++) {
+      uint64_t k = *it;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+
+      REQUIRE(0 == ups_db_erase(m_db, 0, &key, 0));
+    }
+
+    for (IntVector::const_iterator it = ivec.begin();
+                    it != ivec.end(); it++) {
+      uint64_t k = *it;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+
+      REQUIRE(UPS_KEY_NOT_FOUND == ups_db_find(m_db, 0, &key, &record, 0));
+    }
+  }
+
+  // Inserts the keys, then compares cursor iteration and approximate
+  // matching with a std::set
+  void approxMatchTest(const IntVector &ivec) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+    std::set<uint64_t> set;
+
+    for (IntVector::const_iterator it = ivec.begin(); it != ivec.end(); it++) {
+      uint64_t k = *it;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+      set.insert(k);
+    }
+
+    ups_cursor_t *cursor;
+    REQUIRE(0 == ups_cursor_create(&cursor, m_db, 0, 0));
+    for (std::set<uint64_t>::iterator it = set.begin(); it != set.end(); it++) {
+      REQUIRE(0 == ups_cursor_move(cursor, &key, 0, UPS_CURSOR_NEXT));
+      REQUIRE(key.size == sizeof(uint64_t));
+      REQUIRE(*(uint64_t *)key.data == *it);
+    }
+    REQUIRE(UPS_KEY_NOT_FOUND == ups_cursor_move(cursor, &key, 0,
+                            UPS_CURSOR_NEXT));
+    REQUIRE(0 == ups_cursor_close(cursor));
+
+    // search for each key, and for its neighbours (which do not exist)
+    for (std::set<uint64_t>::iterator it = set.begin(); it != set.end(); it++) {
+      uint64_t values[] = {*it - 1, *it, *it + 1};
+      for (int i = 0; i < 3; i++) {
+        uint64_t k = values[i];
+
+        std::set<uint64_t>::iterator geq = set.lower_bound(k);
+        key.data = (void *)&k;
+        key.size = sizeof(k);
+        ups_status_t st = ups_db_find(m_db, 0, &key, &record,
+                        UPS_FIND_GEQ_MATCH);
+        if (geq == set.end())
+          REQUIRE(st == UPS_KEY_NOT_FOUND);
+        else {
+          REQUIRE(st == 0);
+          REQUIRE(*(uint64_t *)key.data == *geq);
+        }
+
+        std::set<uint64_t>::iterator gt = set.upper_bound(k);
+        k = values[i];
+        key.data = (void *)&k;
+        key.size = sizeof(k);
+        st = ups_db_find(m_db, 0, &key, &record, UPS_FIND_GT_MATCH);
+        if (gt == set.end())
+          REQUIRE(st == UPS_KEY_NOT_FOUND);
+        else {
+          REQUIRE(st == 0);
+          REQUIRE(*(uint64_t *)key.data == *gt);
+        }
+
+        k = values[i];
+        key.data = (void *)&k;
+        key.size = sizeof(k);
+        st = ups_db_find(m_db, 0, &key, &record, UPS_FIND_LT_MATCH);
+        if (set.lower_bound(k) == set.begin())
+          REQUIRE(st == UPS_KEY_NOT_FOUND);
+        else {
+          REQUIRE(st == 0);
+          REQUIRE(*(uint64_t *)key.data == *--set.lower_bound(k));
+        }
+      }
+    }
+  }
+
+  void uqiTest() {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    // the keys are larger than 32bit
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < 30000; i++) {
+      uint64_t k = (1ull << 40) + i * 3;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+      sum += k;
+
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+    }
+
+    uqi_result_t *result;
+    uint32_t size;
+
+    REQUIRE(0 == uqi_select(m_env, "SUM($key) from database 1", &result));
+    REQUIRE(uqi_result_get_record_type(result) == UPS_TYPE_UINT64);
+    REQUIRE(*(uint64_t *)uqi_result_get_record_data(result, &size) == sum);
+    uqi_result_close(result);
+
+    REQUIRE(0 == uqi_select(m_env, "COUNT($key) from database 1", &result));
+    REQUIRE(*(uint64_t *)uqi_result_get_record_data(result, &size) == 30000);
+    uqi_result_close(result);
+  }
+
+  // Returns the file size after inserting |count| ascending timestamps
+  uint64_t timestampTest(int count) {
+    ups_key_t key = {0};
+    ups_record_t record = {0};
+
+    uint64_t k = 1476614400000000000ull; // nanoseconds
+    for (int i = 0; i < count; i++) {
+      k += 1000 + (i * 7919) % 5000;
+      key.data = (void *)&k;
+      key.size = sizeof(k);
+      REQUIRE(0 == ups_db_insert(m_db, 0, &key, &record, 0));
+    }
+    REQUIRE(0 == ups_db_check_integrity(m_db, 0));
+    REQUIRE(0 == ups_env_close(m_env, UPS_AUTO_CLEANUP));
+    m_env = 0;
+
+    FILE *f = fopen(Utils::opath(".test"), "rb");
+    REQUIRE(f != 0);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return (size);
+  }
+};
+
+static Zint64Fixture::IntVector
+random_keys()
+{
+  Zint64Fixture::IntVector ivec;
+  for (uint64_t i = 0; i < 30000; i++)
+    ivec.push_back(0xf000000000000000ull + i * 1000003);
+  std::srand(0); // make this reproducible
+  std::random_shuffle(ivec.begin(), ivec.end());
+  return (ivec);
+}
+
+static Zint64Fixture::IntVector
+ascending_keys()
+{
+  Zint64Fixture::IntVector ivec;
+  for (uint64_t i = 0; i < 30000; i++)
+    ivec.push_back(i * i);
+  return (ivec);
+}
+
+static Zint64Fixture::IntVector
+descending_keys()
+{
+  Zint64Fixture::IntVector ivec;
+  for (uint64_t i = 30000; i > 0; i--)
+    ivec.push_back(i << 33);
+  return (ivec);
+}
+
+// mixes small and very large gaps; requires deltas of all sizes
+static Zint64Fixture::IntVector
+sparse_keys()
+{
+  Zint64Fixture::IntVector ivec;
+  uint64_t k = 1;
+  for (int i = 0; i < 5000; i++) {
+    ivec.push_back(k);
+    k += 1ull << ((i * 13) % 50);
+  }
+  ivec.push_back(0xffffffffffffffffull);
+  std::srand(1);
+  std::random_shuffle(ivec.begin(), ivec.end());
+  return (ivec);
+}
+
+TEST_CASE("Zint64/Pod/randomDataTest", "")
+{
+  Zint64Fixture f(0, false, 8);
+  f.insertFindEraseFind(random_keys());
+}
+
+TEST_CASE("Zint64/Pod/approxMatchTest", "")
+{
+  Zint64Fixture f(0, false, 0);
+  f.approxMatchTest(sparse_keys());
+}
+
+TEST_CASE("Zint64/For/randomDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 8);
+  f.insertFindEraseFind(random_keys());
+}
+
+TEST_CASE("Zint64/For/ascendingDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 8);
+  f.insertFindEraseFind(ascending_keys());
+}
+
+TEST_CASE("Zint64/For/descendingDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 8);
+  f.insertFindEraseFind(descending_keys());
+}
+
+TEST_CASE("Zint64/For/sparseDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 8);
+  f.insertFindEraseFind(sparse_keys());
+}
+
+TEST_CASE("Zint64/For/approxMatchTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 0);
+  f.approxMatchTest(sparse_keys());
+}
+
+TEST_CASE("Zint64/For/uqiTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 0);
+  f.uqiTest();
+}
+
+TEST_CASE("Zint64/StreamVbyte/randomDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 8);
+  f.insertFindEraseFind(random_keys());
+}
+
+TEST_CASE("Zint64/StreamVbyte/ascendingDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 8);
+  f.insertFindEraseFind(ascending_keys());
+}
+
+TEST_CASE("Zint64/StreamVbyte/descendingDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 8);
+  f.insertFindEraseFind(descending_keys());
+}
+
+TEST_CASE("Zint64/StreamVbyte/sparseDataTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 8);
+  f.insertFindEraseFind(sparse_keys());
+}
+
+TEST_CASE("Zint64/StreamVbyte/approxMatchTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 0);
+  f.approxMatchTest(sparse_keys());
+}
+
+TEST_CASE("Zint64/StreamVbyte/uqiTest", "")
+{
+  Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 0);
+  f.uqiTest();
+}
+
+TEST_CASE("Zint64/timestampTest", "")
+{
+  uint64_t uncompressed, for_size, svb_size;
+  {
+    Zint64Fixture f(0, false, 0);
+    uncompressed = f.timestampTest(200000);
+  }
+  {
+    Zint64Fixture f(UPS_COMPRESSOR_UINT64_FOR, false, 0);
+    for_size = f.timestampTest(200000);
+  }
+  {
+    Zint64Fixture f(UPS_COMPRESSOR_UINT64_STREAMVBYTE, false, 0);
+    svb_size = f.timestampTest(200000);
+  }
+  REQUIRE(for_size < uncompressed / 2);
+  REQUIRE(svb_size < uncompressed / 2);
+}
+
+TEST_CASE("Zint64/negativeTest", "")
+{
+  ups_env_t *env;
+  ups_db_t *db;
+  ups_parameter_t p[] = {
+    { UPS_PARAM_KEY_TYPE, UPS_TYPE_UINT32 },
+    { UPS_PARAM_KEY_COMPRESSION, UPS_COMPRESSOR_UINT64_FOR },
+    { 0, 0 }
+  };
+
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"), 0, 0644, 0));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &p[0]));
+  p[0].value = UPS_TYPE_BINARY;
+  p[1].value = UPS_COMPRESSOR_UINT64_STREAMVBYTE;
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &p[0]));
+  REQUIRE(0 == ups_env_close(env, 0));
+
+  // uint64 compression requires 16kb pages
+  ups_parameter_t ep[] = {
+    { UPS_PARAM_PAGE_SIZE, 1024 * 4 },
+    { 0, 0 }
+  };
+  p[0].value = UPS_TYPE_UINT64;
+  REQUIRE(0 == ups_env_create(&env, Utils::opath(".test"), 0, 0644, &ep[0]));
+  REQUIRE(UPS_INV_PARAMETER == ups_env_create_db(env, &db, 1, 0, &p[0]));
+  REQUIRE(0 == ups_env_close(env, 0));
+}
+
+} // namespace upscaledb